@@ -0,0 +1,296 @@
+/* ================================================================
+ * lookup_bench.c — cJSON Object Lookups: List Walk vs Hash Index
+ *
+ * Builds objects of increasing width and looks up every key, once
+ * through cJSON_GetObjectItemCaseSensitive() (which indexes an
+ * object after the first long walk) and once by walking the child
+ * list as cJSON used to, reporting nanoseconds per lookup.
+ *
+ * Before timing, it checks that the index never changes an answer:
+ * random Add/Insert/Detach/Delete/Replace sequences on objects with
+ * case-variant duplicate keys, each followed by case-sensitive and
+ * case-insensitive lookups of every key compared against the walk.
+ * The same is checked through an object reference, with edits
+ * made through the original and through the reference.
+ *
+ * Usage: ./bench/lookup_bench [max_width] [check_rounds]
+ * Example: ./bench/lookup_bench 4096 300
+ * ================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "../cJSON.h"
+
+#define KEY_POOL 48 // Distinct keys in the consistency check (x2 case variants)
+
+/* ================================================================
+ * walkLookup() — The list walk get_object_item() does without an
+ * index
+ * ================================================================ */
+static cJSON *walkLookup(const cJSON *object, const char *name, int caseSensitive) {
+    for (cJSON *child = object->child; child != NULL; child = child->next) {
+        if (caseSensitive) {
+            if (child->string == NULL) {
+                return NULL;
+            }
+            if (strcmp(name, child->string) == 0) {
+                return child;
+            }
+        }
+        else if (child->string != NULL && strcasecmp(name, child->string) == 0) {
+            return child;
+        }
+    }
+    return NULL;
+}
+
+/* ================================================================
+ * poolKey() — Key i of the check pool; odd i are upper-case twins
+ * ================================================================ */
+static void poolKey(int i, char *key, size_t size) {
+    snprintf(key, size, (i % 2) ? "KEY_%02d" : "key_%02d", i / 2);
+}
+
+/* ================================================================
+ * checkObject() — Every lookup through cJSON agrees with the walk
+ *
+ * Returns 0, or -1 (with a message) on the first disagreement.
+ * ================================================================ */
+static int checkObject(const cJSON *object, long round) {
+    char key[16];
+
+    for (int i = 0; i < KEY_POOL * 2; i++) {
+        poolKey(i, key, sizeof(key));
+        if (cJSON_GetObjectItemCaseSensitive(object, key) != walkLookup(object, key, 1) ||
+            cJSON_GetObjectItem(object, key) != walkLookup(object, key, 0) ||
+            cJSON_HasObjectItem(object, key) != (walkLookup(object, key, 0) != NULL)) {
+            printf("Error: lookup of %s disagrees with the list walk in round %ld\n", key, round);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* ================================================================
+ * consistencyCheck() — Random edits interleaved with lookups
+ *
+ * Returns 0, or -1 on a disagreement.
+ * ================================================================ */
+static int consistencyCheck(long rounds) {
+    char key[16];
+    srand(1);
+
+    for (long round = 0; round < rounds; round++) {
+        cJSON *object = cJSON_CreateObject();
+        int edits = 50 + rand() % 200;
+
+        for (int e = 0; e < edits; e++) {
+            int size = cJSON_GetArraySize(object);
+            poolKey(rand() % (KEY_POOL * 2), key, sizeof(key));
+
+            switch (rand() % 8) {
+                case 0:
+                case 1:
+                case 2:
+                    cJSON_AddNumberToObject(object, key, e);
+                    break;
+                case 3: {
+                    cJSON *item = cJSON_CreateNumber(e);
+                    item->string = strdup(key);
+                    if (!cJSON_InsertItemInArray(object, size > 0 ? rand() % size : 0, item)) {
+                        cJSON_Delete(item);
+                    }
+                    break;
+                }
+                case 4:
+                    if (rand() % 2) {
+                        cJSON_DeleteItemFromObject(object, key);
+                    }
+                    else {
+                        cJSON_DeleteItemFromObjectCaseSensitive(object, key);
+                    }
+                    break;
+                case 5:
+                    if (size > 0) {
+                        cJSON_Delete(cJSON_DetachItemViaPointer(object,
+                                                                cJSON_GetArrayItem(object, rand() % size)));
+                    }
+                    break;
+                case 6: {
+                    cJSON *item = cJSON_CreateNumber(-e);
+                    int replaced = (rand() % 2) ? cJSON_ReplaceItemInObject(object, key, item)
+                                                : cJSON_ReplaceItemInObjectCaseSensitive(object, key, item);
+                    if (!replaced) {
+                        cJSON_Delete(item);
+                    }
+                    break;
+                }
+                default:
+                    if (size > 0) {
+                        // Replace a member by position with one under another key
+                        cJSON *item = cJSON_CreateNumber(-e);
+                        item->string = strdup(key);
+                        cJSON_ReplaceItemInArray(object, rand() % size, item);
+                    }
+                    break;
+            }
+
+            if (checkObject(object, round) == -1) {
+                cJSON_Delete(object);
+                return -1;
+            }
+        }
+        cJSON_Delete(object);
+    }
+    return 0;
+}
+
+/* ================================================================
+ * referenceCheck() — Lookups on an object and its reference while
+ * either one is edited
+ *
+ * A reference shares the original's child list, so an edit made
+ * through one must show through the other. The original is
+ * indexed before the reference is taken. The first member is never
+ * replaced, detached or inserted before: each side keeps its own
+ * pointer to it, as in stock cJSON.
+ *
+ * Returns 0, or -1 (with a message) on a disagreement.
+ * ================================================================ */
+static int referenceCheck(long rounds) {
+    char key[16];
+    srand(2);
+
+    for (long round = 0; round < rounds; round++) {
+        cJSON *object = cJSON_CreateObject();
+        cJSON *holder = cJSON_CreateArray();
+
+        cJSON_AddNumberToObject(object, "head", -1);
+        for (int i = 0; i < KEY_POOL; i++) {
+            poolKey(i, key, sizeof(key));
+            cJSON_AddNumberToObject(object, key, i);
+        }
+        poolKey(KEY_POOL - 1, key, sizeof(key));
+        cJSON_GetObjectItemCaseSensitive(object, key); // A long walk: indexes the object
+        cJSON_AddItemReferenceToArray(holder, object);
+        cJSON *reference = cJSON_GetArrayItem(holder, 0);
+
+        int edits = 20 + rand() % 60;
+        for (int e = 0; e < edits; e++) {
+            cJSON *target = (rand() % 2) ? reference : object;
+            int size = cJSON_GetArraySize(object);
+            poolKey(rand() % (KEY_POOL * 2), key, sizeof(key));
+
+            // Pool keys never match "head", the first member
+            switch (rand() % 4) {
+                case 0:
+                    cJSON_AddNumberToObject(target, key, e);
+                    break;
+                case 1:
+                    cJSON_DeleteItemFromObjectCaseSensitive(target, key);
+                    break;
+                case 2:
+                    if (size > 1) {
+                        cJSON *item = cJSON_CreateNumber(-e);
+                        item->string = strdup(key);
+                        cJSON_ReplaceItemInArray(target, 1 + rand() % (size - 1), item);
+                    }
+                    break;
+                default: {
+                    cJSON *item = cJSON_CreateNumber(e);
+                    item->string = strdup(key);
+                    cJSON_InsertItemInArray(target, 1 + rand() % size, item);
+                    break;
+                }
+            }
+
+            if (checkObject(reference, round) == -1 || checkObject(object, round) == -1) {
+                cJSON_Delete(holder);
+                cJSON_Delete(object);
+                return -1;
+            }
+        }
+        cJSON_Delete(holder);
+        cJSON_Delete(object);
+    }
+    return 0;
+}
+
+/* ================================================================
+ * nowSeconds() — CLOCK_MONOTONIC time in seconds
+ * ================================================================ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    long maxWidth = (argc > 1) ? atol(argv[1]) : 4096;
+    long rounds = (argc > 2) ? atol(argv[2]) : 300;
+
+    if (maxWidth < 1 || rounds < 0) {
+        printf("Usage: %s [max_width] [check_rounds]\n", argv[0]);
+        return 1;
+    }
+
+    if (consistencyCheck(rounds) == -1) {
+        return 1;
+    }
+    if (referenceCheck(rounds) == -1) {
+        return 1;
+    }
+    printf("Consistency: %ld random edit sequences, on objects and through references, "
+           "every lookup matches the list walk\n", rounds);
+
+    printf("%8s %14s %14s %9s\n", "members", "walk ns/key", "index ns/key", "speedup");
+    for (long width = 4; width <= maxWidth; width *= 4) {
+        cJSON *object = cJSON_CreateObject();
+        char (*keys)[32] = malloc((size_t)width * sizeof(*keys));
+        if (object == NULL || keys == NULL) {
+            printf("Error: Out of memory\n");
+            return 1;
+        }
+        for (long i = 0; i < width; i++) {
+            snprintf(keys[i], sizeof(keys[i]), "Field_%ld", i);
+            cJSON_AddNumberToObject(object, keys[i], (double)i);
+        }
+
+        // A walk costs about width steps, so width^2 * passes stays constant
+        long passes = (1L << 26) / (width * width) + 1;
+        long found = 0;
+
+        double start = nowSeconds();
+        for (long p = 0; p < passes; p++) {
+            for (long i = 0; i < width; i++) {
+                found += walkLookup(object, keys[i], 1) != NULL;
+            }
+        }
+        double middle = nowSeconds();
+        for (long p = 0; p < passes; p++) {
+            for (long i = 0; i < width; i++) {
+                found -= cJSON_GetObjectItemCaseSensitive(object, keys[i]) != NULL;
+            }
+        }
+        double finish = nowSeconds();
+
+        double lookups = (double)passes * width;
+        double walkNs = (middle - start) / lookups * 1e9;
+        double indexNs = (finish - middle) / lookups * 1e9;
+        printf("%8ld %14.1f %14.1f %8.1fx\n", width, walkNs, indexNs, walkNs / indexNs);
+        if (found != 0) {
+            printf("Error: the two methods found different members\n");
+            return 1;
+        }
+
+        free(keys);
+        cJSON_Delete(object);
+    }
+
+    return 0;
+}
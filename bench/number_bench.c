@@ -0,0 +1,341 @@
+/* ================================================================
+ * number_bench.c — cJSON Number Parsing: strtod vs Fast Paths
+ *
+ * Checks that cJSON's number parser (integer, Clinger and
+ * Eisel-Lemire fast paths, strtod() for the rest) agrees bit for
+ * bit with strtod() over a random corpus: integers of up to 25
+ * digits, decimals, exponents past the double range, subnormals,
+ * shortest and 17/18-digit prints of random doubles, exact
+ * halfway points between doubles, and the non-JSON runs cJSON has
+ * always accepted ("01", "1.", "-.5", "1e+", "1.5.3"). For each,
+ * valuedouble, valueint and the end of the parse must match what
+ * strtod() gives.
+ *
+ * The timing then parses arrays of typical numbers and reports
+ * nanoseconds per number for cJSON_Parse() (tree included) against
+ * the work the old parse_number() did per number alone: allocate,
+ * copy, strtod(), free.
+ *
+ * Usage: ./bench/number_bench [check_values] [array_size]
+ * Example: ./bench/number_bench 2000000 100000
+ * ================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+
+#include "../cJSON.h"
+
+#define ROUNDS 5      // Passes over the array per parser (best is kept)
+#define LEXEME_MAX 96 // Longest lexeme the generator writes
+
+static uint64_t rngState = 88172645463325252ULL;
+static volatile double sink; // Keeps the strtod() results alive
+
+/* ================================================================
+ * nextRandom() — xorshift64
+ * ================================================================ */
+static uint64_t nextRandom(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+/* ================================================================
+ * randomFinite() — A double with a random finite bit pattern
+ * ================================================================ */
+static double randomFinite(void) {
+    double d;
+    do {
+        uint64_t bits = nextRandom();
+        memcpy(&d, &bits, sizeof(d));
+    } while (isnan(d) || isinf(d));
+    return d;
+}
+
+/* ================================================================
+ * putDigits() — Append count random digits
+ * ================================================================ */
+static int putDigits(char *text, int count) {
+    for (int i = 0; i < count; i++) {
+        text[i] = (char)('0' + nextRandom() % 10);
+    }
+    return count;
+}
+
+/* ================================================================
+ * randomLexeme() — One number for the corpus, null-terminated
+ * ================================================================ */
+static void randomLexeme(char *text) {
+    int length = 0;
+    double d;
+
+    switch (nextRandom() % 8) {
+        case 0:
+            // Integer, sometimes past 19 digits or with leading zeros
+            if (nextRandom() % 2) {
+                text[length++] = '-';
+            }
+            length += putDigits(text + length, 1 + (int)(nextRandom() % 25));
+            break;
+        case 1:
+        case 2: {
+            // Decimal with an optional exponent
+            if (nextRandom() % 2) {
+                text[length++] = '-';
+            }
+            length += putDigits(text + length, 1 + (int)(nextRandom() % 12));
+            text[length++] = '.';
+            length += putDigits(text + length, 1 + (int)(nextRandom() % 12));
+            if (nextRandom() % 2) {
+                length += sprintf(text + length, "%c%d", (nextRandom() % 2) ? 'e' : 'E',
+                                  (int)(nextRandom() % 800) - 400);
+            }
+            break;
+        }
+        case 3:
+            // Shortest round-trip text of a random double
+            cJSON_PrintNumber(randomFinite(), text);
+            return;
+        case 4:
+            // 17 or 18 significant digits of a random double
+            sprintf(text, (nextRandom() % 2) ? "%.16e" : "%.17e", randomFinite());
+            return;
+        case 5: {
+            // The exact halfway point between a double and the next one up
+            d = fabs(randomFinite());
+            double next = nextafter(d, INFINITY);
+            long double middle = ((long double)d + (long double)next) / 2;
+            if (isinf(next) || (double)middle == d || (double)middle == next) {
+                // long double cannot hold it; use a subnormal instead
+                uint64_t bits = nextRandom() % (1ULL << 52);
+                memcpy(&d, &bits, sizeof(d));
+                sprintf(text, "%.20e", d);
+                return;
+            }
+            sprintf(text, "%.40Le", middle);
+            return;
+        }
+        case 6: {
+            // Runs strtod() takes a prefix of, as cJSON always accepted
+            static const char *const runs[] = {
+                "01", "007", "1.", "-1.", "-.5", "1e", "1e+", "1E-", "1.5.3",
+                "1-2", "2e5e3", "-0", "0e999", "-0.0e-7", "9e-400", "1e400", "-1e400",
+                "4.9406564584124654e-324", "2.4703282292062327e-324", "2.2250738585072011e-308",
+                "1.7976931348623157e308", "1.7976931348623158e308", "9007199254740993",
+                "18446744073709551615", "18446744073709551616", "2147483647", "2147483648",
+                "-2147483648", "-2147483649", "1e23", "8.41e21", "5e-324"
+            };
+            strcpy(text, runs[nextRandom() % (sizeof(runs) / sizeof(runs[0]))]);
+            return;
+        }
+        default:
+            // Long mantissas with exponents near the edges of the range
+            length += putDigits(text + length, 1 + (int)(nextRandom() % 40));
+            length += sprintf(text + length, "e%d", (int)(nextRandom() % 700) - 350);
+            break;
+    }
+    text[length] = '\0';
+}
+
+/* ================================================================
+ * strtodRun() — What the old parse_number() did with the text: the
+ * run of [0-9+-eE.] handed to strtod()
+ *
+ * Returns the length strtod() consumed (0 if none); *value receives
+ * the result.
+ * ================================================================ */
+static size_t strtodRun(const char *text, double *value) {
+    size_t run = strspn(text, "0123456789+-eE.");
+    char *copy = malloc(run + 1);
+    char *end = NULL;
+    if (copy == NULL) {
+        return 0;
+    }
+    memcpy(copy, text, run);
+    copy[run] = '\0';
+    *value = strtod(copy, &end);
+    size_t consumed = (size_t)(end - copy);
+    free(copy);
+    return consumed;
+}
+
+/* ================================================================
+ * saturate() — valueint for a double, as cJSON computes it
+ * ================================================================ */
+static int saturate(double d) {
+    if (d >= INT_MAX) {
+        return INT_MAX;
+    }
+    if (d <= (double)INT_MIN) {
+        return INT_MIN;
+    }
+    return (int)d;
+}
+
+/* ================================================================
+ * equivalenceCheck() — Parse the corpus with cJSON and strtod()
+ *
+ * Returns 0, or -1 (with a message) on the first disagreement.
+ * ================================================================ */
+static int equivalenceCheck(long values) {
+    char text[LEXEME_MAX];
+
+    for (long i = 0; i < values; i++) {
+        randomLexeme(text);
+
+        double expected = 0.0;
+        size_t consumed = strtodRun(text, &expected);
+        const char *parseEnd = NULL;
+        cJSON *number = cJSON_ParseWithOpts(text, &parseEnd, 0);
+
+        if (consumed == 0 || number == NULL) {
+            if ((consumed == 0) != (number == NULL)) {
+                printf("Error: %s: strtod() consumed %zu, cJSON %s\n", text, consumed,
+                       number == NULL ? "failed" : "succeeded");
+                cJSON_Delete(number);
+                return -1;
+            }
+            continue;
+        }
+
+        if (!cJSON_IsNumber(number) || memcmp(&number->valuedouble, &expected, sizeof(double)) != 0 ||
+            number->valueint != saturate(expected) || (size_t)(parseEnd - text) != consumed) {
+            printf("Error: %s: strtod() gives %.17g (%zu bytes), cJSON %.17g / %d (%zu bytes)\n",
+                   text, expected, consumed, number->valuedouble, number->valueint,
+                   (size_t)(parseEnd - text));
+            cJSON_Delete(number);
+            return -1;
+        }
+        cJSON_Delete(number);
+    }
+
+    printf("Equivalence: %ld numbers, all bit-identical to strtod()\n", values);
+    return 0;
+}
+
+/* ================================================================
+ * nowSeconds() — CLOCK_MONOTONIC time in seconds
+ * ================================================================ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ================================================================
+ * timeArray() — ns/number for both parsers over one JSON array
+ *
+ * Returns 0, or -1 if parsing fails.
+ * ================================================================ */
+static int timeArray(const char *label, const char *json, size_t length, long count) {
+    double bestOld = 1e30;
+    double bestNew = 1e30;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        // The old per-number work, walking the same text
+        double start = nowSeconds();
+        const char *pos = json + 1;
+        while (*pos != '\0' && *pos != ']') {
+            double value = 0.0;
+            pos += strtodRun(pos, &value);
+            sink = value;
+            pos++; // ',' or ']'
+        }
+        double middle = nowSeconds();
+        cJSON *array = cJSON_ParseWithLength(json, length);
+        double finish = nowSeconds();
+        if (array == NULL || cJSON_GetArraySize(array) != count) {
+            printf("Error: cJSON could not parse the %s array\n", label);
+            cJSON_Delete(array);
+            return -1;
+        }
+        cJSON_Delete(array);
+
+        if (middle - start < bestOld) {
+            bestOld = middle - start;
+        }
+        if (finish - middle < bestNew) {
+            bestNew = finish - middle;
+        }
+    }
+
+    double oldNs = bestOld / count * 1e9;
+    double newNs = bestNew / count * 1e9;
+    printf("%-16s %12.1f %12.1f %8.1fx\n", label, oldNs, newNs, oldNs / newNs);
+    return 0;
+}
+
+/* ================================================================
+ * buildArray() — "[n,n,...]" from count numbers of one kind
+ *
+ * Returns a malloc'd string, or NULL if out of memory.
+ * ================================================================ */
+static char *buildArray(int kind, long count, size_t *length) {
+    char *json = malloc((size_t)count * 32 + 3);
+    size_t used = 0;
+    if (json == NULL) {
+        return NULL;
+    }
+
+    json[used++] = '[';
+    for (long i = 0; i < count; i++) {
+        double d;
+        if (kind == 0) {
+            // Sensor-style readings with up to four decimals
+            d = (double)((int64_t)(nextRandom() % 2000000) - 1000000) / pow(10, (double)(nextRandom() % 5));
+        }
+        else if (kind == 1) {
+            d = (double)((int64_t)(nextRandom() % 2000000) - 1000000);
+        }
+        else {
+            d = randomFinite();
+        }
+        used += (size_t)cJSON_PrintNumber(d, json + used);
+        json[used++] = ',';
+    }
+    json[used - 1] = ']';
+    json[used] = '\0';
+
+    *length = used;
+    return json;
+}
+
+int main(int argc, char *argv[]) {
+    long values = (argc > 1) ? atol(argv[1]) : 2000000;
+    long count = (argc > 2) ? atol(argv[2]) : 100000;
+
+    if (values < 0 || count < 1) {
+        printf("Usage: %s [check_values] [array_size]\n", argv[0]);
+        return 1;
+    }
+
+    if (equivalenceCheck(values) == -1) {
+        return 1;
+    }
+
+    static const char *const labels[] = { "decimals", "integers", "random bits" };
+    printf("%-16s %12s %12s %9s\n", "values", "strtod ns", "cJSON ns", "speedup");
+    for (int kind = 0; kind < 3; kind++) {
+        size_t length;
+        char *json = buildArray(kind, count, &length);
+        if (json == NULL) {
+            printf("Error: Out of memory\n");
+            return 1;
+        }
+        int status = timeArray(labels[kind], json, length, count);
+        free(json);
+        if (status == -1) {
+            return 1;
+        }
+    }
+    printf("(strtod = the old per-number work alone; cJSON = the whole parse, tree included)\n");
+
+    return 0;
+}
@@ -0,0 +1,292 @@
+/* ================================================================
+ * parse_bench.c — cJSON_Parse vs the Two-Stage Parser
+ *
+ * Turns every line of a key:value file (sample.txt by default) into
+ * the JSON record the client would send, repeats them to fill a
+ * large NDJSON buffer, and parses every record into a cJSON tree:
+ *  - cJSON_ParseWithLengthOpts() (the stock parser)
+ *  - jsonIndexBuild() over the buffer, then jsonIndexParse() per
+ *    record, with each stage 1 implementation the CPU supports
+ * reporting throughput in GB/s, stage 1 on its own as well, and
+ * checking that both parsers build the same trees.
+ *
+ * Trees are allocated from an arena reset after every record, as in
+ * the server, so the numbers measure parsing rather than malloc().
+ *
+ * Usage: ./bench/parse_bench [file] [records]
+ * Example: ./bench/parse_bench sample.txt 200000
+ * ================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../cJSON.h"
+#include "../utils/arena.h"
+#include "../utils/lineparser.h"
+#include "../utils/jsonindex.h"
+
+#define ROUNDS 5 // Passes over the data per parser (best is kept)
+
+/* ================================================================
+ * buildRecords() — Serialize the file's lines, repeated, as NDJSON
+ *
+ * Returns a malloc'd, null-terminated buffer; *size receives its
+ * length and *built the number of records, or NULL on error.
+ * ================================================================ */
+static char *buildRecords(const char *path, long records, size_t *size, long *built) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    // One pass to collect the distinct JSON records
+    static char storage[65536];
+    JsonWriter out;
+    jsonWriterInit(&out, storage, sizeof(storage));
+
+    char *unique = NULL;
+    size_t uniqueSize = 0;
+    long uniqueCount = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        int length = serializeLine(line, strlen(line), &out, NULL);
+        if (length <= 0) {
+            continue;
+        }
+        char *grown = realloc(unique, uniqueSize + (size_t)length + 1);
+        if (grown == NULL) {
+            free(unique);
+            fclose(file);
+            return NULL;
+        }
+        unique = grown;
+        memcpy(unique + uniqueSize, out.data, (size_t)length);
+        uniqueSize += (size_t)length;
+        unique[uniqueSize++] = '\n';
+        uniqueCount++;
+    }
+    fclose(file);
+
+    if (uniqueSize == 0) {
+        printf("Error: No records in %s\n", path);
+        free(unique);
+        return NULL;
+    }
+
+    // Then repeat them until `records` records are in the buffer
+    size_t capacity = (size_t)((records + uniqueCount - 1) / uniqueCount) * uniqueSize + 1;
+    char *data = malloc(capacity);
+    size_t used = 0;
+    long count = 0;
+    if (data == NULL) {
+        free(unique);
+        return NULL;
+    }
+    while (count < records) {
+        const char *pos = unique;
+        const char *end = unique + uniqueSize;
+        while (pos < end && count < records) {
+            const char *newline = memchr(pos, '\n', (size_t)(end - pos));
+            size_t length = (size_t)(newline - pos) + 1;
+            memcpy(data + used, pos, length);
+            used += length;
+            count++;
+            pos = newline + 1;
+        }
+    }
+    data[used] = '\0';
+    free(unique);
+
+    *size = used;
+    *built = count;
+    return data;
+}
+
+/* ================================================================
+ * cjsonPass() — Parse every record with cJSON
+ *
+ * Returns the number of records parsed.
+ * ================================================================ */
+static long cjsonPass(const char *data, size_t size) {
+    const char *pos = data;
+    const char *end = data + size;
+    long parsed = 0;
+
+    while (pos < end) {
+        // With the length given, cJSON does not strlen() the rest of the buffer
+        const char *parseEnd = NULL;
+        cJSON *json = cJSON_ParseWithLengthOpts(pos, (size_t)(end - pos), &parseEnd, 0);
+        if (json == NULL) {
+            break;
+        }
+        cJSON_Delete(json);
+        arenaResetCurrent();
+        parsed++;
+        pos = parseEnd + 1; // '\n'
+    }
+
+    return parsed;
+}
+
+/* ================================================================
+ * indexPass() — Index the buffer, then parse every record from it
+ *
+ * Returns the number of records parsed.
+ * ================================================================ */
+static long indexPass(JsonIndex *index, const char *data, size_t size) {
+    const char *pos = data;
+    const char *end = data + size;
+    long parsed = 0;
+
+    jsonIndexBuild(index, data, size);
+    while (pos < end) {
+        const char *parseEnd = NULL;
+        cJSON *json = jsonIndexParse(index, pos, &parseEnd);
+        if (json == NULL) {
+            break;
+        }
+        cJSON_Delete(json);
+        arenaResetCurrent();
+        parsed++;
+        pos = parseEnd + 1; // '\n'
+    }
+
+    return parsed;
+}
+
+/* ================================================================
+ * verifyPass() — Parse every record both ways and compare
+ *
+ * Returns the number of records whose trees or end positions
+ * differ.
+ * ================================================================ */
+static long verifyPass(JsonIndex *index, const char *data, size_t size) {
+    const char *pos = data;
+    const char *end = data + size;
+    long differing = 0;
+
+    jsonIndexBuild(index, data, size);
+    while (pos < end) {
+        const char *cjsonEnd = NULL;
+        const char *indexEnd = NULL;
+        cJSON *expected = cJSON_ParseWithLengthOpts(pos, (size_t)(end - pos), &cjsonEnd, 0);
+        cJSON *actual = jsonIndexParse(index, pos, &indexEnd);
+
+        if (expected == NULL || actual == NULL || cjsonEnd != indexEnd ||
+            !cJSON_Compare(expected, actual, 1)) {
+            differing++;
+        }
+        cJSON_Delete(expected);
+        cJSON_Delete(actual);
+        arenaResetCurrent();
+        if (cjsonEnd == NULL || cjsonEnd >= end) {
+            break;
+        }
+        pos = cjsonEnd + 1; // '\n'
+    }
+
+    return differing;
+}
+
+/* ================================================================
+ * nowSeconds() — CLOCK_MONOTONIC time in seconds
+ * ================================================================ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = (argc > 1) ? argv[1] : "sample.txt";
+    long records = (argc > 2) ? atol(argv[2]) : 200000;
+    size_t size;
+    long built;
+
+    if (records < 1) {
+        printf("Usage: %s [file] [records]\n", argv[0]);
+        return 1;
+    }
+
+    char *data = buildRecords(path, records, &size, &built);
+    if (data == NULL) {
+        printf("Error: Could not build test records\n");
+        return 1;
+    }
+    printf("%ld records from %s, %.1f MB\n", built, path, size / 1e6);
+
+    Arena arena;
+    arenaInstallHooks();
+    if (arenaInit(&arena, ARENA_DEFAULT_SIZE) == -1) {
+        printf("Error: Could not allocate parse arena\n");
+        free(data);
+        return 1;
+    }
+    arenaSetCurrent(&arena);
+
+    double bestCjson = 1e30;
+    long cjsonParsed = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        double start = nowSeconds();
+        cjsonParsed = cjsonPass(data, size);
+        double elapsed = nowSeconds() - start;
+        if (elapsed < bestCjson) {
+            bestCjson = elapsed;
+        }
+    }
+
+    printf("%-20s %12s %12s %12s\n", "parser", "index GB/s", "parse GB/s", "Mrecords/s");
+    printf("%-20s %12s %12.2f %12.2f\n", "cJSON_Parse", "-",
+           size / bestCjson / 1e9, cjsonParsed / bestCjson / 1e6);
+
+    static const ScanImpl impls[] = { SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2 };
+    JsonIndex index = { 0 };
+    int status = 0;
+
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        if (jsonIndexSelect(impls[i]) == -1) {
+            continue; // Not available on this CPU
+        }
+
+        double bestStage1 = 1e30;
+        double bestTotal = 1e30;
+        long indexParsed = 0;
+        for (int round = 0; round < ROUNDS; round++) {
+            double start = nowSeconds();
+            jsonIndexBuild(&index, data, size);
+            double middle = nowSeconds();
+            indexParsed = indexPass(&index, data, size);
+            double finish = nowSeconds();
+
+            if (middle - start < bestStage1) {
+                bestStage1 = middle - start;
+            }
+            if (finish - middle < bestTotal) {
+                bestTotal = finish - middle;
+            }
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "two-stage (%s)", jsonIndexImplName());
+        printf("%-20s %12.2f %12.2f %12.2f\n", name, size / bestStage1 / 1e9,
+               size / bestTotal / 1e9, indexParsed / bestTotal / 1e6);
+
+        long differing = verifyPass(&index, data, size);
+        if (indexParsed != cjsonParsed || differing > 0) {
+            printf("Error: %s parsed %ld records, %ld differing from cJSON_Parse\n",
+                   name, indexParsed, differing);
+            status = 1;
+        }
+    }
+    printf("(index = stage 1 alone; parse = stage 1 and the trees)\n");
+
+    jsonIndexFree(&index);
+    arenaSetCurrent(NULL);
+    arenaFree(&arena);
+    free(data);
+    return status;
+}
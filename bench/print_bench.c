@@ -0,0 +1,300 @@
+/* ================================================================
+ * print_bench.c — cJSON Number Printing: printf vs Grisu2
+ *
+ * Prints random doubles with cJSON (shortest round-trip digits from
+ * Grisu2) and with a copy of the printf-based print_number() cJSON
+ * used before: "%1.15g", checked by sscanf(), else "%1.17g".
+ *
+ * The equivalence check runs first, over random bit patterns,
+ * decimal-looking values (what records usually carry), integers,
+ * subnormals, powers of two and ten, and both zeros (-0.0 now prints
+ * as "-0", where printf code gave "0"). Every number cJSON prints
+ * must strtod() back to the identical double; the differences from
+ * the old output are counted by kind. The timing then reports
+ * nanoseconds per number for both, printing whole arrays.
+ *
+ * Usage: ./bench/print_bench [check_values] [array_size]
+ * Example: ./bench/print_bench 2000000 100000
+ * ================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include <time.h>
+
+#include "../cJSON.h"
+
+#define ROUNDS 5 // Passes over the array per formatter (best is kept)
+
+static uint64_t rngState = 88172645463325252ULL;
+
+/* ================================================================
+ * nextRandom() — xorshift64
+ * ================================================================ */
+static uint64_t nextRandom(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+/* ================================================================
+ * randomDouble() — A finite double of one of several kinds
+ * ================================================================ */
+static double randomDouble(void) {
+    char text[64];
+    uint64_t bits;
+    double d;
+
+    switch (nextRandom() % 7) {
+        case 0:
+        case 1:
+            // Decimal-looking: up to 17 digits and a scale, rounded by strtod()
+            snprintf(text, sizeof(text), "%llue%d",
+                     (unsigned long long)(nextRandom() % 100000000000000000ULL) >> (nextRandom() % 57),
+                     (int)(nextRandom() % 40) - 24);
+            d = strtod(text, NULL);
+            break;
+        case 2:
+            // Integers, including ones beyond int range
+            d = (double)(int64_t)(nextRandom() >> (nextRandom() % 64));
+            break;
+        case 3:
+            // Subnormals and powers of two
+            bits = (nextRandom() % 2) ? nextRandom() % (1ULL << 52) : (nextRandom() % 2046 + 1) << 52;
+            memcpy(&d, &bits, sizeof(d));
+            break;
+        case 4:
+            d = pow(10, (int)(nextRandom() % 600) - 300);
+            break;
+        case 5:
+            // Zero; the sign flip below makes half of them -0.0
+            d = 0.0;
+            break;
+        default:
+            // Any finite bit pattern
+            do {
+                bits = nextRandom();
+                memcpy(&d, &bits, sizeof(d));
+            } while (isnan(d) || isinf(d));
+            break;
+    }
+
+    return (nextRandom() % 2) ? -d : d;
+}
+
+/* ================================================================
+ * oldCompare() — compare_double() as print_number() used it
+ * ================================================================ */
+static int oldCompare(double a, double b) {
+    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return (fabs(a - b) <= maxVal * DBL_EPSILON);
+}
+
+/* ================================================================
+ * oldPrint() — The printf-based print_number() (C locale)
+ *
+ * Returns the length written to buffer (at least 26 bytes).
+ * ================================================================ */
+static int oldPrint(char *buffer, double d, int valueint) {
+    double test = 0.0;
+
+    if (isnan(d) || isinf(d)) {
+        return sprintf(buffer, "null");
+    }
+    if (d == (double)valueint) {
+        return sprintf(buffer, "%d", valueint);
+    }
+    int length = sprintf(buffer, "%1.15g", d);
+    if ((sscanf(buffer, "%lg", &test) != 1) || !oldCompare(test, d)) {
+        length = sprintf(buffer, "%1.17g", d);
+    }
+    return length;
+}
+
+/* ================================================================
+ * toValueint() — valueint as cJSON_CreateNumber() saturates it
+ * ================================================================ */
+static int toValueint(double d) {
+    if (d >= INT_MAX) {
+        return INT_MAX;
+    }
+    if (d <= (double)INT_MIN) {
+        return INT_MIN;
+    }
+    return (int)d;
+}
+
+/* ================================================================
+ * sameBits() — Whether text strtod()s back to exactly d
+ * ================================================================ */
+static int sameBits(const char *text, double d) {
+    double parsed = strtod(text, NULL);
+    return memcmp(&parsed, &d, sizeof(d)) == 0;
+}
+
+/* ================================================================
+ * equivalenceCheck() — Print values both ways and compare
+ *
+ * Returns 0, or -1 (with a message) if cJSON printed a number that
+ * does not parse back to the same double.
+ * ================================================================ */
+static int equivalenceCheck(long values) {
+    long identical = 0, oldInexact = 0, shorter = 0, sameLength = 0, longer = 0;
+    char newText[64];
+    char oldText[64];
+
+    for (long i = 0; i < values; i++) {
+        double d = randomDouble();
+        cJSON *number = cJSON_CreateNumber(d);
+        if (number == NULL || !cJSON_PrintPreallocated(number, newText, sizeof(newText), 0)) {
+            printf("Error: cJSON could not print %.17g\n", d);
+            cJSON_Delete(number);
+            return -1;
+        }
+        oldPrint(oldText, d, number->valueint);
+        cJSON_Delete(number);
+
+        if (!sameBits(newText, d)) {
+            printf("Error: %.17g printed as %s, which parses as %.17g\n", d, newText, strtod(newText, NULL));
+            return -1;
+        }
+
+        if (strcmp(newText, oldText) == 0) {
+            identical++;
+        }
+        else if (!sameBits(oldText, d)) {
+            oldInexact++;
+        }
+        else if (strlen(newText) < strlen(oldText)) {
+            shorter++;
+        }
+        else if (strlen(newText) == strlen(oldText)) {
+            sameLength++;
+        }
+        else {
+            longer++;
+        }
+    }
+
+    printf("Equivalence: %ld values, all parse back bit-exactly\n", values);
+    printf("  identical to printf output:          %ld\n", identical);
+    printf("  printf output did not round-trip:    %ld\n", oldInexact);
+    printf("  shorter than printf output:          %ld\n", shorter);
+    printf("  same length, different last digits:  %ld\n", sameLength);
+    printf("  longer than printf output:           %ld\n", longer);
+    return 0;
+}
+
+/* ================================================================
+ * nowSeconds() — CLOCK_MONOTONIC time in seconds
+ * ================================================================ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ================================================================
+ * timeArray() — ns/number for both formatters over one array
+ *
+ * Returns 0, or -1 if printing fails.
+ * ================================================================ */
+static int timeArray(const char *label, const double *values, int size) {
+    cJSON *array = cJSON_CreateDoubleArray(values, size);
+    size_t capacity = (size_t)size * 32 + 16;
+    char *output = malloc(capacity);
+    if (array == NULL || output == NULL) {
+        printf("Error: Out of memory\n");
+        cJSON_Delete(array);
+        free(output);
+        return -1;
+    }
+
+    double bestOld = 1e30;
+    double bestNew = 1e30;
+    for (int round = 0; round < ROUNDS; round++) {
+        // The old formatter, joined into an array as cJSON would
+        double start = nowSeconds();
+        size_t used = 0;
+        output[used++] = '[';
+        for (int i = 0; i < size; i++) {
+            used += (size_t)oldPrint(output + used, values[i], toValueint(values[i]));
+            output[used++] = ',';
+        }
+        output[used - 1] = ']';
+        double middle = nowSeconds();
+        if (!cJSON_PrintPreallocated(array, output, (int)capacity, 0)) {
+            printf("Error: cJSON could not print the array\n");
+            cJSON_Delete(array);
+            free(output);
+            return -1;
+        }
+        double finish = nowSeconds();
+
+        if (middle - start < bestOld) {
+            bestOld = middle - start;
+        }
+        if (finish - middle < bestNew) {
+            bestNew = finish - middle;
+        }
+    }
+
+    double oldNs = bestOld / size * 1e9;
+    double newNs = bestNew / size * 1e9;
+    printf("%-16s %12.1f %12.1f %8.1fx\n", label, oldNs, newNs, oldNs / newNs);
+
+    cJSON_Delete(array);
+    free(output);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    long values = (argc > 1) ? atol(argv[1]) : 2000000;
+    long size = (argc > 2) ? atol(argv[2]) : 100000;
+
+    if (values < 0 || size < 1 || size > 10000000) {
+        printf("Usage: %s [check_values] [array_size]\n", argv[0]);
+        return 1;
+    }
+
+    if (equivalenceCheck(values) == -1) {
+        return 1;
+    }
+
+    double *decimals = malloc((size_t)size * sizeof(double));
+    double *integers = malloc((size_t)size * sizeof(double));
+    double *anyBits = malloc((size_t)size * sizeof(double));
+    if (decimals == NULL || integers == NULL || anyBits == NULL) {
+        printf("Error: Out of memory\n");
+        return 1;
+    }
+    for (long i = 0; i < size; i++) {
+        // Sensor-style readings with up to four decimals
+        decimals[i] = (double)((int64_t)(nextRandom() % 2000000) - 1000000) / pow(10, (double)(nextRandom() % 5));
+        integers[i] = (double)(int)(nextRandom() % 2000000) - 1000000;
+        uint64_t bits;
+        do {
+            bits = nextRandom();
+            memcpy(&anyBits[i], &bits, sizeof(double));
+        } while (isnan(anyBits[i]) || isinf(anyBits[i]));
+    }
+
+    printf("%-16s %12s %12s %9s\n", "values", "printf ns", "grisu2 ns", "speedup");
+    int status = 0;
+    if (timeArray("decimals", decimals, (int)size) == -1 ||
+        timeArray("integers", integers, (int)size) == -1 ||
+        timeArray("random bits", anyBits, (int)size) == -1) {
+        status = 1;
+    }
+
+    free(decimals);
+    free(integers);
+    free(anyBits);
+    return status;
+}
@@ -0,0 +1,256 @@
+/* ================================================================
+ * project_bench.c — Full Parse vs Lazy Field Projection
+ *
+ * Turns every line of a key:value file (sample.txt by default) into
+ * the JSON record the client would send, repeats them to fill a
+ * large NDJSON buffer, and extracts the same keys from every record
+ * twice:
+ *  - cJSON_Parse(), then cJSON_GetObjectItemCaseSensitive() per key
+ *    and cJSON_Delete() (the server's default path, without arena)
+ *  - projectRecord(), which skips unwanted members unparsed
+ * reporting throughput and checking that both find the same values.
+ *
+ * Usage: ./bench/project_bench [file] [records] [key[,key...]]
+ * Example: ./bench/project_bench sample.txt 200000 File_Name,File_Size
+ * ================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../cJSON.h"
+#include "../utils/lineparser.h"
+#include "../utils/projection.h"
+
+#define ROUNDS 5 // Passes over the data per parser (best is kept)
+
+/* ================================================================
+ * buildRecords() — Serialize the file's lines, repeated, as NDJSON
+ *
+ * Returns a malloc'd, null-terminated buffer; *size receives its
+ * length and *built the number of records, or NULL on error.
+ * ================================================================ */
+static char *buildRecords(const char *path, long records, size_t *size, long *built) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    // One pass to collect the distinct JSON records
+    static char storage[65536];
+    JsonWriter out;
+    jsonWriterInit(&out, storage, sizeof(storage));
+
+    char *unique = NULL;
+    size_t uniqueSize = 0;
+    long uniqueCount = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        int length = serializeLine(line, strlen(line), &out, NULL);
+        if (length <= 0) {
+            continue;
+        }
+        char *grown = realloc(unique, uniqueSize + (size_t)length + 1);
+        if (grown == NULL) {
+            free(unique);
+            fclose(file);
+            return NULL;
+        }
+        unique = grown;
+        memcpy(unique + uniqueSize, out.data, (size_t)length);
+        uniqueSize += (size_t)length;
+        unique[uniqueSize++] = '\n';
+        uniqueCount++;
+    }
+    fclose(file);
+
+    if (uniqueSize == 0) {
+        printf("Error: No records in %s\n", path);
+        free(unique);
+        return NULL;
+    }
+
+    // Then repeat them until `records` records are in the buffer
+    size_t capacity = (size_t)((records + uniqueCount - 1) / uniqueCount) * uniqueSize + 1;
+    char *data = malloc(capacity);
+    size_t used = 0;
+    long count = 0;
+    if (data == NULL) {
+        free(unique);
+        return NULL;
+    }
+    while (count < records) {
+        const char *pos = unique;
+        const char *end = unique + uniqueSize;
+        while (pos < end && count < records) {
+            const char *newline = memchr(pos, '\n', (size_t)(end - pos));
+            size_t length = (size_t)(newline - pos) + 1;
+            memcpy(data + used, pos, length);
+            used += length;
+            count++;
+            pos = newline + 1;
+        }
+    }
+    data[used] = '\0';
+    free(unique);
+
+    *size = used;
+    *built = count;
+    return data;
+}
+
+/* ================================================================
+ * checkString() / checkNumber() — Fold a value into a checksum
+ * ================================================================ */
+static unsigned long checkString(unsigned long checksum, const char *text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        checksum = checksum * 31 + (unsigned char)text[i];
+    }
+    return checksum + length;
+}
+
+static unsigned long checkNumber(unsigned long checksum, double value) {
+    return checksum * 31 + (unsigned long)(long long)(value * 1000);
+}
+
+/* ================================================================
+ * parsePass() — Full parse of every record, then look the keys up
+ *
+ * Returns a checksum of the values found.
+ * ================================================================ */
+static unsigned long parsePass(const char *data, size_t size, const Projection *projection) {
+    const char *pos = data;
+    const char *end = data + size;
+    unsigned long checksum = 0;
+
+    while (pos < end) {
+        // With the length given, cJSON does not strlen() the rest of the buffer
+        const char *parseEnd = NULL;
+        cJSON *json = cJSON_ParseWithLengthOpts(pos, (size_t)(end - pos), &parseEnd, 0);
+        if (json == NULL) {
+            break;
+        }
+        for (int k = 0; k < projection->count; k++) {
+            cJSON *item = cJSON_GetObjectItemCaseSensitive(json, projection->names[k]);
+            if (cJSON_IsString(item)) {
+                checksum = checkString(checksum, item->valuestring, strlen(item->valuestring));
+            }
+            else if (cJSON_IsNumber(item)) {
+                checksum = checkNumber(checksum, item->valuedouble);
+            }
+        }
+        cJSON_Delete(json);
+        pos = parseEnd + 1; // '\n'
+    }
+
+    return checksum;
+}
+
+/* ================================================================
+ * projectPass() — Project every record
+ *
+ * Returns a checksum of the values found, in projection key order
+ * so it matches parsePass(). Escaped strings are decoded, as the
+ * server does before printing them.
+ * ================================================================ */
+static unsigned long projectPass(const char *data, size_t size, const Projection *projection) {
+    const char *pos = data;
+    const char *end = data + size;
+    unsigned long checksum = 0;
+    Field fields[PROJECT_MAX_KEYS];
+    static char text[65536];
+
+    while (pos < end) {
+        const char *recordEnd;
+        int count = projectRecord(projection, pos, end, fields, PROJECT_MAX_KEYS, &recordEnd);
+        if (count == -1) {
+            break;
+        }
+        for (int k = 0; k < projection->count; k++) {
+            for (int i = 0; i < count; i++) {
+                if (fields[i].key != k) {
+                    continue;
+                }
+                if (fields[i].type == FIELD_STRING && fields[i].length < sizeof(text)) {
+                    int length = fieldString(&fields[i], text);
+                    checksum = checkString(checksum, text, length > 0 ? (size_t)length : 0);
+                }
+                else if (fields[i].type == FIELD_NUMBER) {
+                    checksum = checkNumber(checksum, fieldNumber(&fields[i]));
+                }
+                break;
+            }
+        }
+        pos = recordEnd + 1; // '\n'
+    }
+
+    return checksum;
+}
+
+/* ================================================================
+ * nowSeconds() — CLOCK_MONOTONIC time in seconds
+ * ================================================================ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = (argc > 1) ? argv[1] : "sample.txt";
+    long records = (argc > 2) ? atol(argv[2]) : 200000;
+    const char *keys = (argc > 3) ? argv[3] : "File_Name,File_Size";
+    Projection projection;
+    size_t size;
+    long built;
+
+    if (records < 1 || projectionInit(&projection, keys) == -1) {
+        printf("Usage: %s [file] [records] [key[,key...]]\n", argv[0]);
+        return 1;
+    }
+
+    char *data = buildRecords(path, records, &size, &built);
+    if (data == NULL) {
+        printf("Error: Could not build test records\n");
+        projectionFree(&projection);
+        return 1;
+    }
+    printf("%ld records from %s, %.1f MB, projecting %s\n", built, path, size / 1e6, keys);
+
+    double bestParse = 1e30;
+    double bestProject = 1e30;
+    unsigned long parseSum = 0;
+    unsigned long projectSum = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        double start = nowSeconds();
+        parseSum = parsePass(data, size, &projection);
+        double middle = nowSeconds();
+        projectSum = projectPass(data, size, &projection);
+        double finish = nowSeconds();
+
+        if (middle - start < bestParse) {
+            bestParse = middle - start;
+        }
+        if (finish - middle < bestProject) {
+            bestProject = finish - middle;
+        }
+    }
+
+    printf("%-12s %10s %12s\n", "parser", "MB/s", "Mrecords/s");
+    printf("%-12s %10.1f %12.2f\n", "cJSON_Parse", size / bestParse / 1e6, built / bestParse / 1e6);
+    printf("%-12s %10.1f %12.2f\n", "projection", size / bestProject / 1e6, built / bestProject / 1e6);
+    printf("Speedup: %.1fx\n", bestParse / bestProject);
+
+    int status = 0;
+    if (parseSum != projectSum) {
+        printf("Error: projection found different values than cJSON_Parse\n");
+        status = 1;
+    }
+
+    free(data);
+    projectionFree(&projection);
+    return status;
+}
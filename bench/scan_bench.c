@@ -0,0 +1,179 @@
+/* ================================================================
+ * scan_bench.c — Scalar vs SIMD Tokenizer Microbenchmark
+ *
+ * Generates a large key:value data file in memory and, once per
+ * scanner implementation:
+ *  - scans it with scanQuoted() alone (raw delimiter search), and
+ *  - runs every line through serializeLine() (full tokenizer),
+ * reporting throughput and checking that all implementations
+ * produce identical output.
+ *
+ * Usage: ./bench/scan_bench [lines] [value_length]
+ * Example: ./bench/scan_bench 200000 800
+ * ================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../utils/lineparser.h"
+#include "../utils/scan.h"
+
+#define ROUNDS 5 // Passes over the data per implementation (best is kept)
+
+/* ================================================================
+ * generateData() — Build `lines` lines of sample-style records
+ *
+ * Each line mixes short unquoted values, a quoted value of about
+ * `valueLength` bytes with an escape in it, a number and a boolean.
+ * Returns a malloc'd buffer; *size receives its length.
+ * ================================================================ */
+static char *generateData(long lines, int valueLength, size_t *size) {
+    size_t capacity = (size_t)lines * (valueLength + 160);
+    char *data = malloc(capacity);
+    size_t used = 0;
+
+    if (data == NULL) {
+        return NULL;
+    }
+
+    srand(42);
+    for (long i = 0; i < lines; i++) {
+        used += sprintf(data + used,
+                        "File_Name:\"File%ld.txt\" File_Size:%dKB Ratio:%d.%02d "
+                        "Public:%s Description:\"",
+                        i, rand() % 4096, rand() % 100, rand() % 100,
+                        (rand() & 1) ? "true" : "false");
+
+        for (int j = 0; j < valueLength; j++) {
+            data[used++] = (j % 97 == 50) ? ' ' : (char)('a' + rand() % 26);
+        }
+        used += sprintf(data + used, " \\\"quoted\\\"\"\n");
+    }
+
+    *size = used;
+    return data;
+}
+
+/* ================================================================
+ * runPass() — Serialize every line once
+ *
+ * Returns a checksum of the output so passes can be compared and
+ * the work cannot be optimized away.
+ * ================================================================ */
+static unsigned long runPass(const char *data, size_t size, JsonWriter *out) {
+    const char *pos = data;
+    const char *end = data + size;
+    unsigned long checksum = 0;
+
+    while (pos < end) {
+        const char *newline = memchr(pos, '\n', (size_t)(end - pos));
+        const char *lineEnd = newline ? newline + 1 : end;
+
+        int length = serializeLine(pos, (size_t)(lineEnd - pos), out, NULL);
+        for (int i = 0; i < length; i += 16) {
+            checksum = checksum * 31 + (unsigned char)out->data[i];
+        }
+        checksum += (unsigned long)length;
+
+        pos = lineEnd;
+    }
+
+    return checksum;
+}
+
+/* ================================================================
+ * scanPass() — Visit every quote, backslash and newline in the data
+ *
+ * Returns the number of stops found.
+ * ================================================================ */
+static unsigned long scanPass(const char *data, size_t size) {
+    const char *pos = data;
+    const char *end = data + size;
+    unsigned long stops = 0;
+
+    while ((pos = scanQuoted(pos, end)) < end) {
+        stops++;
+        pos++;
+    }
+
+    return stops;
+}
+
+/* ================================================================
+ * nowSeconds() — CLOCK_MONOTONIC time in seconds
+ * ================================================================ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    long lines = (argc > 1) ? atol(argv[1]) : 200000;
+    int valueLength = (argc > 2) ? atoi(argv[2]) : 200;
+    size_t size;
+
+    char *data = generateData(lines, valueLength, &size);
+    if (data == NULL) {
+        printf("Error: Could not allocate test data\n");
+        return 1;
+    }
+    printf("Generated %ld lines, %.1f MB (quoted value length %d)\n",
+           lines, size / 1e6, valueLength);
+
+    static char storage[65536];
+    JsonWriter out;
+    jsonWriterInit(&out, storage, sizeof(storage));
+
+    const ScanImpl impls[] = { SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2 };
+    unsigned long reference = 0;
+    unsigned long referenceStops = 0;
+    int status = 0;
+
+    printf("%-8s %14s %14s %14s\n", "scanner", "scan MB/s", "tokenize MB/s", "Mlines/s");
+
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        if (scanSelect(impls[i]) == -1) {
+            printf("%-8s unavailable on this CPU\n", i == 1 ? "sse2" : "avx2");
+            continue;
+        }
+
+        double bestScan = 1e30;
+        double bestTokenize = 1e30;
+        unsigned long stops = 0;
+        unsigned long checksum = 0;
+        for (int round = 0; round < ROUNDS; round++) {
+            double start = nowSeconds();
+            stops = scanPass(data, size);
+            double middle = nowSeconds();
+            checksum = runPass(data, size, &out);
+            double finish = nowSeconds();
+
+            if (middle - start < bestScan) {
+                bestScan = middle - start;
+            }
+            if (finish - middle < bestTokenize) {
+                bestTokenize = finish - middle;
+            }
+        }
+
+        if (i == 0) {
+            reference = checksum;
+            referenceStops = stops;
+        }
+        else if (checksum != reference || stops != referenceStops) {
+            printf("Error: %s output differs from scalar\n", scanImplName());
+            status = 1;
+        }
+
+        printf("%-8s %14.1f %14.1f %14.2f\n", scanImplName(),
+               size / bestScan / 1e6, size / bestTokenize / 1e6,
+               lines / bestTokenize / 1e6);
+    }
+
+    free(data);
+    return status;
+}
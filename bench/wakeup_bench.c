@@ -0,0 +1,273 @@
+/* ================================================================
+ * wakeup_bench.c — Blocking vs Busy-Poll Receive Wake-Up Latency
+ *
+ * Sends timestamped datagrams over loopback at a fixed spacing, so
+ * the receiver is idle when each one arrives, and measures how long
+ * the receiver takes to get it:
+ *  - wire-to-user: kernel receive timestamp (SO_TIMESTAMPNS) to the
+ *    receive call returning, i.e. the wake-up cost
+ *  - send-to-user: sender's clock before send() to the receive call
+ *    returning
+ * once with a blocking recvmsg() and once busy-polling with
+ * MSG_DONTWAIT (and SO_BUSY_POLL where permitted), the two modes of
+ * the server's --spin option.
+ *
+ * With two or more CPUs, the sender and receiver are pinned to
+ * different ones; on a single CPU the spinning receiver can only
+ * see a datagram after the scheduler preempts it for the sender, so
+ * busy-polling falls back to blocking and shows no gain.
+ *
+ * Usage: ./bench/wakeup_bench [count] [gap_us] [spin_us]
+ * Example: ./bench/wakeup_bench 20000 200 1000
+ * ================================================================
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "../utils/latency.h"
+
+/* ================================================================
+ * SenderArgs struct:
+ * What the sender thread needs.
+ * ================================================================ */
+typedef struct {
+    int sd;             // Socket connected to the receiver
+    long count;         // Datagrams to send
+    long gapNs;         // Spacing between datagrams
+    int cpu;            // CPU to pin to (-1 = not pinned)
+} SenderArgs;
+
+/* ================================================================
+ * pinThread() — Pin the calling thread to `cpu` (-1 = leave as is)
+ * ================================================================ */
+static void pinThread(int cpu) {
+    if (cpu < 0) {
+        return;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+/* ================================================================
+ * senderMain() — Send `count` timestamped datagrams, evenly spaced
+ *
+ * Absolute CLOCK_MONOTONIC deadlines keep the spacing from
+ * drifting; the payload is the CLOCK_REALTIME send time.
+ * ================================================================ */
+static void *senderMain(void *arg) {
+    SenderArgs *args = arg;
+    struct timespec next;
+
+    pinThread(args->cpu);
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (long i = 0; i < args->count; i++) {
+        long ns = next.tv_nsec + args->gapNs;
+        next.tv_sec += ns / 1000000000L;
+        next.tv_nsec = ns % 1000000000L;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {
+            // Retry until the deadline
+        }
+
+        uint64_t sent = latencyNowNs();
+        if (send(args->sd, &sent, sizeof(sent), 0) == -1) {
+            perror("send");
+        }
+    }
+    return NULL;
+}
+
+/* ================================================================
+ * monotonicNs() — Current CLOCK_MONOTONIC time in nanoseconds
+ * ================================================================ */
+static uint64_t monotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ================================================================
+ * receiveOne() — One datagram and its kernel receive time
+ *
+ * With a spin budget, polls with MSG_DONTWAIT until a datagram is
+ * there or the budget is used up, then blocks; *caught says which.
+ *
+ * Returns: bytes received, or -1 (timeout or error)
+ * ================================================================ */
+static ssize_t receiveOne(int sd, uint64_t *payload, uint64_t *wireNs,
+                          uint64_t spinNs, int *caught) {
+    char control[128];
+    struct iovec iov = { payload, sizeof(*payload) };
+    struct msghdr msg;
+    ssize_t length = -1;
+
+    *caught = 0;
+    if (spinNs > 0) {
+        uint64_t deadline = monotonicNs() + spinNs;
+        do {
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            length = recvmsg(sd, &msg, MSG_DONTWAIT);
+        } while (length == -1 && errno == EAGAIN && monotonicNs() < deadline);
+        *caught = length != -1;
+    }
+
+    if (length == -1) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        length = recvmsg(sd, &msg, 0);
+        if (length == -1) {
+            return -1;
+        }
+    }
+
+    *wireNs = 0;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            *wireNs = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+        }
+    }
+    return length;
+}
+
+/* ================================================================
+ * emitStdout() — EmitFunc for latencyReport()
+ * ================================================================ */
+static void emitStdout(void *ctx, const char *format, ...) {
+    (void)ctx;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/* ================================================================
+ * runMode() — One pass: send `count` datagrams, receive and measure
+ *
+ * Returns: 0 on success, -1 on socket setup failure
+ * ================================================================ */
+static int runMode(const char *name, long count, long gapNs, int spinUs,
+                   int receiverCpu, int senderCpu) {
+    int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+    int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    int on = 1;
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (receiver == -1 || sender == -1 ||
+        bind(receiver, (struct sockaddr *)&address, sizeof(address)) == -1 ||
+        getsockname(receiver, (struct sockaddr *)&address, &length) == -1 ||
+        connect(sender, (struct sockaddr *)&address, sizeof(address)) == -1 ||
+        setsockopt(receiver, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == -1) {
+        perror("socket setup");
+        return -1;
+    }
+
+    // Give up on a lost datagram instead of hanging
+    struct timeval timeout = { 1, 0 };
+    setsockopt(receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    int kernelPoll = 0;
+    if (spinUs > 0) {
+        kernelPoll = setsockopt(receiver, SOL_SOCKET, SO_BUSY_POLL,
+                                &spinUs, sizeof(spinUs)) == 0;
+    }
+
+    static LatencyHistogram wireToUser, sendToUser;
+    latencyInit(&wireToUser, "wire-to-user");
+    latencyInit(&sendToUser, "send-to-user");
+
+    pinThread(receiverCpu);
+    SenderArgs args = { sender, count, gapNs, senderCpu };
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, senderMain, &args) != 0) {
+        printf("Error: Could not start the sender thread\n");
+        return -1;
+    }
+
+    long received = 0;
+    long caughtCount = 0;
+    for (long i = 0; i < count; i++) {
+        uint64_t payload, wireNs;
+        int caught;
+
+        if (receiveOne(receiver, &payload, &wireNs, (uint64_t)spinUs * 1000, &caught) == -1) {
+            break;
+        }
+        uint64_t now = latencyNowNs();
+        received++;
+        caughtCount += caught;
+        if (wireNs != 0) {
+            latencyRecord(&wireToUser, (int64_t)(now - wireNs));
+        }
+        latencyRecord(&sendToUser, (int64_t)(now - payload));
+    }
+    pthread_join(thread, NULL);
+
+    if (spinUs > 0) {
+        printf("%s (spin %d us, SO_BUSY_POLL %s): %ld of %ld received, %ld caught spinning\n",
+               name, spinUs, kernelPoll ? "on" : "not permitted", received, count, caughtCount);
+    }
+    else {
+        printf("%s: %ld of %ld received\n", name, received, count);
+    }
+    latencyReport(&wireToUser, 0, emitStdout, NULL);
+    latencyReport(&sendToUser, 0, emitStdout, NULL);
+
+    close(receiver);
+    close(sender);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    long count = (argc > 1) ? atol(argv[1]) : 20000;
+    long gapUs = (argc > 2) ? atol(argv[2]) : 200;
+    int spinUs = (argc > 3) ? atoi(argv[3]) : (int)(gapUs * 2);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (count < 1 || gapUs < 1 || spinUs < 1) {
+        printf("Usage: %s [count] [gap_us] [spin_us]\n", argv[0]);
+        return 1;
+    }
+
+    printf("Loopback wake-up latency: %ld datagrams, one every %ld us, %ld CPU(s)\n",
+           count, gapUs, cpus);
+
+    // Receiver and sender on their own CPUs when there are two
+    int receiverCpu = cpus >= 2 ? 1 : -1;
+    int senderCpu = cpus >= 2 ? 0 : -1;
+    if (cpus < 2) {
+        printf("Note: one CPU, so a spinning receiver delays the sender; expect no gain\n");
+    }
+
+    if (runMode("blocking", count, gapUs * 1000, 0, receiverCpu, senderCpu) == -1 ||
+        runMode("busy-poll", count, gapUs * 1000, spinUs, receiverCpu, senderCpu) == -1) {
+        return 1;
+    }
+    return 0;
+}
@@ -44,6 +44,7 @@
 #include <limits.h>
 #include <ctype.h>
 #include <float.h>
+#include <stdint.h>
 
 #ifdef ENABLE_LOCALES
 #include <locale.h>
@@ -270,6 +271,11 @@ CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
             global_hooks.deallocate(item->string);
             item->string = NULL;
         }
+        if (item->member_index != NULL)
+        {
+            global_hooks.deallocate(item->member_index);
+            item->member_index = NULL;
+        }
         global_hooks.deallocate(item);
         item = next;
     }
@@ -303,22 +309,565 @@ typedef struct
 /* get a pointer to the buffer at the position */
 #define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
 
+/* Decimal to double conversion without strtod for the common cases, after
+ * Daniel Lemire, "Number Parsing at a Gigabyte per Second" (2021): exact
+ * integer and Clinger fast paths, then the Eisel-Lemire algorithm. Each path
+ * either produces the correctly rounded double, identical to strtod, or gives
+ * up, and the rare numbers no path takes go to strtod. */
+
+#define POWERS_OF_FIVE_MIN_EXPONENT (-342)
+#define POWERS_OF_FIVE_MAX_EXPONENT 308
+
+/* the high 64 bits of 10^q normalized to 128 bits (rounded down), for q from
+ * POWERS_OF_FIVE_MIN_EXPONENT to POWERS_OF_FIVE_MAX_EXPONENT */
+static const uint64_t powers_of_ten_high[] =
+{
+    UINT64_C(0xEEF453D6923BD65A), UINT64_C(0x9558B4661B6565F8), UINT64_C(0xBAAEE17FA23EBF76),
+    UINT64_C(0xE95A99DF8ACE6F53), UINT64_C(0x91D8A02BB6C10594), UINT64_C(0xB64EC836A47146F9),
+    UINT64_C(0xE3E27A444D8D98B7), UINT64_C(0x8E6D8C6AB0787F72), UINT64_C(0xB208EF855C969F4F),
+    UINT64_C(0xDE8B2B66B3BC4723), UINT64_C(0x8B16FB203055AC76), UINT64_C(0xADDCB9E83C6B1793),
+    UINT64_C(0xD953E8624B85DD78), UINT64_C(0x87D4713D6F33AA6B), UINT64_C(0xA9C98D8CCB009506),
+    UINT64_C(0xD43BF0EFFDC0BA48), UINT64_C(0x84A57695FE98746D), UINT64_C(0xA5CED43B7E3E9188),
+    UINT64_C(0xCF42894A5DCE35EA), UINT64_C(0x818995CE7AA0E1B2), UINT64_C(0xA1EBFB4219491A1F),
+    UINT64_C(0xCA66FA129F9B60A6), UINT64_C(0xFD00B897478238D0), UINT64_C(0x9E20735E8CB16382),
+    UINT64_C(0xC5A890362FDDBC62), UINT64_C(0xF712B443BBD52B7B), UINT64_C(0x9A6BB0AA55653B2D),
+    UINT64_C(0xC1069CD4EABE89F8), UINT64_C(0xF148440A256E2C76), UINT64_C(0x96CD2A865764DBCA),
+    UINT64_C(0xBC807527ED3E12BC), UINT64_C(0xEBA09271E88D976B), UINT64_C(0x93445B8731587EA3),
+    UINT64_C(0xB8157268FDAE9E4C), UINT64_C(0xE61ACF033D1A45DF), UINT64_C(0x8FD0C16206306BAB),
+    UINT64_C(0xB3C4F1BA87BC8696), UINT64_C(0xE0B62E2929ABA83C), UINT64_C(0x8C71DCD9BA0B4925),
+    UINT64_C(0xAF8E5410288E1B6F), UINT64_C(0xDB71E91432B1A24A), UINT64_C(0x892731AC9FAF056E),
+    UINT64_C(0xAB70FE17C79AC6CA), UINT64_C(0xD64D3D9DB981787D), UINT64_C(0x85F0468293F0EB4E),
+    UINT64_C(0xA76C582338ED2621), UINT64_C(0xD1476E2C07286FAA), UINT64_C(0x82CCA4DB847945CA),
+    UINT64_C(0xA37FCE126597973C), UINT64_C(0xCC5FC196FEFD7D0C), UINT64_C(0xFF77B1FCBEBCDC4F),
+    UINT64_C(0x9FAACF3DF73609B1), UINT64_C(0xC795830D75038C1D), UINT64_C(0xF97AE3D0D2446F25),
+    UINT64_C(0x9BECCE62836AC577), UINT64_C(0xC2E801FB244576D5), UINT64_C(0xF3A20279ED56D48A),
+    UINT64_C(0x9845418C345644D6), UINT64_C(0xBE5691EF416BD60C), UINT64_C(0xEDEC366B11C6CB8F),
+    UINT64_C(0x94B3A202EB1C3F39), UINT64_C(0xB9E08A83A5E34F07), UINT64_C(0xE858AD248F5C22C9),
+    UINT64_C(0x91376C36D99995BE), UINT64_C(0xB58547448FFFFB2D), UINT64_C(0xE2E69915B3FFF9F9),
+    UINT64_C(0x8DD01FAD907FFC3B), UINT64_C(0xB1442798F49FFB4A), UINT64_C(0xDD95317F31C7FA1D),
+    UINT64_C(0x8A7D3EEF7F1CFC52), UINT64_C(0xAD1C8EAB5EE43B66), UINT64_C(0xD863B256369D4A40),
+    UINT64_C(0x873E4F75E2224E68), UINT64_C(0xA90DE3535AAAE202), UINT64_C(0xD3515C2831559A83),
+    UINT64_C(0x8412D9991ED58091), UINT64_C(0xA5178FFF668AE0B6), UINT64_C(0xCE5D73FF402D98E3),
+    UINT64_C(0x80FA687F881C7F8E), UINT64_C(0xA139029F6A239F72), UINT64_C(0xC987434744AC874E),
+    UINT64_C(0xFBE9141915D7A922), UINT64_C(0x9D71AC8FADA6C9B5), UINT64_C(0xC4CE17B399107C22),
+    UINT64_C(0xF6019DA07F549B2B), UINT64_C(0x99C102844F94E0FB), UINT64_C(0xC0314325637A1939),
+    UINT64_C(0xF03D93EEBC589F88), UINT64_C(0x96267C7535B763B5), UINT64_C(0xBBB01B9283253CA2),
+    UINT64_C(0xEA9C227723EE8BCB), UINT64_C(0x92A1958A7675175F), UINT64_C(0xB749FAED14125D36),
+    UINT64_C(0xE51C79A85916F484), UINT64_C(0x8F31CC0937AE58D2), UINT64_C(0xB2FE3F0B8599EF07),
+    UINT64_C(0xDFBDCECE67006AC9), UINT64_C(0x8BD6A141006042BD), UINT64_C(0xAECC49914078536D),
+    UINT64_C(0xDA7F5BF590966848), UINT64_C(0x888F99797A5E012D), UINT64_C(0xAAB37FD7D8F58178),
+    UINT64_C(0xD5605FCDCF32E1D6), UINT64_C(0x855C3BE0A17FCD26), UINT64_C(0xA6B34AD8C9DFC06F),
+    UINT64_C(0xD0601D8EFC57B08B), UINT64_C(0x823C12795DB6CE57), UINT64_C(0xA2CB1717B52481ED),
+    UINT64_C(0xCB7DDCDDA26DA268), UINT64_C(0xFE5D54150B090B02), UINT64_C(0x9EFA548D26E5A6E1),
+    UINT64_C(0xC6B8E9B0709F109A), UINT64_C(0xF867241C8CC6D4C0), UINT64_C(0x9B407691D7FC44F8),
+    UINT64_C(0xC21094364DFB5636), UINT64_C(0xF294B943E17A2BC4), UINT64_C(0x979CF3CA6CEC5B5A),
+    UINT64_C(0xBD8430BD08277231), UINT64_C(0xECE53CEC4A314EBD), UINT64_C(0x940F4613AE5ED136),
+    UINT64_C(0xB913179899F68584), UINT64_C(0xE757DD7EC07426E5), UINT64_C(0x9096EA6F3848984F),
+    UINT64_C(0xB4BCA50B065ABE63), UINT64_C(0xE1EBCE4DC7F16DFB), UINT64_C(0x8D3360F09CF6E4BD),
+    UINT64_C(0xB080392CC4349DEC), UINT64_C(0xDCA04777F541C567), UINT64_C(0x89E42CAAF9491B60),
+    UINT64_C(0xAC5D37D5B79B6239), UINT64_C(0xD77485CB25823AC7), UINT64_C(0x86A8D39EF77164BC),
+    UINT64_C(0xA8530886B54DBDEB), UINT64_C(0xD267CAA862A12D66), UINT64_C(0x8380DEA93DA4BC60),
+    UINT64_C(0xA46116538D0DEB78), UINT64_C(0xCD795BE870516656), UINT64_C(0x806BD9714632DFF6),
+    UINT64_C(0xA086CFCD97BF97F3), UINT64_C(0xC8A883C0FDAF7DF0), UINT64_C(0xFAD2A4B13D1B5D6C),
+    UINT64_C(0x9CC3A6EEC6311A63), UINT64_C(0xC3F490AA77BD60FC), UINT64_C(0xF4F1B4D515ACB93B),
+    UINT64_C(0x991711052D8BF3C5), UINT64_C(0xBF5CD54678EEF0B6), UINT64_C(0xEF340A98172AACE4),
+    UINT64_C(0x9580869F0E7AAC0E), UINT64_C(0xBAE0A846D2195712), UINT64_C(0xE998D258869FACD7),
+    UINT64_C(0x91FF83775423CC06), UINT64_C(0xB67F6455292CBF08), UINT64_C(0xE41F3D6A7377EECA),
+    UINT64_C(0x8E938662882AF53E), UINT64_C(0xB23867FB2A35B28D), UINT64_C(0xDEC681F9F4C31F31),
+    UINT64_C(0x8B3C113C38F9F37E), UINT64_C(0xAE0B158B4738705E), UINT64_C(0xD98DDAEE19068C76),
+    UINT64_C(0x87F8A8D4CFA417C9), UINT64_C(0xA9F6D30A038D1DBC), UINT64_C(0xD47487CC8470652B),
+    UINT64_C(0x84C8D4DFD2C63F3B), UINT64_C(0xA5FB0A17C777CF09), UINT64_C(0xCF79CC9DB955C2CC),
+    UINT64_C(0x81AC1FE293D599BF), UINT64_C(0xA21727DB38CB002F), UINT64_C(0xCA9CF1D206FDC03B),
+    UINT64_C(0xFD442E4688BD304A), UINT64_C(0x9E4A9CEC15763E2E), UINT64_C(0xC5DD44271AD3CDBA),
+    UINT64_C(0xF7549530E188C128), UINT64_C(0x9A94DD3E8CF578B9), UINT64_C(0xC13A148E3032D6E7),
+    UINT64_C(0xF18899B1BC3F8CA1), UINT64_C(0x96F5600F15A7B7E5), UINT64_C(0xBCB2B812DB11A5DE),
+    UINT64_C(0xEBDF661791D60F56), UINT64_C(0x936B9FCEBB25C995), UINT64_C(0xB84687C269EF3BFB),
+    UINT64_C(0xE65829B3046B0AFA), UINT64_C(0x8FF71A0FE2C2E6DC), UINT64_C(0xB3F4E093DB73A093),
+    UINT64_C(0xE0F218B8D25088B8), UINT64_C(0x8C974F7383725573), UINT64_C(0xAFBD2350644EEACF),
+    UINT64_C(0xDBAC6C247D62A583), UINT64_C(0x894BC396CE5DA772), UINT64_C(0xAB9EB47C81F5114F),
+    UINT64_C(0xD686619BA27255A2), UINT64_C(0x8613FD0145877585), UINT64_C(0xA798FC4196E952E7),
+    UINT64_C(0xD17F3B51FCA3A7A0), UINT64_C(0x82EF85133DE648C4), UINT64_C(0xA3AB66580D5FDAF5),
+    UINT64_C(0xCC963FEE10B7D1B3), UINT64_C(0xFFBBCFE994E5C61F), UINT64_C(0x9FD561F1FD0F9BD3),
+    UINT64_C(0xC7CABA6E7C5382C8), UINT64_C(0xF9BD690A1B68637B), UINT64_C(0x9C1661A651213E2D),
+    UINT64_C(0xC31BFA0FE5698DB8), UINT64_C(0xF3E2F893DEC3F126), UINT64_C(0x986DDB5C6B3A76B7),
+    UINT64_C(0xBE89523386091465), UINT64_C(0xEE2BA6C0678B597F), UINT64_C(0x94DB483840B717EF),
+    UINT64_C(0xBA121A4650E4DDEB), UINT64_C(0xE896A0D7E51E1566), UINT64_C(0x915E2486EF32CD60),
+    UINT64_C(0xB5B5ADA8AAFF80B8), UINT64_C(0xE3231912D5BF60E6), UINT64_C(0x8DF5EFABC5979C8F),
+    UINT64_C(0xB1736B96B6FD83B3), UINT64_C(0xDDD0467C64BCE4A0), UINT64_C(0x8AA22C0DBEF60EE4),
+    UINT64_C(0xAD4AB7112EB3929D), UINT64_C(0xD89D64D57A607744), UINT64_C(0x87625F056C7C4A8B),
+    UINT64_C(0xA93AF6C6C79B5D2D), UINT64_C(0xD389B47879823479), UINT64_C(0x843610CB4BF160CB),
+    UINT64_C(0xA54394FE1EEDB8FE), UINT64_C(0xCE947A3DA6A9273E), UINT64_C(0x811CCC668829B887),
+    UINT64_C(0xA163FF802A3426A8), UINT64_C(0xC9BCFF6034C13052), UINT64_C(0xFC2C3F3841F17C67),
+    UINT64_C(0x9D9BA7832936EDC0), UINT64_C(0xC5029163F384A931), UINT64_C(0xF64335BCF065D37D),
+    UINT64_C(0x99EA0196163FA42E), UINT64_C(0xC06481FB9BCF8D39), UINT64_C(0xF07DA27A82C37088),
+    UINT64_C(0x964E858C91BA2655), UINT64_C(0xBBE226EFB628AFEA), UINT64_C(0xEADAB0ABA3B2DBE5),
+    UINT64_C(0x92C8AE6B464FC96F), UINT64_C(0xB77ADA0617E3BBCB), UINT64_C(0xE55990879DDCAABD),
+    UINT64_C(0x8F57FA54C2A9EAB6), UINT64_C(0xB32DF8E9F3546564), UINT64_C(0xDFF9772470297EBD),
+    UINT64_C(0x8BFBEA76C619EF36), UINT64_C(0xAEFAE51477A06B03), UINT64_C(0xDAB99E59958885C4),
+    UINT64_C(0x88B402F7FD75539B), UINT64_C(0xAAE103B5FCD2A881), UINT64_C(0xD59944A37C0752A2),
+    UINT64_C(0x857FCAE62D8493A5), UINT64_C(0xA6DFBD9FB8E5B88E), UINT64_C(0xD097AD07A71F26B2),
+    UINT64_C(0x825ECC24C873782F), UINT64_C(0xA2F67F2DFA90563B), UINT64_C(0xCBB41EF979346BCA),
+    UINT64_C(0xFEA126B7D78186BC), UINT64_C(0x9F24B832E6B0F436), UINT64_C(0xC6EDE63FA05D3143),
+    UINT64_C(0xF8A95FCF88747D94), UINT64_C(0x9B69DBE1B548CE7C), UINT64_C(0xC24452DA229B021B),
+    UINT64_C(0xF2D56790AB41C2A2), UINT64_C(0x97C560BA6B0919A5), UINT64_C(0xBDB6B8E905CB600F),
+    UINT64_C(0xED246723473E3813), UINT64_C(0x9436C0760C86E30B), UINT64_C(0xB94470938FA89BCE),
+    UINT64_C(0xE7958CB87392C2C2), UINT64_C(0x90BD77F3483BB9B9), UINT64_C(0xB4ECD5F01A4AA828),
+    UINT64_C(0xE2280B6C20DD5232), UINT64_C(0x8D590723948A535F), UINT64_C(0xB0AF48EC79ACE837),
+    UINT64_C(0xDCDB1B2798182244), UINT64_C(0x8A08F0F8BF0F156B), UINT64_C(0xAC8B2D36EED2DAC5),
+    UINT64_C(0xD7ADF884AA879177), UINT64_C(0x86CCBB52EA94BAEA), UINT64_C(0xA87FEA27A539E9A5),
+    UINT64_C(0xD29FE4B18E88640E), UINT64_C(0x83A3EEEEF9153E89), UINT64_C(0xA48CEAAAB75A8E2B),
+    UINT64_C(0xCDB02555653131B6), UINT64_C(0x808E17555F3EBF11), UINT64_C(0xA0B19D2AB70E6ED6),
+    UINT64_C(0xC8DE047564D20A8B), UINT64_C(0xFB158592BE068D2E), UINT64_C(0x9CED737BB6C4183D),
+    UINT64_C(0xC428D05AA4751E4C), UINT64_C(0xF53304714D9265DF), UINT64_C(0x993FE2C6D07B7FAB),
+    UINT64_C(0xBF8FDB78849A5F96), UINT64_C(0xEF73D256A5C0F77C), UINT64_C(0x95A8637627989AAD),
+    UINT64_C(0xBB127C53B17EC159), UINT64_C(0xE9D71B689DDE71AF), UINT64_C(0x9226712162AB070D),
+    UINT64_C(0xB6B00D69BB55C8D1), UINT64_C(0xE45C10C42A2B3B05), UINT64_C(0x8EB98A7A9A5B04E3),
+    UINT64_C(0xB267ED1940F1C61C), UINT64_C(0xDF01E85F912E37A3), UINT64_C(0x8B61313BBABCE2C6),
+    UINT64_C(0xAE397D8AA96C1B77), UINT64_C(0xD9C7DCED53C72255), UINT64_C(0x881CEA14545C7575),
+    UINT64_C(0xAA242499697392D2), UINT64_C(0xD4AD2DBFC3D07787), UINT64_C(0x84EC3C97DA624AB4),
+    UINT64_C(0xA6274BBDD0FADD61), UINT64_C(0xCFB11EAD453994BA), UINT64_C(0x81CEB32C4B43FCF4),
+    UINT64_C(0xA2425FF75E14FC31), UINT64_C(0xCAD2F7F5359A3B3E), UINT64_C(0xFD87B5F28300CA0D),
+    UINT64_C(0x9E74D1B791E07E48), UINT64_C(0xC612062576589DDA), UINT64_C(0xF79687AED3EEC551),
+    UINT64_C(0x9ABE14CD44753B52), UINT64_C(0xC16D9A0095928A27), UINT64_C(0xF1C90080BAF72CB1),
+    UINT64_C(0x971DA05074DA7BEE), UINT64_C(0xBCE5086492111AEA), UINT64_C(0xEC1E4A7DB69561A5),
+    UINT64_C(0x9392EE8E921D5D07), UINT64_C(0xB877AA3236A4B449), UINT64_C(0xE69594BEC44DE15B),
+    UINT64_C(0x901D7CF73AB0ACD9), UINT64_C(0xB424DC35095CD80F), UINT64_C(0xE12E13424BB40E13),
+    UINT64_C(0x8CBCCC096F5088CB), UINT64_C(0xAFEBFF0BCB24AAFE), UINT64_C(0xDBE6FECEBDEDD5BE),
+    UINT64_C(0x89705F4136B4A597), UINT64_C(0xABCC77118461CEFC), UINT64_C(0xD6BF94D5E57A42BC),
+    UINT64_C(0x8637BD05AF6C69B5), UINT64_C(0xA7C5AC471B478423), UINT64_C(0xD1B71758E219652B),
+    UINT64_C(0x83126E978D4FDF3B), UINT64_C(0xA3D70A3D70A3D70A), UINT64_C(0xCCCCCCCCCCCCCCCC),
+    UINT64_C(0x8000000000000000), UINT64_C(0xA000000000000000), UINT64_C(0xC800000000000000),
+    UINT64_C(0xFA00000000000000), UINT64_C(0x9C40000000000000), UINT64_C(0xC350000000000000),
+    UINT64_C(0xF424000000000000), UINT64_C(0x9896800000000000), UINT64_C(0xBEBC200000000000),
+    UINT64_C(0xEE6B280000000000), UINT64_C(0x9502F90000000000), UINT64_C(0xBA43B74000000000),
+    UINT64_C(0xE8D4A51000000000), UINT64_C(0x9184E72A00000000), UINT64_C(0xB5E620F480000000),
+    UINT64_C(0xE35FA931A0000000), UINT64_C(0x8E1BC9BF04000000), UINT64_C(0xB1A2BC2EC5000000),
+    UINT64_C(0xDE0B6B3A76400000), UINT64_C(0x8AC7230489E80000), UINT64_C(0xAD78EBC5AC620000),
+    UINT64_C(0xD8D726B7177A8000), UINT64_C(0x878678326EAC9000), UINT64_C(0xA968163F0A57B400),
+    UINT64_C(0xD3C21BCECCEDA100), UINT64_C(0x84595161401484A0), UINT64_C(0xA56FA5B99019A5C8),
+    UINT64_C(0xCECB8F27F4200F3A), UINT64_C(0x813F3978F8940984), UINT64_C(0xA18F07D736B90BE5),
+    UINT64_C(0xC9F2C9CD04674EDE), UINT64_C(0xFC6F7C4045812296), UINT64_C(0x9DC5ADA82B70B59D),
+    UINT64_C(0xC5371912364CE305), UINT64_C(0xF684DF56C3E01BC6), UINT64_C(0x9A130B963A6C115C),
+    UINT64_C(0xC097CE7BC90715B3), UINT64_C(0xF0BDC21ABB48DB20), UINT64_C(0x96769950B50D88F4),
+    UINT64_C(0xBC143FA4E250EB31), UINT64_C(0xEB194F8E1AE525FD), UINT64_C(0x92EFD1B8D0CF37BE),
+    UINT64_C(0xB7ABC627050305AD), UINT64_C(0xE596B7B0C643C719), UINT64_C(0x8F7E32CE7BEA5C6F),
+    UINT64_C(0xB35DBF821AE4F38B), UINT64_C(0xE0352F62A19E306E), UINT64_C(0x8C213D9DA502DE45),
+    UINT64_C(0xAF298D050E4395D6), UINT64_C(0xDAF3F04651D47B4C), UINT64_C(0x88D8762BF324CD0F),
+    UINT64_C(0xAB0E93B6EFEE0053), UINT64_C(0xD5D238A4ABE98068), UINT64_C(0x85A36366EB71F041),
+    UINT64_C(0xA70C3C40A64E6C51), UINT64_C(0xD0CF4B50CFE20765), UINT64_C(0x82818F1281ED449F),
+    UINT64_C(0xA321F2D7226895C7), UINT64_C(0xCBEA6F8CEB02BB39), UINT64_C(0xFEE50B7025C36A08),
+    UINT64_C(0x9F4F2726179A2245), UINT64_C(0xC722F0EF9D80AAD6), UINT64_C(0xF8EBAD2B84E0D58B),
+    UINT64_C(0x9B934C3B330C8577), UINT64_C(0xC2781F49FFCFA6D5), UINT64_C(0xF316271C7FC3908A),
+    UINT64_C(0x97EDD871CFDA3A56), UINT64_C(0xBDE94E8E43D0C8EC), UINT64_C(0xED63A231D4C4FB27),
+    UINT64_C(0x945E455F24FB1CF8), UINT64_C(0xB975D6B6EE39E436), UINT64_C(0xE7D34C64A9C85D44),
+    UINT64_C(0x90E40FBEEA1D3A4A), UINT64_C(0xB51D13AEA4A488DD), UINT64_C(0xE264589A4DCDAB14),
+    UINT64_C(0x8D7EB76070A08AEC), UINT64_C(0xB0DE65388CC8ADA8), UINT64_C(0xDD15FE86AFFAD912),
+    UINT64_C(0x8A2DBF142DFCC7AB), UINT64_C(0xACB92ED9397BF996), UINT64_C(0xD7E77A8F87DAF7FB),
+    UINT64_C(0x86F0AC99B4E8DAFD), UINT64_C(0xA8ACD7C0222311BC), UINT64_C(0xD2D80DB02AABD62B),
+    UINT64_C(0x83C7088E1AAB65DB), UINT64_C(0xA4B8CAB1A1563F52), UINT64_C(0xCDE6FD5E09ABCF26),
+    UINT64_C(0x80B05E5AC60B6178), UINT64_C(0xA0DC75F1778E39D6), UINT64_C(0xC913936DD571C84C),
+    UINT64_C(0xFB5878494ACE3A5F), UINT64_C(0x9D174B2DCEC0E47B), UINT64_C(0xC45D1DF942711D9A),
+    UINT64_C(0xF5746577930D6500), UINT64_C(0x9968BF6ABBE85F20), UINT64_C(0xBFC2EF456AE276E8),
+    UINT64_C(0xEFB3AB16C59B14A2), UINT64_C(0x95D04AEE3B80ECE5), UINT64_C(0xBB445DA9CA61281F),
+    UINT64_C(0xEA1575143CF97226), UINT64_C(0x924D692CA61BE758), UINT64_C(0xB6E0C377CFA2E12E),
+    UINT64_C(0xE498F455C38B997A), UINT64_C(0x8EDF98B59A373FEC), UINT64_C(0xB2977EE300C50FE7),
+    UINT64_C(0xDF3D5E9BC0F653E1), UINT64_C(0x8B865B215899F46C), UINT64_C(0xAE67F1E9AEC07187),
+    UINT64_C(0xDA01EE641A708DE9), UINT64_C(0x884134FE908658B2), UINT64_C(0xAA51823E34A7EEDE),
+    UINT64_C(0xD4E5E2CDC1D1EA96), UINT64_C(0x850FADC09923329E), UINT64_C(0xA6539930BF6BFF45),
+    UINT64_C(0xCFE87F7CEF46FF16), UINT64_C(0x81F14FAE158C5F6E), UINT64_C(0xA26DA3999AEF7749),
+    UINT64_C(0xCB090C8001AB551C), UINT64_C(0xFDCB4FA002162A63), UINT64_C(0x9E9F11C4014DDA7E),
+    UINT64_C(0xC646D63501A1511D), UINT64_C(0xF7D88BC24209A565), UINT64_C(0x9AE757596946075F),
+    UINT64_C(0xC1A12D2FC3978937), UINT64_C(0xF209787BB47D6B84), UINT64_C(0x9745EB4D50CE6332),
+    UINT64_C(0xBD176620A501FBFF), UINT64_C(0xEC5D3FA8CE427AFF), UINT64_C(0x93BA47C980E98CDF),
+    UINT64_C(0xB8A8D9BBE123F017), UINT64_C(0xE6D3102AD96CEC1D), UINT64_C(0x9043EA1AC7E41392),
+    UINT64_C(0xB454E4A179DD1877), UINT64_C(0xE16A1DC9D8545E94), UINT64_C(0x8CE2529E2734BB1D),
+    UINT64_C(0xB01AE745B101E9E4), UINT64_C(0xDC21A1171D42645D), UINT64_C(0x899504AE72497EBA),
+    UINT64_C(0xABFA45DA0EDBDE69), UINT64_C(0xD6F8D7509292D603), UINT64_C(0x865B86925B9BC5C2),
+    UINT64_C(0xA7F26836F282B732), UINT64_C(0xD1EF0244AF2364FF), UINT64_C(0x8335616AED761F1F),
+    UINT64_C(0xA402B9C5A8D3A6E7), UINT64_C(0xCD036837130890A1), UINT64_C(0x802221226BE55A64),
+    UINT64_C(0xA02AA96B06DEB0FD), UINT64_C(0xC83553C5C8965D3D), UINT64_C(0xFA42A8B73ABBF48C),
+    UINT64_C(0x9C69A97284B578D7), UINT64_C(0xC38413CF25E2D70D), UINT64_C(0xF46518C2EF5B8CD1),
+    UINT64_C(0x98BF2F79D5993802), UINT64_C(0xBEEEFB584AFF8603), UINT64_C(0xEEAABA2E5DBF6784),
+    UINT64_C(0x952AB45CFA97A0B2), UINT64_C(0xBA756174393D88DF), UINT64_C(0xE912B9D1478CEB17),
+    UINT64_C(0x91ABB422CCB812EE), UINT64_C(0xB616A12B7FE617AA), UINT64_C(0xE39C49765FDF9D94),
+    UINT64_C(0x8E41ADE9FBEBC27D), UINT64_C(0xB1D219647AE6B31C), UINT64_C(0xDE469FBD99A05FE3),
+    UINT64_C(0x8AEC23D680043BEE), UINT64_C(0xADA72CCC20054AE9), UINT64_C(0xD910F7FF28069DA4),
+    UINT64_C(0x87AA9AFF79042286), UINT64_C(0xA99541BF57452B28), UINT64_C(0xD3FA922F2D1675F2),
+    UINT64_C(0x847C9B5D7C2E09B7), UINT64_C(0xA59BC234DB398C25), UINT64_C(0xCF02B2C21207EF2E),
+    UINT64_C(0x8161AFB94B44F57D), UINT64_C(0xA1BA1BA79E1632DC), UINT64_C(0xCA28A291859BBF93),
+    UINT64_C(0xFCB2CB35E702AF78), UINT64_C(0x9DEFBF01B061ADAB), UINT64_C(0xC56BAEC21C7A1916),
+    UINT64_C(0xF6C69A72A3989F5B), UINT64_C(0x9A3C2087A63F6399), UINT64_C(0xC0CB28A98FCF3C7F),
+    UINT64_C(0xF0FDF2D3F3C30B9F), UINT64_C(0x969EB7C47859E743), UINT64_C(0xBC4665B596706114),
+    UINT64_C(0xEB57FF22FC0C7959), UINT64_C(0x9316FF75DD87CBD8), UINT64_C(0xB7DCBF5354E9BECE),
+    UINT64_C(0xE5D3EF282A242E81), UINT64_C(0x8FA475791A569D10), UINT64_C(0xB38D92D760EC4455),
+    UINT64_C(0xE070F78D3927556A), UINT64_C(0x8C469AB843B89562), UINT64_C(0xAF58416654A6BABB),
+    UINT64_C(0xDB2E51BFE9D0696A), UINT64_C(0x88FCF317F22241E2), UINT64_C(0xAB3C2FDDEEAAD25A),
+    UINT64_C(0xD60B3BD56A5586F1), UINT64_C(0x85C7056562757456), UINT64_C(0xA738C6BEBB12D16C),
+    UINT64_C(0xD106F86E69D785C7), UINT64_C(0x82A45B450226B39C), UINT64_C(0xA34D721642B06084),
+    UINT64_C(0xCC20CE9BD35C78A5), UINT64_C(0xFF290242C83396CE), UINT64_C(0x9F79A169BD203E41),
+    UINT64_C(0xC75809C42C684DD1), UINT64_C(0xF92E0C3537826145), UINT64_C(0x9BBCC7A142B17CCB),
+    UINT64_C(0xC2ABF989935DDBFE), UINT64_C(0xF356F7EBF83552FE), UINT64_C(0x98165AF37B2153DE),
+    UINT64_C(0xBE1BF1B059E9A8D6), UINT64_C(0xEDA2EE1C7064130C), UINT64_C(0x9485D4D1C63E8BE7),
+    UINT64_C(0xB9A74A0637CE2EE1), UINT64_C(0xE8111C87C5C1BA99), UINT64_C(0x910AB1D4DB9914A0),
+    UINT64_C(0xB54D5E4A127F59C8), UINT64_C(0xE2A0B5DC971F303A), UINT64_C(0x8DA471A9DE737E24),
+    UINT64_C(0xB10D8E1456105DAD), UINT64_C(0xDD50F1996B947518), UINT64_C(0x8A5296FFE33CC92F),
+    UINT64_C(0xACE73CBFDC0BFB7B), UINT64_C(0xD8210BEFD30EFA5A), UINT64_C(0x8714A775E3E95C78),
+    UINT64_C(0xA8D9D1535CE3B396), UINT64_C(0xD31045A8341CA07C), UINT64_C(0x83EA2B892091E44D),
+    UINT64_C(0xA4E4B66B68B65D60), UINT64_C(0xCE1DE40642E3F4B9), UINT64_C(0x80D2AE83E9CE78F3),
+    UINT64_C(0xA1075A24E4421730), UINT64_C(0xC94930AE1D529CFC), UINT64_C(0xFB9B7CD9A4A7443C),
+    UINT64_C(0x9D412E0806E88AA5), UINT64_C(0xC491798A08A2AD4E), UINT64_C(0xF5B5D7EC8ACB58A2),
+    UINT64_C(0x9991A6F3D6BF1765), UINT64_C(0xBFF610B0CC6EDD3F), UINT64_C(0xEFF394DCFF8A948E),
+    UINT64_C(0x95F83D0A1FB69CD9), UINT64_C(0xBB764C4CA7A4440F), UINT64_C(0xEA53DF5FD18D5513),
+    UINT64_C(0x92746B9BE2F8552C), UINT64_C(0xB7118682DBB66A77), UINT64_C(0xE4D5E82392A40515),
+    UINT64_C(0x8F05B1163BA6832D), UINT64_C(0xB2C71D5BCA9023F8), UINT64_C(0xDF78E4B2BD342CF6),
+    UINT64_C(0x8BAB8EEFB6409C1A), UINT64_C(0xAE9672ABA3D0C320), UINT64_C(0xDA3C0F568CC4F3E8),
+    UINT64_C(0x8865899617FB1871), UINT64_C(0xAA7EEBFB9DF9DE8D), UINT64_C(0xD51EA6FA85785631),
+    UINT64_C(0x8533285C936B35DE), UINT64_C(0xA67FF273B8460356), UINT64_C(0xD01FEF10A657842C),
+    UINT64_C(0x8213F56A67F6B29B), UINT64_C(0xA298F2C501F45F42), UINT64_C(0xCB3F2F7642717713),
+    UINT64_C(0xFE0EFB53D30DD4D7), UINT64_C(0x9EC95D1463E8A506), UINT64_C(0xC67BB4597CE2CE48),
+    UINT64_C(0xF81AA16FDC1B81DA), UINT64_C(0x9B10A4E5E9913128), UINT64_C(0xC1D4CE1F63F57D72),
+    UINT64_C(0xF24A01A73CF2DCCF), UINT64_C(0x976E41088617CA01), UINT64_C(0xBD49D14AA79DBC82),
+    UINT64_C(0xEC9C459D51852BA2), UINT64_C(0x93E1AB8252F33B45), UINT64_C(0xB8DA1662E7B00A17),
+    UINT64_C(0xE7109BFBA19C0C9D), UINT64_C(0x906A617D450187E2), UINT64_C(0xB484F9DC9641E9DA),
+    UINT64_C(0xE1A63853BBD26451), UINT64_C(0x8D07E33455637EB2), UINT64_C(0xB049DC016ABC5E5F),
+    UINT64_C(0xDC5C5301C56B75F7), UINT64_C(0x89B9B3E11B6329BA), UINT64_C(0xAC2820D9623BF429),
+    UINT64_C(0xD732290FBACAF133), UINT64_C(0x867F59A9D4BED6C0), UINT64_C(0xA81F301449EE8C70),
+    UINT64_C(0xD226FC195C6A2F8C), UINT64_C(0x83585D8FD9C25DB7), UINT64_C(0xA42E74F3D032F525),
+    UINT64_C(0xCD3A1230C43FB26F), UINT64_C(0x80444B5E7AA7CF85), UINT64_C(0xA0555E361951C366),
+    UINT64_C(0xC86AB5C39FA63440), UINT64_C(0xFA856334878FC150), UINT64_C(0x9C935E00D4B9D8D2),
+    UINT64_C(0xC3B8358109E84F07), UINT64_C(0xF4A642E14C6262C8), UINT64_C(0x98E7E9CCCFBD7DBD),
+    UINT64_C(0xBF21E44003ACDD2C), UINT64_C(0xEEEA5D5004981478), UINT64_C(0x95527A5202DF0CCB),
+    UINT64_C(0xBAA718E68396CFFD), UINT64_C(0xE950DF20247C83FD), UINT64_C(0x91D28B7416CDD27E),
+    UINT64_C(0xB6472E511C81471D), UINT64_C(0xE3D8F9E563A198E5), UINT64_C(0x8E679C2F5E44FF8F)
+};
+
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+/* the powers of ten a double holds exactly */
+static const double exact_powers_of_ten[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#endif
+
+/* 64 x 64 -> 128 bit multiplication */
+static void multiply_64(const uint64_t a, const uint64_t b, uint64_t * const high, uint64_t * const low)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 product = (uint128)a * b;
+    *high = (uint64_t)(product >> 64);
+    *low = (uint64_t)product;
+#else
+    const uint64_t mask = UINT64_C(0xFFFFFFFF);
+    uint64_t a_hi = a >> 32;
+    uint64_t a_lo = a & mask;
+    uint64_t b_hi = b >> 32;
+    uint64_t b_lo = b & mask;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t middle = (lo_lo >> 32) + (hi_lo & mask) + lo_hi;
+    *high = (a_hi * b_hi) + (hi_lo >> 32) + (middle >> 32);
+    *low = (middle << 32) | (lo_lo & mask);
+#endif
+}
+
+static int leading_zeros_64(uint64_t x)
+{
+    int count = 0;
+
+    if ((x >> 32) == 0)
+    {
+        count += 32;
+        x <<= 32;
+    }
+    if ((x >> 48) == 0)
+    {
+        count += 16;
+        x <<= 16;
+    }
+    if ((x >> 56) == 0)
+    {
+        count += 8;
+        x <<= 8;
+    }
+    if ((x >> 60) == 0)
+    {
+        count += 4;
+        x <<= 4;
+    }
+    if ((x >> 62) == 0)
+    {
+        count += 2;
+        x <<= 2;
+    }
+    if ((x >> 63) == 0)
+    {
+        count += 1;
+    }
+
+    return count;
+}
+
+/* Eisel-Lemire: the double nearest to mantissa * 10^exponent (mantissa nonzero).
+ * Returns false when it cannot decide the rounding, or for subnormal or
+ * out of range results, which are left to strtod. */
+static cJSON_bool eisel_lemire(uint64_t mantissa, const int exponent, const cJSON_bool negative, double * const number)
+{
+    uint64_t high = 0;
+    uint64_t low = 0;
+    uint64_t bits = 0;
+    uint64_t upper_bit = 0;
+    int leading_zeros = 0;
+    int binary_exponent = 0;
+    int scaled = 0;
+
+    if ((exponent < POWERS_OF_FIVE_MIN_EXPONENT) || (exponent > POWERS_OF_FIVE_MAX_EXPONENT))
+    {
+        return false;
+    }
+
+    leading_zeros = leading_zeros_64(mantissa);
+    mantissa <<= leading_zeros;
+
+    /* floor(exponent * log2(10)) + 64 + bias, without shifting a negative number */
+    scaled = 217706 * exponent;
+    binary_exponent = ((scaled >= 0) ? (scaled / 65536) : -((-scaled + 65535) / 65536)) + 64 + 1023 - leading_zeros;
+
+    multiply_64(mantissa, powers_of_ten_high[exponent - POWERS_OF_FIVE_MIN_EXPONENT], &high, &low);
+
+    /* the truncated low half of the power could carry into the bits that
+     * decide the rounding; a wider product would settle it, this gives up */
+    if (((high & 0x1FF) == 0x1FF) && ((low + mantissa) < mantissa))
+    {
+        return false;
+    }
+
+    /* keep 54 bits */
+    upper_bit = high >> 63;
+    bits = high >> (upper_bit + 9);
+    binary_exponent -= (int)(1 ^ upper_bit);
+
+    /* exactly halfway between two doubles: round-half-even needs more digits */
+    if ((low == 0) && ((high & 0x1FF) == 0) && ((bits & 3) == 1))
+    {
+        return false;
+    }
+
+    /* round to 53 bits */
+    bits += bits & 1;
+    bits >>= 1;
+    if ((bits >> 53) != 0)
+    {
+        bits >>= 1;
+        binary_exponent++;
+    }
+
+    if ((binary_exponent <= 0) || (binary_exponent >= 0x7FF))
+    {
+        return false;
+    }
+
+    bits = ((uint64_t)binary_exponent << 52) | (bits & ((UINT64_C(1) << 52) - 1));
+    if (negative)
+    {
+        bits |= UINT64_C(1) << 63;
+    }
+    memcpy(number, &bits, sizeof(bits));
+
+    return true;
+}
+
+/* Convert the number at the start of input, which holds length bytes, the way
+ * strtod would, accepting what strtod accepts: [+-] digits [. digits] [e [+-] digits].
+ * *end receives the length converted (0 if there is no number). Returns false
+ * for the numbers that have to go to strtod; *end is set nonetheless. If
+ * the number is an integer, *is_integer is set and *integer receives its
+ * saturated int value. */
+static cJSON_bool fast_parse_number(const unsigned char * const input, const size_t length, double * const number, size_t * const end, cJSON_bool * const is_integer, int * const integer)
+{
+    size_t position = 0;
+    size_t digits_start = 0;
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    long explicit_exponent = 0;
+    cJSON_bool negative = false;
+    cJSON_bool has_fraction = false;
+    cJSON_bool has_exponent = false;
+
+    *end = 0;
+    *is_integer = false;
+
+    if ((position < length) && ((input[position] == '-') || (input[position] == '+')))
+    {
+        negative = (input[position] == '-');
+        position++;
+    }
+
+    digits_start = position;
+    while ((position < length) && (input[position] >= '0') && (input[position] <= '9'))
+    {
+        if ((significant_digits > 0) || (input[position] != '0'))
+        {
+            significant_digits++;
+        }
+        mantissa = mantissa * 10 + (uint64_t)(input[position] - '0');
+        position++;
+        if (significant_digits > 19)
+        {
+            break;
+        }
+    }
+    if ((significant_digits <= 19) && (position < length) && (input[position] == '.'))
+    {
+        has_fraction = true;
+        position++;
+        while ((position < length) && (input[position] >= '0') && (input[position] <= '9'))
+        {
+            if ((significant_digits > 0) || (input[position] != '0'))
+            {
+                significant_digits++;
+            }
+            mantissa = mantissa * 10 + (uint64_t)(input[position] - '0');
+            exponent--;
+            position++;
+            if (significant_digits > 19)
+            {
+                break;
+            }
+        }
+    }
+    if (significant_digits > 19)
+    {
+        /* too many digits for the mantissa; strtod finds the end */
+        *end = position;
+        return false;
+    }
+    if ((position - digits_start) == (size_t)(has_fraction ? 1 : 0))
+    {
+        /* no digits at all */
+        return false;
+    }
+
+    if ((position < length) && ((input[position] == 'e') || (input[position] == 'E')))
+    {
+        /* only an exponent with digits is part of the number */
+        size_t exponent_position = position + 1;
+        cJSON_bool negative_exponent = false;
+
+        if ((exponent_position < length) && ((input[exponent_position] == '-') || (input[exponent_position] == '+')))
+        {
+            negative_exponent = (input[exponent_position] == '-');
+            exponent_position++;
+        }
+        if ((exponent_position < length) && (input[exponent_position] >= '0') && (input[exponent_position] <= '9'))
+        {
+            has_exponent = true;
+            while ((exponent_position < length) && (input[exponent_position] >= '0') && (input[exponent_position] <= '9'))
+            {
+                if (explicit_exponent < 100000)
+                {
+                    explicit_exponent = explicit_exponent * 10 + (input[exponent_position] - '0');
+                }
+                exponent_position++;
+            }
+            if (negative_exponent)
+            {
+                explicit_exponent = -explicit_exponent;
+            }
+            position = exponent_position;
+        }
+    }
+    *end = position;
+
+    if (!has_fraction && !has_exponent)
+    {
+        /* an integer of at most 19 digits: the conversion rounds correctly */
+        *number = negative ? -(double)mantissa : (double)mantissa;
+        *is_integer = true;
+        if (negative)
+        {
+            *integer = (mantissa >= (uint64_t)INT_MAX + 1) ? INT_MIN : -(int)mantissa;
+        }
+        else
+        {
+            *integer = (mantissa >= (uint64_t)INT_MAX) ? INT_MAX : (int)mantissa;
+        }
+        return true;
+    }
+
+    if (mantissa == 0)
+    {
+        *number = negative ? -0.0 : 0.0;
+        return true;
+    }
+
+    exponent += (int)explicit_exponent;
+
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+    /* Clinger: both operands are exact, so one IEEE operation rounds correctly */
+    if ((mantissa <= (UINT64_C(1) << 53)) && (exponent >= -22) && (exponent <= 22))
+    {
+        *number = (double)mantissa;
+        if (exponent < 0)
+        {
+            *number /= exact_powers_of_ten[-exponent];
+        }
+        else
+        {
+            *number *= exact_powers_of_ten[exponent];
+        }
+        if (negative)
+        {
+            *number = -*number;
+        }
+        return true;
+    }
+#endif
+
+    return eisel_lemire(mantissa, exponent, negative, number);
+}
+
 /* Parse the input text to generate a number, and populate the result into item. */
 static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
 {
     double number = 0;
     unsigned char *after_end = NULL;
     unsigned char *number_c_string;
+    unsigned char short_number[64];
     unsigned char decimal_point = get_decimal_point();
     size_t i = 0;
     size_t number_string_length = 0;
     cJSON_bool has_decimal_point = false;
+    cJSON_bool is_integer = false;
+    int integer = 0;
 
     if ((input_buffer == NULL) || (input_buffer->content == NULL))
     {
         return false;
     }
 
+    if (fast_parse_number(buffer_at_offset(input_buffer), input_buffer->length - input_buffer->offset, &number, &number_string_length, &is_integer, &integer))
+    {
+        if (is_integer)
+        {
+            item->valuedouble = number;
+            item->valueint = integer;
+        }
+        else
+        {
+            cJSON_SetNumberHelper(item, number);
+        }
+        item->type = cJSON_Number;
+        input_buffer->offset += number_string_length;
+        return true;
+    }
+
+    /* the rare hard cases go to strtod */
+    number_string_length = 0;
+
     /* copy the number into a temporary buffer and replace '.' with the decimal point
      * of the current locale (for strtod)
      * This also takes care of '\0' not necessarily being available for marking the end of the input */
@@ -353,11 +902,18 @@ static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_bu
         }
     }
 loop_end:
-    /* malloc for temporary buffer, add 1 for '\0' */
-    number_c_string = (unsigned char *) input_buffer->hooks.allocate(number_string_length + 1);
-    if (number_c_string == NULL)
+    /* short numbers fit on the stack, add 1 for '\0' */
+    if (number_string_length < sizeof(short_number))
     {
-        return false; /* allocation failure */
+        number_c_string = short_number;
+    }
+    else
+    {
+        number_c_string = (unsigned char *) input_buffer->hooks.allocate(number_string_length + 1);
+        if (number_c_string == NULL)
+        {
+            return false; /* allocation failure */
+        }
     }
 
     memcpy(number_c_string, buffer_at_offset(input_buffer), number_string_length);
@@ -379,31 +935,23 @@ loop_end:
     if (number_c_string == after_end)
     {
         /* free the temporary buffer */
-        input_buffer->hooks.deallocate(number_c_string);
+        if (number_c_string != short_number)
+        {
+            input_buffer->hooks.deallocate(number_c_string);
+        }
         return false; /* parse_error */
     }
 
-    item->valuedouble = number;
-
     /* use saturation in case of overflow */
-    if (number >= INT_MAX)
-    {
-        item->valueint = INT_MAX;
-    }
-    else if (number <= (double)INT_MIN)
-    {
-        item->valueint = INT_MIN;
-    }
-    else
-    {
-        item->valueint = (int)number;
-    }
-
+    cJSON_SetNumberHelper(item, number);
     item->type = cJSON_Number;
 
     input_buffer->offset += (size_t)(after_end - number_c_string);
     /* free the temporary buffer */
-    input_buffer->hooks.deallocate(number_c_string);
+    if (number_c_string != short_number)
+    {
+        input_buffer->hooks.deallocate(number_c_string);
+    }
     return true;
 }
 
@@ -587,71 +1135,490 @@ static cJSON_bool compare_double(double a, double b)
     return (fabs(a - b) <= maxVal * DBL_EPSILON);
 }
 
-/* Render the number nicely from the given item into a string. */
-static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+/* Shortest round-trip formatting of doubles: Grisu2, from Florian Loitsch,
+ * "Printing Floating-Point Numbers Quickly and Accurately with Integers"
+ * (PLDI 2010). The digits it produces always parse back to the same double,
+ * and in all but about 0.1% of cases no shorter digit string does. Only
+ * integer arithmetic is used, so the result does not depend on the locale. */
+
+/* a floating point number f * 2^e with a 64 bit significand */
+typedef struct
 {
-    unsigned char *output_pointer = NULL;
-    double d = item->valuedouble;
-    int length = 0;
-    size_t i = 0;
-    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
-    unsigned char decimal_point = get_decimal_point();
-    double test = 0.0;
+    uint64_t f;
+    int e;
+} diy_fp;
 
-    if (output_buffer == NULL)
+/* 10^k ~= f * 2^e, normalized */
+typedef struct
+{
+    uint64_t f;
+    int e;
+    int k;
+} cached_power;
+
+#define GRISU_ALPHA (-60)
+#define GRISU_GAMMA (-32)
+#define CACHED_POWERS_MIN_DECIMAL_EXPONENT (-300)
+#define CACHED_POWERS_DECIMAL_STEP 8
+
+static const cached_power cached_powers[] =
+{
+    { UINT64_C(0xAB70FE17C79AC6CA), -1060, -300 },
+    { UINT64_C(0xFF77B1FCBEBCDC4F), -1034, -292 },
+    { UINT64_C(0xBE5691EF416BD60C), -1007, -284 },
+    { UINT64_C(0x8DD01FAD907FFC3C), -980, -276 },
+    { UINT64_C(0xD3515C2831559A83), -954, -268 },
+    { UINT64_C(0x9D71AC8FADA6C9B5), -927, -260 },
+    { UINT64_C(0xEA9C227723EE8BCB), -901, -252 },
+    { UINT64_C(0xAECC49914078536D), -874, -244 },
+    { UINT64_C(0x823C12795DB6CE57), -847, -236 },
+    { UINT64_C(0xC21094364DFB5637), -821, -228 },
+    { UINT64_C(0x9096EA6F3848984F), -794, -220 },
+    { UINT64_C(0xD77485CB25823AC7), -768, -212 },
+    { UINT64_C(0xA086CFCD97BF97F4), -741, -204 },
+    { UINT64_C(0xEF340A98172AACE5), -715, -196 },
+    { UINT64_C(0xB23867FB2A35B28E), -688, -188 },
+    { UINT64_C(0x84C8D4DFD2C63F3B), -661, -180 },
+    { UINT64_C(0xC5DD44271AD3CDBA), -635, -172 },
+    { UINT64_C(0x936B9FCEBB25C996), -608, -164 },
+    { UINT64_C(0xDBAC6C247D62A584), -582, -156 },
+    { UINT64_C(0xA3AB66580D5FDAF6), -555, -148 },
+    { UINT64_C(0xF3E2F893DEC3F126), -529, -140 },
+    { UINT64_C(0xB5B5ADA8AAFF80B8), -502, -132 },
+    { UINT64_C(0x87625F056C7C4A8B), -475, -124 },
+    { UINT64_C(0xC9BCFF6034C13053), -449, -116 },
+    { UINT64_C(0x964E858C91BA2655), -422, -108 },
+    { UINT64_C(0xDFF9772470297EBD), -396, -100 },
+    { UINT64_C(0xA6DFBD9FB8E5B88F), -369, -92 },
+    { UINT64_C(0xF8A95FCF88747D94), -343, -84 },
+    { UINT64_C(0xB94470938FA89BCF), -316, -76 },
+    { UINT64_C(0x8A08F0F8BF0F156B), -289, -68 },
+    { UINT64_C(0xCDB02555653131B6), -263, -60 },
+    { UINT64_C(0x993FE2C6D07B7FAC), -236, -52 },
+    { UINT64_C(0xE45C10C42A2B3B06), -210, -44 },
+    { UINT64_C(0xAA242499697392D3), -183, -36 },
+    { UINT64_C(0xFD87B5F28300CA0E), -157, -28 },
+    { UINT64_C(0xBCE5086492111AEB), -130, -20 },
+    { UINT64_C(0x8CBCCC096F5088CC), -103, -12 },
+    { UINT64_C(0xD1B71758E219652C), -77, -4 },
+    { UINT64_C(0x9C40000000000000), -50, 4 },
+    { UINT64_C(0xE8D4A51000000000), -24, 12 },
+    { UINT64_C(0xAD78EBC5AC620000), 3, 20 },
+    { UINT64_C(0x813F3978F8940984), 30, 28 },
+    { UINT64_C(0xC097CE7BC90715B3), 56, 36 },
+    { UINT64_C(0x8F7E32CE7BEA5C70), 83, 44 },
+    { UINT64_C(0xD5D238A4ABE98068), 109, 52 },
+    { UINT64_C(0x9F4F2726179A2245), 136, 60 },
+    { UINT64_C(0xED63A231D4C4FB27), 162, 68 },
+    { UINT64_C(0xB0DE65388CC8ADA8), 189, 76 },
+    { UINT64_C(0x83C7088E1AAB65DB), 216, 84 },
+    { UINT64_C(0xC45D1DF942711D9A), 242, 92 },
+    { UINT64_C(0x924D692CA61BE758), 269, 100 },
+    { UINT64_C(0xDA01EE641A708DEA), 295, 108 },
+    { UINT64_C(0xA26DA3999AEF774A), 322, 116 },
+    { UINT64_C(0xF209787BB47D6B85), 348, 124 },
+    { UINT64_C(0xB454E4A179DD1877), 375, 132 },
+    { UINT64_C(0x865B86925B9BC5C2), 402, 140 },
+    { UINT64_C(0xC83553C5C8965D3D), 428, 148 },
+    { UINT64_C(0x952AB45CFA97A0B3), 455, 156 },
+    { UINT64_C(0xDE469FBD99A05FE3), 481, 164 },
+    { UINT64_C(0xA59BC234DB398C25), 508, 172 },
+    { UINT64_C(0xF6C69A72A3989F5C), 534, 180 },
+    { UINT64_C(0xB7DCBF5354E9BECE), 561, 188 },
+    { UINT64_C(0x88FCF317F22241E2), 588, 196 },
+    { UINT64_C(0xCC20CE9BD35C78A5), 614, 204 },
+    { UINT64_C(0x98165AF37B2153DF), 641, 212 },
+    { UINT64_C(0xE2A0B5DC971F303A), 667, 220 },
+    { UINT64_C(0xA8D9D1535CE3B396), 694, 228 },
+    { UINT64_C(0xFB9B7CD9A4A7443C), 720, 236 },
+    { UINT64_C(0xBB764C4CA7A44410), 747, 244 },
+    { UINT64_C(0x8BAB8EEFB6409C1A), 774, 252 },
+    { UINT64_C(0xD01FEF10A657842C), 800, 260 },
+    { UINT64_C(0x9B10A4E5E9913129), 827, 268 },
+    { UINT64_C(0xE7109BFBA19C0C9D), 853, 276 },
+    { UINT64_C(0xAC2820D9623BF429), 880, 284 },
+    { UINT64_C(0x80444B5E7AA7CF85), 907, 292 },
+    { UINT64_C(0xBF21E44003ACDD2D), 933, 300 },
+    { UINT64_C(0x8E679C2F5E44FF8F), 960, 308 },
+    { UINT64_C(0xD433179D9C8CB841), 986, 316 },
+    { UINT64_C(0x9E19DB92B4E31BA9), 1013, 324 }
+};
+
+/* product of two diy_fps, rounded to 64 bits */
+static diy_fp diy_fp_multiply(const diy_fp x, const diy_fp y)
+{
+    const uint64_t mask = UINT64_C(0xFFFFFFFF);
+    uint64_t x_hi = x.f >> 32;
+    uint64_t x_lo = x.f & mask;
+    uint64_t y_hi = y.f >> 32;
+    uint64_t y_lo = y.f & mask;
+    uint64_t hi_hi = x_hi * y_hi;
+    uint64_t hi_lo = x_hi * y_lo;
+    uint64_t lo_hi = x_lo * y_hi;
+    uint64_t lo_lo = x_lo * y_lo;
+    uint64_t middle = (lo_lo >> 32) + (hi_lo & mask) + (lo_hi & mask) + (UINT64_C(1) << 31);
+    diy_fp product;
+
+    product.f = hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + (middle >> 32);
+    product.e = x.e + y.e + 64;
+
+    return product;
+}
+
+static diy_fp diy_fp_normalize(diy_fp x)
+{
+    while ((x.f >> 63) == 0)
     {
-        return false;
+        x.f <<= 1;
+        x.e--;
     }
 
-    /* This checks for NaN and Infinity */
-    if (isnan(d) || isinf(d))
+    return x;
+}
+
+/* number of decimal digits in n (at least 1); *power receives 10^(digits - 1) */
+static int count_digits(const uint32_t n, uint32_t * const power)
+{
+    static const uint32_t powers_of_ten[] =
+    {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+    };
+    int digits = 10;
+
+    while ((digits > 1) && (n < powers_of_ten[digits - 1]))
     {
-        length = sprintf((char*)number_buffer, "null");
+        digits--;
     }
-    else if(d == (double)item->valueint)
+    *power = powers_of_ten[digits - 1];
+
+    return digits;
+}
+
+/* move the last digit towards w while the result stays inside the interval */
+static void grisu_round(char * const digits, const int length, const uint64_t distance, const uint64_t delta, uint64_t rest, const uint64_t ten_kappa)
+{
+    while ((rest < distance) && ((delta - rest) >= ten_kappa)
+           && (((rest + ten_kappa) < distance) || ((distance - rest) > (rest + ten_kappa - distance))))
     {
-        length = sprintf((char*)number_buffer, "%d", item->valueint);
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+/* Write the shortest digits of a positive, finite, nonzero double; the value
+ * is digits * 10^(*decimal_exponent). Returns the number of digits (at most 17). */
+static int grisu2(const double value, char * const digits, int * const decimal_exponent)
+{
+    uint64_t bits = 0;
+    uint64_t significand = 0;
+    int biased_exponent = 0;
+    diy_fp v;
+    diy_fp w;
+    diy_fp m_plus;
+    diy_fp m_minus;
+    diy_fp cached;
+    diy_fp one;
+    const cached_power *power = NULL;
+    uint64_t delta = 0;
+    uint64_t distance = 0;
+    uint64_t fraction = 0;
+    uint64_t rest = 0;
+    uint32_t integral = 0;
+    uint32_t divisor = 0;
+    int remaining = 0;
+    int length = 0;
+    int f = 0;
+    int k = 0;
+
+    memcpy(&bits, &value, sizeof(bits));
+    significand = bits & ((UINT64_C(1) << 52) - 1);
+    biased_exponent = (int)((bits >> 52) & 0x7FF);
+    if (biased_exponent == 0)
+    {
+        /* subnormal */
+        v.f = significand;
+        v.e = 1 - 1075;
     }
     else
     {
-        /* Try 15 decimal places of precision to avoid nonsignificant nonzero digits */
-        length = sprintf((char*)number_buffer, "%1.15g", d);
+        v.f = significand | (UINT64_C(1) << 52);
+        v.e = biased_exponent - 1075;
+    }
 
-        /* Check whether the original double can be recovered */
-        if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || !compare_double((double)test, d))
+    /* the boundaries halfway to the neighbouring doubles; the lower one is
+     * closer when v is a power of two */
+    m_plus.f = (v.f << 1) + 1;
+    m_plus.e = v.e - 1;
+    m_plus = diy_fp_normalize(m_plus);
+    if ((significand == 0) && (biased_exponent > 1))
+    {
+        m_minus.f = (v.f << 2) - 1;
+        m_minus.e = v.e - 2;
+    }
+    else
+    {
+        m_minus.f = (v.f << 1) - 1;
+        m_minus.e = v.e - 1;
+    }
+    m_minus.f <<= m_minus.e - m_plus.e;
+    m_minus.e = m_plus.e;
+    w = diy_fp_normalize(v);
+
+    /* scale by a cached power of ten so the exponent lands in [alpha, gamma] */
+    f = GRISU_ALPHA - m_plus.e - 1;
+    k = (f * 78913) / (1 << 18) + (f > 0);
+    power = &cached_powers[(-CACHED_POWERS_MIN_DECIMAL_EXPONENT + k + (CACHED_POWERS_DECIMAL_STEP - 1)) / CACHED_POWERS_DECIMAL_STEP];
+    cached.f = power->f;
+    cached.e = power->e;
+    w = diy_fp_multiply(w, cached);
+    m_plus = diy_fp_multiply(m_plus, cached);
+    m_minus = diy_fp_multiply(m_minus, cached);
+    *decimal_exponent = -power->k;
+
+    /* shrink the interval by one unit on each side to stay inside it
+     * despite the rounding of the multiplications */
+    m_plus.f--;
+    m_minus.f++;
+    delta = m_plus.f - m_minus.f;
+    distance = m_plus.f - w.f;
+
+    /* generate digits of m_plus until the rest falls inside the interval */
+    one.e = m_plus.e;
+    one.f = UINT64_C(1) << -one.e;
+    integral = (uint32_t)(m_plus.f >> -one.e);
+    fraction = m_plus.f & (one.f - 1);
+
+    remaining = count_digits(integral, &divisor);
+    while (remaining > 0)
+    {
+        digits[length++] = (char)('0' + integral / divisor);
+        integral %= divisor;
+        remaining--;
+        rest = ((uint64_t)integral << -one.e) + fraction;
+        if (rest <= delta)
         {
-            /* If not, print with 17 decimal places of precision */
-            length = sprintf((char*)number_buffer, "%1.17g", d);
+            *decimal_exponent += remaining;
+            grisu_round(digits, length, distance, delta, rest, (uint64_t)divisor << -one.e);
+            return length;
         }
+        divisor /= 10;
     }
 
-    /* sprintf failed or buffer overrun occurred */
-    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
+    for (;;)
     {
-        return false;
+        fraction *= 10;
+        digits[length++] = (char)('0' + (fraction >> -one.e));
+        fraction &= one.f - 1;
+        delta *= 10;
+        distance *= 10;
+        remaining--;
+        if (fraction <= delta)
+        {
+            break;
+        }
     }
+    *decimal_exponent += remaining;
+    grisu_round(digits, length, distance, delta, fraction, one.f);
 
-    /* reserve appropriate space in the output */
-    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
-    if (output_pointer == NULL)
+    return length;
+}
+
+/* print an int without going through sprintf */
+static int print_integer(unsigned char * const buffer, const int value)
+{
+    unsigned char reversed[16];
+    unsigned int magnitude = (value < 0) ? (0U - (unsigned int)value) : (unsigned int)value;
+    int length = 0;
+    int count = 0;
+
+    do
     {
-        return false;
+        reversed[count++] = (unsigned char)('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (value < 0)
+    {
+        buffer[length++] = '-';
+    }
+    while (count > 0)
+    {
+        buffer[length++] = reversed[--count];
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
+
+/* Print a finite double with its shortest round-trip digits, laid out the
+ * way printf("%1.15g") does, or "%1.17g" when more than 15 digits are
+ * needed, so numbers look as they did when cJSON printed them that way. */
+static int print_double(unsigned char * const buffer, const double d)
+{
+    char digits[18];
+    uint64_t bits = 0;
+    int count = 0;
+    int exponent = 0;
+    int point = 0;
+    int precision = 0;
+    int length = 0;
+    int i = 0;
+
+    /* the sign bit, so -0.0 prints as "-0" like printf does */
+    memcpy(&bits, &d, sizeof(bits));
+    if ((bits >> 63) != 0)
+    {
+        buffer[length++] = '-';
+    }
+
+    if (d == 0)
+    {
+        digits[0] = '0';
+        count = 1;
     }
+    else
+    {
+        count = grisu2(fabs(d), digits, &exponent);
+    }
+
+    /* %g drops trailing zeros */
+    while ((count > 1) && (digits[count - 1] == '0'))
+    {
+        count--;
+        exponent++;
+    }
+
+    /* decimal exponent of the first digit */
+    point = count + exponent - 1;
+    precision = (count <= 15) ? 15 : 17;
 
-    /* copy the printed number to the output and replace locale
-     * dependent decimal point with '.' */
-    for (i = 0; i < ((size_t)length); i++)
+    if ((point < -4) || (point >= precision))
     {
-        if (number_buffer[i] == decimal_point)
+        /* d.ddde+XX */
+        buffer[length++] = (unsigned char)digits[0];
+        if (count > 1)
         {
-            output_pointer[i] = '.';
-            continue;
+            buffer[length++] = '.';
+            memcpy(buffer + length, digits + 1, (size_t)(count - 1));
+            length += count - 1;
+        }
+        buffer[length++] = 'e';
+        buffer[length++] = (point < 0) ? '-' : '+';
+        if (point < 0)
+        {
+            point = -point;
+        }
+        if (point >= 100)
+        {
+            buffer[length++] = (unsigned char)('0' + point / 100);
+        }
+        buffer[length++] = (unsigned char)('0' + (point / 10) % 10);
+        buffer[length++] = (unsigned char)('0' + point % 10);
+    }
+    else if (point < 0)
+    {
+        /* 0.000ddd */
+        buffer[length++] = '0';
+        buffer[length++] = '.';
+        for (i = -1; i > point; i--)
+        {
+            buffer[length++] = '0';
         }
+        memcpy(buffer + length, digits, (size_t)count);
+        length += count;
+    }
+    else if (count <= point + 1)
+    {
+        /* ddd000 */
+        memcpy(buffer + length, digits, (size_t)count);
+        length += count;
+        for (i = count; i <= point; i++)
+        {
+            buffer[length++] = '0';
+        }
+    }
+    else
+    {
+        /* ddd.ddd */
+        memcpy(buffer + length, digits, (size_t)(point + 1));
+        length += point + 1;
+        buffer[length++] = '.';
+        memcpy(buffer + length, digits + point + 1, (size_t)(count - point - 1));
+        length += count - point - 1;
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
+
+/* format a number as print_number does, valueint being its saturated int value */
+static int format_number(unsigned char * const buffer, const double d, const int valueint)
+{
+    /* This checks for NaN and Infinity */
+    if (isnan(d) || isinf(d))
+    {
+        memcpy(buffer, "null", sizeof("null"));
+        return sizeof("null") - 1;
+    }
+
+    if ((d == (double)valueint) && (d != 0))
+    {
+        return print_integer(buffer, valueint);
+    }
+
+    /* zero comes here too, so that -0.0 prints as "-0" (the printf-based
+     * code printed "0") and parses back bit-exactly */
+    return print_double(buffer, d);
+}
+
+CJSON_PUBLIC(int) cJSON_PrintNumber(double number, char *buffer)
+{
+    int valueint = 0;
+
+    if (buffer == NULL)
+    {
+        return 0;
+    }
+
+    if (number >= INT_MAX)
+    {
+        valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        valueint = INT_MIN;
+    }
+    else if (!isnan(number))
+    {
+        valueint = (int)number;
+    }
+
+    return format_number((unsigned char*)buffer, number, valueint);
+}
+
+/* Render the number nicely from the given item into a string. */
+static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    int length = 0;
+    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    length = format_number(number_buffer, item->valuedouble, item->valueint);
 
-        output_pointer[i] = number_buffer[i];
+    /* reserve appropriate space in the output */
+    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
+    if (output_pointer == NULL)
+    {
+        return false;
     }
-    output_pointer[i] = '\0';
 
+    /* the formatters never use the locale's decimal point */
+    memcpy(output_pointer, number_buffer, (size_t)length + sizeof(""));
     output_buffer->offset += (size_t)length;
 
     return true;
@@ -1933,21 +2900,250 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
     return get_array_item(array, (size_t)index);
 }
 
+/* Hash index of an object's members.
+ *
+ * Every member is kept in an open-addressing table with linear probing, hashed on its key folded with tolower(), so one
+ * table serves case-sensitive and case-insensitive lookups. Members with equal folded keys share a home slot, and
+ * since they are inserted in list order they are probed in list order: the first match is the member a walk of the
+ * list would find. Appending keeps that order; inserting elsewhere only adds to the table if no member with the same
+ * folded key exists, otherwise the index is dropped and rebuilt by the next lookup that needs it.
+ *
+ * A reference shares its members with the original, and edits made through it never reach the original's index.
+ * Neither is ever indexed: creating a reference drops the original's index and marks it cJSON_IsReferenced. */
+#define cJSON_IsReferenced 1024
+typedef struct
+{
+    cJSON *item; /* NULL = empty slot */
+    size_t hash;
+} index_slot;
+
+struct cJSON_Index
+{
+    size_t capacity; /* power of two, at least twice count */
+    size_t count;
+    index_slot *slots;
+};
+
+static size_t hash_key(const unsigned char *key)
+{
+    /* FNV-1a */
+    size_t hash = (size_t)2166136261u;
+    for (; *key != '\0'; key++)
+    {
+        hash = (hash ^ (size_t)tolower(*key)) * (size_t)16777619u;
+    }
+
+    return hash;
+}
+
+static struct cJSON_Index *index_create(size_t members)
+{
+    struct cJSON_Index *index = NULL;
+    size_t capacity = 2 * CJSON_INDEX_THRESHOLD;
+
+    while (capacity < 2 * members)
+    {
+        capacity *= 2;
+    }
+
+    index = (struct cJSON_Index*)global_hooks.allocate(sizeof(struct cJSON_Index) + capacity * sizeof(index_slot));
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    index->capacity = capacity;
+    index->count = 0;
+    index->slots = (index_slot*)(index + 1);
+    memset(index->slots, '\0', capacity * sizeof(index_slot));
+
+    return index;
+}
+
+static void index_free(cJSON *object)
+{
+    if (object->member_index != NULL)
+    {
+        global_hooks.deallocate(object->member_index);
+        object->member_index = NULL;
+    }
+}
+
+/* insert behind every member already in the table */
+static void index_insert(struct cJSON_Index *index, cJSON *item)
+{
+    size_t mask = index->capacity - 1;
+    size_t hash = hash_key((const unsigned char*)item->string);
+    size_t slot = hash & mask;
+
+    while (index->slots[slot].item != NULL)
+    {
+        slot = (slot + 1) & mask;
+    }
+    index->slots[slot].item = item;
+    index->slots[slot].hash = hash;
+    index->count++;
+}
+
+static cJSON *index_find(const struct cJSON_Index *index, const char *name, const cJSON_bool case_sensitive)
+{
+    size_t mask = index->capacity - 1;
+    size_t hash = hash_key((const unsigned char*)name);
+    size_t slot = hash & mask;
+
+    for (; index->slots[slot].item != NULL; slot = (slot + 1) & mask)
+    {
+        const index_slot *current = &index->slots[slot];
+        if (current->hash != hash)
+        {
+            continue;
+        }
+        if (case_sensitive ? (strcmp(name, current->item->string) == 0)
+                           : (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)current->item->string) == 0))
+        {
+            return current->item;
+        }
+    }
+
+    return NULL;
+}
+
+/* slot holding this very item, or capacity if it is not in the table */
+static size_t index_slot_of(const struct cJSON_Index *index, const cJSON *item)
+{
+    size_t mask = index->capacity - 1;
+    size_t slot = hash_key((const unsigned char*)item->string) & mask;
+
+    for (; index->slots[slot].item != NULL; slot = (slot + 1) & mask)
+    {
+        if (index->slots[slot].item == item)
+        {
+            return slot;
+        }
+    }
+
+    return index->capacity;
+}
+
+/* remove by shifting the rest of the probe run back, which keeps its order */
+static void index_remove(struct cJSON_Index *index, const cJSON *item)
+{
+    size_t mask = index->capacity - 1;
+    size_t hole = index_slot_of(index, item);
+    size_t next = hole;
+
+    if (hole == index->capacity)
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        size_t home = 0;
+        next = (next + 1) & mask;
+        if (index->slots[next].item == NULL)
+        {
+            break;
+        }
+        /* an entry whose home lies cyclically in (hole, next] must stay where it is */
+        home = index->slots[next].hash & mask;
+        if ((hole <= next) ? ((hole < home) && (home <= next)) : ((hole < home) || (home <= next)))
+        {
+            continue;
+        }
+        index->slots[hole] = index->slots[next];
+        hole = next;
+    }
+    index->slots[hole].item = NULL;
+    index->count--;
+}
+
+/* index every member in list order; objects with a nameless member are left unindexed */
+static void index_build(cJSON *object)
+{
+    struct cJSON_Index *index = NULL;
+    cJSON *child = NULL;
+    size_t members = 0;
+
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        if (child->string == NULL)
+        {
+            return;
+        }
+        members++;
+    }
+
+    index = index_create(members);
+    if (index == NULL)
+    {
+        return; /* lookups keep walking the list */
+    }
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        index_insert(index, child);
+    }
+
+    index_free(object);
+    object->member_index = index;
+}
+
+/* an item was appended to the object */
+static void index_append(cJSON *object, cJSON *item)
+{
+    struct cJSON_Index *index = object->member_index;
+
+    if (item->string == NULL)
+    {
+        index_free(object);
+    }
+    else if (2 * (index->count + 1) > index->capacity)
+    {
+        index_build(object);
+    }
+    else
+    {
+        index_insert(index, item);
+    }
+}
+
+/* an item was inserted before the end of the object */
+static void index_insert_inside(cJSON *object, cJSON *item)
+{
+    if ((item->string == NULL) || (2 * (object->member_index->count + 1) > object->member_index->capacity) ||
+        (index_find(object->member_index, item->string, false) != NULL))
+    {
+        /* it might have to be found before an existing member */
+        index_free(object);
+        return;
+    }
+
+    index_insert(object->member_index, item);
+}
+
+static void* cast_away_const(const void* string);
+
 static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
 {
     cJSON *current_element = NULL;
+    size_t walked = 0;
 
     if ((object == NULL) || (name == NULL))
     {
         return NULL;
     }
 
+    if (object->member_index != NULL)
+    {
+        return index_find(object->member_index, name, case_sensitive);
+    }
+
     current_element = object->child;
     if (case_sensitive)
     {
         while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
         {
             current_element = current_element->next;
+            walked++;
         }
     }
     else
@@ -1955,9 +3151,16 @@ static cJSON *get_object_item(const cJSON * const object, const char * const nam
         while ((current_element != NULL) && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)(current_element->string)) != 0))
         {
             current_element = current_element->next;
+            walked++;
         }
     }
 
+    /* a long walk: index the object for the lookups that follow, unless it shares its members */
+    if ((walked >= CJSON_INDEX_THRESHOLD) && !(object->type & (cJSON_IsReference | cJSON_IsReferenced)))
+    {
+        index_build((cJSON*)cast_away_const(object));
+    }
+
     if ((current_element == NULL) || (current_element->string == NULL)) {
         return NULL;
     }
@@ -1991,6 +3194,7 @@ static void suffix_object(cJSON *prev, cJSON *item)
 static cJSON *create_reference(const cJSON *item, const internal_hooks * const hooks)
 {
     cJSON *reference = NULL;
+    cJSON *original = NULL;
     if (item == NULL)
     {
         return NULL;
@@ -2002,6 +3206,11 @@ static cJSON *create_reference(const cJSON *item, const internal_hooks * const h
         return NULL;
     }
 
+    /* edits through the reference would bypass an index on the original, see get_object_item */
+    original = (cJSON*)cast_away_const(item);
+    index_free(original);
+    original->type |= cJSON_IsReferenced;
+
     memcpy(reference, item, sizeof(cJSON));
     reference->string = NULL;
     reference->type |= cJSON_IsReference;
@@ -2039,6 +3248,11 @@ static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
         }
     }
 
+    if (array->member_index != NULL)
+    {
+        index_append(array, item);
+    }
+
     return true;
 }
 
@@ -2247,6 +3461,18 @@ CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const it
         return NULL;
     }
 
+    if (parent->member_index != NULL)
+    {
+        if (item->string != NULL)
+        {
+            index_remove(parent->member_index, item);
+        }
+        else
+        {
+            index_free(parent);
+        }
+    }
+
     if (item != parent->child)
     {
         /* not the first element */
@@ -2336,6 +3562,11 @@ CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON
         return false;
     }
 
+    if (array->member_index != NULL)
+    {
+        index_insert_inside(array, newitem);
+    }
+
     newitem->next = after_inserted;
     newitem->prev = after_inserted->prev;
     after_inserted->prev = newitem;
@@ -2362,6 +3593,25 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON
         return true;
     }
 
+    if (parent->member_index != NULL)
+    {
+        size_t slot = (item->string != NULL) ? index_slot_of(parent->member_index, item) : parent->member_index->capacity;
+        if ((slot != parent->member_index->capacity) && (replacement->string != NULL) &&
+            (hash_key((const unsigned char*)replacement->string) == parent->member_index->slots[slot].hash))
+        {
+            /* same probe run: take the item's place in it */
+            parent->member_index->slots[slot].item = replacement;
+        }
+        else
+        {
+            if (slot != parent->member_index->capacity)
+            {
+                index_remove(parent->member_index, item);
+            }
+            index_insert_inside(parent, replacement);
+        }
+    }
+
     replacement->next = item->next;
     replacement->prev = item->prev;
 
@@ -2790,7 +4040,7 @@ cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
         goto fail;
     }
     /* Copy over all vars */
-    newitem->type = item->type & (~cJSON_IsReference);
+    newitem->type = item->type & (~(cJSON_IsReference | cJSON_IsReferenced));
     newitem->valueint = item->valueint;
     newitem->valuedouble = item->valuedouble;
     if (item->valuestring)
@@ -120,6 +120,9 @@ typedef struct cJSON
 
     /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
     char *string;
+
+    /* Hash index of an object's members, built by the lookup functions once an object is wide enough (see CJSON_INDEX_THRESHOLD). Internal: NULL until then. */
+    struct cJSON_Index *member_index;
 } cJSON;
 
 typedef struct cJSON_Hooks
@@ -137,6 +140,13 @@ typedef int cJSON_bool;
 #define CJSON_NESTING_LIMIT 1000
 #endif
 
+/* A key lookup that walks past this many members of an object builds a hash index for it, so later lookups (and
+ * replacing, detaching and deleting by key) take constant time. Add/Detach/Replace keep the index up to date.
+ * The index is built on a first lookup, so lookups on one object from several threads must be serialized. */
+#ifndef CJSON_INDEX_THRESHOLD
+#define CJSON_INDEX_THRESHOLD 16
+#endif
+
 /* Limits the length of circular references can be before cJSON rejects to parse them.
  * This is to prevent stack overflows. */
 #ifndef CJSON_CIRCULAR_LIMIT
@@ -167,6 +177,8 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 /* Render a cJSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
 /* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format);
+/* Render a number exactly as cJSON_Print would print a cJSON_CreateNumber(number): the shortest digits that parse back to the same double, independent of the locale. buffer must hold at least 26 bytes; it is null-terminated. Returns the length. */
+CJSON_PUBLIC(int) cJSON_PrintNumber(double number, char *buffer);
 /* Delete a cJSON entity and all subentities. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item);
 
@@ -8,8 +8,8 @@
  * JSON objects using the cJSON library, serializes them to JSON
  * strings, and sends them to a UDP multicast group.
  *
- * Usage: ./client <multicast_ip> <port>
- * Example: ./client 239.0.0.1 5000
+ * Usage: ./client [options] <multicast_ip> <port> [file ...]
+ * Example: ./client -b 32 239.0.0.1 5000 sample.txt
  * ================================================================
  */
 
@@ -19,7 +19,10 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <unistd.h>
-#include <errno.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/random.h>
 
 // Networking headers
 #include <sys/socket.h>
@@ -31,12 +34,175 @@
 
 // Shared utilities
 #include "utils/utils.h"
+#include "utils/sendbatch.h"
+#include "utils/pacer.h"
+#include "utils/lineparser.h"
+#include "utils/arena.h"
+#include "utils/linereader.h"
+#include "utils/pipeline.h"
+#include "utils/envelope.h"
 
-// Constants
-#define MAX_TOKEN 1024 // Maximum bytes for a single key or value token during parsing.
+/* ================================================================
+ * ClientOptions struct:
+ * Settings parsed from the command-line options.
+ *
+ *  - batchSize: datagrams collected before one sendmmsg() flush
+ *               (1 sends every record as soon as it is serialized)
+ *  - rate: pacing target in rateUnit per second (0 = unlimited)
+ *  - rateUnit: whether rate counts records or bytes
+ *  - spin: busy-spin between records instead of sleeping
+ *  - packSize: datagram payload limit for NDJSON packing
+ *              (0 sends one record per datagram)
+ *  - maxDelayNs: longest time a record may wait in a packed datagram
+ *  - quiet: skip per-record console output (and the cJSON tree
+ *           that only exists to print it)
+ *  - follow: keep reading the input file as it grows (tail -F)
+ *  - threads: parse/serialize worker threads (0 = everything on
+ *             the main thread, no pipeline)
+ *  - envelope: prefix every datagram with a sequence envelope
+ *  - senderId: envelope sender ID (random unless given)
+ * ================================================================ */
+typedef struct {
+    int batchSize;
+    double rate;
+    PaceUnit rateUnit;
+    int spin;
+    size_t packSize;
+    uint64_t maxDelayNs;
+    int quiet;
+    int follow;
+    int threads;
+    int envelope;
+    uint32_t senderId;
+} ClientOptions;
+
+/* ================================================================
+ * Sender struct:
+ * Everything between a serialized record and the socket.
+ *
+ * With packing enabled, records are appended newline-delimited to
+ * the batch's next free slot (the "open pack"). The pack is queued
+ * when the next record would not fit, or when its first record has
+ * waited maxDelayNs. Queued datagrams go out when the batch is full
+ * or the client is about to go idle.
+ *
+ * With the envelope enabled, every datagram carries the next
+ * sequence number, stamped just before it is handed to the kernel.
+ * ================================================================ */
+typedef struct {
+    SendBatch batch;            // Queued datagrams
+    const ClientOptions *opts;  // Packing limits
+    size_t packLength;          // Bytes in the open pack
+    int packRecords;            // Records in the open pack (0 = none open)
+    uint64_t packDeadlineNs;    // When the open pack must be queued
+    const char *destIP;         // For "Sent" reports
+    int port;                   // For "Sent" reports
+    uint64_t sequence;          // Next envelope sequence number
+} Sender;
+
+/* ================================================================
+ * Inputs struct:
+ * The files to read in order. When no file was named on the command
+ * line, `prompted` is the file the user typed in and count is 1.
+ * ================================================================ */
+typedef struct {
+    char **names;       // File names ("-" = stdin)
+    int count;          // Number of inputs
+    FILE *prompted;     // Interactively opened file, or NULL
+} Inputs;
+
+/* ================================================================
+ * ReaderArgs struct:
+ * What the pipeline's reader thread needs.
+ * ================================================================ */
+typedef struct {
+    Pipeline *pipeline;
+    const Inputs *inputs;
+    const ClientOptions *opts;
+} ReaderArgs;
+
+// Set by the SIGINT handler; the read loop stops at the next record.
+static volatile sig_atomic_t stopRequested = 0;
+static void handleInterrupt(int signum);
 
 // Function prototypes
 
+/* ================================================================
+ * parseClientOptions():
+ * Parses command-line options into *opts and returns the index of
+ * the first positional argument (the multicast IP).
+ * Exits with a usage message on invalid options.
+ * ================================================================ */
+int parseClientOptions(int argc, char *argv[], ClientOptions *opts);
+
+/* ================================================================
+ * senderQueue():
+ * Queues one serialized record, packing it into the open datagram
+ * when packing is enabled. Sends the batch once it is full.
+ * ================================================================ */
+void senderQueue(Sender *sender, const char *json, size_t length);
+
+/* ================================================================
+ * senderIdle():
+ * Called before the client waits `delayNs` for its next record.
+ * Queues the open pack if its deadline falls inside the wait, then
+ * sends everything already queued.
+ * ================================================================ */
+void senderIdle(Sender *sender, uint64_t delayNs);
+
+/* ================================================================
+ * senderFlush():
+ * Queues the open pack and sends every queued datagram, printing
+ * one "Sent" line per datagram.
+ * ================================================================ */
+void senderFlush(Sender *sender);
+
+/* ================================================================
+ * openInput():
+ * Opens input `index` for reading: follows it, maps it, or streams
+ * it (stdin and the prompted file included) and prints a header.
+ * *ownedFd is set to a descriptor the caller must close, or -1.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the input cannot be read (error printed)
+ * ================================================================ */
+int openInput(const Inputs *inputs, int index, const ClientOptions *opts,
+              LineReader *reader, int *ownedFd);
+
+/* ================================================================
+ * closeInput():
+ * Releases what openInput() set up.
+ * ================================================================ */
+void closeInput(LineReader *reader, int ownedFd);
+
+/* ================================================================
+ * sendRecord():
+ * Paces one serialized record and queues it on the sender. If the
+ * pacer is about to wait, what is already queued is sent first.
+ * ================================================================ */
+void sendRecord(Sender *sender, Pacer *pacer, const char *json, size_t length);
+
+/* ================================================================
+ * sendPipelined():
+ * Runs the reader thread and worker pool over all inputs while the
+ * calling thread sends the serialized records in input order.
+ * ================================================================ */
+void sendPipelined(const Inputs *inputs, Sender *sender, Pacer *pacer);
+
+/* ================================================================
+ * sendRecords():
+ * Reads every line from `reader`, serializes it, paces it, and
+ * queues it on `sender`. Whatever is queued is sent before the
+ * reader blocks for more input.
+ *
+ * Returns:
+ *  - 0 at end of input (or after SIGINT)
+ *  - -1 on read error
+ * ================================================================ */
+int sendRecords(LineReader *reader, Sender *sender, Pacer *pacer,
+                Arena *arena, JsonWriter *writer);
+
 /* ================================================================
  * openFile():
  * Prompts the user for a filename and returns an open FILE pointer.
@@ -44,14 +210,6 @@
  * ================================================================ */
 FILE *openFile();
 
-/* ================================================================
- * parseLine():
- * Parses a line of space-separated key:value pairs into a cJSON object.
- * Returns NULL for empty/invalid lines.
- * Any error on the line discards the entire line.
- * ================================================================ */
-cJSON *parseLine(const char *line);
-
 /* ================================================================
  * rtrim():
  * Strips trailing whitespace (including newline) from a string.
@@ -64,19 +222,33 @@ char *rtrim(char *s);
  * Main function and orchestrator for Client
  * 
  * Flow:
- *  1. Validate arguments (IP, multicast range, port)
+ *  1. Parse options, validate arguments (IP, multicast range, port)
  *  2. Create socket and complete server address struct
- *  3. Open the data file
- *  4. Read loop: parse each line, serialize, send
+ *  3. Open the inputs: file arguments, stdin, or a prompted file name
+ *  4. Read loop: map, stream or follow each input, serialize each
+ *     line view, queue, send in batches
  *  5. Cleanup and exit
  * ================================================================ */
 int main(int argc, char *argv[]) {
     int sd; // Socket descriptor
     struct sockaddr_in server_address; // Server address
     int portNumber; // Port number
+    ClientOptions opts; // Command-line options
 
     printf("========================SETUP========================\n");
 
+    /*
+     * Step 1a: Parse options
+     *
+     * getopt_long() moves the positional arguments to the end of argv.
+     * Shift the view so validateArguments() still sees
+     * <program> <multicast_ip> <port>.
+     */
+    int firstArg = parseClientOptions(argc, argv, &opts);
+    argv[firstArg - 1] = argv[0];
+    argc -= firstArg - 1;
+    argv += firstArg - 1;
+
     /*
      * Step 1: Validate arguments (IP, multicast range, port)
      *
@@ -89,441 +261,787 @@ int main(int argc, char *argv[]) {
      */
     validateArguments(argc, argv, &server_address.sin_addr, &portNumber);
 
-    // Step 2: Create socket and complete server address struct
-    setupSocket(&sd, portNumber, &server_address, MODE_CLIENT);
+    // Step 2: Create socket, connect it to the server address
+    setupSocket(&sd, portNumber, &server_address, MODE_CLIENT, 0);
     printf("Socket created, server address set to %s:%d\n", argv[1], portNumber);
 
-    // Step 3: Open the data file
-    FILE *fptr = openFile();
-    
-    printf("File opened successfully\n");
-    printf("=====================================================\n\n");
+    Sender sender;
+    memset(&sender, 0, sizeof(sender));
+    sender.opts = &opts;
+    sender.destIP = argv[1];
+    sender.port = portNumber;
+    SendBatch *batch = &sender.batch;
+
+    // The envelope counts against the datagram size limit
+    size_t headerSize = opts.envelope ? ENVELOPE_SIZE : 0;
+    size_t slotSize = opts.packSize > 0 ? opts.packSize : MAX_DATAGRAM;
+    if (slotSize > MAX_DATAGRAM - headerSize) {
+        slotSize = MAX_DATAGRAM - headerSize;
+        opts.packSize = opts.packSize > 0 ? slotSize : 0;
+    }
+    if (sendBatchInit(batch, sd, opts.batchSize, headerSize, slotSize) == -1) {
+        printf("Error: Could not allocate send batch\n");
+        close(sd);
+        exit(1);
+    }
+    printf("Batch size: %d datagram(s) per sendmmsg()\n", opts.batchSize);
+    if (opts.packSize > 0) {
+        printf("Packing records into datagrams of up to %zu bytes, max delay %.3f ms\n",
+               opts.packSize, opts.maxDelayNs / 1e6);
+    }
+    if (opts.envelope) {
+        printf("Envelope: sender ID %08x, sequence numbers from 0\n", opts.senderId);
+    }
 
-    // Step 4: Read loop: parse each line, serialize, send
-    char *line = NULL;
-    size_t lineLen = 0;
-    ssize_t lengthRead;
-    int sentCount = 0;
-
-    // getline() reads one line at a time
-    while ((lengthRead = getline(&line, &lineLen, fptr)) != -1) {
-        // Parse the line into a cJSON object
-        cJSON *json = parseLine(line);
-        if (json == NULL) {
-            continue; // Skip invalid/empty lines
-        }
+    Pacer pacer;
+    if (pacerInit(&pacer, opts.rate, opts.rateUnit, opts.spin) == -1) {
+        sendBatchFree(batch);
+        close(sd);
+        exit(1);
+    }
 
-        /*
-         * Convert cJSON object to a JSON string.
-         * This is what will be sent over the network.
-         */
-        char *jsonString = cJSON_PrintUnformatted(json);
-        if (jsonString == NULL) {
-            printf("Error: cJSON_Print() allocation failed, skipping\n");
-            cJSON_Delete(json);
-            continue;
-        }
+    /*
+     * The console-only cJSON tree of each record is built in an arena
+     * and reclaimed with one reset after cJSON_Delete().
+     */
+    Arena arena;
+    arenaInstallHooks();
+    if (arenaInit(&arena, ARENA_DEFAULT_SIZE) == -1) {
+        printf("Error: Could not allocate record arena\n");
+        exit(1);
+    }
+    arenaSetCurrent(&arena);
 
-        // Print all key-value pairs.
-        printJSONObject(json, MODE_CLIENT, 0);
-        printf("\n");
-
-        // Send the JSON string
-        int bytesSent = sendto(sd, jsonString, strlen(jsonString), 0,
-                               (struct sockaddr *)&server_address,
-                               sizeof(server_address));
-        
-        if (bytesSent == -1) {
-            perror("sendto");
-        }
-        else {
-            printf("Sent %d bytes to %s:%d\n", bytesSent, argv[1], portNumber);
-            printf("\n");
-            sentCount++;
-        }
+    /*
+     * Serialized records are written into one reusable buffer, sized
+     * to the largest datagram, so the send path allocates nothing.
+     */
+    static char jsonBuffer[MAX_DATAGRAM];
+    JsonWriter writer;
+    jsonWriterInit(&writer, jsonBuffer, sizeof(jsonBuffer));
+
+    /*
+     * Step 3: Open the inputs
+     *
+     * Files named after the port are read in order ("-" is stdin).
+     * Without any, the user is prompted for one file name.
+     */
+    Inputs inputs = { argv + 3, argc - 3, NULL };
+    if (opts.follow && (inputs.count != 1 || strcmp(inputs.names[0], "-") == 0)) {
+        printf("Error: --follow needs exactly one file name\n");
+        exit(1);
+    }
+
+    if (inputs.count == 0) {
+        inputs.prompted = openFile();
+        inputs.count = 1;
+    }
 
-        // Clean up the cJSON object and the JSON string
-        cJSON_Delete(json);
-        cJSON_free(jsonString);
+    // Ctrl+C ends the run cleanly, so queued records and the summary still go out
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handleInterrupt;
+    sigaction(SIGINT, &action, NULL);
 
-        // Wait for 0.5 seconds before sending the next JSON object
-        usleep(500000);
+    // Step 4: Read loop: parse each line, serialize, queue, send
+    if (opts.threads > 0) {
+        sendPipelined(&inputs, &sender, &pacer);
     }
+    else {
+        for (int i = 0; i < inputs.count && !stopRequested; i++) {
+            LineReader reader;
+            int ownedFd;
 
-    // Clean up the line buffer
-    free(line);
+            if (openInput(&inputs, i, &opts, &reader, &ownedFd) == -1) {
+                continue;
+            }
+            sendRecords(&reader, &sender, &pacer, &arena, &writer);
+            closeInput(&reader, ownedFd);
+        }
+    }
 
-    printf("Done! Sent %d JSON objects.\n", sentCount);
+    // Send whatever is still queued from a partial pack or batch
+    senderFlush(&sender);
+
+    /*
+     * One sendto() per record would have cost one call per record;
+     * the difference to the sendmmsg() calls actually made is saved
+     * by batching datagrams and packing records into datagrams.
+     */
+    printf("Done! Sent %ld JSON objects in %ld datagrams.\n",
+           batch->itemsSent, batch->datagramsSent);
+    printf("Batch size: %d, sendmmsg() calls: %ld, syscalls saved: %ld\n",
+           opts.batchSize, batch->sendCalls, batch->itemsSent - batch->sendCalls);
+    pacerReport(&pacer);
+    if (arena.allocations > 0) {
+        printf("Arena: %zu bytes peak per record, %ld heap fallbacks\n",
+               arena.highWater, arena.heapFallbacks);
+    }
 
     // Clean up and exit
-    fclose(fptr);
+    arenaFree(&arena);
+    pacerFree(&pacer);
+    sendBatchFree(batch);
+    if (inputs.prompted != NULL) {
+        fclose(inputs.prompted);
+    }
     close(sd);
     return 0;
 }
 
 /* ================================================================
- * openFile() — Prompt for filename, open and return FILE*
+ * parseClientOptions() — Parse command-line options
+ *
+ * Options:
+ *  -b, --batch <n>         datagrams per sendmmsg() call (1-MAX_BATCH)
+ *  -r, --rate <n>          pacing target per second, 0 = unlimited
+ *  -u, --rate-unit <unit>  "records" (default) or "bytes"
+ *  -s, --spin              busy-spin instead of sleeping on a timerfd
+ *  -p, --pack <bytes>      pack NDJSON records into datagrams up to <bytes>
+ *  -d, --max-delay <ms>    longest a record may wait in a pack (default 10)
+ *  -q, --quiet             no per-record console output
+ *  -F, --follow            keep reading the file as it grows (tail -F)
+ *  -t, --threads <n>       parse on n worker threads (default 0 = serial)
+ *  -E, --envelope          prefix datagrams with a sequence envelope
+ *  -i, --sender-id <n>     envelope sender ID (default random)
+ *  -h, --help              print usage and exit
+ *
+ * Returns the index of the first positional argument.
  * ================================================================
  */
-FILE *openFile() {
-    FILE *fptr = NULL;
-    char fileName[100]; // Buffer for user input (filename)
-
-    while (1) {
-        memset(fileName, 0, 100);
-        printf("What is the name of the data file? ");
+int parseClientOptions(int argc, char *argv[], ClientOptions *opts) {
+    static const struct option longOptions[] = {
+        { "batch",     required_argument, NULL, 'b' },
+        { "rate",      required_argument, NULL, 'r' },
+        { "rate-unit", required_argument, NULL, 'u' },
+        { "spin",      no_argument,       NULL, 's' },
+        { "pack",      required_argument, NULL, 'p' },
+        { "max-delay", required_argument, NULL, 'd' },
+        { "quiet",     no_argument,       NULL, 'q' },
+        { "follow",    no_argument,       NULL, 'F' },
+        { "threads",   required_argument, NULL, 't' },
+        { "envelope",  no_argument,       NULL, 'E' },
+        { "sender-id", required_argument, NULL, 'i' },
+        { "help",      no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+
+    // Defaults: unbatched, one send per record, 2 records per second
+    opts->batchSize = 1;
+    opts->rate = 2.0;
+    opts->rateUnit = PACE_RECORDS;
+    opts->spin = 0;
+    opts->packSize = 0;
+    opts->maxDelayNs = 10000000;
+    opts->quiet = 0;
+    opts->follow = 0;
+    opts->threads = 0;
+    opts->envelope = 0;
+    if (getrandom(&opts->senderId, sizeof(opts->senderId), 0) != sizeof(opts->senderId)) {
+        opts->senderId = (uint32_t)getpid();
+    }
 
-        if (fgets(fileName, sizeof(fileName), stdin) == NULL) {
-            perror("fgets");
-            exit(1);
+    while ((opt = getopt_long(argc, argv, "b:r:u:sp:d:qFt:Ei:h", longOptions, NULL)) != -1) {
+        switch (opt) {
+            case 'b': {
+                char *end;
+                long value = strtol(optarg, &end, 10);
+                if (*end != '\0' || value < 1 || value > MAX_BATCH) {
+                    printf("Error: Batch size must be between 1 and %d\n", MAX_BATCH);
+                    exit(1);
+                }
+                opts->batchSize = (int)value;
+                break;
+            }
+            case 'r': {
+                char *end;
+                double value = strtod(optarg, &end);
+                if (end == optarg || *end != '\0' || value < 0) {
+                    printf("Error: Rate must be a non-negative number\n");
+                    exit(1);
+                }
+                opts->rate = value;
+                break;
+            }
+            case 'u':
+                if (strcmp(optarg, "records") == 0) {
+                    opts->rateUnit = PACE_RECORDS;
+                }
+                else if (strcmp(optarg, "bytes") == 0) {
+                    opts->rateUnit = PACE_BYTES;
+                }
+                else {
+                    printf("Error: Rate unit must be \"records\" or \"bytes\"\n");
+                    exit(1);
+                }
+                break;
+            case 's':
+                opts->spin = 1;
+                break;
+            case 'p': {
+                char *end;
+                long value = strtol(optarg, &end, 10);
+                if (*end != '\0' || value < 0 || value > MAX_DATAGRAM) {
+                    printf("Error: Pack size must be between 0 and %d bytes\n", MAX_DATAGRAM);
+                    exit(1);
+                }
+                opts->packSize = (size_t)value;
+                break;
+            }
+            case 'd': {
+                char *end;
+                double value = strtod(optarg, &end);
+                if (end == optarg || *end != '\0' || value < 0) {
+                    printf("Error: Max delay must be a non-negative number of milliseconds\n");
+                    exit(1);
+                }
+                opts->maxDelayNs = (uint64_t)(value * 1e6);
+                break;
+            }
+            case 'q':
+                opts->quiet = 1;
+                break;
+            case 'F':
+                opts->follow = 1;
+                break;
+            case 't': {
+                char *end;
+                long value = strtol(optarg, &end, 10);
+                if (*end != '\0' || value < 0 || value > MAX_WORKERS) {
+                    printf("Error: Thread count must be between 0 and %d\n", MAX_WORKERS);
+                    exit(1);
+                }
+                opts->threads = (int)value;
+                break;
+            }
+            case 'E':
+                opts->envelope = 1;
+                break;
+            case 'i': {
+                char *end;
+                unsigned long long value = strtoull(optarg, &end, 0);
+                if (end == optarg || *end != '\0' || optarg[0] == '-' || value > UINT32_MAX) {
+                    printf("Error: Sender ID must be between 0 and %u\n", UINT32_MAX);
+                    exit(1);
+                }
+                opts->senderId = (uint32_t)value;
+                opts->envelope = 1;
+                break;
+            }
+            case 'h':
+            default:
+                printf("Usage: %s [options] <multicast_ip> <port> [file ...]\n", argv[0]);
+                printf("  Files are read in order, \"-\" is stdin; without any, a file name is prompted for.\n");
+                printf("  -b, --batch <n>         datagrams per sendmmsg() call (default 1)\n");
+                printf("  -r, --rate <n>          records or bytes per second, 0 = unlimited (default 2)\n");
+                printf("  -u, --rate-unit <unit>  \"records\" or \"bytes\" (default records)\n");
+                printf("  -s, --spin              busy-spin for microsecond pacing\n");
+                printf("  -p, --pack <bytes>      pack records into datagrams up to <bytes> (default 0 = off)\n");
+                printf("  -d, --max-delay <ms>    longest a record waits in a pack (default 10)\n");
+                printf("  -q, --quiet             no per-record console output\n");
+                printf("  -F, --follow            keep reading the file as it grows (tail -F)\n");
+                printf("  -t, --threads <n>       parse on n worker threads, no per-record parse output (default 0)\n");
+                printf("  -E, --envelope          prefix datagrams with sender ID, sequence number, send time\n");
+                printf("  -i, --sender-id <n>     envelope sender ID, implies -E (default random)\n");
+                printf("  -h, --help              show this help\n");
+                exit(opt == 'h' ? 0 : 1);
         }
+    }
 
-        rtrim(fileName);
+    return optind;
+}
 
-        if (strlen(fileName) == 0) {
-            printf("Error: Must enter a filename.\n");
-            continue;
+/* ================================================================
+ * stampEnvelope() — Write the next sequence envelope to `header`
+ * ================================================================
+ */
+static void stampEnvelope(Sender *sender, char *header, uint64_t now) {
+    Envelope env;
+    memset(&env, 0, sizeof(env));
+    env.senderId = sender->opts->senderId;
+    env.sequence = sender->sequence++;
+    env.sendTimeNs = now;
+    envelopeEncode(header, &env);
+}
+
+/* ================================================================
+ * sendBatchReport() — Send queued datagrams and report each one
+ *
+ * Envelopes are stamped here rather than when a slot is queued, so
+ * the send time is as close to the sendmmsg() call as possible and
+ * sequence numbers follow the order datagrams reach the kernel.
+ * ================================================================
+ */
+static void sendBatchReport(Sender *sender) {
+    SendBatch *batch = &sender->batch;
+
+    if (batch->count == 0) {
+        return;
+    }
+
+    if (sender->opts->envelope) {
+        uint64_t now = envelopeNowNs();
+        for (int i = 0; i < batch->count; i++) {
+            stampEnvelope(sender, sendBatchHeader(batch, i), now);
         }
+    }
 
-        fptr = fopen(fileName, "r");
-        if (fptr == NULL) {
-            printf("Error: Could not open file %s\n", fileName);
-            continue;
+    sendBatchFlush(batch);
+
+    if (sender->opts->quiet) {
+        return;
+    }
+
+    for (int i = 0; i < batch->flushed; i++) {
+        if (batch->msgs[i].msg_len > 0) {
+            printf("Sent %u bytes to %s:%d\n", batch->msgs[i].msg_len,
+                   sender->destIP, sender->port);
+            printf("\n");
         }
+    }
+}
 
-        return fptr;
+/* ================================================================
+ * closePack() — Queue the open pack as one datagram
+ * ================================================================
+ */
+static void closePack(Sender *sender) {
+    if (sender->packRecords == 0) {
+        return;
+    }
+
+    sendBatchCommit(&sender->batch, sender->packLength, sender->packRecords);
+    sender->packLength = 0;
+    sender->packRecords = 0;
+
+    if (sendBatchFull(&sender->batch)) {
+        sendBatchReport(sender);
     }
 }
 
 /* ================================================================
- * parseLine() — Stateful tokenizer for key:value pairs
- * 
- * This function tokenizes a line of text into key:value pairs.
- * For each pair, it:
- *  1. Extracts the key (everything before the ':')
- *  2. Extracts the value (quoted or unquoted)
- *  3. Adds the pair to a cJSON object
- * 
- * Validation:
- *  - If any key or value on the line fails validation, the ENTIRE
- *    line is discarded.
- *  - Keys must be non-empty with no whitespace or colons.
- *  - Values can be quoted or unquoted.
- *  - Unquoted values may not contain whitespace.
- *  - Quoted values keep their enclosing quotes as part of the value
- *  - Escaped characters are are valid and become plain characters
- *  - Example input:  msg:"hello \"world\""
- *  - Stored key: msg
- *  - Stored value: "hello "world""
- * 
- * Returns: cJSON* on success, NULL on empty/invalid lines
+ * senderQueue() — Queue one serialized record
+ *
+ * Packed datagrams are NDJSON: records separated by '\n', no
+ * trailing newline, so a pack of one is byte-identical to an
+ * unpacked datagram. A record larger than a slot is sent on its own
+ * straight from the caller's buffer.
  * ================================================================
  */
-cJSON *parseLine(const char *line) {
-    const char *pos = line; // Current read position in the line
-    char key[MAX_TOKEN]; // Buffer for the current key
-    char value[MAX_TOKEN]; // Buffer for the current value
-    int pairCount = 0; // Number of key:value pairs added
-
-    // Step 1: Skip leading whitespace
-    while (*pos && isspace((unsigned char)*pos)) {
-        pos++;
-    }
-    
-    // If the line is empty, return NULL
-    if (*pos == '\0' || *pos == '\n') {
-        return NULL;
-    }
-
-    // Step 2: Create empty cJSON object
-    cJSON *obj = cJSON_CreateObject();
-    if (obj == NULL) {
-        return NULL;
-    }
-
-    // Step 3: Main parsing loop
-    while (*pos != '\0' && *pos != '\n') {
-        
-        // Skip whitespace between pairs
-        while (*pos && *pos != '\n' && isspace((unsigned char)*pos)) {
-            pos++;
+void senderQueue(Sender *sender, const char *json, size_t length) {
+    SendBatch *batch = &sender->batch;
+    size_t packSize = sender->opts->packSize;
+
+    // No packing: one record per datagram
+    if (packSize == 0 && length <= batch->slotSize) {
+        memcpy(sendBatchSlot(batch), json, length);
+        sendBatchCommit(batch, length, 1);
+        if (sendBatchFull(batch)) {
+            sendBatchReport(sender);
         }
+        return;
+    }
 
-        // Check if we've reached the end after skipping whitespace
-        if (*pos == '\0' || *pos == '\n') {
-            break;
+    // Record does not fit behind what is already packed
+    if (sender->packRecords > 0 && sender->packLength + 1 + length > packSize) {
+        closePack(sender);
+    }
+
+    // Oversized record: the slab only has slotSize bytes per slot
+    if (length > batch->slotSize) {
+        if (batch->count > 0) {
+            sendBatchReport(sender);
         }
 
-        /*
-         * Extract key
-         * Valid key characters:
-         *  - anything except whitespace, ':', '"', '\\', '\0', and '\n'.
-         */
-        const char *keyStart = pos;
-        while (*pos != '\0' && *pos != '\n' && *pos != ':' &&
-               !isspace((unsigned char)*pos) && *pos != '"' && *pos != '\\') {
-            pos++;
+        char header[ENVELOPE_SIZE];
+        struct iovec iov[2] = { { header, 0 }, { (void *)json, length } };
+        if (sender->opts->envelope) {
+            stampEnvelope(sender, header, envelopeNowNs());
+            iov[0].iov_len = ENVELOPE_SIZE;
         }
 
-        // Check what character stopped the key scan (only ':' is a valid stop)
-        if (*pos != ':') {
-            if (isspace((unsigned char)*pos)) {
-                printf("Warning: whitespace in key, skipping line\n");
-            }
-            else if (*pos == '"') {
-                printf("Warning: quote character in key, skipping line\n");
-            }
-            else if (*pos == '\\') {
-                printf("Warning: backslash in key, skipping line\n");
-            }
-            else {
-                printf("Warning: no colon found in token, skipping line\n");
-            }
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = sender->opts->envelope ? iov : &iov[1];
+        msg.msg_iovlen = sender->opts->envelope ? 2 : 1;
 
-            cJSON_Delete(obj);
-            return NULL;
+        ssize_t bytesSent = sendmsg(batch->sd, &msg, 0);
+        batch->sendCalls++;
+        if (bytesSent == -1) {
+            perror("sendmsg");
+            batch->sendErrors++;
         }
+        else {
+            batch->datagramsSent++;
+            batch->itemsSent++;
+            batch->bytesSent += bytesSent;
+            if (!sender->opts->quiet) {
+                printf("Sent %zd bytes to %s:%d\n", bytesSent, sender->destIP, sender->port);
+                printf("\n");
+            }
+        }
+        return;
+    }
 
-        // Calculate key length
-        int keyLen = (int)(pos - keyStart);
+    // Start a new pack, or append behind a newline separator
+    char *slot = sendBatchSlot(batch);
+    if (sender->packRecords == 0) {
+        sender->packDeadlineNs = pacerNowNs() + sender->opts->maxDelayNs;
+    }
+    else {
+        slot[sender->packLength++] = '\n';
+    }
+    memcpy(slot + sender->packLength, json, length);
+    sender->packLength += length;
+    sender->packRecords++;
+
+    // Deadline already passed: the pack goes out now
+    if (pacerNowNs() >= sender->packDeadlineNs) {
+        closePack(sender);
+        sendBatchReport(sender);
+    }
+}
 
-        // Empty key — colon appeared at the start, like ":value"
-        if (keyLen == 0) {
-            printf("Warning: empty key found, skipping line\n");
-            cJSON_Delete(obj);
-            return NULL;
-        }
+/* ================================================================
+ * senderIdle() — Send what must not wait through an idle period
+ * ================================================================
+ */
+void senderIdle(Sender *sender, uint64_t delayNs) {
+    if (sender->packRecords > 0 &&
+        pacerNowNs() + delayNs >= sender->packDeadlineNs) {
+        closePack(sender);
+    }
+
+    sendBatchReport(sender);
+}
+
+/* ================================================================
+ * senderFlush() — Send the open pack and all queued datagrams
+ * ================================================================
+ */
+void senderFlush(Sender *sender) {
+    closePack(sender);
+    sendBatchReport(sender);
+}
+
+/* ================================================================
+ * handleInterrupt() — SIGINT: finish the current record and stop
+ * ================================================================
+ */
+static void handleInterrupt(int signum) {
+    (void)signum;
+    stopRequested = 1;
+}
+
+/* ================================================================
+ * openInput() — Follow, map or stream one input
+ *
+ * Regular files are memory-mapped and handed to the tokenizer as
+ * (pointer, length) views without copying; pipes and stdin are
+ * streamed through one reusable buffer. A followed file is streamed
+ * and reopened by the reader itself.
+ * ================================================================
+ */
+int openInput(const Inputs *inputs, int index, const ClientOptions *opts,
+              LineReader *reader, int *ownedFd) {
+    const char *name = (inputs->prompted != NULL) ? "data file" : inputs->names[index];
+    int fd;
+    int opened;
 
-        // Key exceeds buffer size
-        if (keyLen >= MAX_TOKEN) {
-            printf("Warning: key too long, skipping line\n");
-            cJSON_Delete(obj);
-            return NULL;
+    *ownedFd = -1;
+
+    if (opts->follow) {
+        opened = lineReaderOpenFollow(reader, name);
+    }
+    else {
+        if (inputs->prompted != NULL) {
+            fd = fileno(inputs->prompted);
         }
+        else if (strcmp(name, "-") == 0) {
+            name = "stdin";
+            fd = STDIN_FILENO;
+        }
+        else {
+            fd = open(name, O_RDONLY | O_CLOEXEC);
+            if (fd == -1) {
+                printf("Error: Could not open file %s\n", name);
+                return -1;
+            }
+            *ownedFd = fd;
+        }
+        opened = lineReaderOpen(reader, fd);
+    }
+    if (opened == -1) {
+        printf("Error: Could not read %s\n", name);
+        if (*ownedFd != -1) {
+            close(*ownedFd);
+        }
+        return -1;
+    }
+
+    printf("Reading %s (%s)\n", name, reader->follow ? "following" :
+           reader->mapped ? "memory-mapped" : "streaming");
+    printf("=====================================================\n\n");
+    return 0;
+}
+
+/* ================================================================
+ * closeInput() — Unmap the file or free the stream buffer
+ * ================================================================
+ */
+void closeInput(LineReader *reader, int ownedFd) {
+    lineReaderClose(reader);
+    if (ownedFd != -1) {
+        close(ownedFd);
+    }
+}
+
+/* ================================================================
+ * sendRecord() — Pace one record and queue it
+ * ================================================================
+ */
+void sendRecord(Sender *sender, Pacer *pacer, const char *json, size_t length) {
+    /*
+     * If the pacer is about to wait, send what is already queued
+     * first so batching and packing never hold records back while
+     * the client is idle.
+     */
+    double cost = (sender->opts->rateUnit == PACE_BYTES) ? (double)length : 1.0;
+    uint64_t delay = pacerDelayNs(pacer, cost);
+    if (delay > 0) {
+        senderIdle(sender, delay);
+    }
+    pacerWait(pacer, cost);
+
+    // Queue the JSON string; full batches are sent immediately
+    senderQueue(sender, json, length);
+}
+
+/* ================================================================
+ * readerMain() — Pipeline reader thread: cut inputs into chunks
+ *
+ * A chunk is dispatched once it holds CHUNK_BYTES, at the end of
+ * each input, and whenever the input would block, so a slow
+ * producer's lines are never held back waiting for a full chunk.
+ * This is the only thread that takes SIGINT, which interrupts its
+ * waits for input.
+ * ================================================================
+ */
+static void *readerMain(void *arg) {
+    ReaderArgs *args = arg;
+    Pipeline *pipeline = args->pipeline;
+    sigset_t interrupt;
 
-        // Copy key into buffer and null-terminate
-        memcpy(key, keyStart, keyLen);
-        key[keyLen] = '\0';
+    sigemptyset(&interrupt);
+    sigaddset(&interrupt, SIGINT);
+    pthread_sigmask(SIG_UNBLOCK, &interrupt, NULL);
 
-        // Advance past the ':' delimiter
-        pos++;
+    for (int i = 0; i < args->inputs->count && !stopRequested; i++) {
+        LineReader reader;
+        int ownedFd;
 
-        // Check for whitespace after colon
-        if (isspace((unsigned char)*pos)) {
-            printf("Warning: whitespace after colon for key '%s', skipping line\n", key);
-            cJSON_Delete(obj);
-            return NULL;
+        if (openInput(args->inputs, i, args->opts, &reader, &ownedFd) == -1) {
+            continue;
         }
 
-        /* 
-         * Extract value
-         * 
-         * Two modes: Quoted and Unquoted
-         *  - Quoted: may contain spaces and escapes
-         *  - Unquoted: may not contain spaces or backslashes
-         */
-        int valueLen = 0;
-
-        // Quoted mode: value starts with '"'
-        if (*pos == '"') {
-            // Store the opening quote as part of the value
-            value[0] = '"';
-            valueLen++;
-
-            // Advance past the opening quote
-            pos++;
-
-            // Walk through the quoted content
-            while (*pos != '\0' && *pos != '\n') {
-
-                // Check for escape sequences
-                if (*pos == '\\') {
-                    char nextChar = *(pos + 1);
-
-                    // Trailing backslash — no character to escape.
-                    if (nextChar == '\0' || nextChar == '\n') {
-                        printf("Warning: trailing backslash in quoted value, skipping line\n");
-                        cJSON_Delete(obj);
-                        return NULL;
-                    }
-
-                    // Determine the escaped character
-                    char escaped;
-                    switch (nextChar) {
-                        case '"': /* \" -> " */
-                            escaped = '"';
-                            break;
-                        case '\\': /* \\ -> \ */
-                            escaped = '\\';
-                            break;
-                        case 'n': /* \n -> newline */
-                            escaped = '\n';
-                            break;
-                        case 't': /* \t -> tab */
-                            escaped = '\t';
-                            break;
-                        case 'r': /* \r -> carriage return */
-                            escaped = '\r';
-                            break;
-                        default:
-                            printf("Warning: unrecognized escape sequence '\\%c' in quoted value, skipping line\n", nextChar);
-                            cJSON_Delete(obj);
-                            return NULL;
-                    }
-
-                    // Check if the value is too long
-                    if (valueLen >= MAX_TOKEN - 1) {
-                        printf("Warning: value too long, skipping line\n");
-                        cJSON_Delete(obj);
-                        return NULL;
-                    }
-                    value[valueLen] = escaped;
-                    valueLen++;
-                    
-                    // Skip both the backslash and the escape char
-                    pos += 2;
-                }
+        Chunk *chunk = pipelineAcquire(pipeline);
+        const char *line;
+        size_t length;
 
-                else if (*pos == '"') {
-                    // Closing quote — end of quoted value
-                    break; // Exit the loop, store the end quote after the loop
-                }
+        while (!stopRequested) {
+            LineStatus status = lineReaderNext(&reader, &line, &length);
 
-                else {
-                    // Regular character — copy it to the value buffer
-                    // Check if the value is too long
-                    if (valueLen >= MAX_TOKEN - 1) {
-                        printf("Warning: value too long, skipping line\n");
-                        cJSON_Delete(obj);
-                        return NULL;
-                    }
-                    value[valueLen] = *pos;
-                    valueLen++;
-                    pos++;
+            if (status == LINE_END || status == LINE_ERROR) {
+                break;
+            }
+            if (status == LINE_PENDING) {
+                pipelineDispatch(pipeline, chunk);
+                chunk = pipelineAcquire(pipeline);
+                if (lineReaderWait(&reader) == -1) {
+                    break;
                 }
+                continue;
             }
 
-            // Check for unclosed quote
-            if (*pos != '"') {
-                printf("Warning: unclosed quote, skipping line\n");
-                cJSON_Delete(obj);
-                return NULL;
+            if (pipelineAppend(chunk, line, length, reader.mapped) == -1) {
+                break;
             }
-
-            // Store the closing quote as part of the value
-            if (valueLen >= MAX_TOKEN - 1) {
-                printf("Warning: value too long, skipping line\n");
-                cJSON_Delete(obj);
-                return NULL;
+            if (chunk->length >= CHUNK_BYTES) {
+                pipelineDispatch(pipeline, chunk);
+                chunk = pipelineAcquire(pipeline);
             }
+        }
 
-            // Store the closing quote as part of the value
-            value[valueLen] = '"';
-            valueLen++;
-            value[valueLen] = '\0';
-
-            // Advance past the closing quote
-            pos++;   
+        // Mapped chunks point into the file: let them be sent before unmapping
+        pipelineDispatch(pipeline, chunk);
+        if (reader.mapped) {
+            pipelineDrain(pipeline);
         }
+        closeInput(&reader, ownedFd);
+    }
 
-        // Unquoted mode
-        else {
-            const char *valueStart = pos;
-
-            /*
-             * Walk through the unquoted content
-             * Stopping at whitespace, newline, or backslash, or end of string.
-             */
-            while (*pos != '\0' && *pos != '\n' &&
-                   !isspace((unsigned char)*pos) && *pos != '\\') {
-                pos++;    
-            }
+    pipelineFinish(pipeline);
+    return NULL;
+}
 
-            // Backslash in unquoted value — not allowed.
-            if (*pos == '\\') {
-                printf("Warning: backslash in unquoted value for key '%s', skipping line\n", key);
-                cJSON_Delete(obj);
-                return NULL;
-            }
+/* ================================================================
+ * sendPipelined() — Send the pipeline's output in input order
+ *
+ * SIGINT is blocked on this thread (and inherited blocked by the
+ * workers), so it reaches the reader thread, which stops reading;
+ * everything already read is still sent. Queued records are sent
+ * whenever this thread runs out of finished chunks.
+ * ================================================================
+ */
+void sendPipelined(const Inputs *inputs, Sender *sender, Pacer *pacer) {
+    Pipeline pipeline;
+    pthread_t readerThread;
+    sigset_t interrupt;
 
-            valueLen = (int)(pos - valueStart);
-            
-            // Empty value — colon with nothing after it, like "key:"
-            if (valueLen == 0) {
-                printf("Warning: empty value for key '%s', skipping line\n", key);
-                cJSON_Delete(obj);
-                return NULL;
-            }
+    sigemptyset(&interrupt);
+    sigaddset(&interrupt, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &interrupt, NULL);
 
-            // Value exceeds buffer size
-            if (valueLen >= MAX_TOKEN) {
-                printf("Warning: value too long, skipping line\n");
-                cJSON_Delete(obj);
-                return NULL;
+    if (pipelineInit(&pipeline, sender->opts->threads) == -1) {
+        exit(1);
+    }
+
+    ReaderArgs args = { &pipeline, inputs, sender->opts };
+    int err = pthread_create(&readerThread, NULL, readerMain, &args);
+    if (err != 0) {
+        printf("Error: Could not start reader thread: %s\n", strerror(err));
+        exit(1);
+    }
+
+    unsigned attempt = 0;
+    while (1) {
+        Chunk *chunk = pipelineTryNext(&pipeline);
+        if (chunk == NULL) {
+            if (ringBackoff(&attempt)) {
+                senderFlush(sender);
             }
+            continue;
+        }
+        attempt = 0;
+
+        if (chunk->last) {
+            break;
+        }
 
-            // Copy value into buffer and null-terminate
-            memcpy(value, valueStart, valueLen);
-            value[valueLen] = '\0';
+        const char *json = chunk->json;
+        for (int i = 0; i < chunk->records; i++) {
+            sendRecord(sender, pacer, json, chunk->recordLengths[i]);
+            json += chunk->recordLengths[i];
+        }
+        pipelineRelease(&pipeline, chunk);
+    }
+
+    pthread_join(readerThread, NULL);
+    printf("Pipeline: %d worker thread(s), %ld chunks\n",
+           pipeline.workerCount, pipeline.collected);
+    pipelineFree(&pipeline);
+    pthread_sigmask(SIG_UNBLOCK, &interrupt, NULL);
+}
+
+/* ================================================================
+ * sendRecords() — Serialize, pace and queue every line of an input
+ * ================================================================
+ */
+int sendRecords(LineReader *reader, Sender *sender, Pacer *pacer,
+                Arena *arena, JsonWriter *writer) {
+    const ClientOptions *opts = sender->opts;
+    const char *line;
+    size_t lengthRead;
+
+    // Each line view includes its trailing newline, like getline()
+    while (!stopRequested) {
+        LineStatus status = lineReaderNext(reader, &line, &lengthRead);
+
+        if (status == LINE_END) {
+            return 0;
+        }
+        if (status == LINE_ERROR) {
+            return -1;
         }
 
         /*
-         * Type Detection and cJSON Object Construction
-         *
-         * 1. Boolean: "true" or "false" (case-insensitive)
-         * 2. Number: valid numeric format (integers, floats, scientific notation)
-         * 3. String: everything else
-         * 4. Quoted values are always treated as strings.
+         * The input has nothing more right now. Send everything that
+         * is queued before blocking, so a slow producer never holds
+         * back records that were already read.
          */
-
-        // Quoted values are always strings
-        if (value[0] == '"') {
-            cJSON_AddStringToObject(obj, key, value);
+        if (status == LINE_PENDING) {
+            senderFlush(sender);
+            if (lineReaderWait(reader) == -1) {
+                return -1;
+            }
+            continue;
         }
-        // Boolean detection
-        else if (strcasecmp(value, "true") == 0) {
-            cJSON_AddBoolToObject(obj, key, 1);
+
+        /*
+         * Serialize the line straight into JSON bytes. This is what
+         * will be sent over the network. Unless quiet, the pairs also
+         * go into a cJSON object for the console output.
+         */
+        cJSON *json = NULL;
+        if (!opts->quiet) {
+            json = cJSON_CreateObject();
         }
-        else if (strcasecmp(value, "false") == 0) {
-            cJSON_AddBoolToObject(obj, key, 0);
+
+        int jsonLen = serializeLine(line, lengthRead, writer, json);
+        if (jsonLen <= 0) {
+            cJSON_Delete(json);
+            arenaReset(arena);
+            continue; // Skip invalid/empty lines
         }
-        // Number detection using strtod()
-        else {
-            /*
-             * strtod() converts a string to double:
-             *  - Integers: "42", "-5", "+5"
-             *  - Floats: "3.14", "-0.5"
-             *  - Scientific notation: "1e10", "3.14e-2"
-             *
-             * Validate by checking:
-             *  - endptr != value: at least one character was parsed
-             *  - *endptr == '\0': entire string was consumed (no trailing chars)
-             *  - errno != ERANGE: no overflow/underflow occurred
-             */
-            char *endptr;
-            errno = 0;  // Clear errno before strtod() call
-            double numValue = strtod(value, &endptr);
-
-            if (endptr != value && *endptr == '\0' && errno != ERANGE) {
-                // Valid number — store as cJSON number
-                cJSON_AddNumberToObject(obj, key, numValue);
-            }
-            else {
-                // Not a valid number — store as string
-                cJSON_AddStringToObject(obj, key, value);
-            }
+
+        // Print all key-value pairs.
+        if (json != NULL) {
+            printJSONObject(json, MODE_CLIENT, 0);
+            printf("\n");
+            cJSON_Delete(json);
+            arenaReset(arena);
         }
 
-        pairCount++;
+        // Pace the record and queue it
+        sendRecord(sender, pacer, writer->data, (size_t)jsonLen);
     }
 
-    // If no pairs were successfully parsed, discard the object.
-    if (pairCount == 0) {
-        cJSON_Delete(obj);
-        return NULL;
-    }
+    return 0;
+}
+
+/* ================================================================
+ * openFile() — Prompt for filename, open and return FILE*
+ * ================================================================
+ */
+FILE *openFile() {
+    FILE *fptr = NULL;
+    char fileName[100]; // Buffer for user input (filename)
+
+    while (1) {
+        memset(fileName, 0, 100);
+        printf("What is the name of the data file? ");
 
-    return obj;
+        if (fgets(fileName, sizeof(fileName), stdin) == NULL) {
+            perror("fgets");
+            exit(1);
+        }
+
+        rtrim(fileName);
+
+        if (strlen(fileName) == 0) {
+            printf("Error: Must enter a filename.\n");
+            continue;
+        }
+
+        fptr = fopen(fileName, "r");
+        if (fptr == NULL) {
+            printf("Error: Could not open file %s\n", fileName);
+            continue;
+        }
+
+        return fptr;
+    }
 }
 
 /* ================================================================
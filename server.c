@@ -4,13 +4,15 @@
  * Author: Elijah Heimsoth
  * Date: 02-13-2026
  *
- * Joins a multicast group and receives serialized JSON strings over
- * UDP, deserializes them with cJSON, and prints each key-value pair.
+ * Joins one or more multicast groups and receives serialized JSON
+ * strings over UDP, deserializes them with cJSON, and prints each
+ * key-value pair.
  *
- * Runs continuously until Ctrl+C.
+ * Runs continuously until Ctrl+C, then prints receive statistics.
  *
- * Usage: ./server <multicast_ip> <port>
- * Example: ./server 239.0.0.1 5000
+ * Usage: ./server [options] <multicast_ip> <port>
+ *        ./server [options] <group>:<port>[@interface] ...
+ * Example: ./server -b 64 239.0.0.1 5000
  * ================================================================
  */
 
@@ -19,6 +21,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 
 // Networking headers
 #include <sys/socket.h>
@@ -30,166 +40,1500 @@
 
 // Shared utilities
 #include "utils/utils.h"
+#include "utils/arena.h"
+#include "utils/recvbatch.h"
+#include "utils/rxpool.h"
+#include "utils/outsink.h"
+#include "utils/mcast.h"
+#include "utils/seqtrack.h"
+#include "utils/latency.h"
+#include "utils/projection.h"
+#include "utils/filter.h"
+#include "utils/jsonindex.h"
 
 // Constants
-#define BUFFER_SIZE 4096 // Maximum bytes for incoming UDP datagram
+#define BUFFER_SIZE 65536 // Maximum bytes for incoming UDP datagram (+ terminator)
+#define RCVBUF_MAX (1024 * 1024 * 1024) // Largest receive buffer accepted (1 GB)
+#define MAX_SPIN_US 1000000 // Longest busy-poll budget accepted (1 s)
+
+/* ================================================================
+ * ServerOptions struct:
+ * Settings parsed from the command-line options.
+ *
+ *  - batchSize: datagrams taken per recvmmsg() call
+ *  - threads: decoder threads behind a dedicated receive thread
+ *             (0 = receive and decode on the main thread)
+ *  - ordered: decode each sender's datagrams in arrival order
+ *  - slots: datagram slots shared by receiver and decoders
+ *  - outPolicy / sampleEvery: what to do when output falls behind
+ *  - outBlocks: output buffers between decoders and the writer
+ *  - subscriptionFile: file with more group:port[@interface] lines
+ *  - sources: sender include/exclude list for every subscription
+ *  - latency: record per-stage latency histograms
+ *  - interval: seconds between periodic statistics (0 = only at exit)
+ *  - rcvbuf: receive buffer to ask for (0 = system default)
+ *  - rcvbufMax: grow the buffer up to this effective size on kernel
+ *    drops (0 = fixed size)
+ *  - spinUs: busy-poll for this long before blocking (0 = block)
+ *  - cpu: CPU to pin the receive thread to (-1 = not pinned)
+ *  - fields: comma-separated keys to project (NULL = whole records)
+ *  - filter: expression records must match (NULL = keep all)
+ *  - twoStage: parse records with the two-stage parser instead of
+ *    cJSON_ParseWithOpts()
+ * ================================================================ */
+typedef struct {
+    int batchSize;
+    int threads;
+    int ordered;
+    int slots;
+    OutPolicy outPolicy;
+    int sampleEvery;
+    int outBlocks;
+    const char *subscriptionFile;
+    SourceFilter sources;
+    int latency;
+    double interval;
+    int rcvbuf;
+    int rcvbufMax;
+    int spinUs;
+    int cpu;
+    const char *fields;
+    const char *filter;
+    int twoStage;
+} ServerOptions;
+
+/* ================================================================
+ * LatencyStage enum:
+ * The measured stages of a datagram's trip. Send times come from
+ * the sender's envelope, wire times from SO_TIMESTAMPNS, user times
+ * from the receive thread right after recvmmsg() returns, and
+ * processed times from the decoder once the output is formatted.
+ * ================================================================ */
+typedef enum {
+    LAT_SEND_TO_WIRE,           // Envelope send time -> kernel receive
+    LAT_WIRE_TO_USER,           // Kernel receive -> recvmmsg() return
+    LAT_USER_TO_PROCESSED,      // recvmmsg() return -> output formatted
+    LAT_END_TO_END,             // Envelope send time -> output formatted
+    LAT_STAGES
+} LatencyStage;
+
+// Set by the SIGINT handler; the receive loop stops and reports.
+static volatile sig_atomic_t stopRequested = 0;
+
+// Record output; written to stdout by a background thread.
+static OutSink sink;
+
+// Set with more than one subscription: records name their group.
+static int tagGroups = 0;
+
+// Envelope sequence state per sender; owned by the receive thread.
+static SeqTracker tracker;
+
+// Keys extracted by the lazy scanner; count 0 = parse whole records.
+static Projection projection;
+
+// Record filter (codeLength 0 = off) and its verdicts, all decoders.
+static Filter filter;
+static atomic_long filterMatched;
+static atomic_long filterRejected;
+
+// Two-stage parsing (--parser simd): each decoding thread's index.
+static int twoStage = 0;
+static __thread JsonIndex parseIndex;
+
+// One histogram per LatencyStage, or NULL without --latency.
+static LatencyHistogram *latency = NULL;
+
+// Kernel drop accounting, written by the receive thread.
+static int rcvbufMax = 0;           // Adaptive growth limit (0 = off)
+static atomic_long kernelDrops;     // Datagrams dropped, all sockets
+static atomic_int rcvbufLargest;    // Largest effective receive buffer
+static atomic_long rcvbufGrows;     // Growth steps, all sockets
+
+// Busy-poll receive mode, used by the receive thread only.
+static uint64_t spinNs = 0;         // Spin budget per wait (0 = block at once)
+static long spinCaught = 0;         // Waits that found data while spinning
+static long spinFellBack = 0;       // Waits that ran out of budget and blocked
+
+// Periodic statistics thread, woken early to stop.
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int stopping;
+    double interval;
+    uint64_t startNs;
+} stats;
 
 // Function prototypes
 
 /* ================================================================
- * joinMulticastGroup():
- * Join a UDP socket to a multicast group
+ * parseServerOptions():
+ * Parses command-line options into *opts and returns the index of
+ * the first positional argument (the multicast IP).
+ * Exits with a usage message on invalid options.
+ * ================================================================ */
+int parseServerOptions(int argc, char *argv[], ServerOptions *opts);
+
+/* ================================================================
+ * collectSubscriptions():
+ * Builds the subscription list from the positional arguments
+ * (either <multicast_ip> <port>, or any number of
+ * <group>:<port>[@interface]) and the --subscriptions file.
+ * Exits with an error message on invalid input.
+ *
+ * Returns: number of subscriptions in *subs (malloc'ed)
+ * ================================================================ */
+int collectSubscriptions(int argc, char *argv[], const ServerOptions *opts,
+                         Subscription **subs);
+
+/* ================================================================
+ * receiveDirect():
+ * Receive loop that decodes every batch on the calling thread.
+ * ================================================================ */
+void receiveDirect(RecvBatch *batch, McastSet *set);
+
+/* ================================================================
+ * receivePooled():
+ * Receive loop that only drains the sockets into pool slots and
+ * leaves decoding to the pool's threads.
+ * ================================================================ */
+void receivePooled(RecvBatch *batch, McastSet *set, RxPool *pool);
+
+/* ================================================================
+ * handleInterrupt():
+ * SIGINT handler: asks the receive loop to stop.
+ * ================================================================ */
+void handleInterrupt(int signum);
+
+/* ================================================================
+ * flushOutput():
+ * Queues the calling thread's buffered output for the writer.
+ * Decoders call it when they run out of work.
+ * ================================================================ */
+void flushOutput(void);
+
+/* ================================================================
+ * releaseParseIndex():
+ * Frees the calling thread's two-stage parser index. Decoders call
+ * it as they exit.
+ * ================================================================ */
+void releaseParseIndex(void);
+
+/* ================================================================
+ * startStats() / stopStats():
+ * Start the thread that prints statistics every opts->interval
+ * seconds through the output sink; wake it up and join it.
+ * ================================================================ */
+void startStats(const ServerOptions *opts);
+void stopStats(void);
+
+/* ================================================================
+ * setupBusyPoll():
+ * Sets SO_BUSY_POLL on every socket for opts->spinUs, enables the
+ * spin in the receive loop, and checks that opts->cpu is usable.
+ * ================================================================ */
+void setupBusyPoll(McastSet *set, const ServerOptions *opts);
+
+/* ================================================================
+ * pinReceiveThread():
+ * Pins the calling thread to `cpu`. Called after every worker
+ * thread is started, so they keep the full CPU mask.
+ * ================================================================ */
+void pinReceiveThread(int cpu);
+
+// printf()-backed EmitFunc for the summary
+static void emitToStdout(void *ctx, const char *format, ...);
+
+/* ================================================================
+ * processDatagram():
+ * Parse and display every JSON record in one received datagram.
  *
- * Parameters:
- *  - sd: socket descriptor
- *  - multicastIP: multicast group IP address
+ * A datagram holds one record or several newline-delimited (NDJSON)
+ * records. The data must be null-terminated at data[length].
+ * Safe to call from several decoder threads at once: the output of
+ * one datagram is formatted into the thread's output buffer as one
+ * message, so it is written as one uninterrupted block.
  *
- * Returns:
- *  - 0 on success
- *  - -1 on error (perror)
+ * Returns: number of records parsed successfully
  * ================================================================ */
-int joinMulticastGroup(int sd, const char *multicastIP);
+int processDatagram(const DatagramSlot *datagram);
 
 /* ================================================================
  * main():
  * Main function and orchestrator for Server
  * 
  * Flow:
- *  1. Validate arguments (IP, multicast range, port)
- *  2. Create socket and bind to port
- *  3. Join the multicast group
- *  4. Receive loop
- *  5. Cleanup
+ *  1. Parse options, validate arguments (IP, multicast range, port)
+ *  2. Collect the group:port subscriptions
+ *  3. Create and bind sockets, join the groups
+ *  4. Start the output writer (and decoder threads)
+ *  5. Receive loop: recvmmsg() batches, process each datagram
+ *  6. On Ctrl+C: report statistics, cleanup
  * ================================================================ */
 int main(int argc, char *argv[]) {
-    int sd; // Socket descriptor
-    struct sockaddr_in server_address; // Server address
-    int portNumber; // Port number
+    ServerOptions opts; // Command-line options
+    McastSet set; // Subscribed groups and their sockets
 
     printf("========================SETUP========================\n");
 
     /*
-     * Step 1: Validate arguments (IP, multicast range, port)
+     * Step 1a: Parse options
      *
-     * validateArguments() checks argc, validates the IP format with
-     * inet_pton(), verifies the multicast range, and parses the port.
-     * 
-     * On success, the binary IP is written into a temporary in_addr.
-     * The server binds to INADDR_ANY, not the multicast IP. The 
-     * multicast IP is only used when joining the group via setsockopt.
+     * getopt_long() moves the positional arguments to the end of argv.
+     * Shift the view so validateArguments() still sees
+     * <program> <multicast_ip> <port>.
      */
-    struct in_addr multicast_check;
-    validateArguments(argc, argv, &multicast_check, &portNumber);
+    int firstArg = parseServerOptions(argc, argv, &opts);
+    argv[firstArg - 1] = argv[0];
+    argc -= firstArg - 1;
+    argv += firstArg - 1;
 
-    // Step 2: Create socket and bind to port
-    setupSocket(&sd, portNumber, &server_address, MODE_SERVER);
+    // Step 1b/2: Validate arguments and collect the subscriptions
+    Subscription *subs;
+    int subCount = collectSubscriptions(argc, argv, &opts, &subs);
 
-    // Step 3: Join the multicast group
-    if (joinMulticastGroup(sd, argv[1]) == -1) {
-        printf("Error: Failed to join multicast group %s\n", argv[1]);
-        close(sd);
+    /*
+     * Route cJSON allocations through a per-record arena: every record
+     * is parsed into it, and after cJSON_Delete() (which then frees
+     * nothing) the whole tree is reclaimed with one reset.
+     */
+    Arena arena;
+    arenaInstallHooks();
+    if (opts.fields != NULL && projectionInit(&projection, opts.fields) == -1) {
         exit(1);
     }
+    if (opts.filter != NULL && filterCompile(&filter, opts.filter) == -1) {
+        exit(1);
+    }
+    // Projection skips the tree altogether, so no parser is needed then
+    twoStage = opts.twoStage && projection.count == 0;
+    if (arenaInit(&arena, ARENA_DEFAULT_SIZE) == -1) {
+        printf("Error: Could not allocate parse arena\n");
+        exit(1);
+    }
+    arenaSetCurrent(&arena);
+
+    if (seqTrackerInit(&tracker, 64) == -1) {
+        printf("Error: Could not allocate sequence tracker\n");
+        exit(1);
+    }
+
+    /*
+     * Step 3: Create sockets and join the groups
+     *
+     * Sockets bind to INADDR_ANY on their port, not to a group; the
+     * groups are joined with IP_ADD_MEMBERSHIP. With several sockets
+     * they are multiplexed with epoll.
+     */
+    if (mcastOpen(&set, subs, subCount, &opts.sources, opts.rcvbuf) == -1) {
+        printf("Error: Failed to join the multicast groups\n");
+        exit(1);
+    }
+    tagGroups = set.subCount > 1;
+    rcvbufMax = opts.rcvbufMax;
+    for (int i = 0; i < set.socketCount; i++) {
+        if (set.sockets[i].rcvbuf > atomic_load(&rcvbufLargest)) {
+            atomic_store(&rcvbufLargest, set.sockets[i].rcvbuf);
+        }
+    }
+
+    /*
+     * Latency needs the kernel's receive time of every datagram:
+     * SO_TIMESTAMPNS attaches it as a CLOCK_REALTIME timespec.
+     */
+    if (opts.latency) {
+        static const char *names[LAT_STAGES] = {
+            "send-to-wire", "wire-to-user", "user-to-processed", "end-to-end"
+        };
+        int on = 1;
+
+        latency = calloc(LAT_STAGES, sizeof(LatencyHistogram));
+        if (latency == NULL) {
+            printf("Error: Could not allocate latency histograms\n");
+            exit(1);
+        }
+        for (int k = 0; k < LAT_STAGES; k++) {
+            latencyInit(&latency[k], names[k]);
+        }
+        for (int i = 0; i < set.socketCount; i++) {
+            if (setsockopt(set.sockets[i].sd, SOL_SOCKET, SO_TIMESTAMPNS,
+                           &on, sizeof(on)) == -1) {
+                perror("setsockopt SO_TIMESTAMPNS");
+                exit(1);
+            }
+        }
+    }
 
-    printf("Socket created, joined multicast group %s on port %d...\n",
-           argv[1], portNumber);
+    if (set.subCount == 1) {
+        char group[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &set.subs[0].group, group, sizeof(group));
+        printf("Socket created, joined multicast group %s on port %d%s%s...\n",
+               group, set.subs[0].port, set.subs[0].ifname[0] ? " via " : "",
+               set.subs[0].ifname);
+    }
+    else {
+        printf("%d sockets created, joined %d group:port subscriptions...\n",
+               set.socketCount, set.subCount);
+    }
+    if (opts.sources.mode != SOURCE_ANY) {
+        printf("Source filter: %s %d sender(s), %s\n",
+               opts.sources.mode == SOURCE_INCLUDE ? "only" : "all but",
+               opts.sources.count,
+               opts.sources.kernel ? "filtered in the kernel"
+                                   : "filtered in user space");
+    }
+    printf("Receive buffer: %d bytes%s", atomic_load(&rcvbufLargest),
+           opts.rcvbuf > 0 ? "" : " (system default)");
+    if (opts.rcvbufMax > 0) {
+        printf(", growing up to %d bytes on drops", opts.rcvbufMax);
+    }
+    printf("\n");
+    if (opts.spinUs > 0 || opts.cpu >= 0) {
+        setupBusyPoll(&set, &opts);
+    }
+    if (projection.count > 0) {
+        printf("Projection: %d field(s) per record, the rest skipped:", projection.count);
+        for (int k = 0; k < projection.count; k++) {
+            printf("%s %s", k > 0 ? "," : "", projection.names[k]);
+        }
+        printf("\n");
+    }
+    if (filter.codeLength > 0) {
+        printf("Filter: %s (%d comparison(s) on %d key(s), %d instructions)\n",
+               filter.source, filter.conditionCount, filter.keys.count, filter.codeLength);
+    }
+    if (twoStage) {
+        printf("Parser: two-stage (structural index: %s)\n", jsonIndexImplName());
+    }
+    if (opts.latency) {
+        printf("Latency: kernel timestamps on, %s\n",
+               opts.interval > 0 ? "reporting periodically" : "reporting at exit");
+    }
     printf("=====================================================\n\n");
 
-    // Step 4: Receive loop
-    char buffer[BUFFER_SIZE]; // Buffer for incoming data
-    struct sockaddr_in client_address; // Client address (filled by recvfrom)
-    socklen_t addr_len; // Length of client address
-    int bytesReceived; // Return value from recvfrom
-    char clientIP[INET_ADDRSTRLEN]; // IP address of client
+    /*
+     * Step 4: Allocate the receive batch
+     *
+     * Each recvmmsg() call blocks for the first datagram and then
+     * takes whatever else is already queued, up to the batch size.
+     * Without decoder threads the batch is processed in one tight
+     * loop before the socket is drained again. With them, recvmmsg()
+     * writes straight into pool slots and this thread does nothing
+     * but receive.
+     */
+    RecvBatch batch;
+    if (recvBatchInit(&batch, set.sockets[0].sd, opts.batchSize,
+                      opts.threads > 0 ? 0 : BUFFER_SIZE) == -1) {
+        printf("Error: Could not allocate receive batch\n");
+        mcastClose(&set);
+        exit(1);
+    }
+
+    // Ctrl+C interrupts recvmmsg() and ends the loop
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handleInterrupt;
+    sigaction(SIGINT, &action, NULL);
 
-    while (1) {
-        // Reset addr_len before EACH recvfrom() call.
-        addr_len = sizeof(client_address);
+    /*
+     * Step 5: Start the output writer (and decoder threads)
+     *
+     * From here on records are formatted into per-thread buffers and
+     * written by the writer thread, so stdio's own buffer is flushed
+     * first to keep the setup lines ahead of them. Worker threads
+     * inherit a blocked SIGINT, so Ctrl+C always lands on this
+     * thread and interrupts recvmmsg().
+     */
+    fflush(stdout);
+    sigset_t interrupt, previous;
+    sigemptyset(&interrupt);
+    sigaddset(&interrupt, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &interrupt, &previous);
+    if (outSinkInit(&sink, STDOUT_FILENO, opts.outBlocks, OUT_BLOCK_SIZE,
+                    opts.outPolicy, opts.sampleEvery) == -1) {
+        exit(1);
+    }
+    RxPool pool;
+    if (opts.threads > 0 &&
+        rxPoolInit(&pool, opts.threads, opts.slots, BUFFER_SIZE,
+                   opts.ordered, processDatagram, flushOutput, releaseParseIndex) == -1) {
+        exit(1);
+    }
+    if (opts.interval > 0) {
+        startStats(&opts);
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+    if (opts.cpu >= 0) {
+        pinReceiveThread(opts.cpu);
+    }
+
+    // Step 6: Receive loop
+    if (opts.threads > 0) {
+        receivePooled(&batch, &set, &pool);
+    }
+    else {
+        receiveDirect(&batch, &set);
+    }
+
+    // Step 7: Finish decoding and writing, report statistics, cleanup
+    if (opts.threads > 0) {
+        rxPoolStop(&pool);
+    }
+    if (opts.interval > 0) {
+        stopStats();
+    }
+    outSinkStop(&sink);
+    printf("=======================SUMMARY=======================\n");
+    recvBatchReport(&batch);
+    printf("Kernel drops: %ld datagrams (receive buffer full), receive buffer %d bytes",
+           atomic_load(&kernelDrops), atomic_load(&rcvbufLargest));
+    if (atomic_load(&rcvbufGrows) > 0) {
+        printf(", grown %ld times", atomic_load(&rcvbufGrows));
+    }
+    printf("\n");
+    if (spinNs > 0) {
+        printf("Busy-poll: %ld waits caught data within %d us, %ld fell back to blocking\n",
+               spinCaught, opts.spinUs, spinFellBack);
+    }
+    if (set.subCount > 1 || set.filter.mode != SOURCE_ANY) {
+        mcastReport(&set);
+    }
+    if (tracker.count > 0 || tracker.badEnvelopes > 0) {
+        seqTrackerReport(&tracker);
+    }
+    if (filter.codeLength > 0) {
+        printf("Filter: %ld records matched, %ld rejected before parsing\n",
+               atomic_load(&filterMatched), atomic_load(&filterRejected));
+    }
+    if (latency != NULL) {
+        printf("Latency over the whole run (datagrams, percentiles):\n");
+        for (int k = 0; k < LAT_STAGES; k++) {
+            latencyReport(&latency[k], 0, emitToStdout, NULL);
+        }
+    }
+    if (opts.threads > 0) {
+        rxPoolReport(&pool);
+        rxPoolFree(&pool);
+    }
+    outSinkReport(&sink);
+    outSinkFree(&sink);
+
+    recvBatchFree(&batch);
+    arenaFree(&arena);
+    seqTrackerFree(&tracker);
+    projectionFree(&projection);
+    filterFree(&filter);
+    releaseParseIndex();
+    free(latency);
+    mcastClose(&set);
+    return 0;
+}
+
+/* ================================================================
+ * receiveFrom() — One recvmmsg() call on subscription socket `index`
+ *
+ * With several sockets, epoll has already said the socket is
+ * readable, so the call never blocks on one feed while others wait.
+ * ================================================================
+ */
+static int receiveFrom(McastSet *set, int index, RecvBatch *batch, int flags) {
+    batch->sd = set->sockets[index].sd;
+    if (set->socketCount > 1) {
+        flags |= MSG_DONTWAIT;
+    }
+    return recvBatchReceive(batch, flags);
+}
+
+/* ================================================================
+ * monotonicNs() — Current CLOCK_MONOTONIC time in nanoseconds
+ *
+ * For deadlines and intervals; latencyNowNs() (CLOCK_REALTIME) is
+ * only for comparing against envelope and kernel timestamps.
+ * ================================================================
+ */
+static uint64_t monotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ================================================================
+ * noteDrops() — Account kernel drops reported with the last batch
+ *
+ * The SO_RXQ_OVFL counter of the batch's last datagram is the most
+ * recent one; the difference to the last counter seen on the socket
+ * is how many datagrams were lost in between. With --rcvbuf-grow,
+ * a socket that dropped gets its buffer doubled, at most every
+ * RCVBUF_GROW_GAP_NS: datagrams queued before a growth still carry
+ * older counters, and must not trigger another one.
+ * ================================================================
+ */
+#define RCVBUF_GROW_GAP_NS 100000000ULL
+
+static void noteDrops(McastSet *set, int index, RecvBatch *batch) {
+    McastSocket *sock = &set->sockets[index];
+    uint32_t counter;
 
-        // Receive data from client
-        bytesReceived = recvfrom(sd, buffer, BUFFER_SIZE, 0,
-                                (struct sockaddr *)&client_address, &addr_len);
-        
-        if (bytesReceived == -1) {
-            perror("recvfrom");
+    if (batch->count == 0 || recvBatchDrops(batch, batch->count - 1, &counter) == -1 ||
+        counter == sock->dropsSeen) {
+        return;
+    }
+
+    uint32_t lost = counter - sock->dropsSeen;
+    sock->dropsSeen = counter;
+    sock->drops += lost;
+    atomic_fetch_add_explicit(&kernelDrops, lost, memory_order_relaxed);
+
+    /*
+     * The kernel doubles every request, so requesting the current
+     * effective size doubles it. rcvbufMax caps the effective size:
+     * the largest request is half of it.
+     */
+    if (rcvbufMax == 0 || sock->rcvbuf >= rcvbufMax) {
+        return;
+    }
+    int request = sock->rcvbuf < rcvbufMax / 2 ? sock->rcvbuf : rcvbufMax / 2;
+
+    uint64_t now = monotonicNs();
+    if (now - sock->grownNs < RCVBUF_GROW_GAP_NS) {
+        return;
+    }
+
+    // Without CAP_NET_ADMIN the kernel may cap the size at rmem_max
+    sock->grownNs = now;
+    int effective = setReceiveBuffer(sock->sd, request);
+    if (effective > sock->rcvbuf) {
+        sock->rcvbuf = effective;
+        sock->grows++;
+        atomic_fetch_add_explicit(&rcvbufGrows, 1, memory_order_relaxed);
+        if (effective > atomic_load_explicit(&rcvbufLargest, memory_order_relaxed)) {
+            atomic_store_explicit(&rcvbufLargest, effective, memory_order_relaxed);
+        }
+    }
+}
+
+/* ================================================================
+ * describeDatagram() — Length, source and group of datagram i
+ *
+ * The group comes from IP_PKTINFO and the port from the socket;
+ * the subscription it matches is credited with the datagram, or
+ * with a filtered datagram if the sender fails the source filter.
+ *
+ * A sequence envelope is recognized from its first two bytes and
+ * fed to the tracker here, on the receive thread, so sequence
+ * checks see datagrams in arrival order and never touch the JSON.
+ * The envelope is then skipped through datagram->offset.
+ *
+ * With --latency, `userNs` is when the batch left recvmmsg(); the
+ * send-to-wire and wire-to-user stages are recorded here.
+ *
+ * Returns: the receive buffer, or NULL if the datagram is filtered
+ * out or carries a damaged envelope
+ * ================================================================
+ */
+static const char *describeDatagram(McastSet *set, int index, RecvBatch *batch,
+                                    int i, DatagramSlot *datagram, uint64_t userNs) {
+    const struct sockaddr_in *source;
+    const char *data = recvBatchData(batch, i, &datagram->length, &source);
+    int allowed = mcastAllowed(set, source->sin_addr);
+    struct in_addr group;
+    int ifindex;
+
+    datagram->source = *source;
+    memset(&datagram->destination, 0, sizeof(datagram->destination));
+    if (recvBatchDestination(batch, i, &group, &ifindex) == 0) {
+        datagram->destination.sin_family = AF_INET;
+        datagram->destination.sin_addr = group;
+        datagram->destination.sin_port = htons(set->sockets[index].port);
+
+        Subscription *sub = mcastLookup(set, index, group, ifindex);
+        if (sub != NULL && allowed) {
+            sub->datagrams++;
+            sub->bytes += datagram->length;
+        }
+        else if (sub != NULL) {
+            sub->filtered++;
+            sub->filteredBytes += datagram->length;
+        }
+    }
+    if (!allowed) {
+        return NULL;
+    }
+
+    datagram->offset = 0;
+    switch (envelopeDecode(data, datagram->length, &datagram->envelope)) {
+        case ENVELOPE_OK:
+            seqTrack(&tracker, &datagram->envelope, source->sin_addr);
+            datagram->offset = ENVELOPE_SIZE;
+            datagram->length -= ENVELOPE_SIZE;
+            break;
+        case ENVELOPE_BAD:
+            tracker.badEnvelopes++;
+            return NULL;
+        case ENVELOPE_NONE:
+            break;
+    }
+
+    datagram->userNs = userNs;
+    if (latency != NULL && recvBatchTimestamp(batch, i, &datagram->wireNs) == 0) {
+        latencyRecord(&latency[LAT_WIRE_TO_USER], (int64_t)(userNs - datagram->wireNs));
+        if (datagram->offset > 0) {
+            latencyRecord(&latency[LAT_SEND_TO_WIRE],
+                          (int64_t)(datagram->wireNs - datagram->envelope.sendTimeNs));
+        }
+    }
+    return data;
+}
+
+/* ================================================================
+ * receiveNext() — Wait for and receive the next batch
+ *
+ * Without `wait`, only checks. With it, busy-polls first when a
+ * spin budget is set: the sockets are read with MSG_DONTWAIT in a
+ * loop, so a datagram arriving within the budget is picked up
+ * without a sleep and a scheduler wake-up. Once the budget is used
+ * up, it blocks as usual.
+ *
+ * Returns: the socket index the batch came from, or -1 (errno set)
+ * ================================================================
+ */
+static int receiveNext(McastSet *set, RecvBatch *batch, int wait) {
+    int index;
+
+    if (wait && spinNs > 0) {
+        uint64_t deadline = monotonicNs() + spinNs;
+        do {
+            index = mcastNextReady(set, 0);
+            if (index != -1 && receiveFrom(set, index, batch, MSG_DONTWAIT) != -1) {
+                spinCaught++;
+                return index;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return -1;
+            }
+        } while (!stopRequested && monotonicNs() < deadline);
+        spinFellBack++;
+    }
+
+    index = mcastNextReady(set, wait);
+    if (index == -1 || receiveFrom(set, index, batch, wait ? 0 : MSG_DONTWAIT) == -1) {
+        return -1;
+    }
+    return index;
+}
+
+/* ================================================================
+ * receiveDirect() — Receive and decode on this thread
+ *
+ * While output is buffered, the sockets are checked without
+ * blocking first; if nothing is waiting, the output is queued for
+ * the writer before blocking, so nothing waits in the buffer while
+ * the server idles.
+ * ================================================================
+ */
+void receiveDirect(RecvBatch *batch, McastSet *set) {
+    OutBuffer *out = outCurrent(&sink);
+    DatagramSlot datagram;
+
+    while (!stopRequested) {
+        int index = receiveNext(set, batch, !outPending(out));
+        if (index == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                outFlush(out);
+            }
+            else if (errno != EINTR) {
+                perror("receive");
+            }
             continue;
         }
 
-        // Null terminate buffer
-        buffer[bytesReceived] = '\0';
+        uint64_t userNs = latency != NULL ? latencyNowNs() : 0;
+        noteDrops(set, index, batch);
+        for (int i = 0; i < batch->count; i++) {
+            datagram.data = (char *)describeDatagram(set, index, batch, i, &datagram, userNs);
+            if (datagram.data != NULL) {
+                processDatagram(&datagram);
+            }
+        }
+    }
+}
 
-        // Convert client binary IP to string
-        inet_ntop(AF_INET, &client_address.sin_addr, clientIP, INET_ADDRSTRLEN);
+/* ================================================================
+ * receivePooled() — Drain the sockets into pool slots
+ *
+ * Every batch slot is backed by a pool slot. Filled slots are
+ * queued for the decoders as they are, and replaced by fresh ones
+ * for the next recvmmsg() call.
+ * ================================================================
+ */
+void receivePooled(RecvBatch *batch, McastSet *set, RxPool *pool) {
+    DatagramSlot *held[MAX_RECV_BATCH];
 
-        printf("Received from %s:%d\n", clientIP, ntohs(client_address.sin_port));
-        printf("=====================================================\n");
-        
-        // Parse the JSON string into a cJSON object
-        cJSON *json = cJSON_Parse(buffer);
-        if (json == NULL) {
-            printf("Invalid JSON received: %s\n", buffer);
-            printf("=====================================================\n\n");
+    for (int i = 0; i < batch->capacity; i++) {
+        held[i] = rxPoolAcquire(pool);
+        recvBatchAttach(batch, i, held[i]->data, pool->slotSize);
+    }
+
+    while (!stopRequested) {
+        int index = receiveNext(set, batch, 1);
+        if (index == -1) {
+            if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("receive");
+            }
             continue;
         }
 
-        // Print the parsed JSON
-        printJSONObject(json, MODE_SERVER, 0);
+        uint64_t userNs = latency != NULL ? latencyNowNs() : 0;
+        noteDrops(set, index, batch);
+        for (int i = 0; i < batch->count; i++) {
+            DatagramSlot *slot = held[i];
 
-        // Free the cJSON object tree memory allocation
-        cJSON_Delete(json);
+            // A filtered datagram's slot is simply received into again
+            if (describeDatagram(set, index, batch, i, slot, userNs) == NULL) {
+                continue;
+            }
+            rxPoolSubmit(pool, slot);
+
+            held[i] = rxPoolAcquire(pool);
+            recvBatchAttach(batch, i, held[i]->data, pool->slotSize);
+        }
+    }
 
-        printf("=====================================================\n\n");
+    // Slots still attached to the batch go back unused
+    for (int i = 0; i < batch->capacity; i++) {
+        mpmcPush(&pool->freeRing, held[i]);
     }
-    
-    // Cleanup (Unreachable code)
-    close(sd);
-    return 0;
 }
 
 /* ================================================================
- * joinMulticastGroup() — Join a UDP socket to a multicast group
+ * collectSubscriptions() — Positional arguments and file to a list
+ *
+ * Two arguments without a ':' are the original
+ * <multicast_ip> <port> form and go through validateArguments();
+ * otherwise every argument is a group:port[@interface] spec.
+ * ================================================================
+ */
+int collectSubscriptions(int argc, char *argv[], const ServerOptions *opts,
+                         Subscription **subs) {
+    int count = 0;
+
+    *subs = calloc(MAX_SUBSCRIPTIONS, sizeof(Subscription));
+    if (*subs == NULL) {
+        printf("Error: Could not allocate subscriptions\n");
+        exit(1);
+    }
+
+    if (argc == 3 && strchr(argv[1], ':') == NULL && strchr(argv[2], ':') == NULL) {
+        Subscription *sub = &(*subs)[count++];
+        validateArguments(argc, argv, &sub->group, &sub->port);
+    }
+    else {
+        for (int i = 1; i < argc; i++) {
+            if (count >= MAX_SUBSCRIPTIONS) {
+                printf("Error: More than %d subscriptions\n", MAX_SUBSCRIPTIONS);
+                exit(1);
+            }
+            if (mcastParse(argv[i], &(*subs)[count++]) == -1) {
+                exit(1);
+            }
+        }
+    }
+
+    if (opts->subscriptionFile != NULL &&
+        mcastLoadFile(opts->subscriptionFile, *subs, &count) == -1) {
+        exit(1);
+    }
+
+    // Nothing given: validateArguments() prints the usage and exits
+    if (count == 0) {
+        validateArguments(argc, argv, &(*subs)[0].group, &(*subs)[0].port);
+    }
+    return count;
+}
+
+/* ================================================================
+ * parseServerOptions() — Parse command-line options
+ *
+ * Options:
+ *  -b, --batch <n>         datagrams per recvmmsg() call (1-MAX_RECV_BATCH)
+ *  -t, --threads <n>       decoder threads behind a receive thread (0 = off)
+ *  -o, --ordered           keep each sender's datagrams in order
+ *  -n, --slots <n>         datagram slots between receiver and decoders
+ *  -P, --out-policy <p>    block | drop | sample[:N] when output falls behind
+ *  -B, --out-blocks <n>    256 KB output buffers (4-4096)
+ *  -S, --subscriptions <f> read group:port[@interface] lines from a file
+ *  -I, --include-source <a[,a...]>  only accept these senders (SSM)
+ *  -X, --exclude-source <a[,a...]>  block these senders
+ *  -U, --user-filter       filter senders in user space only
+ *  -L, --latency           record per-stage latency histograms
+ *  -i, --interval <s>      seconds between periodic statistics (0 = off)
+ *  -R, --rcvbuf <size>     socket receive buffer (k/m suffixes)
+ *  -G, --rcvbuf-grow <max> grow the receive buffer up to max on drops
+ *  -W, --spin <us>         busy-poll up to us microseconds before blocking
+ *  -C, --cpu <n>           pin the receive thread to CPU n
+ *  -F, --fields <k[,k...]> print only these keys, skipping the rest unparsed
+ *  -f, --filter <expr>     drop records not matching expr before parsing
+ *  -J, --parser <p>        cjson | simd (two-stage parser with a SIMD index)
+ *  -h, --help              print usage and exit
  *
- * Parameters:
- *  - sd: socket descriptor
- *  - multicastIP: multicast group IP address
+ * Returns the index of the first positional argument.
+ * ================================================================
+ */
+int parseServerOptions(int argc, char *argv[], ServerOptions *opts) {
+    static const struct option longOptions[] = {
+        { "batch",   required_argument, NULL, 'b' },
+        { "threads", required_argument, NULL, 't' },
+        { "ordered", no_argument,       NULL, 'o' },
+        { "slots",      required_argument, NULL, 'n' },
+        { "out-policy", required_argument, NULL, 'P' },
+        { "out-blocks", required_argument, NULL, 'B' },
+        { "subscriptions", required_argument, NULL, 'S' },
+        { "include-source", required_argument, NULL, 'I' },
+        { "exclude-source", required_argument, NULL, 'X' },
+        { "user-filter", no_argument,      NULL, 'U' },
+        { "latency",    no_argument,       NULL, 'L' },
+        { "interval",   required_argument, NULL, 'i' },
+        { "rcvbuf",     required_argument, NULL, 'R' },
+        { "rcvbuf-grow", required_argument, NULL, 'G' },
+        { "spin",       required_argument, NULL, 'W' },
+        { "cpu",        required_argument, NULL, 'C' },
+        { "fields",     required_argument, NULL, 'F' },
+        { "filter",     required_argument, NULL, 'f' },
+        { "parser",     required_argument, NULL, 'J' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+
+    // Defaults: one datagram per call, like recvfrom(), on one thread
+    opts->batchSize = 1;
+    opts->threads = 0;
+    opts->ordered = 0;
+    opts->slots = 256;
+    opts->outPolicy = OUT_BLOCK;
+    opts->sampleEvery = OUT_SAMPLE_EVERY;
+    opts->outBlocks = OUT_BLOCKS;
+    opts->subscriptionFile = NULL;
+    memset(&opts->sources, 0, sizeof(opts->sources));
+    opts->sources.kernel = 1;
+    opts->latency = 0;
+    opts->interval = -1;
+    opts->rcvbuf = 0;
+    opts->rcvbufMax = 0;
+    opts->spinUs = 0;
+    opts->cpu = -1;
+    opts->fields = NULL;
+    opts->filter = NULL;
+    opts->twoStage = 0;
+
+    while ((opt = getopt_long(argc, argv, "b:t:on:P:B:S:I:X:ULi:R:G:W:C:F:f:J:h", longOptions, NULL)) != -1) {
+        switch (opt) {
+            case 'b': {
+                char *end;
+                long value = strtol(optarg, &end, 10);
+                if (*end != '\0' || value < 1 || value > MAX_RECV_BATCH) {
+                    printf("Error: Batch size must be between 1 and %d\n", MAX_RECV_BATCH);
+                    exit(1);
+                }
+                opts->batchSize = (int)value;
+                break;
+            }
+            case 't': {
+                char *end;
+                long value = strtol(optarg, &end, 10);
+                if (*end != '\0' || value < 0 || value > MAX_DECODERS) {
+                    printf("Error: Thread count must be between 0 and %d\n", MAX_DECODERS);
+                    exit(1);
+                }
+                opts->threads = (int)value;
+                break;
+            }
+            case 'o':
+                opts->ordered = 1;
+                break;
+            case 'n': {
+                char *end;
+                long value = strtol(optarg, &end, 10);
+                if (*end != '\0' || value < 1 || value > 65536) {
+                    printf("Error: Slot count must be between 1 and 65536\n");
+                    exit(1);
+                }
+                opts->slots = (int)value;
+                break;
+            }
+            case 'P': {
+                // sample takes an optional ":N" (keep one message in N)
+                if (strcmp(optarg, "block") == 0) {
+                    opts->outPolicy = OUT_BLOCK;
+                }
+                else if (strcmp(optarg, "drop") == 0) {
+                    opts->outPolicy = OUT_DROP;
+                }
+                else if (strncmp(optarg, "sample", 6) == 0 &&
+                         (optarg[6] == '\0' || optarg[6] == ':')) {
+                    opts->outPolicy = OUT_SAMPLE;
+                    if (optarg[6] == ':') {
+                        char *end;
+                        long value = strtol(optarg + 7, &end, 10);
+                        if (*end != '\0' || value < 1 || value > 1000000) {
+                            printf("Error: Sample rate must be between 1 and 1000000\n");
+                            exit(1);
+                        }
+                        opts->sampleEvery = (int)value;
+                    }
+                }
+                else {
+                    printf("Error: Output policy must be block, drop or sample[:N]\n");
+                    exit(1);
+                }
+                break;
+            }
+            case 'B': {
+                char *end;
+                long value = strtol(optarg, &end, 10);
+                if (*end != '\0' || value < 4 || value > 4096) {
+                    printf("Error: Output buffer count must be between 4 and 4096\n");
+                    exit(1);
+                }
+                opts->outBlocks = (int)value;
+                break;
+            }
+            case 'S':
+                opts->subscriptionFile = optarg;
+                break;
+            case 'I':
+            case 'X':
+                if (mcastAddSources(&opts->sources,
+                                    opt == 'I' ? SOURCE_INCLUDE : SOURCE_EXCLUDE,
+                                    optarg) == -1) {
+                    exit(1);
+                }
+                break;
+            case 'U':
+                opts->sources.kernel = 0;
+                break;
+            case 'L':
+                opts->latency = 1;
+                break;
+            case 'i': {
+                char *end;
+                double value = strtod(optarg, &end);
+                if (end == optarg || *end != '\0' || value < 0) {
+                    printf("Error: Interval must be a non-negative number of seconds\n");
+                    exit(1);
+                }
+                opts->interval = value;
+                break;
+            }
+            case 'W': {
+                char *end;
+                long value = strtol(optarg, &end, 10);
+                if (*end != '\0' || value < 0 || value > MAX_SPIN_US) {
+                    printf("Error: Spin budget must be between 0 and %d microseconds\n",
+                           MAX_SPIN_US);
+                    exit(1);
+                }
+                opts->spinUs = (int)value;
+                break;
+            }
+            case 'C': {
+                char *end;
+                long value = strtol(optarg, &end, 10);
+                if (*end != '\0' || value < 0 || value >= CPU_SETSIZE) {
+                    printf("Error: CPU must be between 0 and %d\n", CPU_SETSIZE - 1);
+                    exit(1);
+                }
+                opts->cpu = (int)value;
+                break;
+            }
+            case 'F':
+                opts->fields = optarg;
+                break;
+            case 'f':
+                opts->filter = optarg;
+                break;
+            case 'J':
+                if (strcmp(optarg, "cjson") == 0) {
+                    opts->twoStage = 0;
+                }
+                else if (strcmp(optarg, "simd") == 0) {
+                    opts->twoStage = 1;
+                }
+                else {
+                    printf("Error: Parser must be cjson or simd\n");
+                    exit(1);
+                }
+                break;
+            case 'R':
+            case 'G': {
+                char *end;
+                double value = strtod(optarg, &end);
+                if (*end == 'k' || *end == 'K') {
+                    value *= 1024;
+                    end++;
+                }
+                else if (*end == 'm' || *end == 'M') {
+                    value *= 1024 * 1024;
+                    end++;
+                }
+                if (end == optarg || *end != '\0' || value < 1024 || value > RCVBUF_MAX) {
+                    printf("Error: Receive buffer size must be between 1k and %dm\n",
+                           RCVBUF_MAX / (1024 * 1024));
+                    exit(1);
+                }
+                if (opt == 'R') {
+                    opts->rcvbuf = (int)value;
+                }
+                else {
+                    opts->rcvbufMax = (int)value;
+                }
+                break;
+            }
+            case 'h':
+            default:
+                printf("Usage: %s [options] <multicast_ip> <port>\n", argv[0]);
+                printf("       %s [options] <group>:<port>[@interface] ...\n", argv[0]);
+                printf("  -b, --batch <n>         datagrams per recvmmsg() call (default 1)\n");
+                printf("  -t, --threads <n>       decoder threads behind a receive thread (default 0 = off)\n");
+                printf("  -o, --ordered           keep each sender's datagrams in order (with -t)\n");
+                printf("  -n, --slots <n>         64 KB datagram slots for -t (default 256)\n");
+                printf("  -P, --out-policy <p>    when output falls behind: block, drop or\n");
+                printf("                          sample[:N] (keep 1 in N, default %d; default block)\n",
+                       OUT_SAMPLE_EVERY);
+                printf("  -B, --out-blocks <n>    256 KB output buffers (default %d)\n", OUT_BLOCKS);
+                printf("  -S, --subscriptions <f> read group:port[@interface] lines from a file\n");
+                printf("  -I, --include-source <a[,a...]>  only accept these senders (source-specific joins)\n");
+                printf("  -X, --exclude-source <a[,a...]>  drop these senders in the kernel\n");
+                printf("  -U, --user-filter       apply -I/-X in user space only, counting every drop\n");
+                printf("  -L, --latency           latency histograms from kernel receive timestamps\n");
+                printf("  -i, --interval <s>      seconds between periodic statistics, 0 = off\n");
+                printf("                          (default 10 with -L, -R or -G, else 0)\n");
+                printf("  -R, --rcvbuf <size>     socket receive buffer, e.g. 4m (default: system)\n");
+                printf("  -G, --rcvbuf-grow <max> double the receive buffer on kernel drops, up to max\n");
+                printf("  -W, --spin <us>         busy-poll up to us microseconds before blocking (default 0)\n");
+                printf("  -C, --cpu <n>           pin the receive thread to CPU n\n");
+                printf("  -F, --fields <k[,k...]> print only these keys, skipping the rest unparsed\n");
+                printf("  -f, --filter <expr>     only records matching expr, e.g.\n");
+                printf("                          'File_Type == \"Video\" && File_Size > 100MB'\n");
+                printf("  -J, --parser <p>        cjson, or simd for the two-stage parser (default cjson)\n");
+                printf("  -h, --help              show this help\n");
+                exit(opt == 'h' ? 0 : 1);
+        }
+    }
+
+    // Periodic statistics by default once there is something to watch
+    if (opts->interval < 0) {
+        opts->interval = (opts->latency || opts->rcvbuf > 0 || opts->rcvbufMax > 0) ? 10.0 : 0;
+    }
+
+    // The receiver holds a whole batch of slots and needs spares
+    if (opts->threads > 0 && opts->slots < 2 * opts->batchSize) {
+        opts->slots = 2 * opts->batchSize;
+    }
+
+    return optind;
+}
+
+/* ================================================================
+ * setupBusyPoll() — SO_BUSY_POLL on every socket, pin this thread
  *
- * Returns:
- *  - 0 on success
- *  - -1 on error (perror)
+ * SO_BUSY_POLL makes a non-blocking read poll the NIC's receive
+ * queue directly for up to that many microseconds, on drivers that
+ * support it. Raising it needs CAP_NET_ADMIN; without that, the
+ * user-space spin still avoids the sleep and wake-up.
+ * ================================================================
+ */
+void setupBusyPoll(McastSet *set, const ServerOptions *opts) {
+    if (opts->spinUs > 0) {
+        int kernelPoll = 1;
+
+        spinNs = (uint64_t)opts->spinUs * 1000;
+        for (int i = 0; i < set->socketCount; i++) {
+            if (setsockopt(set->sockets[i].sd, SOL_SOCKET, SO_BUSY_POLL,
+                           &opts->spinUs, sizeof(opts->spinUs)) == -1) {
+                kernelPoll = 0;
+            }
+        }
+        printf("Busy-poll: spinning up to %d us before blocking, %s\n", opts->spinUs,
+               kernelPoll ? "SO_BUSY_POLL on" : "SO_BUSY_POLL not permitted (user-space spin only)");
+    }
+
+    if (opts->cpu >= 0) {
+        cpu_set_t allowed;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1 ||
+            !CPU_ISSET(opts->cpu, &allowed)) {
+            printf("Error: CPU %d is not available to this process\n", opts->cpu);
+            exit(1);
+        }
+        printf("Receive thread pinned to CPU %d\n", opts->cpu);
+    }
+}
+
+/* ================================================================
+ * pinReceiveThread() — Restrict the calling thread to one CPU
+ * ================================================================
+ */
+void pinReceiveThread(int cpu) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (err != 0) {
+        printf("Error: Could not pin the receive thread to CPU %d: %s\n", cpu, strerror(err));
+        exit(1);
+    }
+}
+
+/* ================================================================
+ * handleInterrupt() — SIGINT: stop receiving
+ * ================================================================
+ */
+void handleInterrupt(int signum) {
+    (void)signum;
+    stopRequested = 1;
+}
+
+/* ================================================================
+ * flushOutput() — Queue this thread's buffered output
+ * ================================================================
+ */
+void flushOutput(void) {
+    OutBuffer *out = outCurrent(&sink);
+    if (outPending(out)) {
+        outFlush(out);
+    }
+}
+
+/* ================================================================
+ * releaseParseIndex() — Free this thread's structural index
+ * ================================================================
+ */
+void releaseParseIndex(void) {
+    jsonIndexFree(&parseIndex);
+}
+
+/* ================================================================
+ * emitToBuffer() — EmitFunc that formats into an OutBuffer
+ * ================================================================
+ */
+static void emitToBuffer(void *ctx, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    outVprintf(ctx, format, args);
+    va_end(args);
+}
+
+/* ================================================================
+ * emitToStdout() — EmitFunc that prints (after the sink is stopped)
+ * ================================================================
+ */
+static void emitToStdout(void *ctx, const char *format, ...) {
+    (void)ctx;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/* ================================================================
+ * statsMain() — Print interval statistics until stopped
+ *
+ * Deadlines advance by a fixed step from the start, so reports do
+ * not drift. The report bypasses the output policy: it is most
+ * useful exactly when output is being dropped.
+ * ================================================================
+ */
+static void *statsMain(void *arg) {
+    (void)arg;
+    OutBuffer *out = outCurrent(&sink);
+    uint64_t step = (uint64_t)(stats.interval * 1e9);
+    long dropsBefore = 0;
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    pthread_mutex_lock(&stats.lock);
+    while (!stats.stopping) {
+        uint64_t ns = (uint64_t)deadline.tv_nsec + step;
+        deadline.tv_sec += ns / 1000000000ULL;
+        deadline.tv_nsec = ns % 1000000000ULL;
+
+        while (!stats.stopping &&
+               pthread_cond_timedwait(&stats.wake, &stats.lock, &deadline) != ETIMEDOUT) {
+            // Spurious wake-up: keep waiting for the deadline
+        }
+        if (stats.stopping) {
+            break;
+        }
+        pthread_mutex_unlock(&stats.lock);
+
+        long drops = atomic_load_explicit(&kernelDrops, memory_order_relaxed);
+        outBeginWait(out);
+        outPrintf(out, "Statistics, last %g s (at %.1f s):\n", stats.interval,
+                  (monotonicNs() - stats.startNs) / 1e9);
+        outPrintf(out, "  Kernel drops: %ld (%ld total), receive buffer %d bytes",
+                  drops - dropsBefore, drops,
+                  atomic_load_explicit(&rcvbufLargest, memory_order_relaxed));
+        long grows = atomic_load_explicit(&rcvbufGrows, memory_order_relaxed);
+        if (grows > 0) {
+            outPrintf(out, ", grown %ld times", grows);
+        }
+        outPrintf(out, "\n");
+        for (int k = 0; latency != NULL && k < LAT_STAGES; k++) {
+            latencyReport(&latency[k], 1, emitToBuffer, out);
+        }
+        outPrintf(out, "\n");
+        dropsBefore = drops;
+        outEnd(out);
+        outFlush(out);
+
+        pthread_mutex_lock(&stats.lock);
+    }
+    pthread_mutex_unlock(&stats.lock);
+    return NULL;
+}
+
+/* ================================================================
+ * startStats() — Start the periodic statistics thread
+ * ================================================================
+ */
+void startStats(const ServerOptions *opts) {
+    pthread_condattr_t attr;
+
+    pthread_mutex_init(&stats.lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&stats.wake, &attr);
+    pthread_condattr_destroy(&attr);
+    stats.stopping = 0;
+    stats.interval = opts->interval;
+    stats.startNs = monotonicNs();
+
+    int err = pthread_create(&stats.thread, NULL, statsMain, NULL);
+    if (err != 0) {
+        printf("Error: Could not start statistics thread: %s\n", strerror(err));
+        exit(1);
+    }
+}
+
+/* ================================================================
+ * stopStats() — Wake the statistics thread and join it
+ * ================================================================
+ */
+void stopStats(void) {
+    pthread_mutex_lock(&stats.lock);
+    stats.stopping = 1;
+    pthread_cond_signal(&stats.wake);
+    pthread_mutex_unlock(&stats.lock);
+
+    pthread_join(stats.thread, NULL);
+    pthread_mutex_destroy(&stats.lock);
+    pthread_cond_destroy(&stats.wake);
+}
+
+/* ================================================================
+ * emitFields() — Format projected fields like emitJSONObject()
+ *
+ * Same columns and value formats as the whole-record output. Only
+ * strings with escapes need decoding; the copy comes from cJSON's
+ * allocator, i.e. the per-record arena. Nested objects, arrays and
+ * null are printed as the raw JSON text.
+ * ================================================================
+ */
+static void emitFields(OutBuffer *out, const Field *fields, int count) {
+    for (int i = 0; i < count; i++) {
+        const Field *field = &fields[i];
+
+        outPrintf(out, "%20s: ", projection.names[field->key]);
+        switch (field->type) {
+            case FIELD_STRING: {
+                char *text = field->escaped ? cJSON_malloc(field->length + 1) : NULL;
+                if (text != NULL && fieldString(field, text) != -1) {
+                    outPrintf(out, "%20s\n", text);
+                }
+                else {
+                    outPrintf(out, "%20.*s\n", (int)field->length, field->value);
+                }
+                cJSON_free(text);
+                break;
+            }
+            case FIELD_NUMBER:
+                outPrintf(out, "%20g\n", fieldNumber(field));
+                break;
+            case FIELD_TRUE:
+            case FIELD_FALSE:
+                outPrintf(out, "%20s\n", field->type == FIELD_TRUE ? "true" : "false");
+                break;
+            default:
+                outPrintf(out, "%20.*s\n", (int)field->length, field->value);
+                break;
+        }
+    }
+}
+
+/* ================================================================
+ * emitHeader() — The "Received from" lines opening a datagram
+ * ================================================================
+ */
+static void emitHeader(OutBuffer *out, const DatagramSlot *datagram) {
+    char clientIP[INET_ADDRSTRLEN]; // IP address of client
+
+    // Convert client binary IP to string
+    inet_ntop(AF_INET, &datagram->source.sin_addr, clientIP, INET_ADDRSTRLEN);
+    if (tagGroups && datagram->destination.sin_family == AF_INET) {
+        char group[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &datagram->destination.sin_addr, group, INET_ADDRSTRLEN);
+        outPrintf(out, "Received from %s:%d on %s:%d\n", clientIP,
+                  ntohs(datagram->source.sin_port), group,
+                  ntohs(datagram->destination.sin_port));
+    }
+    else {
+        outPrintf(out, "Received from %s:%d\n", clientIP,
+                  ntohs(datagram->source.sin_port));
+    }
+    if (datagram->offset > 0) {
+        outPrintf(out, "Sender %08x, sequence %llu\n", datagram->envelope.senderId,
+                  (unsigned long long)datagram->envelope.sequence);
+    }
+    outPrintf(out, "=====================================================\n");
+}
+
+/* ================================================================
+ * skipSeparators() — Skip the whitespace before the next record
+ * ================================================================
+ */
+static const char *skipSeparators(const char *pos, const char *end) {
+    while (pos < end && (*pos == '\n' || *pos == '\r' ||
+                         *pos == ' ' || *pos == '\t')) {
+        pos++;
+    }
+    return pos;
+}
+
+/* ================================================================
+ * processDatagram() — Parse and display all records in a datagram
+ *
+ * cJSON_ParseWithOpts() with require_null_terminated = 0 stops at
+ * the end of the first JSON value and reports where via
+ * return_parse_end. Whitespace (including the '\n' separators) is
+ * skipped and parsing continues until the buffer is consumed, so
+ * single-record and packed datagrams go through the same loop.
+ *
+ * With --filter, each record is first checked on its raw text and
+ * skipped unparsed if it does not match; a datagram with no record
+ * left prints nothing.
+ *
+ * With --fields, records are not parsed into a tree at all:
+ * projectRecord() scans each one for the projected keys and skips
+ * everything else, and parseEnd comes from the scan instead.
+ *
+ * With --parser simd, the datagram is indexed once up front and
+ * each record is parsed from the index by jsonIndexParse(), which
+ * builds the same trees and stops at the same places.
+ *
+ * The datagram's output is one message in the thread's output
+ * buffer. If the output policy drops the message, records are still
+ * parsed and counted, but not formatted.
  * ================================================================ */
-int joinMulticastGroup(int sd, const char *multicastIP) {
-    struct ip_mreq mreq;
+int processDatagram(const DatagramSlot *datagram) {
+    OutBuffer *out = outCurrent(&sink);
+    const char *pos = datagram->data + datagram->offset;
+    const char *end = pos + datagram->length;
+    int total = 0;
+    long matched = 0;   // Filter verdicts, added to the totals once
+    long rejected = 0;
+    int headed = 0;     // Header written (only once a record is shown)
 
-    // Zero out multicast request structure
-    memset(&mreq, 0, sizeof(mreq));
+    int print = outBegin(out);
 
-    /*
-     * Fill in the multicast request structure
-     *  - imr_multiaddr: multicast group IP address
-     *  - imr_interface: which network interface to use
-     */
-    int result = inet_pton(AF_INET, multicastIP, &mreq.imr_multiaddr);
-    if (result == 0) {
-        fprintf(stderr, "joinMulticastGroup: invalid IP address format: %s\n",
-                multicastIP);
-        return -1;
-    } else if (result == -1) {
-        perror("inet_pton");
-        return -1;
+    if (twoStage) {
+        jsonIndexBuild(&parseIndex, pos, datagram->length);
     }
-    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
 
-    /*
-     * Join the multicast group
-     * 
-     * - IPPROTO_IP: IP Proctocol IPv4 level option
-     * - IP_ADD_MEMBERSHIP: Add multicast membership option
-     */
-    if (setsockopt(sd, IPPROTO_IP, IP_ADD_MEMBERSHIP,
-                   &mreq, sizeof(mreq)) == -1) {
-        perror("setsockopt IP_ADD_MEMBERSHIP");
-        return -1;
+    do {
+        const char *parseEnd = NULL;
+        cJSON *json = NULL;
+        Field fields[PROJECT_MAX_KEYS];
+        int fieldCount = 0;
+
+        /*
+         * Run the filter on the raw record first. A rejected record is
+         * never parsed; a malformed one goes on to the parser, which
+         * reports it.
+         */
+        if (filter.codeLength > 0) {
+            int verdict = filterMatch(&filter, pos, end, &parseEnd);
+            if (verdict == 0) {
+                rejected++;
+                pos = skipSeparators(parseEnd, end);
+                continue;
+            }
+            else if (verdict == 1) {
+                matched++;
+            }
+        }
+
+        // Scan the next record for the projected fields, or parse it whole
+        if (projection.count > 0) {
+            fieldCount = projectRecord(&projection, pos, end, fields, PROJECT_MAX_KEYS,
+                                       &parseEnd);
+        }
+        else if (twoStage) {
+            json = jsonIndexParse(&parseIndex, pos, &parseEnd);
+        }
+        else {
+            json = cJSON_ParseWithOpts(pos, &parseEnd, 0);
+        }
+        if (print && !headed) {
+            emitHeader(out, datagram);
+            headed = 1;
+        }
+        if (fieldCount == -1 || (projection.count == 0 && json == NULL)) {
+            if (print) {
+                outPrintf(out, "Invalid JSON received: %s\n", pos);
+                outPrintf(out, "=====================================================\n");
+            }
+            break;
+        }
+        total++;
+
+        // Format the parsed JSON, then free the tree
+        if (print) {
+            if (json != NULL) {
+                emitJSONObject(json, MODE_SERVER, 0, emitToBuffer, out);
+            }
+            else {
+                emitFields(out, fields, fieldCount);
+            }
+            outPrintf(out, "=====================================================\n");
+        }
+        cJSON_Delete(json);
+
+        pos = skipSeparators(parseEnd, end);
+    } while (pos < end);
+
+    if (headed) {
+        outPrintf(out, "\n");
     }
+    outEnd(out);
 
-    return 0;
-}
\ No newline at end of file
+    if (matched > 0 || rejected > 0) {
+        atomic_fetch_add(&filterMatched, matched);
+        atomic_fetch_add(&filterRejected, rejected);
+    }
+
+    if (latency != NULL && datagram->userNs != 0) {
+        uint64_t now = latencyNowNs();
+        latencyRecord(&latency[LAT_USER_TO_PROCESSED], (int64_t)(now - datagram->userNs));
+        if (datagram->offset > 0) {
+            latencyRecord(&latency[LAT_END_TO_END],
+                          (int64_t)(now - datagram->envelope.sendTimeNs));
+        }
+    }
+
+    // Reclaim every tree of this datagram (and any failed parse) at once
+    arenaResetCurrent();
+    return total;
+}
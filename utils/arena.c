@@ -0,0 +1,190 @@
+/* ================================================================
+ * arena.c — Per-Record Bump Allocator for cJSON
+ *
+ * A fixed block of memory handed out by bumping an offset. Plugged
+ * into cJSON through cJSON_InitHooks(), it serves every allocation
+ * made while one record is parsed or built; cJSON_Delete() then
+ * frees nothing and arenaReset() reclaims the whole record in O(1).
+ * ================================================================ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "../cJSON.h"
+#include "arena.h"
+
+// Maximum number of arenas alive at once (one per thread is typical).
+#define ARENA_MAX 64
+
+// Allocation alignment, enough for any C type.
+#define ARENA_ALIGN (sizeof(max_align_t))
+
+/*
+ * Registry of live arenas, so the free hook can tell arena memory
+ * from heap memory no matter which thread frees it. Slots are only
+ * written under the mutex; the free hook reads them without locking.
+ */
+static Arena *registry[ARENA_MAX];
+static pthread_mutex_t registryLock = PTHREAD_MUTEX_INITIALIZER;
+
+// The calling thread's allocation target.
+static __thread Arena *currentArena;
+
+/* ================================================================
+ * ownsPointer() — Whether `pointer` lies inside `arena`'s block
+ * ================================================================ */
+static int ownsPointer(const Arena *arena, const void *pointer) {
+    uintptr_t p = (uintptr_t)pointer;
+    uintptr_t base = (uintptr_t)arena->base;
+    return p >= base && p < base + arena->size;
+}
+
+/* ================================================================
+ * arenaInit() — Allocate and register the block
+ * ================================================================ */
+int arenaInit(Arena *arena, size_t size) {
+    arena->base = malloc(size);
+    arena->size = size;
+    arena->used = 0;
+    arena->highWater = 0;
+    arena->allocations = 0;
+    arena->heapFallbacks = 0;
+
+    if (arena->base == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&registryLock);
+    for (int i = 0; i < ARENA_MAX; i++) {
+        if (registry[i] == NULL) {
+            __atomic_store_n(&registry[i], arena, __ATOMIC_RELEASE);
+            pthread_mutex_unlock(&registryLock);
+            return 0;
+        }
+    }
+    pthread_mutex_unlock(&registryLock);
+
+    free(arena->base);
+    arena->base = NULL;
+    return -1;
+}
+
+/* ================================================================
+ * arenaAlloc() — Bump the offset, or NULL when out of room
+ * ================================================================ */
+void *arenaAlloc(Arena *arena, size_t size) {
+    size_t start = (arena->used + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    if (size > arena->size || start > arena->size - size) {
+        return NULL;
+    }
+
+    arena->used = start + size;
+    if (arena->used > arena->highWater) {
+        arena->highWater = arena->used;
+    }
+    arena->allocations++;
+
+    return arena->base + start;
+}
+
+/* ================================================================
+ * arenaReset() — Reclaim everything in O(1)
+ * ================================================================ */
+void arenaReset(Arena *arena) {
+    arena->used = 0;
+}
+
+/* ================================================================
+ * arenaFree() — Unregister and release the block
+ * ================================================================ */
+void arenaFree(Arena *arena) {
+    pthread_mutex_lock(&registryLock);
+    for (int i = 0; i < ARENA_MAX; i++) {
+        if (registry[i] == arena) {
+            __atomic_store_n(&registry[i], NULL, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&registryLock);
+
+    if (currentArena == arena) {
+        currentArena = NULL;
+    }
+
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+}
+
+/* ================================================================
+ * arenaSetCurrent() — Select the calling thread's arena
+ * ================================================================ */
+Arena *arenaSetCurrent(Arena *arena) {
+    Arena *previous = currentArena;
+    currentArena = arena;
+    return previous;
+}
+
+/* ================================================================
+ * arenaResetCurrent() — Reset the calling thread's arena
+ * ================================================================ */
+void arenaResetCurrent(void) {
+    if (currentArena != NULL) {
+        arenaReset(currentArena);
+    }
+}
+
+/* ================================================================
+ * hookMalloc() — cJSON allocation hook
+ *
+ * Oversized requests (or a full arena) fall back to the heap, so a
+ * huge datagram still parses; only the speedup is lost.
+ * ================================================================ */
+static void *hookMalloc(size_t size) {
+    Arena *arena = currentArena;
+
+    if (arena != NULL) {
+        void *pointer = arenaAlloc(arena, size);
+        if (pointer != NULL) {
+            return pointer;
+        }
+        arena->heapFallbacks++;
+    }
+
+    return malloc(size);
+}
+
+/* ================================================================
+ * hookFree() — cJSON free hook
+ *
+ * The calling thread's arena is checked first (the common case),
+ * then every registered arena, before handing the pointer to free().
+ * ================================================================ */
+static void hookFree(void *pointer) {
+    if (pointer == NULL) {
+        return;
+    }
+
+    Arena *arena = currentArena;
+    if (arena != NULL && ownsPointer(arena, pointer)) {
+        return;
+    }
+
+    for (int i = 0; i < ARENA_MAX; i++) {
+        Arena *other = __atomic_load_n(&registry[i], __ATOMIC_ACQUIRE);
+        if (other != NULL && ownsPointer(other, pointer)) {
+            return;
+        }
+    }
+
+    free(pointer);
+}
+
+/* ================================================================
+ * arenaInstallHooks() — Route cJSON allocations through the arenas
+ * ================================================================ */
+void arenaInstallHooks(void) {
+    cJSON_Hooks hooks = { hookMalloc, hookFree };
+    cJSON_InitHooks(&hooks);
+}
@@ -0,0 +1,95 @@
+/* ================================================================
+ * arena.h — Per-Record Bump Allocator for cJSON
+ *
+ * A fixed block of memory handed out by bumping an offset. Plugged
+ * into cJSON through cJSON_InitHooks(), it serves every allocation
+ * made while one record is parsed or built; cJSON_Delete() then
+ * frees nothing and arenaReset() reclaims the whole record in O(1).
+ *
+ * Each thread selects its own arena with arenaSetCurrent(), so
+ * multithreaded receivers never share one.
+ * ================================================================ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Default arena size: comfortably holds the tree of a maximum-size datagram.
+#define ARENA_DEFAULT_SIZE (1024 * 1024)
+
+/* ================================================================
+ * Arena struct:
+ * One contiguous block and a bump offset.
+ *
+ *  - base / size: the block
+ *  - used: bytes handed out since the last reset
+ *  - highWater: most bytes ever in use at once
+ *  - heapFallbacks: requests that did not fit and went to malloc()
+ * ================================================================ */
+typedef struct {
+    char *base;             // Start of the block
+    size_t size;            // Block size in bytes
+    size_t used;            // Bump offset
+    size_t highWater;       // Peak of `used`
+    long allocations;       // Requests served from the block
+    long heapFallbacks;     // Requests served by malloc()
+} Arena;
+
+/* ================================================================
+ * arenaInit():
+ * Allocate a `size`-byte block and register it so the cJSON free
+ * hook can recognize its pointers.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on allocation failure or too many arenas
+ * ================================================================ */
+int arenaInit(Arena *arena, size_t size);
+
+/* ================================================================
+ * arenaAlloc():
+ * Returns `size` bytes aligned for any type, or NULL if the block
+ * does not have room left.
+ * ================================================================ */
+void *arenaAlloc(Arena *arena, size_t size);
+
+/* ================================================================
+ * arenaReset():
+ * Releases everything allocated from the arena in O(1). Any cJSON
+ * tree built in it must already have been passed to cJSON_Delete().
+ * ================================================================ */
+void arenaReset(Arena *arena);
+
+/* ================================================================
+ * arenaFree():
+ * Unregisters the arena and releases its block.
+ * ================================================================ */
+void arenaFree(Arena *arena);
+
+/* ================================================================
+ * arenaSetCurrent():
+ * Makes `arena` the calling thread's allocation target for cJSON
+ * (NULL = plain heap). Returns the previous one.
+ * ================================================================ */
+Arena *arenaSetCurrent(Arena *arena);
+
+/* ================================================================
+ * arenaResetCurrent():
+ * arenaReset() on the calling thread's current arena, if any.
+ * ================================================================ */
+void arenaResetCurrent(void);
+
+/* ================================================================
+ * arenaInstallHooks():
+ * Routes cJSON's allocations through the arenas with
+ * cJSON_InitHooks(). Call once at startup, before any cJSON use.
+ *
+ * Allocation: from the calling thread's current arena, or malloc()
+ *             if there is none or the request does not fit.
+ * Free: a no-op for pointers inside any registered arena,
+ *       free() for everything else.
+ * ================================================================ */
+void arenaInstallHooks(void);
+
+#endif /* ARENA_H */
@@ -0,0 +1,63 @@
+/* ================================================================
+ * envelope.c — Sequence-Numbered Datagram Envelope
+ *
+ * Encodes and decodes the 24-byte big-endian envelope header.
+ * ================================================================ */
+
+#include <string.h>
+#include <time.h>
+#include <endian.h>
+#include "envelope.h"
+
+/* ================================================================
+ * envelopeEncode() — Write the header in network byte order
+ * ================================================================ */
+void envelopeEncode(char *out, const Envelope *env) {
+    uint16_t magic = htobe16(ENVELOPE_MAGIC);
+    uint32_t senderId = htobe32(env->senderId);
+    uint64_t sequence = htobe64(env->sequence);
+    uint64_t sendTime = htobe64(env->sendTimeNs);
+
+    memcpy(out, &magic, 2);
+    out[2] = ENVELOPE_VERSION;
+    out[3] = (char)env->flags;
+    memcpy(out + 4, &senderId, 4);
+    memcpy(out + 8, &sequence, 8);
+    memcpy(out + 16, &sendTime, 8);
+}
+
+/* ================================================================
+ * envelopeDecode() — Recognize and read the header
+ * ================================================================ */
+EnvelopeStatus envelopeDecode(const char *data, size_t length, Envelope *env) {
+    if (length < 2 || (unsigned char)data[0] != (ENVELOPE_MAGIC >> 8) ||
+        (unsigned char)data[1] != (ENVELOPE_MAGIC & 0xFF)) {
+        return ENVELOPE_NONE;
+    }
+    if (length < ENVELOPE_SIZE || data[2] != ENVELOPE_VERSION) {
+        return ENVELOPE_BAD;
+    }
+
+    uint32_t senderId;
+    uint64_t sequence;
+    uint64_t sendTime;
+    memcpy(&senderId, data + 4, 4);
+    memcpy(&sequence, data + 8, 8);
+    memcpy(&sendTime, data + 16, 8);
+
+    env->version = (uint8_t)data[2];
+    env->flags = (uint8_t)data[3];
+    env->senderId = be32toh(senderId);
+    env->sequence = be64toh(sequence);
+    env->sendTimeNs = be64toh(sendTime);
+    return ENVELOPE_OK;
+}
+
+/* ================================================================
+ * envelopeNowNs() — Current CLOCK_REALTIME time in nanoseconds
+ * ================================================================ */
+uint64_t envelopeNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
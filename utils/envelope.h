@@ -0,0 +1,72 @@
+/* ================================================================
+ * envelope.h — Sequence-Numbered Datagram Envelope
+ *
+ * An optional fixed 24-byte header in front of a datagram's JSON
+ * payload, so a receiver can detect loss, duplication and
+ * reordering without looking at the JSON:
+ *
+ *   offset  size  field
+ *        0     2  magic 0xC0DE
+ *        2     1  version (1)
+ *        3     1  flags (0, reserved)
+ *        4     4  sender ID
+ *        8     8  sequence number (per sender, from 0)
+ *       16     8  send time, CLOCK_REALTIME nanoseconds
+ *
+ * All fields are big-endian. 0xC0 can never start JSON text (it is
+ * not even valid UTF-8), so enveloped and plain datagrams can be
+ * told apart from the first byte.
+ * ================================================================ */
+
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ENVELOPE_MAGIC 0xC0DE
+#define ENVELOPE_VERSION 1
+#define ENVELOPE_SIZE 24
+
+/* ================================================================
+ * Envelope struct:
+ * The decoded header fields.
+ * ================================================================ */
+typedef struct {
+    uint8_t version;            // Format version
+    uint8_t flags;              // Reserved, 0
+    uint32_t senderId;          // Identifies one sending stream
+    uint64_t sequence;          // Datagram number within the stream
+    uint64_t sendTimeNs;        // CLOCK_REALTIME when sent
+} Envelope;
+
+/* ================================================================
+ * EnvelopeStatus enum:
+ * What envelopeDecode() found at the start of a datagram.
+ * ================================================================ */
+typedef enum {
+    ENVELOPE_NONE,              // Plain datagram, no envelope
+    ENVELOPE_OK,                // Envelope decoded
+    ENVELOPE_BAD                // Magic present, but truncated or unknown version
+} EnvelopeStatus;
+
+/* ================================================================
+ * envelopeEncode():
+ * Writes the ENVELOPE_SIZE-byte header for `env` to `out`
+ * (version and magic are filled in).
+ * ================================================================ */
+void envelopeEncode(char *out, const Envelope *env);
+
+/* ================================================================
+ * envelopeDecode():
+ * Checks the start of a datagram for an envelope and decodes it.
+ * ================================================================ */
+EnvelopeStatus envelopeDecode(const char *data, size_t length, Envelope *env);
+
+/* ================================================================
+ * envelopeNowNs():
+ * Returns the current CLOCK_REALTIME time in nanoseconds.
+ * ================================================================ */
+uint64_t envelopeNowNs(void);
+
+#endif /* ENVELOPE_H */
@@ -0,0 +1,498 @@
+/* ================================================================
+ * filter.c — Record Filter Expressions
+ *
+ * A recursive-descent compiler turns the expression into a flat
+ * program for a one-register machine: each comparison becomes a
+ * TEST, and && / || become conditional jumps over their right-hand
+ * side, so evaluation short-circuits without a stack. At run time
+ * the record is scanned once for the keys the program needs and
+ * the program runs over those fields.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include "filter.h"
+
+// Values up to this long are unescaped on the stack, longer ones on the heap.
+#define VALUE_STACK_MAX 1024
+
+// Longest number text converted, suffix included.
+#define NUMBER_MAX 64
+
+/* ================================================================
+ * Parser struct:
+ * Compiler state: the expression, the read position, and the
+ * filter being filled in.
+ * ================================================================ */
+typedef struct {
+    const char *text;
+    const char *pos;
+    Filter *filter;
+} Parser;
+
+static int parseOr(Parser *parser);
+
+/* ================================================================
+ * parseSize() — A number with an optional B/KB/MB/GB/TB suffix
+ *
+ * The whole text must be used: leading and trailing spaces are
+ * allowed, anything else is not.
+ *
+ * Returns: 0 with *value set, or -1
+ * ================================================================ */
+static int parseSize(const char *text, size_t length, double *value) {
+    static const struct {
+        const char *suffix;
+        double scale;
+    } units[] = {
+        { "B", 1.0 },
+        { "KB", 1024.0 },
+        { "MB", 1024.0 * 1024 },
+        { "GB", 1024.0 * 1024 * 1024 },
+        { "TB", 1024.0 * 1024 * 1024 * 1024 },
+    };
+    char number[NUMBER_MAX];
+    char *end;
+
+    if (length == 0 || length >= sizeof(number)) {
+        return -1;
+    }
+    memcpy(number, text, length);
+    number[length] = '\0';
+
+    *value = strtod(number, &end);
+    if (end == number) {
+        return -1;
+    }
+    while (*end == ' ') {
+        end++;
+    }
+
+    char *suffix = end;
+    while (isalpha((unsigned char)*end)) {
+        end++;
+    }
+    if (end > suffix) {
+        size_t suffixLength = (size_t)(end - suffix);
+        size_t i;
+        for (i = 0; i < sizeof(units) / sizeof(units[0]); i++) {
+            if (strlen(units[i].suffix) == suffixLength &&
+                strncasecmp(suffix, units[i].suffix, suffixLength) == 0) {
+                *value *= units[i].scale;
+                break;
+            }
+        }
+        if (i == sizeof(units) / sizeof(units[0])) {
+            return -1;
+        }
+    }
+
+    while (*end == ' ') {
+        end++;
+    }
+    return *end == '\0' ? 0 : -1;
+}
+
+/* ================================================================
+ * syntaxError() — Report a compile error at the parser's position
+ * ================================================================ */
+static int syntaxError(Parser *parser, const char *message) {
+    printf("Error: Filter: %s at column %d\n", message,
+           (int)(parser->pos - parser->text) + 1);
+    return -1;
+}
+
+/* ================================================================
+ * skipSpace() / accept() — Tokenizer helpers
+ *
+ * accept() consumes `token` if the input continues with it.
+ * ================================================================ */
+static void skipSpace(Parser *parser) {
+    while (isspace((unsigned char)*parser->pos)) {
+        parser->pos++;
+    }
+}
+
+static int accept(Parser *parser, const char *token) {
+    size_t length = strlen(token);
+
+    skipSpace(parser);
+    if (strncmp(parser->pos, token, length) == 0) {
+        parser->pos += length;
+        return 1;
+    }
+    return 0;
+}
+
+/* ================================================================
+ * emit() — Append one instruction
+ *
+ * Returns: its address, or -1 when the program is full
+ * ================================================================ */
+static int emit(Parser *parser, FilterOp op, int arg) {
+    Filter *filter = parser->filter;
+
+    if (filter->codeLength == FILTER_MAX_CODE) {
+        return syntaxError(parser, "expression too long");
+    }
+    filter->code[filter->codeLength].op = op;
+    filter->code[filter->codeLength].arg = arg;
+    return filter->codeLength++;
+}
+
+/* ================================================================
+ * parseLiteral() — "string", number[suffix], true, false or null
+ * ================================================================ */
+static int parseLiteral(Parser *parser, Condition *condition) {
+    skipSpace(parser);
+    const char *start = parser->pos;
+
+    if (*start == '"') {
+        // \" and \\ are the only escapes; the result is the bytes compared
+        size_t capacity = strlen(start);
+        char *text = malloc(capacity + 1);
+        size_t length = 0;
+        const char *pos = start + 1;
+
+        if (text == NULL) {
+            return syntaxError(parser, "out of memory");
+        }
+        while (*pos != '\0' && *pos != '"') {
+            if (*pos == '\\' && (pos[1] == '"' || pos[1] == '\\')) {
+                pos++;
+            }
+            text[length++] = *pos++;
+        }
+        if (*pos != '"') {
+            free(text);
+            return syntaxError(parser, "unterminated string");
+        }
+        text[length] = '\0';
+        parser->pos = pos + 1;
+        condition->literal = FIELD_STRING;
+        condition->text = text;
+        condition->length = length;
+        return 0;
+    }
+
+    if (accept(parser, "true")) {
+        condition->literal = FIELD_TRUE;
+        return 0;
+    }
+    if (accept(parser, "false")) {
+        condition->literal = FIELD_FALSE;
+        return 0;
+    }
+    if (accept(parser, "null")) {
+        condition->literal = FIELD_NULL;
+        return 0;
+    }
+
+    // A number runs up to the next space, operator or parenthesis
+    const char *end = start;
+    while (*end != '\0' && !isspace((unsigned char)*end) && strchr("()&|!=<>", *end) == NULL) {
+        end++;
+    }
+    if (end == start || parseSize(start, (size_t)(end - start), &condition->number) == -1) {
+        return syntaxError(parser, "expected a string, number, true, false or null");
+    }
+    parser->pos = end;
+    condition->literal = FIELD_NUMBER;
+    return 0;
+}
+
+/* ================================================================
+ * parseCondition() — key [op literal]
+ * ================================================================ */
+static int parseCondition(Parser *parser) {
+    static const struct {
+        const char *token;
+        CompareOp op;
+    } operators[] = {
+        // Two-character operators first, so "<=" is not read as "<"
+        { "==", CMP_EQ }, { "!=", CMP_NE }, { "<=", CMP_LE }, { ">=", CMP_GE },
+        { "<", CMP_LT }, { ">", CMP_GT },
+    };
+    Filter *filter = parser->filter;
+
+    skipSpace(parser);
+    const char *key = parser->pos;
+    while (isalnum((unsigned char)*parser->pos) || *parser->pos == '_' ||
+           *parser->pos == '-' || *parser->pos == '.') {
+        parser->pos++;
+    }
+    if (parser->pos == key) {
+        return syntaxError(parser, "expected a key");
+    }
+    if (filter->conditionCount == FILTER_MAX_CONDITIONS) {
+        return syntaxError(parser, "too many comparisons");
+    }
+
+    Condition *condition = &filter->conditions[filter->conditionCount];
+    memset(condition, 0, sizeof(*condition));
+    condition->key = projectionAdd(&filter->keys, key, (size_t)(parser->pos - key));
+    if (condition->key == -1) {
+        return syntaxError(parser, "bad key");
+    }
+    filter->conditionCount++;
+
+    condition->op = CMP_EXISTS;
+    for (size_t i = 0; i < sizeof(operators) / sizeof(operators[0]); i++) {
+        if (accept(parser, operators[i].token)) {
+            condition->op = operators[i].op;
+            if (parseLiteral(parser, condition) == -1) {
+                return -1;
+            }
+            break;
+        }
+    }
+
+    // Strings order byte-wise and numbers numerically; the rest only (in)equal
+    if ((condition->literal == FIELD_TRUE || condition->literal == FIELD_FALSE ||
+         condition->literal == FIELD_NULL) &&
+        condition->op != CMP_EQ && condition->op != CMP_NE) {
+        return syntaxError(parser, "true, false and null only compare with == and !=");
+    }
+
+    return emit(parser, FOP_TEST, filter->conditionCount - 1) == -1 ? -1 : 0;
+}
+
+/* ================================================================
+ * parseUnary() — !unary | ( or ) | condition
+ * ================================================================ */
+static int parseUnary(Parser *parser) {
+    if (accept(parser, "!")) {
+        if (parseUnary(parser) == -1) {
+            return -1;
+        }
+        return emit(parser, FOP_NOT, 0) == -1 ? -1 : 0;
+    }
+    if (accept(parser, "(")) {
+        if (parseOr(parser) == -1) {
+            return -1;
+        }
+        if (!accept(parser, ")")) {
+            return syntaxError(parser, "expected ')'");
+        }
+        return 0;
+    }
+    return parseCondition(parser);
+}
+
+/* ================================================================
+ * parseAnd() / parseOr() — Short-circuit chains
+ *
+ * a && b compiles to: [a] JUMP_IF_FALSE end [b] end:
+ * so b only runs when a held, and a false a is the result. || is
+ * the same with JUMP_IF_TRUE.
+ * ================================================================ */
+static int parseAnd(Parser *parser) {
+    if (parseUnary(parser) == -1) {
+        return -1;
+    }
+    while (accept(parser, "&&")) {
+        int jump = emit(parser, FOP_JUMP_IF_FALSE, 0);
+        if (jump == -1 || parseUnary(parser) == -1) {
+            return -1;
+        }
+        parser->filter->code[jump].arg = parser->filter->codeLength;
+    }
+    return 0;
+}
+
+static int parseOr(Parser *parser) {
+    if (parseAnd(parser) == -1) {
+        return -1;
+    }
+    while (accept(parser, "||")) {
+        int jump = emit(parser, FOP_JUMP_IF_TRUE, 0);
+        if (jump == -1 || parseAnd(parser) == -1) {
+            return -1;
+        }
+        parser->filter->code[jump].arg = parser->filter->codeLength;
+    }
+    return 0;
+}
+
+/* ================================================================
+ * filterCompile() — Parse the whole expression
+ * ================================================================ */
+int filterCompile(Filter *filter, const char *text) {
+    Parser parser = { text, text, filter };
+
+    memset(filter, 0, sizeof(*filter));
+    if (parseOr(&parser) == -1) {
+        filterFree(filter);
+        return -1;
+    }
+    skipSpace(&parser);
+    if (*parser.pos != '\0') {
+        syntaxError(&parser, "unexpected text");
+        filterFree(filter);
+        return -1;
+    }
+
+    filter->source = strdup(text);
+    if (filter->source == NULL) {
+        perror("strdup");
+        filterFree(filter);
+        return -1;
+    }
+    return 0;
+}
+
+/* ================================================================
+ * compare() — Apply `op` to a three-way comparison result
+ * ================================================================ */
+static int compare(CompareOp op, int order) {
+    switch (op) {
+        case CMP_EQ: return order == 0;
+        case CMP_NE: return order != 0;
+        case CMP_LT: return order < 0;
+        case CMP_LE: return order <= 0;
+        case CMP_GT: return order > 0;
+        case CMP_GE: return order >= 0;
+        default:     return 1;
+    }
+}
+
+/* ================================================================
+ * testCondition() — Evaluate one comparison against a field
+ *
+ * `field` is NULL when the record lacks the key. A value of the
+ * wrong type is unequal to the literal and not ordered against it.
+ * ================================================================ */
+static int testCondition(const Condition *condition, const Field *field) {
+    if (field == NULL) {
+        return 0;
+    }
+    if (condition->op == CMP_EXISTS) {
+        return 1;
+    }
+
+    if (condition->literal == FIELD_TRUE || condition->literal == FIELD_FALSE ||
+        condition->literal == FIELD_NULL) {
+        return compare(condition->op, field->type == condition->literal ? 0 : 1);
+    }
+    if (condition->literal == FIELD_NUMBER && field->type == FIELD_NUMBER) {
+        double value = fieldNumber(field);
+        return compare(condition->op, (value > condition->number) - (value < condition->number));
+    }
+    if (field->type != FIELD_STRING) {
+        return condition->op == CMP_NE;
+    }
+
+    // String value: unescape (only if needed) and drop enclosing quotes
+    char stack[VALUE_STACK_MAX];
+    char *heap = NULL;
+    const char *text = field->value;
+    size_t length = field->length;
+
+    if (field->escaped) {
+        char *buffer = stack;
+        if (field->length >= sizeof(stack)) {
+            buffer = heap = malloc(field->length + 1);
+            if (heap == NULL) {
+                return 0;
+            }
+        }
+        int decoded = fieldString(field, buffer);
+        if (decoded == -1) {
+            free(heap);
+            return 0;
+        }
+        text = buffer;
+        length = (size_t)decoded;
+    }
+    if (length >= 2 && text[0] == '"' && text[length - 1] == '"') {
+        text++;
+        length -= 2;
+    }
+
+    int result;
+    if (condition->literal == FIELD_NUMBER) {
+        double value;
+        if (parseSize(text, length, &value) == -1) {
+            result = condition->op == CMP_NE;
+        }
+        else {
+            result = compare(condition->op, (value > condition->number) -
+                                            (value < condition->number));
+        }
+    }
+    else {
+        size_t common = length < condition->length ? length : condition->length;
+        int order = memcmp(text, condition->text, common);
+        if (order == 0) {
+            order = (length > condition->length) - (length < condition->length);
+        }
+        result = compare(condition->op, order);
+    }
+
+    free(heap);
+    return result;
+}
+
+/* ================================================================
+ * filterMatch() — Scan the record, then run the program
+ * ================================================================ */
+int filterMatch(const Filter *filter, const char *pos, const char *end,
+                const char **recordEnd) {
+    Field fields[PROJECT_MAX_KEYS];
+    const Field *byKey[PROJECT_MAX_KEYS];
+
+    int count = projectRecord(&filter->keys, pos, end, fields, PROJECT_MAX_KEYS, recordEnd);
+    if (count == -1) {
+        return -1;
+    }
+
+    // Walk backwards so the first occurrence of a key wins
+    memset(byKey, 0, (size_t)filter->keys.count * sizeof(byKey[0]));
+    for (int i = count - 1; i >= 0; i--) {
+        byKey[fields[i].key] = &fields[i];
+    }
+
+    int value = 0;
+    int pc = 0;
+    while (pc < filter->codeLength) {
+        const FilterInstr *instr = &filter->code[pc++];
+        switch (instr->op) {
+            case FOP_TEST: {
+                const Condition *condition = &filter->conditions[instr->arg];
+                value = testCondition(condition, byKey[condition->key]);
+                break;
+            }
+            case FOP_NOT:
+                value = !value;
+                break;
+            case FOP_JUMP_IF_FALSE:
+                if (!value) {
+                    pc = instr->arg;
+                }
+                break;
+            case FOP_JUMP_IF_TRUE:
+                if (value) {
+                    pc = instr->arg;
+                }
+                break;
+        }
+    }
+    return value;
+}
+
+/* ================================================================
+ * filterFree() — Release everything the compiler allocated
+ * ================================================================ */
+void filterFree(Filter *filter) {
+    for (int i = 0; i < filter->conditionCount; i++) {
+        free(filter->conditions[i].text);
+    }
+    projectionFree(&filter->keys);
+    free(filter->source);
+    filter->conditionCount = 0;
+    filter->codeLength = 0;
+    filter->source = NULL;
+}
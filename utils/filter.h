@@ -0,0 +1,135 @@
+/* ================================================================
+ * filter.h — Record Filter Expressions
+ *
+ * A small predicate language over a record's top-level keys,
+ * compiled once into bytecode and evaluated against the raw JSON
+ * text of each record, so records that do not match can be dropped
+ * before they are parsed:
+ *
+ *   File_Type == "Video" && (File_Size > 100MB || !Description)
+ *
+ *  - comparisons: key == != < <= > >= literal
+ *  - literals: "string", number (with an optional B/KB/MB/GB/TB
+ *    suffix, powers of 1024), true, false, null
+ *  - a bare key tests that the record has it
+ *  - combined with !, &&, || and parentheses (usual precedence)
+ * ================================================================ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "projection.h"
+
+// Most comparisons, and bytecode instructions, in one expression.
+#define FILTER_MAX_CONDITIONS 64
+#define FILTER_MAX_CODE 256
+
+/* ================================================================
+ * CompareOp enum:
+ * What a condition checks.
+ * ================================================================ */
+typedef enum {
+    CMP_EXISTS,     // The key is present
+    CMP_EQ,
+    CMP_NE,
+    CMP_LT,
+    CMP_LE,
+    CMP_GT,
+    CMP_GE
+} CompareOp;
+
+/* ================================================================
+ * Condition struct:
+ * One comparison of a key against a literal.
+ *
+ *  - key: index into the filter's key projection
+ *  - literal: FIELD_STRING, FIELD_NUMBER, FIELD_TRUE, FIELD_FALSE or
+ *    FIELD_NULL; text/length hold a string, number a number
+ * ================================================================ */
+typedef struct {
+    int key;
+    CompareOp op;
+    FieldType literal;
+    char *text;
+    size_t length;
+    double number;
+} Condition;
+
+/* ================================================================
+ * FilterOp enum / FilterInstr struct:
+ * Bytecode. The machine has one boolean register; TEST sets it, NOT
+ * flips it, and the jumps implement short-circuit && and ||.
+ * ================================================================ */
+typedef enum {
+    FOP_TEST,           // value = condition[arg]
+    FOP_NOT,            // value = !value
+    FOP_JUMP_IF_FALSE,  // if (!value) goto arg
+    FOP_JUMP_IF_TRUE    // if (value) goto arg
+} FilterOp;
+
+typedef struct {
+    FilterOp op;
+    int arg;
+} FilterInstr;
+
+/* ================================================================
+ * Filter struct:
+ * A compiled expression.
+ *
+ *  - keys: every key the expression names, scanned for in one pass
+ *  - conditions / code: the comparisons and the program using them
+ *  - source: the expression text, for reports
+ * ================================================================ */
+typedef struct {
+    Projection keys;
+    Condition conditions[FILTER_MAX_CONDITIONS];
+    int conditionCount;
+    FilterInstr code[FILTER_MAX_CODE];
+    int codeLength;
+    char *source;
+} Filter;
+
+/* ================================================================
+ * filterCompile():
+ * Parses and compiles `text` into *filter.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on a syntax error or a limit exceeded (message printed
+ *    with the column of the problem)
+ * ================================================================ */
+int filterCompile(Filter *filter, const char *text);
+
+/* ================================================================
+ * filterMatch():
+ * Evaluates the filter against the JSON object at `pos` (need not
+ * be null-terminated). The record is scanned once with
+ * projectRecord(), collecting only the keys the filter names.
+ *
+ * Comparisons against a missing key are false; against a value of
+ * another type, only != is true. Strings compare
+ * byte-wise after unescaping; a value wrapped in literal double
+ * quotes (a quoted value in the client's key:value input) is
+ * compared without them. Numeric comparisons also accept string
+ * values holding a number with an optional size suffix ("12KB").
+ * Keys match case-sensitively; a repeated key is judged by its
+ * first occurrence, the one cJSON_GetObjectItemCaseSensitive()
+ * would find.
+ *
+ * On success *recordEnd points just past the record.
+ *
+ * Returns:
+ *  - 1 if the record matches
+ *  - 0 if it does not
+ *  - -1 if the record is not a well-formed object
+ * ================================================================ */
+int filterMatch(const Filter *filter, const char *pos, const char *end,
+                const char **recordEnd);
+
+/* ================================================================
+ * filterFree():
+ * Releases the keys, string literals and source text.
+ * ================================================================ */
+void filterFree(Filter *filter);
+
+#endif /* FILTER_H */
@@ -0,0 +1,732 @@
+/* ================================================================
+ * jsonindex.c — Two-Stage JSON Parser
+ *
+ * Stage 1 turns each 64-byte block into bitmasks (one bit per byte)
+ * and derives the structural characters from them without
+ * branching on the data:
+ *
+ *  - escaped: bytes preceded by an odd run of backslashes, found
+ *    with one carrying add per block
+ *  - in string: prefix XOR of the unescaped quotes (set from an
+ *    opening quote up to, not including, the closing one)
+ *  - structurals: brackets, ':' and ',' outside strings, every
+ *    unescaped quote, and the first byte of each run of other
+ *    characters outside strings (a number or literal)
+ *
+ * Stage 2 is a recursive descent over the positions instead of the
+ * bytes, building cJSON nodes exactly as cJSON's parse_value() would.
+ * ================================================================ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "jsonindex.h"
+#include "projection.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define INDEX_X86 1
+#include <immintrin.h>
+#endif
+
+#define BLOCK_SIZE 64
+#define EVEN_BITS 0x5555555555555555ULL
+
+// Longest number converted here; longer ones are left to cJSON.
+#define NUMBER_MAX 64
+
+/* ================================================================
+ * BlockMasks struct:
+ * One bit per byte of a 64-byte block for each character class.
+ * "space" is every byte up to 0x20, cJSON's notion of whitespace.
+ * ================================================================ */
+typedef struct {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;        // { } [ ] : ,
+    uint64_t space;
+} BlockMasks;
+
+/* ================================================================
+ * IndexState struct:
+ * What carries from one block into the next.
+ *
+ *  - escaped: the next block's first byte is escaped (0 or 1)
+ *  - inString: all ones if the block ended inside a string
+ *  - scalar: the block ended inside a number or literal (0 or 1)
+ * ================================================================ */
+typedef struct {
+    uint64_t escaped;
+    uint64_t inString;
+    uint64_t scalar;
+} IndexState;
+
+/*
+ * Character classes for the scalar implementation.
+ */
+#define CLASS_QUOTE     0x01
+#define CLASS_BACKSLASH 0x02
+#define CLASS_OP        0x04
+#define CLASS_SPACE     0x08
+
+static const uint8_t classTable[256] = {
+    [0x00] = CLASS_SPACE, [0x01] = CLASS_SPACE, [0x02] = CLASS_SPACE, [0x03] = CLASS_SPACE,
+    [0x04] = CLASS_SPACE, [0x05] = CLASS_SPACE, [0x06] = CLASS_SPACE, [0x07] = CLASS_SPACE,
+    [0x08] = CLASS_SPACE, [0x09] = CLASS_SPACE, [0x0A] = CLASS_SPACE, [0x0B] = CLASS_SPACE,
+    [0x0C] = CLASS_SPACE, [0x0D] = CLASS_SPACE, [0x0E] = CLASS_SPACE, [0x0F] = CLASS_SPACE,
+    [0x10] = CLASS_SPACE, [0x11] = CLASS_SPACE, [0x12] = CLASS_SPACE, [0x13] = CLASS_SPACE,
+    [0x14] = CLASS_SPACE, [0x15] = CLASS_SPACE, [0x16] = CLASS_SPACE, [0x17] = CLASS_SPACE,
+    [0x18] = CLASS_SPACE, [0x19] = CLASS_SPACE, [0x1A] = CLASS_SPACE, [0x1B] = CLASS_SPACE,
+    [0x1C] = CLASS_SPACE, [0x1D] = CLASS_SPACE, [0x1E] = CLASS_SPACE, [0x1F] = CLASS_SPACE,
+    [' ']  = CLASS_SPACE,
+    ['"']  = CLASS_QUOTE,
+    ['\\'] = CLASS_BACKSLASH,
+    ['{']  = CLASS_OP, ['}'] = CLASS_OP,
+    ['[']  = CLASS_OP, [']'] = CLASS_OP,
+    [':']  = CLASS_OP, [','] = CLASS_OP,
+};
+
+/* ================================================================
+ * scalarClassify() — One byte at a time through the class table
+ * ================================================================ */
+static inline void scalarClassify(const uint8_t *block, BlockMasks *masks) {
+    uint64_t quote = 0, backslash = 0, op = 0, space = 0;
+
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        uint64_t bit = 1ULL << i;
+        uint8_t class = classTable[block[i]];
+        quote |= (class & CLASS_QUOTE) ? bit : 0;
+        backslash |= (class & CLASS_BACKSLASH) ? bit : 0;
+        op |= (class & CLASS_OP) ? bit : 0;
+        space |= (class & CLASS_SPACE) ? bit : 0;
+    }
+
+    masks->quote = quote;
+    masks->backslash = backslash;
+    masks->op = op;
+    masks->space = space;
+}
+
+#ifdef INDEX_X86
+
+/* ================================================================
+ * sse2Classify() — Four 16-byte compares per class
+ *
+ * OR-ing 0x20 folds '[' onto '{' and ']' onto '}' (and nothing else
+ * onto either), so brackets take two compares instead of four.
+ * Bytes up to 0x20 are those equal to min(byte, 0x20), unsigned.
+ * ================================================================ */
+static inline void sse2Classify(const uint8_t *block, BlockMasks *masks) {
+    uint64_t quote = 0, backslash = 0, op = 0, space = 0;
+
+    for (int i = 0; i < BLOCK_SIZE; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(block + i));
+        __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i brackets = _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                        _mm_cmpeq_epi8(folded, _mm_set1_epi8('}')));
+        __m128i punctuation = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')),
+                                           _mm_cmpeq_epi8(v, _mm_set1_epi8(',')));
+        __m128i blank = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x20)), v);
+
+        quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << i;
+        backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << i;
+        op |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_or_si128(brackets, punctuation)) << i;
+        space |= (uint64_t)(uint16_t)_mm_movemask_epi8(blank) << i;
+    }
+
+    masks->quote = quote;
+    masks->backslash = backslash;
+    masks->op = op;
+    masks->space = space;
+}
+
+/* ================================================================
+ * avx2Classify() — Same as sse2Classify(), 32 bytes wide
+ *
+ * Compiled for AVX2 with a target attribute, like scan.c, and only
+ * selected after __builtin_cpu_supports("avx2").
+ * ================================================================ */
+__attribute__((target("avx2")))
+static inline void avx2Classify(const uint8_t *block, BlockMasks *masks) {
+    uint64_t quote = 0, backslash = 0, op = 0, space = 0;
+
+    for (int i = 0; i < BLOCK_SIZE; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(block + i));
+        __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i brackets = _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                                           _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}')));
+        __m256i punctuation = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                                              _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')));
+        __m256i blank = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x20)), v);
+
+        quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))) << i;
+        backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))) << i;
+        op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_or_si256(brackets, punctuation)) << i;
+        space |= (uint64_t)(uint32_t)_mm256_movemask_epi8(blank) << i;
+    }
+
+    masks->quote = quote;
+    masks->backslash = backslash;
+    masks->op = op;
+    masks->space = space;
+}
+
+#endif /* INDEX_X86 */
+
+/* ================================================================
+ * prefixXor() — Bit i becomes the XOR of bits 0..i
+ * ================================================================ */
+static inline uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+/* ================================================================
+ * blockStructurals() — Structural characters of one block
+ *
+ * Escapes: a backslash run that starts on an even bit ends in an
+ * escaped byte if its length is odd, which shows up as the carry of
+ * run + start landing on an odd bit (and vice versa for odd
+ * starts). Adding the odd starts to the runs and XOR-ing with the
+ * even bits marks exactly the bytes following an odd run.
+ * ================================================================ */
+static inline uint64_t blockStructurals(const BlockMasks *masks, IndexState *state) {
+    uint64_t backslash = masks->backslash & ~state->escaped;
+    uint64_t followsEscape = (backslash << 1) | state->escaped;
+    uint64_t oddStarts = backslash & ~EVEN_BITS & ~followsEscape;
+    uint64_t evenSequences;
+    state->escaped = __builtin_add_overflow(oddStarts, backslash, &evenSequences);
+    uint64_t escaped = (EVEN_BITS ^ (evenSequences << 1)) & followsEscape;
+
+    uint64_t quote = masks->quote & ~escaped;
+    uint64_t inString = prefixXor(quote) ^ state->inString;
+    state->inString = (uint64_t)((int64_t)inString >> 63);
+
+    uint64_t scalar = ~(masks->op | masks->space | quote | inString);
+    uint64_t scalarStart = scalar & ~((scalar << 1) | state->scalar);
+    state->scalar = scalar >> 63;
+
+    return (masks->op & ~inString) | quote | scalarStart;
+}
+
+/* ================================================================
+ * flatten() — Append the offsets of the set bits to out
+ *
+ * Eight offsets are written per step whether or not that many bits
+ * are left, so the loop runs popcount / 8 times instead of once per
+ * bit with a hard-to-predict exit. The extra slots are overwritten
+ * by the next block; the caller leaves room for them.
+ * ================================================================ */
+static inline uint32_t *flatten(uint32_t *out, uint32_t base, uint64_t bits) {
+    int count = __builtin_popcountll(bits);
+
+    for (int i = 0; i < count; i += 8) {
+        for (int k = 0; k < 8; k++) {
+            // The top bit stands in for the exhausted mask (ctz(0) is undefined)
+            out[i + k] = base + (uint32_t)__builtin_ctzll(bits | (1ULL << 63));
+            bits &= bits - 1;
+        }
+    }
+    return out + count;
+}
+
+/* ================================================================
+ * indexBlocks() — Stage 1 over a whole buffer with one classifier
+ *
+ * Inlined into one function per implementation so the classifier
+ * is inlined too. The last partial block is padded with spaces.
+ *
+ * Returns the number of positions written.
+ * ================================================================ */
+static inline __attribute__((always_inline))
+size_t indexBlocks(const uint8_t *bytes, size_t length, uint32_t *positions,
+                   void (*classify)(const uint8_t *, BlockMasks *)) {
+    IndexState state = { 0, 0, 0 };
+    uint32_t *out = positions;
+    BlockMasks masks;
+    size_t base = 0;
+
+    for (; length - base >= BLOCK_SIZE; base += BLOCK_SIZE) {
+        classify(bytes + base, &masks);
+        out = flatten(out, (uint32_t)base, blockStructurals(&masks, &state));
+    }
+    if (base < length) {
+        uint8_t tail[BLOCK_SIZE];
+        memset(tail, ' ', sizeof(tail));
+        memcpy(tail, bytes + base, length - base);
+        classify(tail, &masks);
+        out = flatten(out, (uint32_t)base, blockStructurals(&masks, &state));
+    }
+    return (size_t)(out - positions);
+}
+
+static size_t scalarIndex(const uint8_t *bytes, size_t length, uint32_t *positions) {
+    return indexBlocks(bytes, length, positions, scalarClassify);
+}
+
+#ifdef INDEX_X86
+static size_t sse2Index(const uint8_t *bytes, size_t length, uint32_t *positions) {
+    return indexBlocks(bytes, length, positions, sse2Classify);
+}
+
+// AVX2 CPUs all have POPCNT, which flatten() uses
+__attribute__((target("avx2,popcnt")))
+static size_t avx2Index(const uint8_t *bytes, size_t length, uint32_t *positions) {
+    return indexBlocks(bytes, length, positions, avx2Classify);
+}
+#endif
+
+/* ================================================================
+ * IndexOps struct:
+ * The active stage 1 implementation. Filled in with the SCAN_AUTO
+ * choice, exactly once, on first use or by the first
+ * jsonIndexSelect() call; an explicit jsonIndexSelect() then
+ * overrides it.
+ * ================================================================ */
+typedef struct {
+    size_t (*index)(const uint8_t *, size_t, uint32_t *);
+    const char *name;
+} IndexOps;
+
+static IndexOps active;
+static pthread_once_t activeOnce = PTHREAD_ONCE_INIT;
+
+/* ================================================================
+ * selectImpl() — Install an implementation in `active`
+ * ================================================================ */
+static int selectImpl(ScanImpl impl) {
+#ifdef INDEX_X86
+    if (impl == SCAN_AUTO) {
+        impl = __builtin_cpu_supports("avx2") ? SCAN_AVX2 : SCAN_SSE2;
+    }
+
+    if (impl == SCAN_AVX2) {
+        if (!__builtin_cpu_supports("avx2")) {
+            return -1;
+        }
+        active = (IndexOps){ avx2Index, "avx2" };
+        return 0;
+    }
+
+    if (impl == SCAN_SSE2) {
+        active = (IndexOps){ sse2Index, "sse2" };
+        return 0;
+    }
+#else
+    if (impl == SCAN_AUTO) {
+        impl = SCAN_SCALAR;
+    }
+#endif
+
+    if (impl == SCAN_SCALAR) {
+        active = (IndexOps){ scalarIndex, "scalar" };
+        return 0;
+    }
+
+    return -1;
+}
+
+/* ================================================================
+ * selectAuto() — The SCAN_AUTO choice, made once by pthread_once()
+ * ================================================================ */
+static void selectAuto(void) {
+    selectImpl(SCAN_AUTO);
+}
+
+/* ================================================================
+ * jsonIndexBuild() — Stage 1
+ *
+ * The position array is sized for the worst case up front (every
+ * byte structural, plus the slack flatten() writes into and the
+ * sentinel), so the block loop never checks for room.
+ * ================================================================ */
+int jsonIndexBuild(JsonIndex *index, const char *data, size_t length) {
+    pthread_once(&activeOnce, selectAuto);
+
+    length = strnlen(data, length);
+    index->data = NULL;
+    index->length = 0;
+    index->count = 0;
+    index->cursor = 0;
+    if (length >= UINT32_MAX - BLOCK_SIZE) {
+        return -1;
+    }
+
+    size_t needed = length + BLOCK_SIZE + 1;
+    if (needed > index->capacity) {
+        uint32_t *grown = realloc(index->positions, needed * sizeof(uint32_t));
+        if (grown == NULL) {
+            return -1;
+        }
+        index->positions = grown;
+        index->capacity = needed;
+    }
+
+    size_t count = active.index((const uint8_t *)data, length, index->positions);
+    index->positions[count] = (uint32_t)length;
+
+    index->data = data;
+    index->length = length;
+    index->count = count;
+    return 0;
+}
+
+/* ================================================================
+ * Walker struct:
+ * Stage 2 state for one value.
+ *
+ *  - next: index of the structural being looked at
+ *  - end: offset just past the last value completed
+ *  - depth: open arrays and objects (cJSON's nesting limit applies)
+ * ================================================================ */
+typedef struct {
+    const char *data;
+    const uint32_t *positions;
+    size_t count;
+    size_t next;
+    size_t end;
+    int depth;
+} Walker;
+
+/* ================================================================
+ * current() — The structural character being looked at, '\0' past
+ * the last one
+ * ================================================================ */
+static inline char current(const Walker *walker) {
+    return walker->next < walker->count ? walker->data[walker->positions[walker->next]] : '\0';
+}
+
+/* ================================================================
+ * newItem() — A zeroed node from cJSON's allocator
+ * ================================================================ */
+static cJSON *newItem(void) {
+    cJSON *item = cJSON_malloc(sizeof(cJSON));
+    if (item != NULL) {
+        memset(item, 0, sizeof(cJSON));
+    }
+    return item;
+}
+
+/* ================================================================
+ * strictNumber() — Whether the text is a number in JSON syntax
+ *
+ * Such numbers are exactly what cJSON's strtod() call consumes.
+ * Other runs cJSON may still accept ("01", "1.") are left to it.
+ * ================================================================ */
+static int strictNumber(const char *pos, size_t length) {
+    const char *end = pos + length;
+    const char *p = pos;
+
+    if (p < end && *p == '-') {
+        p++;
+    }
+    if (p < end && *p == '0') {
+        p++;
+    }
+    else if (p < end && *p >= '1' && *p <= '9') {
+        while (p < end && *p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    else {
+        return 0;
+    }
+    if (p < end && *p == '.') {
+        const char *digits = ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            p++;
+        }
+        if (p == digits) {
+            return 0;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        const char *digits = p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            p++;
+        }
+        if (p == digits) {
+            return 0;
+        }
+    }
+    return p == end;
+}
+
+/* ================================================================
+ * parseString() — The string opening at the current quote
+ *
+ * Its closing quote is the next structural. Text without
+ * backslashes is copied as is; otherwise it is unescaped with
+ * fieldString(), which follows cJSON's rules.
+ *
+ * Returns 0, or -1 on an invalid string or allocation failure.
+ * ================================================================ */
+static int parseString(Walker *walker, char **out) {
+    if (walker->next + 1 >= walker->count ||
+        walker->data[walker->positions[walker->next + 1]] != '"') {
+        return -1;
+    }
+    uint32_t open = walker->positions[walker->next];
+    uint32_t close = walker->positions[walker->next + 1];
+
+    Field field;
+    field.key = 0;
+    field.type = FIELD_STRING;
+    field.value = walker->data + open + 1;
+    field.length = close - open - 1;
+    field.escaped = memchr(field.value, '\\', field.length) != NULL;
+
+    char *text = cJSON_malloc(field.length + 1);
+    if (text == NULL) {
+        return -1;
+    }
+    if (field.escaped) {
+        if (fieldString(&field, text) == -1) {
+            cJSON_free(text);
+            return -1;
+        }
+    }
+    else {
+        memcpy(text, field.value, field.length);
+        text[field.length] = '\0';
+    }
+
+    *out = text;
+    walker->next += 2;
+    walker->end = close + 1;
+    return 0;
+}
+
+/* ================================================================
+ * parseScalar() — The number or literal starting at the current
+ * structural
+ *
+ * It runs until the first whitespace or the next structural; only
+ * whitespace can lie between the two.
+ *
+ * Returns 0, or -1 if the run is not a literal or a number in JSON
+ * syntax.
+ * ================================================================ */
+static int parseScalar(Walker *walker, cJSON *item) {
+    uint32_t start = walker->positions[walker->next];
+    uint32_t limit = walker->positions[walker->next + 1];
+    const char *text = walker->data + start;
+    size_t length = 0;
+
+    while (start + length < limit && (unsigned char)text[length] > ' ') {
+        length++;
+    }
+
+    if (length == 4 && memcmp(text, "null", 4) == 0) {
+        item->type = cJSON_NULL;
+    }
+    else if (length == 4 && memcmp(text, "true", 4) == 0) {
+        item->type = cJSON_True;
+        item->valueint = 1;
+    }
+    else if (length == 5 && memcmp(text, "false", 5) == 0) {
+        item->type = cJSON_False;
+    }
+    else if (length < NUMBER_MAX && strictNumber(text, length)) {
+        char number[NUMBER_MAX];
+        memcpy(number, text, length);
+        number[length] = '\0';
+        cJSON_SetNumberHelper(item, strtod(number, NULL));
+        item->type = cJSON_Number;
+    }
+    else {
+        return -1;
+    }
+
+    walker->next++;
+    walker->end = start + length;
+    return 0;
+}
+
+static int parseValue(Walker *walker, cJSON *item);
+
+/* ================================================================
+ * parseContainer() — An array or object at the current bracket
+ *
+ * Children are linked as cJSON links them (the first child's prev
+ * points to the last). The item owns them from the first one on, so
+ * deleting it after a failure releases everything.
+ *
+ * Returns 0, or -1 on invalid JSON or allocation failure.
+ * ================================================================ */
+static int parseContainer(Walker *walker, cJSON *item) {
+    int object = current(walker) == '{';
+    char close = object ? '}' : ']';
+    cJSON *last = NULL;
+
+    if (walker->depth >= CJSON_NESTING_LIMIT) {
+        return -1;
+    }
+    walker->depth++;
+    walker->next++;
+    item->type = object ? cJSON_Object : cJSON_Array;
+
+    if (current(walker) != close) {
+        for (;;) {
+            cJSON *child = newItem();
+            if (child == NULL) {
+                return -1;
+            }
+            if (last == NULL) {
+                item->child = child;
+            }
+            else {
+                last->next = child;
+                child->prev = last;
+            }
+            last = child;
+            item->child->prev = last;
+
+            if (object) {
+                if (current(walker) != '"' || parseString(walker, &child->string) == -1 ||
+                    current(walker) != ':') {
+                    return -1;
+                }
+                walker->next++;
+            }
+            if (parseValue(walker, child) == -1) {
+                return -1;
+            }
+
+            char separator = current(walker);
+            if (separator == close) {
+                break;
+            }
+            if (separator != ',') {
+                return -1;
+            }
+            walker->next++;
+        }
+    }
+
+    walker->end = walker->positions[walker->next] + 1;
+    walker->next++;
+    walker->depth--;
+    return 0;
+}
+
+/* ================================================================
+ * parseValue() — Dispatch on the current structural
+ * ================================================================ */
+static int parseValue(Walker *walker, cJSON *item) {
+    switch (current(walker)) {
+        case '{':
+        case '[':
+            return parseContainer(walker, item);
+        case '"':
+            if (parseString(walker, &item->valuestring) == -1) {
+                return -1;
+            }
+            item->type = cJSON_String;
+            return 0;
+        case '}':
+        case ']':
+        case ':':
+        case ',':
+        case '\0':
+            return -1;
+        default:
+            return parseScalar(walker, item);
+    }
+}
+
+/* ================================================================
+ * fallback() — Parse with cJSON, as cJSON_ParseWithOpts() would
+ * ================================================================ */
+static cJSON *fallback(const JsonIndex *index, const char *pos, const char **parseEnd) {
+    if (index->data == NULL || pos < index->data || pos > index->data + index->length) {
+        return cJSON_ParseWithOpts(pos, parseEnd, 0);
+    }
+    // The '\0' at data[length] counts, as it does for cJSON_ParseWithOpts()
+    size_t length = (size_t)(index->data + index->length - pos) + 1;
+    return cJSON_ParseWithLengthOpts(pos, length, parseEnd, 0);
+}
+
+/* ================================================================
+ * jsonIndexParse() — Stage 2 for the value at pos
+ *
+ * The cursor is moved to the first structural at or after the
+ * value's first byte. If that is not the value's first byte (text
+ * outside the index, a UTF-8 byte order mark cJSON would skip) or
+ * stage 2 rejects the value, cJSON parses it instead.
+ * ================================================================ */
+cJSON *jsonIndexParse(JsonIndex *index, const char *pos, const char **parseEnd) {
+    if (index->data == NULL || pos < index->data || pos >= index->data + index->length ||
+        (index->data + index->length - pos >= 3 && memcmp(pos, "\xEF\xBB\xBF", 3) == 0)) {
+        return fallback(index, pos, parseEnd);
+    }
+
+    const char *end = index->data + index->length;
+    const char *start = pos;
+    while (start < end && (unsigned char)*start <= ' ') {
+        start++;
+    }
+    uint32_t offset = (uint32_t)(start - index->data);
+
+    // Records come in order; only a step backwards restarts the search
+    size_t cursor = index->cursor;
+    if (cursor > index->count || (cursor > 0 && index->positions[cursor - 1] >= offset)) {
+        cursor = 0;
+    }
+    while (index->positions[cursor] < offset) {
+        cursor++;
+    }
+    if (cursor == index->count || index->positions[cursor] != offset) {
+        index->cursor = cursor;
+        return fallback(index, pos, parseEnd);
+    }
+
+    Walker walker = { index->data, index->positions, index->count, cursor, 0, 0 };
+    cJSON *item = newItem();
+    if (item == NULL || parseValue(&walker, item) == -1) {
+        cJSON_Delete(item);
+        index->cursor = cursor;
+        return fallback(index, pos, parseEnd);
+    }
+
+    index->cursor = walker.next;
+    if (parseEnd != NULL) {
+        *parseEnd = index->data + walker.end;
+    }
+    return item;
+}
+
+/* ================================================================
+ * jsonIndexFree() — Release the position array
+ * ================================================================ */
+void jsonIndexFree(JsonIndex *index) {
+    free(index->positions);
+    index->positions = NULL;
+    index->capacity = 0;
+    index->count = 0;
+    index->data = NULL;
+}
+
+/* ================================================================
+ * jsonIndexSelect() — Choose the stage 1 implementation
+ * ================================================================ */
+int jsonIndexSelect(ScanImpl impl) {
+    pthread_once(&activeOnce, selectAuto);
+    return selectImpl(impl);
+}
+
+/* ================================================================
+ * jsonIndexImplName() — Name of the implementation in use
+ * ================================================================ */
+const char *jsonIndexImplName(void) {
+    pthread_once(&activeOnce, selectAuto);
+    return active.name;
+}
@@ -0,0 +1,106 @@
+/* ================================================================
+ * jsonindex.h — Two-Stage JSON Parser
+ *
+ * An alternative to cJSON_Parse() in the style of simdjson. Stage 1
+ * classifies the input 64 bytes at a time with SIMD compares
+ * (quotes, backslashes, brackets, ':' and ',', whitespace), resolves
+ * escapes and string regions with bit arithmetic, and records the
+ * offset of every structural character: each bracket, ':' and ','
+ * outside strings, each unescaped quote, and the first byte of each
+ * number or literal. Stage 2 walks that index to build an ordinary
+ * cJSON tree, so no byte is examined one at a time to find where a
+ * token ends.
+ *
+ * The trees are the ones cJSON would build: same node layout, same
+ * allocator (cJSON_malloc(), i.e. the server's arena), same string
+ * unescaping, valueint saturation and nesting limit. Anything stage
+ * 2 does not accept is handed to cJSON_ParseWithLengthOpts(), which
+ * then gives the verdict, so error handling is cJSON's too.
+ * ================================================================ */
+
+#ifndef JSONINDEX_H
+#define JSONINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../cJSON.h"
+#include "scan.h"
+
+/* ================================================================
+ * JsonIndex struct:
+ * The structural index of one buffer.
+ *
+ *  - data / length: the indexed text (up to the first '\0')
+ *  - positions: offsets of the structural characters, in order,
+ *    followed by a sentinel equal to length
+ *  - count / capacity: positions used (sentinel excluded) and
+ *    allocated
+ *  - cursor: the next position stage 2 reads
+ * ================================================================ */
+typedef struct {
+    const char *data;
+    size_t length;
+    uint32_t *positions;
+    size_t count;
+    size_t capacity;
+    size_t cursor;
+} JsonIndex;
+
+/* ================================================================
+ * jsonIndexBuild():
+ * Stage 1: indexes `data`, which must be null-terminated at
+ * data[length] (as datagram slots are). Indexing stops at the
+ * first '\0', like cJSON_ParseWithOpts(). The index keeps a pointer
+ * to data and reuses its position array from build to build.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the buffer is larger than 4 GB or allocation fails
+ *    (jsonIndexParse() then falls back to cJSON for every record)
+ * ================================================================ */
+int jsonIndexBuild(JsonIndex *index, const char *data, size_t length);
+
+/* ================================================================
+ * jsonIndexParse():
+ * Stage 2: parses the JSON value at `pos`, a position in the
+ * indexed buffer (leading whitespace is skipped), into a cJSON tree
+ * to be released with cJSON_Delete(). Records are expected in
+ * buffer order; each call continues from where the last one
+ * stopped.
+ *
+ * Behaves like cJSON_ParseWithOpts(pos, parseEnd, 0): *parseEnd is
+ * set just past the value, or to the error position on failure.
+ *
+ * Returns:
+ *  - the parsed tree
+ *  - NULL if the text is not valid JSON (or allocation fails)
+ * ================================================================ */
+cJSON *jsonIndexParse(JsonIndex *index, const char *pos, const char **parseEnd);
+
+/* ================================================================
+ * jsonIndexFree():
+ * Releases the position array.
+ * ================================================================ */
+void jsonIndexFree(JsonIndex *index);
+
+/* ================================================================
+ * jsonIndexSelect():
+ * Chooses the stage 1 implementation, as scanSelect() does for the
+ * line scanner. SCAN_AUTO picks AVX2 when the CPU supports it, else
+ * SSE2 on x86, else scalar. Without a call, the SCAN_AUTO choice
+ * is made once, thread-safely, on first use; an explicit choice
+ * must be made before other threads build indexes.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the requested implementation is unavailable
+ * ================================================================ */
+int jsonIndexSelect(ScanImpl impl);
+
+/* ================================================================
+ * jsonIndexImplName():
+ * Name of the stage 1 implementation currently in use.
+ * ================================================================ */
+const char *jsonIndexImplName(void);
+
+#endif /* JSONINDEX_H */
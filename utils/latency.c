@@ -0,0 +1,140 @@
+/* ================================================================
+ * latency.c — Log-Linear Latency Histograms
+ *
+ * Bucket layout: values below 2 * HIST_HALF get one bucket each.
+ * Above that, a value with its top bit at position `msb` is shifted
+ * right by msb - HIST_SUB_BITS + 1, which leaves HIST_SUB_BITS
+ * significant bits in [HIST_HALF, 2 * HIST_HALF); each shift step
+ * adds HIST_HALF buckets.
+ * ================================================================ */
+
+#include <string.h>
+#include <time.h>
+#include "latency.h"
+
+// Percentiles reported, in parts per 1000.
+static const int percentiles[] = { 500, 990, 999 };
+#define PERCENTILES (int)(sizeof(percentiles) / sizeof(percentiles[0]))
+
+/* ================================================================
+ * bucketOf() — Bucket index of a value
+ * ================================================================ */
+static int bucketOf(uint64_t value) {
+    if (value < 2 * HIST_HALF) {
+        return (int)value;
+    }
+    int shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS + 1;
+    return shift * HIST_HALF + (int)(value >> shift);
+}
+
+/* ================================================================
+ * bucketHigh() — Largest value that falls in bucket `index`
+ * ================================================================ */
+static uint64_t bucketHigh(int index) {
+    if (index < 2 * HIST_HALF) {
+        return (uint64_t)index;
+    }
+    int shift = index / HIST_HALF - 1;
+    uint64_t sub = (uint64_t)(index - shift * HIST_HALF);
+    return ((sub + 1) << shift) - 1;
+}
+
+/* ================================================================
+ * raiseMax() — Atomically raise *max to at least `value`
+ * ================================================================ */
+static void raiseMax(atomic_ulong *max, unsigned long value) {
+    unsigned long current = atomic_load_explicit(max, memory_order_relaxed);
+    while (value > current &&
+           !atomic_compare_exchange_weak_explicit(max, &current, value,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+        // current was reloaded; retry while still larger
+    }
+}
+
+/* ================================================================
+ * latencyNowNs() — Current CLOCK_REALTIME time in nanoseconds
+ * ================================================================ */
+uint64_t latencyNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ================================================================
+ * latencyInit() — Clear and name a histogram
+ * ================================================================ */
+void latencyInit(LatencyHistogram *hist, const char *name) {
+    memset(hist, 0, sizeof(*hist));
+    hist->name = name;
+}
+
+/* ================================================================
+ * latencyRecord() — Count one value
+ * ================================================================ */
+void latencyRecord(LatencyHistogram *hist, int64_t ns) {
+    if (ns < 0) {
+        atomic_fetch_add_explicit(&hist->negative, 1, memory_order_relaxed);
+        return;
+    }
+
+    atomic_fetch_add_explicit(&hist->counts[bucketOf((uint64_t)ns)], 1,
+                              memory_order_relaxed);
+    raiseMax(&hist->max, (unsigned long)ns);
+    raiseMax(&hist->intervalMax, (unsigned long)ns);
+}
+
+/* ================================================================
+ * latencyReport() — Emit count, percentiles and max
+ *
+ * A percentile is reported as the highest value of the bucket that
+ * holds it (never more than the max), the convention of HDR
+ * histograms. Counts are read without stopping the recorders, so
+ * an interval may be off by the few values recorded meanwhile;
+ * they are then counted in the next one.
+ * ================================================================ */
+void latencyReport(LatencyHistogram *hist, int interval, EmitFunc emit, void *ctx) {
+    static unsigned long counts[HIST_BUCKETS];
+    unsigned long total = 0;
+
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        unsigned long count = atomic_load_explicit(&hist->counts[i], memory_order_relaxed);
+        counts[i] = interval ? count - hist->snapshot[i] : count;
+        if (interval) {
+            hist->snapshot[i] = count;
+        }
+        total += counts[i];
+    }
+
+    unsigned long negative = atomic_load_explicit(&hist->negative, memory_order_relaxed);
+    unsigned long max = interval
+        ? atomic_exchange_explicit(&hist->intervalMax, 0, memory_order_relaxed)
+        : atomic_load_explicit(&hist->max, memory_order_relaxed);
+    if (interval) {
+        unsigned long previous = hist->snapshotNegative;
+        hist->snapshotNegative = negative;
+        negative -= previous;
+    }
+
+    if (total == 0 && negative == 0) {
+        return;
+    }
+
+    uint64_t values[PERCENTILES] = { 0 };
+    unsigned long seen = 0;
+    int next = 0;
+    for (int i = 0; i < HIST_BUCKETS && next < PERCENTILES; i++) {
+        seen += counts[i];
+        while (next < PERCENTILES && seen * 1000 >= total * percentiles[next] && seen > 0) {
+            values[next++] = bucketHigh(i) < max ? bucketHigh(i) : max;
+        }
+    }
+
+    emit(ctx, "  %-18s %9lu  p50 %10.1f us  p99 %10.1f us  p99.9 %10.1f us  max %10.1f us",
+         hist->name, total, values[0] / 1000.0, values[1] / 1000.0, values[2] / 1000.0,
+         max / 1000.0);
+    if (negative > 0) {
+        emit(ctx, "  (%lu negative)", negative);
+    }
+    emit(ctx, "\n");
+}
@@ -0,0 +1,74 @@
+/* ================================================================
+ * latency.h — Log-Linear Latency Histograms
+ *
+ * HDR-style histograms of nanosecond latencies: every power of two
+ * is split into HIST_HALF linear sub-buckets, so any recorded value
+ * is reported within 1/HIST_HALF (about 1.6 %) of itself, from 1 ns
+ * up to centuries, in a fixed array. Recording is one atomic add,
+ * so several threads can record into the same histogram.
+ * ================================================================ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "utils.h"
+
+// Linear sub-buckets per power of two: 2^(HIST_SUB_BITS - 1).
+#define HIST_SUB_BITS 7
+#define HIST_HALF (1 << (HIST_SUB_BITS - 1))
+
+// Buckets needed to cover every 64-bit value.
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 2) * HIST_HALF)
+
+/* ================================================================
+ * LatencyHistogram struct:
+ * Bucket counts for one measured stage.
+ *
+ *  - negative: values below zero (a clock stepped, or two hosts'
+ *    clocks disagree); counted but kept out of the percentiles
+ *  - snapshot: counts at the last interval report, so an interval
+ *    report can show only what was recorded since
+ * ================================================================ */
+typedef struct {
+    const char *name;                   // Stage name for reports
+    atomic_ulong counts[HIST_BUCKETS];  // Values per bucket
+    atomic_ulong max;                   // Largest value recorded
+    atomic_ulong intervalMax;           // Largest value since the last interval report
+    atomic_ulong negative;              // Values below zero
+    unsigned long snapshot[HIST_BUCKETS];  // counts at the last interval report
+    unsigned long snapshotNegative;     // negative at the last interval report
+} LatencyHistogram;
+
+/* ================================================================
+ * latencyNowNs():
+ * Returns the current CLOCK_REALTIME time in nanoseconds (the clock
+ * of the envelope send time and SO_TIMESTAMPNS).
+ * ================================================================ */
+uint64_t latencyNowNs(void);
+
+/* ================================================================
+ * latencyInit():
+ * Clears a histogram and names it.
+ * ================================================================ */
+void latencyInit(LatencyHistogram *hist, const char *name);
+
+/* ================================================================
+ * latencyRecord():
+ * Adds one value in nanoseconds; thread-safe.
+ * ================================================================ */
+void latencyRecord(LatencyHistogram *hist, int64_t ns);
+
+/* ================================================================
+ * latencyReport():
+ * Emits one line: count, p50, p99, p99.9 and max. With `interval`
+ * set, covers only the values recorded since the last interval
+ * report (and starts a new interval); otherwise the whole run.
+ * Prints nothing for a histogram with no values.
+ *
+ * Reports must come from one thread at a time.
+ * ================================================================ */
+void latencyReport(LatencyHistogram *hist, int interval, EmitFunc emit, void *ctx);
+
+#endif /* LATENCY_H */
@@ -0,0 +1,726 @@
+/* ================================================================
+ * lineparser.c — Key:Value Line Tokenizer and JSON Serializer
+ *
+ * Turns one line of space-separated key:value pairs into JSON,
+ * either as a cJSON object tree or written directly as compact JSON
+ * bytes into a reusable output buffer.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include "../cJSON.h"
+#include "lineparser.h"
+#include "scan.h"
+
+/* ================================================================
+ * writerPut() — Append raw bytes to the output buffer
+ *
+ * Once the buffer overflows nothing more is written; the caller
+ * checks out->overflow after the line is complete.
+ * ================================================================ */
+static void writerPut(JsonWriter *out, const char *bytes, size_t length) {
+    if (out->overflow || out->length + length > out->capacity) {
+        out->overflow = 1;
+        return;
+    }
+    memcpy(out->data + out->length, bytes, length);
+    out->length += length;
+}
+
+/* ================================================================
+ * writerPutChar() — Append one byte to the output buffer
+ * ================================================================ */
+static void writerPutChar(JsonWriter *out, char c) {
+    if (out->overflow || out->length >= out->capacity) {
+        out->overflow = 1;
+        return;
+    }
+    out->data[out->length++] = c;
+}
+
+/* ================================================================
+ * writerPutString() — Append a JSON string literal
+ *
+ * Same escaping as cJSON's print_string_ptr(): '"' and '\\' and the
+ * common control characters get a two-character escape, any other
+ * byte below 0x20 becomes \u00XX, everything else is copied.
+ * ================================================================ */
+static void writerPutString(JsonWriter *out, const char *string) {
+    const unsigned char *pos = (const unsigned char *)string;
+
+    writerPutChar(out, '"');
+
+    while (*pos != '\0') {
+        // Copy the longest run that needs no escaping in one go
+        const unsigned char *run = pos;
+        while (*pos > 31 && *pos != '"' && *pos != '\\') {
+            pos++;
+        }
+        if (pos > run) {
+            writerPut(out, (const char *)run, (size_t)(pos - run));
+        }
+        if (*pos == '\0') {
+            break;
+        }
+
+        char escape[7];
+        switch (*pos) {
+            case '\\': writerPut(out, "\\\\", 2); break;
+            case '"':  writerPut(out, "\\\"", 2); break;
+            case '\b': writerPut(out, "\\b", 2); break;
+            case '\f': writerPut(out, "\\f", 2); break;
+            case '\n': writerPut(out, "\\n", 2); break;
+            case '\r': writerPut(out, "\\r", 2); break;
+            case '\t': writerPut(out, "\\t", 2); break;
+            default:
+                snprintf(escape, sizeof(escape), "\\u%04x", *pos);
+                writerPut(out, escape, 6);
+                break;
+        }
+        pos++;
+    }
+
+    writerPutChar(out, '"');
+}
+
+/* ================================================================
+ * writerPutNumber() — Append a number the way cJSON prints it
+ *
+ * cJSON_PrintNumber() is the formatter print_number() uses, so the
+ * client's records match what cJSON_PrintUnformatted() would send.
+ * ================================================================ */
+static void writerPutNumber(JsonWriter *out, double d) {
+    char number[26];
+    int length = cJSON_PrintNumber(d, number);
+
+    writerPut(out, number, (size_t)length);
+}
+
+/* ================================================================
+ * NumberClass enum:
+ * Result of the hand-written numeric lexeme classifier.
+ * ================================================================ */
+typedef enum {
+    NUMBER_NONE,        // strtod() cannot accept it: a string
+    NUMBER_JSON,        // JSON number grammar, safely in double range
+    NUMBER_JSON_RANGE,  // JSON number grammar, strtod() must check range
+    NUMBER_OTHER        // Not JSON grammar, but strtod() might accept it
+} NumberClass;
+
+/* ================================================================
+ * classifyNumber() — Classify an unquoted value without strtod()
+ *
+ * Matches the JSON number grammar
+ *     -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+ * and estimates the decimal exponent of the leading significant
+ * digit. Values between 1e-300 and 1e300 (or exactly zero) can
+ * neither overflow nor underflow a double, so strtod()'s ERANGE
+ * check can be skipped for them.
+ *
+ * Lexemes outside the grammar can still be numbers to strtod()
+ * ("+5", ".5", "007", "0x1A", "inf", "nan") only if they start
+ * with a sign, digit, '.', 'i' or 'n'; everything else is a string.
+ * ================================================================ */
+static NumberClass classifyNumber(const char *value, int length) {
+    const char *pos = value;
+    const char *end = value + length;
+    int intDigits = 0;          // Digits before the decimal point
+    int leadingFracZeros = 0;   // Zeros after the point before the first nonzero
+    int nonzero = 0;            // Saw a nonzero digit
+    long exponent = 0;          // Explicit exponent, clamped
+
+    // Optional minus sign
+    if (pos < end && *pos == '-') {
+        pos++;
+    }
+
+    // Integer part: "0" or a nonzero digit followed by digits
+    if (pos < end && *pos == '0') {
+        pos++;
+        intDigits = 1;
+        if (pos < end && *pos >= '0' && *pos <= '9') {
+            goto not_json; // Leading zero, like "007"
+        }
+    }
+    else if (pos < end && *pos >= '1' && *pos <= '9') {
+        nonzero = 1;
+        while (pos < end && *pos >= '0' && *pos <= '9') {
+            pos++;
+            intDigits++;
+        }
+    }
+    else {
+        goto not_json;
+    }
+
+    // Optional fraction: '.' followed by at least one digit
+    if (pos < end && *pos == '.') {
+        pos++;
+        if (pos >= end || *pos < '0' || *pos > '9') {
+            goto not_json; // Like "5."
+        }
+        while (pos < end && *pos >= '0' && *pos <= '9') {
+            if (!nonzero) {
+                if (*pos == '0') {
+                    leadingFracZeros++;
+                }
+                else {
+                    nonzero = 1;
+                }
+            }
+            pos++;
+        }
+    }
+
+    // Optional exponent: 'e' or 'E', optional sign, at least one digit
+    if (pos < end && (*pos == 'e' || *pos == 'E')) {
+        int negative = 0;
+        pos++;
+        if (pos < end && (*pos == '+' || *pos == '-')) {
+            negative = (*pos == '-');
+            pos++;
+        }
+        if (pos >= end || *pos < '0' || *pos > '9') {
+            goto not_json; // Like "1e"
+        }
+        while (pos < end && *pos >= '0' && *pos <= '9') {
+            if (exponent < 100000) {
+                exponent = exponent * 10 + (*pos - '0');
+            }
+            pos++;
+        }
+        if (negative) {
+            exponent = -exponent;
+        }
+    }
+
+    if (pos != end) {
+        goto not_json; // Trailing characters, like "12KB"
+    }
+
+    // Zero never overflows or underflows
+    if (!nonzero) {
+        return NUMBER_JSON;
+    }
+
+    // Decimal exponent of the leading significant digit
+    long magnitude = (value[value[0] == '-'] != '0')
+                   ? exponent + intDigits - 1
+                   : exponent - leadingFracZeros - 1;
+    if (magnitude >= -300 && magnitude <= 300) {
+        return NUMBER_JSON;
+    }
+    return NUMBER_JSON_RANGE;
+
+not_json:
+    switch (value[0]) {
+        case '+': case '-': case '.':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case 'i': case 'I': case 'n': case 'N':
+            return NUMBER_OTHER;
+        default:
+            return NUMBER_NONE;
+    }
+}
+
+/* ================================================================
+ * matchWordNoCase() — Case-insensitive compare with a lowercase word
+ *
+ * Setting bit 0x20 lowercases ASCII letters; for the letters in
+ * "true" and "false" no other byte maps onto them.
+ * ================================================================ */
+static int matchWordNoCase(const char *value, int length,
+                           const char *word, int wordLength) {
+    if (length != wordLength) {
+        return 0;
+    }
+    for (int i = 0; i < length; i++) {
+        if ((value[i] | 0x20) != word[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* ================================================================
+ * emitKey() — Append the separator and "key": for a pair
+ * ================================================================ */
+static void emitKey(JsonWriter *out, int index, const char *key) {
+    if (index > 0) {
+        writerPutChar(out, ',');
+    }
+    writerPutString(out, key);
+    writerPutChar(out, ':');
+}
+
+/* ================================================================
+ * emitString() / emitBool() / emitNumber() / emitLexeme()
+ * — Output one typed pair
+ *
+ * Each adds the pair to the cJSON tree and/or appends it to the
+ * output buffer, whichever of the two the caller asked for.
+ * emitLexeme() writes a validated JSON number exactly as the input
+ * spelled it; the tree, which needs a double, gets strtod() of it.
+ * ================================================================ */
+static void emitString(cJSON *obj, JsonWriter *out, int index,
+                       const char *key, const char *value) {
+    if (obj != NULL) {
+        cJSON_AddStringToObject(obj, key, value);
+    }
+    if (out != NULL) {
+        emitKey(out, index, key);
+        writerPutString(out, value);
+    }
+}
+
+static void emitBool(cJSON *obj, JsonWriter *out, int index,
+                     const char *key, int value) {
+    if (obj != NULL) {
+        cJSON_AddBoolToObject(obj, key, value);
+    }
+    if (out != NULL) {
+        emitKey(out, index, key);
+        if (value) {
+            writerPut(out, "true", 4);
+        }
+        else {
+            writerPut(out, "false", 5);
+        }
+    }
+}
+
+static void emitNumber(cJSON *obj, JsonWriter *out, int index,
+                       const char *key, double value) {
+    if (obj != NULL) {
+        cJSON_AddNumberToObject(obj, key, value);
+    }
+    if (out != NULL) {
+        emitKey(out, index, key);
+        writerPutNumber(out, value);
+    }
+}
+
+static void emitLexeme(cJSON *obj, JsonWriter *out, int index,
+                       const char *key, const char *lexeme, int length) {
+    if (obj != NULL) {
+        cJSON_AddNumberToObject(obj, key, strtod(lexeme, NULL));
+    }
+    if (out != NULL) {
+        emitKey(out, index, key);
+        writerPut(out, lexeme, (size_t)length);
+    }
+}
+
+/* ================================================================
+ * charAt() — Byte at p, or '\0' at the end of the line
+ *
+ * Lines are (pointer, length) views that need not be terminated, so
+ * the end of the view reads as '\0' — the same thing a terminated
+ * string would hold there.
+ * ================================================================ */
+static inline char charAt(const char *p, const char *end) {
+    return p < end ? *p : '\0';
+}
+
+/* ================================================================
+ * tokenizeLine() — Stateful tokenizer for key:value pairs
+ * 
+ * This function tokenizes a line of text into key:value pairs.
+ * For each pair, it:
+ *  1. Extracts the key (everything before the ':')
+ *  2. Extracts the value (quoted or unquoted)
+ *  3. Adds the pair to the cJSON object (if obj != NULL) and writes
+ *     it as JSON to the output buffer (if out != NULL)
+ * 
+ * Validation:
+ *  - If any key or value on the line fails validation, the ENTIRE
+ *    line is discarded.
+ *  - Keys must be non-empty with no whitespace or colons.
+ *  - Values can be quoted or unquoted.
+ *  - Unquoted values may not contain whitespace.
+ *  - Quoted values keep their enclosing quotes as part of the value
+ *  - Escaped characters are are valid and become plain characters
+ *  - Example input:  msg:"hello \"world\""
+ *  - Stored key: msg
+ *  - Stored value: "hello "world""
+ *
+ * Scanning:
+ *  - The line is the `length` bytes at `line`; a '\0' or '\n'
+ *    inside it also ends the line.
+ *  - Keys and values are found with the scan.h scanners, which look
+ *    for the next structural character 16 or 32 bytes at a time.
+ * 
+ * Returns: number of pairs, 0 for empty lines, -1 for invalid lines
+ * ================================================================
+ */
+static int tokenizeLine(const char *line, size_t length, cJSON *obj, JsonWriter *out) {
+    const char *pos = line; // Current read position in the line
+    const char *end = line + length; // One past the last byte of the line
+    char key[MAX_TOKEN]; // Buffer for the current key
+    char value[MAX_TOKEN]; // Buffer for the current value
+    int pairCount = 0; // Number of key:value pairs added
+
+    // Step 1: Skip leading whitespace
+    while (pos < end && isspace((unsigned char)*pos)) {
+        pos++;
+    }
+    
+    // If the line is empty, return 0
+    if (charAt(pos, end) == '\0' || charAt(pos, end) == '\n') {
+        return 0;
+    }
+
+    // Step 2: Open the JSON object in the output buffer
+    if (out != NULL) {
+        out->length = 0;
+        out->overflow = 0;
+        writerPutChar(out, '{');
+    }
+
+    // Step 3: Main parsing loop
+    while (charAt(pos, end) != '\0' && charAt(pos, end) != '\n') {
+        
+        // Skip whitespace between pairs
+        while (pos < end && *pos != '\n' && isspace((unsigned char)*pos)) {
+            pos++;
+        }
+
+        // Check if we've reached the end after skipping whitespace
+        if (charAt(pos, end) == '\0' || charAt(pos, end) == '\n') {
+            break;
+        }
+
+        /*
+         * Extract key
+         * Valid key characters:
+         *  - anything except whitespace, ':', '"', '\\', '\0', and '\n'.
+         */
+        const char *keyStart = pos;
+        pos = scanKey(pos, end);
+        char stop = charAt(pos, end);
+
+        // Check what character stopped the key scan (only ':' is a valid stop)
+        if (stop != ':') {
+            if (isspace((unsigned char)stop)) {
+                printf("Warning: whitespace in key, skipping line\n");
+            }
+            else if (stop == '"') {
+                printf("Warning: quote character in key, skipping line\n");
+            }
+            else if (stop == '\\') {
+                printf("Warning: backslash in key, skipping line\n");
+            }
+            else {
+                printf("Warning: no colon found in token, skipping line\n");
+            }
+
+            return -1;
+        }
+
+        // Calculate key length
+        int keyLen = (int)(pos - keyStart);
+
+        // Empty key — colon appeared at the start, like ":value"
+        if (keyLen == 0) {
+            printf("Warning: empty key found, skipping line\n");
+            return -1;
+        }
+
+        // Key exceeds buffer size
+        if (keyLen >= MAX_TOKEN) {
+            printf("Warning: key too long, skipping line\n");
+            return -1;
+        }
+
+        // Copy key into buffer and null-terminate
+        memcpy(key, keyStart, keyLen);
+        key[keyLen] = '\0';
+
+        // Advance past the ':' delimiter
+        pos++;
+
+        // Check for whitespace after colon
+        if (isspace((unsigned char)charAt(pos, end))) {
+            printf("Warning: whitespace after colon for key '%s', skipping line\n", key);
+            return -1;
+        }
+
+        /* 
+         * Extract value
+         * 
+         * Two modes: Quoted and Unquoted
+         *  - Quoted: may contain spaces and escapes
+         *  - Unquoted: may not contain spaces or backslashes
+         */
+        int valueLen = 0;
+
+        // Quoted mode: value starts with '"'
+        if (charAt(pos, end) == '"') {
+            // Store the opening quote as part of the value
+            value[0] = '"';
+            valueLen++;
+
+            // Advance past the opening quote
+            pos++;
+
+            // Walk through the quoted content
+            while (1) {
+                /*
+                 * Copy the run of regular characters up to the next
+                 * quote, backslash, newline or end of line in one go.
+                 * A run that would push the value past MAX_TOKEN - 1
+                 * fails exactly where the byte-by-byte copy would.
+                 */
+                const char *runEnd = scanQuoted(pos, end);
+                int runLen = (int)(runEnd - pos);
+                if (runLen > 0) {
+                    // Check if the value is too long
+                    if (valueLen + runLen > MAX_TOKEN - 1) {
+                        printf("Warning: value too long, skipping line\n");
+                        return -1;
+                    }
+                    memcpy(value + valueLen, pos, runLen);
+                    valueLen += runLen;
+                    pos = runEnd;
+                }
+
+                // Anything but an escape ends the walk
+                if (charAt(pos, end) != '\\') {
+                    break;
+                }
+
+                // Check for escape sequences
+                char nextChar = charAt(pos + 1, end);
+
+                // Trailing backslash — no character to escape.
+                if (nextChar == '\0' || nextChar == '\n') {
+                    printf("Warning: trailing backslash in quoted value, skipping line\n");
+                    return -1;
+                }
+
+                // Determine the escaped character
+                char escaped;
+                switch (nextChar) {
+                    case '"': /* \" -> " */
+                        escaped = '"';
+                        break;
+                    case '\\': /* \\ -> \ */
+                        escaped = '\\';
+                        break;
+                    case 'n': /* \n -> newline */
+                        escaped = '\n';
+                        break;
+                    case 't': /* \t -> tab */
+                        escaped = '\t';
+                        break;
+                    case 'r': /* \r -> carriage return */
+                        escaped = '\r';
+                        break;
+                    default:
+                        printf("Warning: unrecognized escape sequence '\\%c' in quoted value, skipping line\n", nextChar);
+                        return -1;
+                }
+
+                // Check if the value is too long
+                if (valueLen >= MAX_TOKEN - 1) {
+                    printf("Warning: value too long, skipping line\n");
+                    return -1;
+                }
+                value[valueLen] = escaped;
+                valueLen++;
+                
+                // Skip both the backslash and the escape char
+                pos += 2;
+            }
+
+            // Check for unclosed quote
+            if (charAt(pos, end) != '"') {
+                printf("Warning: unclosed quote, skipping line\n");
+                return -1;
+            }
+
+            // Store the closing quote as part of the value
+            if (valueLen >= MAX_TOKEN - 1) {
+                printf("Warning: value too long, skipping line\n");
+                return -1;
+            }
+
+            // Store the closing quote as part of the value
+            value[valueLen] = '"';
+            valueLen++;
+            value[valueLen] = '\0';
+
+            // Advance past the closing quote
+            pos++;   
+        }
+
+        // Unquoted mode
+        else {
+            const char *valueStart = pos;
+
+            /*
+             * Walk through the unquoted content
+             * Stopping at whitespace, newline, or backslash, or end of string.
+             */
+            pos = scanUnquoted(pos, end);
+
+            // Backslash in unquoted value — not allowed.
+            if (charAt(pos, end) == '\\') {
+                printf("Warning: backslash in unquoted value for key '%s', skipping line\n", key);
+                return -1;
+            }
+
+            valueLen = (int)(pos - valueStart);
+            
+            // Empty value — colon with nothing after it, like "key:"
+            if (valueLen == 0) {
+                printf("Warning: empty value for key '%s', skipping line\n", key);
+                return -1;
+            }
+
+            // Value exceeds buffer size
+            if (valueLen >= MAX_TOKEN) {
+                printf("Warning: value too long, skipping line\n");
+                return -1;
+            }
+
+            // Copy value into buffer and null-terminate
+            memcpy(value, valueStart, valueLen);
+            value[valueLen] = '\0';
+        }
+
+        /*
+         * Type Detection and Output
+         *
+         * 1. Boolean: "true" or "false" (case-insensitive)
+         * 2. Number: valid numeric format (integers, floats, scientific notation)
+         * 3. String: everything else
+         * 4. Quoted values are always treated as strings.
+         */
+
+        // Quoted values are always strings
+        if (value[0] == '"') {
+            emitString(obj, out, pairCount, key, value);
+        }
+        // Boolean detection
+        else if (matchWordNoCase(value, valueLen, "true", 4)) {
+            emitBool(obj, out, pairCount, key, 1);
+        }
+        else if (matchWordNoCase(value, valueLen, "false", 5)) {
+            emitBool(obj, out, pairCount, key, 0);
+        }
+        // Number detection
+        else {
+            /*
+             * classifyNumber() settles the common cases without libc:
+             *  - NUMBER_JSON: valid JSON number, safely inside double
+             *    range, sent on the wire exactly as written
+             *  - NUMBER_NONE: cannot be a number, stored as a string
+             *
+             * Anything else goes through strtod() as before:
+             *  - Integers: "42", "-5", "+5"
+             *  - Floats: "3.14", "-0.5", ".5"
+             *  - Scientific notation: "1e10", "3.14e-2"
+             *
+             * Validate by checking:
+             *  - endptr != value: at least one character was parsed
+             *  - *endptr == '\0': entire string was consumed (no trailing chars)
+             *  - errno != ERANGE: no overflow/underflow occurred
+             */
+            NumberClass numberClass = classifyNumber(value, valueLen);
+
+            if (numberClass == NUMBER_JSON) {
+                // Valid number — pass the lexeme through unchanged
+                emitLexeme(obj, out, pairCount, key, value, valueLen);
+            }
+            else if (numberClass == NUMBER_NONE) {
+                // Not a valid number — store as string
+                emitString(obj, out, pairCount, key, value);
+            }
+            else {
+                char *endptr;
+                errno = 0;  // Clear errno before strtod() call
+                double numValue = strtod(value, &endptr);
+
+                if (endptr == value || *endptr != '\0' || errno == ERANGE) {
+                    // Not a valid number — store as string
+                    emitString(obj, out, pairCount, key, value);
+                }
+                else if (numberClass == NUMBER_JSON_RANGE) {
+                    // Valid JSON number, in range after all — pass through
+                    emitLexeme(obj, out, pairCount, key, value, valueLen);
+                }
+                else {
+                    // Valid for strtod() but not JSON ("+5", "0x1A") — reformat
+                    emitNumber(obj, out, pairCount, key, numValue);
+                }
+            }
+        }
+
+        pairCount++;
+    }
+
+    // If no pairs were successfully parsed, discard the object.
+    if (pairCount == 0) {
+        return 0;
+    }
+
+    // Close the JSON object
+    if (out != NULL) {
+        writerPutChar(out, '}');
+    }
+
+    return pairCount;
+}
+
+
+/* ================================================================
+ * jsonWriterInit() — Attach a writer to caller-owned storage
+ * ================================================================ */
+void jsonWriterInit(JsonWriter *out, char *storage, size_t capacity) {
+    out->data = storage;
+    out->capacity = capacity;
+    out->length = 0;
+    out->overflow = 0;
+}
+
+/* ================================================================
+ * parseLine() — Tokenize a line into a cJSON object
+ *
+ * Returns: cJSON* on success, NULL on empty/invalid lines
+ * ================================================================ */
+cJSON *parseLine(const char *line) {
+    cJSON *obj = cJSON_CreateObject();
+    if (obj == NULL) {
+        return NULL;
+    }
+
+    if (tokenizeLine(line, strlen(line), obj, NULL) <= 0) {
+        cJSON_Delete(obj);
+        return NULL;
+    }
+
+    return obj;
+}
+
+/* ================================================================
+ * serializeLine() — Tokenize a line straight into JSON bytes
+ * ================================================================ */
+int serializeLine(const char *line, size_t length, JsonWriter *out, cJSON *obj) {
+    int pairCount = tokenizeLine(line, length, obj, out);
+    if (pairCount <= 0) {
+        return pairCount;
+    }
+
+    if (out->overflow) {
+        printf("Warning: serialized object larger than %zu bytes, skipping line\n",
+               out->capacity);
+        return -1;
+    }
+
+    return (int)out->length;
+}
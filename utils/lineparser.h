@@ -0,0 +1,69 @@
+/* ================================================================
+ * lineparser.h — Key:Value Line Tokenizer and JSON Serializer
+ *
+ * Turns one line of space-separated key:value pairs into JSON,
+ * either as a cJSON object tree or written directly as compact JSON
+ * bytes into a reusable output buffer.
+ * ================================================================ */
+
+#ifndef LINEPARSER_H
+#define LINEPARSER_H
+
+#include <stddef.h>
+#include "../cJSON.h"
+
+// Constants
+#define MAX_TOKEN 1024 // Maximum bytes for a single key or value token during parsing.
+
+/* ================================================================
+ * JsonWriter struct:
+ * A caller-owned output buffer the serializer appends JSON to.
+ *
+ *  - data / capacity: storage provided by the caller, reused for
+ *                     every line (no allocation per record)
+ *  - length: bytes written for the current line
+ *  - overflow: set when the output did not fit in capacity
+ * ================================================================ */
+typedef struct {
+    char *data;
+    size_t capacity;
+    size_t length;
+    int overflow;
+} JsonWriter;
+
+/* ================================================================
+ * jsonWriterInit():
+ * Attach a writer to `capacity` bytes of caller-owned storage.
+ * ================================================================ */
+void jsonWriterInit(JsonWriter *out, char *storage, size_t capacity);
+
+/* ================================================================
+ * parseLine():
+ * Parses a line of space-separated key:value pairs into a cJSON object.
+ * Returns NULL for empty/invalid lines.
+ * Any error on the line discards the entire line.
+ * ================================================================ */
+cJSON *parseLine(const char *line);
+
+/* ================================================================
+ * serializeLine():
+ * Parses the `length` bytes at `line` (one line of space-separated
+ * key:value pairs, need not be null-terminated) and writes it
+ * as compact JSON into `out` without building a tree.
+ *
+ * The output matches cJSON_PrintUnformatted(parseLine(line)) except
+ * for numbers: a value that is already a valid JSON number is
+ * written exactly as the input spelled it ("1.50" stays "1.50"), so
+ * the receiver parses back the sender's value with full precision.
+ *
+ * If `obj` is not NULL, the pairs are also added to it (for console
+ * output); the caller still owns and deletes it on every return.
+ *
+ * Returns:
+ *  - length of the JSON in out->data (not null-terminated)
+ *  - 0 for empty lines
+ *  - -1 for invalid lines or output larger than the buffer
+ * ================================================================ */
+int serializeLine(const char *line, size_t length, JsonWriter *out, cJSON *obj);
+
+#endif /* LINEPARSER_H */
@@ -0,0 +1,431 @@
+/* ================================================================
+ * linereader.c — Zero-Copy Line Reader for the Client
+ *
+ * Hands out (pointer, length) views of input lines. Regular files
+ * are memory-mapped and read in place; pipes, terminals and stdin
+ * fall back to streaming read()s into a growable buffer. Follow
+ * mode waits on inotify for appended data and survives rotation.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "linereader.h"
+
+// Bytes asked for ahead of the read position with MADV_WILLNEED.
+#define READAHEAD_WINDOW (8 * 1024 * 1024)
+
+// Consumed bytes released with MADV_DONTNEED at a time.
+#define RELEASE_CHUNK (64 * 1024 * 1024)
+
+// Initial streaming buffer size; doubles for longer lines.
+#define STREAM_BUFFER_SIZE (64 * 1024)
+
+// What followCheck() found out about the followed file.
+#define FOLLOW_SAME      0   // Same file, nothing new
+#define FOLLOW_TRUNCATED 1   // Same file, shorter than what was read
+#define FOLLOW_ROTATED   2   // `path` now names a different file
+
+/* ================================================================
+ * lineReaderOpen() — Map regular files, stream everything else
+ * ================================================================ */
+int lineReaderOpen(LineReader *reader, int fd) {
+    struct stat info;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = fd;
+    reader->inotifyFd = -1;
+    reader->fileWatch = -1;
+    reader->dirWatch = -1;
+
+    if (fstat(fd, &info) == -1) {
+        perror("fstat");
+        return -1;
+    }
+
+    /*
+     * Map regular files. Reading starts at the current file offset,
+     * so a file that was partly consumed through fd stays consistent.
+     */
+    off_t position = lseek(fd, 0, SEEK_CUR);
+    if (S_ISREG(info.st_mode) && info.st_size > 0 && position >= 0 &&
+        position < info.st_size) {
+        void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            reader->mapped = 1;
+            reader->data = data;
+            reader->size = (size_t)info.st_size;
+            reader->offset = (size_t)position;
+            reader->releasedOffset = 0;
+            reader->adviseOffset = reader->offset;
+
+            // The file is read front to back exactly once
+            madvise(data, reader->size, MADV_SEQUENTIAL);
+            return 0;
+        }
+    }
+
+    // Streaming fallback: pipes, terminals, empty or unmappable files
+    reader->buffer = malloc(STREAM_BUFFER_SIZE);
+    if (reader->buffer == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    reader->capacity = STREAM_BUFFER_SIZE;
+    reader->pollable = !S_ISREG(info.st_mode);
+    return 0;
+}
+
+/* ================================================================
+ * followOpen() — Open `path` and watch the file it names now
+ *
+ * Returns 0 on success, -1 if the file cannot be opened (errno set).
+ * ================================================================ */
+static int followOpen(LineReader *reader) {
+    struct stat info;
+
+    int fd = open(reader->path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    reader->fd = fd;
+    reader->dev = info.st_dev;
+    reader->ino = info.st_ino;
+    reader->position = 0;
+
+    // The old file's watch may already be gone if it was deleted
+    if (reader->fileWatch != -1) {
+        inotify_rm_watch(reader->inotifyFd, reader->fileWatch);
+    }
+    reader->fileWatch = inotify_add_watch(reader->inotifyFd, reader->path,
+                                          IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF |
+                                          IN_DELETE_SELF);
+    return 0;
+}
+
+/* ================================================================
+ * followCheck() — Compare the open file with what `path` names now
+ * ================================================================ */
+static int followCheck(LineReader *reader) {
+    struct stat named;
+    struct stat opened;
+
+    if (stat(reader->path, &named) == 0 &&
+        (reader->fd == -1 || named.st_dev != reader->dev || named.st_ino != reader->ino)) {
+        return FOLLOW_ROTATED;
+    }
+
+    if (reader->fd != -1 && fstat(reader->fd, &opened) == 0 &&
+        opened.st_size < reader->position) {
+        return FOLLOW_TRUNCATED;
+    }
+
+    return FOLLOW_SAME;
+}
+
+/* ================================================================
+ * lineReaderOpenFollow() — Stream a file and wait for it to grow
+ *
+ * The directory watch sees a new file being created or renamed to
+ * `path`; the file watch sees appends, truncation, and the file
+ * being renamed away or deleted.
+ * ================================================================ */
+int lineReaderOpenFollow(LineReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = -1;
+    reader->follow = 1;
+    reader->path = path;
+    reader->fileWatch = -1;
+    reader->dirWatch = -1;
+
+    reader->buffer = malloc(STREAM_BUFFER_SIZE);
+    if (reader->buffer == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    reader->capacity = STREAM_BUFFER_SIZE;
+
+    reader->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (reader->inotifyFd == -1) {
+        perror("inotify_init1");
+        lineReaderClose(reader);
+        return -1;
+    }
+
+    // dirname() may modify its argument
+    char directory[4096];
+    snprintf(directory, sizeof(directory), "%s", path);
+    reader->dirWatch = inotify_add_watch(reader->inotifyFd, dirname(directory),
+                                         IN_CREATE | IN_MOVED_TO);
+    if (reader->dirWatch == -1) {
+        perror("inotify_add_watch");
+    }
+
+    if (followOpen(reader) == -1) {
+        if (errno != ENOENT) {
+            perror(path);
+            lineReaderClose(reader);
+            return -1;
+        }
+        printf("Waiting for %s to appear\n", path);
+    }
+
+    return 0;
+}
+
+/* ================================================================
+ * nextMapped() — Next line from the mapping
+ *
+ * Keeps a READAHEAD_WINDOW of MADV_WILLNEED ahead of the reader and
+ * drops consumed pages in RELEASE_CHUNK steps, so page faults stay
+ * off the critical path and resident memory stays bounded no matter
+ * how large the file is.
+ * ================================================================ */
+static LineStatus nextMapped(LineReader *reader, const char **line, size_t *length) {
+    if (reader->offset >= reader->size) {
+        return LINE_END;
+    }
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+    size_t offset = reader->offset;
+
+    /*
+     * Release consumed pages, one RELEASE_CHUNK behind the reader so
+     * lines still being worked on by the caller stay resident.
+     */
+    if (offset - reader->releasedOffset >= 2 * (size_t)RELEASE_CHUNK) {
+        madvise((char *)reader->data + reader->releasedOffset, RELEASE_CHUNK, MADV_DONTNEED);
+        reader->releasedOffset += RELEASE_CHUNK;
+    }
+
+    // Extend the readahead window once the reader is halfway into it
+    if (reader->adviseOffset < reader->size &&
+        offset + READAHEAD_WINDOW / 2 >= reader->adviseOffset) {
+        size_t from = reader->adviseOffset & ~((size_t)pageSize - 1);
+        size_t to = reader->adviseOffset + READAHEAD_WINDOW;
+        if (to > reader->size) {
+            to = reader->size;
+        }
+        madvise((char *)reader->data + from, to - from, MADV_WILLNEED);
+        reader->adviseOffset = to;
+    }
+
+    const char *start = reader->data + offset;
+    const char *newline = memchr(start, '\n', reader->size - offset);
+    size_t lineLength = newline ? (size_t)(newline + 1 - start)
+                                : reader->size - offset;
+
+    *line = start;
+    *length = lineLength;
+    reader->offset += lineLength;
+    return LINE_READY;
+}
+
+/* ================================================================
+ * nextStreamed() — Next line from read()s into the buffer
+ * ================================================================ */
+static LineStatus nextStreamed(LineReader *reader, const char **line, size_t *length) {
+    while (1) {
+        // Look for a newline in the bytes not searched yet
+        if (reader->scanned < reader->start) {
+            reader->scanned = reader->start;
+        }
+        char *newline = memchr(reader->buffer + reader->scanned, '\n',
+                               reader->length - reader->scanned);
+        if (newline != NULL) {
+            size_t end = (size_t)(newline + 1 - reader->buffer);
+            *line = reader->buffer + reader->start;
+            *length = end - reader->start;
+            reader->start = end;
+            reader->scanned = end;
+            return LINE_READY;
+        }
+        reader->scanned = reader->length;
+
+        // End of input: hand out the unterminated last line, if any
+        if (reader->eof) {
+            if (reader->start < reader->length) {
+                *line = reader->buffer + reader->start;
+                *length = reader->length - reader->start;
+                reader->start = reader->length;
+                return LINE_READY;
+            }
+            return LINE_END;
+        }
+
+        // Move the partial line to the front, grow if it fills the buffer
+        if (reader->start > 0) {
+            memmove(reader->buffer, reader->buffer + reader->start,
+                    reader->length - reader->start);
+            reader->length -= reader->start;
+            reader->scanned -= reader->start;
+            reader->start = 0;
+        }
+        if (reader->length == reader->capacity) {
+            char *grown = realloc(reader->buffer, reader->capacity * 2);
+            if (grown == NULL) {
+                perror("realloc");
+                return LINE_ERROR;
+            }
+            reader->buffer = grown;
+            reader->capacity *= 2;
+        }
+
+        ssize_t bytesRead = 0;
+        if (reader->fd != -1) {
+            // Let the caller flush before a read that would block
+            if (reader->pollable) {
+                struct pollfd ready = { reader->fd, POLLIN, 0 };
+                if (poll(&ready, 1, 0) == 0) {
+                    return LINE_PENDING;
+                }
+            }
+
+            bytesRead = read(reader->fd, reader->buffer + reader->length,
+                             reader->capacity - reader->length);
+            if (bytesRead == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("read");
+                return LINE_ERROR;
+            }
+        }
+        if (bytesRead > 0) {
+            reader->length += (size_t)bytesRead;
+            reader->position += bytesRead;
+            continue;
+        }
+
+        // No more data for now
+        if (!reader->follow) {
+            reader->eof = 1;
+            continue;
+        }
+
+        int change = followCheck(reader);
+        if (change == FOLLOW_TRUNCATED) {
+            // Rewritten in place: drop the partial line, start over
+            printf("%s: file truncated\n", reader->path);
+            lseek(reader->fd, 0, SEEK_SET);
+            reader->position = 0;
+            reader->start = reader->length = reader->scanned = 0;
+            continue;
+        }
+        if (change == FOLLOW_SAME) {
+            return LINE_PENDING;
+        }
+
+        /*
+         * Rotated: read the old file once more in case the writer
+         * appended to it after the rename, then switch files.
+         */
+        if (!reader->draining) {
+            reader->draining = 1;
+            continue;
+        }
+        reader->draining = 0;
+
+        if (reader->fd != -1) {
+            close(reader->fd);
+            reader->fd = -1;
+        }
+        if (followOpen(reader) == 0) {
+            printf("%s: following new file\n", reader->path);
+        }
+
+        // The old file's unterminated last line is complete now
+        if (reader->start < reader->length) {
+            *line = reader->buffer + reader->start;
+            *length = reader->length - reader->start;
+            reader->start = reader->length;
+            return LINE_READY;
+        }
+    }
+}
+
+/* ================================================================
+ * lineReaderNext() — Next line view from either mode
+ * ================================================================ */
+LineStatus lineReaderNext(LineReader *reader, const char **line, size_t *length) {
+    if (reader->mapped) {
+        return nextMapped(reader, line, length);
+    }
+    return nextStreamed(reader, line, length);
+}
+
+/* ================================================================
+ * lineReaderWait() — Block until input may be available
+ *
+ * Queued inotify events are only wake-ups; the next read() and
+ * followCheck() find out what actually changed, so the events are
+ * drained without being decoded.
+ * ================================================================ */
+int lineReaderWait(LineReader *reader) {
+    struct pollfd ready;
+    int timeout = -1;
+
+    if (reader->follow) {
+        ready.fd = reader->inotifyFd;
+        timeout = FOLLOW_POLL_MS;
+    }
+    else {
+        ready.fd = reader->fd;
+    }
+    ready.events = POLLIN;
+
+    if (poll(&ready, 1, timeout) == -1) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        perror("poll");
+        return -1;
+    }
+
+    if (reader->follow) {
+        char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        while (read(reader->inotifyFd, events, sizeof(events)) > 0) {
+            // Discard
+        }
+    }
+
+    return 0;
+}
+
+/* ================================================================
+ * lineReaderClose() — Unmap or free
+ * ================================================================ */
+void lineReaderClose(LineReader *reader) {
+    if (reader->mapped) {
+        munmap((void *)reader->data, reader->size);
+        reader->data = NULL;
+        reader->mapped = 0;
+    }
+    free(reader->buffer);
+    reader->buffer = NULL;
+
+    // Follow mode opened these itself
+    if (reader->follow) {
+        if (reader->fd != -1) {
+            close(reader->fd);
+            reader->fd = -1;
+        }
+        if (reader->inotifyFd != -1) {
+            close(reader->inotifyFd);
+            reader->inotifyFd = -1;
+        }
+    }
+}
@@ -0,0 +1,155 @@
+/* ================================================================
+ * linereader.h — Zero-Copy Line Reader for the Client
+ *
+ * Hands out (pointer, length) views of input lines. Regular files
+ * are memory-mapped and read in place, with sequential-access and
+ * readahead hints and with consumed pages released as the reader
+ * moves on, so multi-gigabyte files start immediately and keep RSS
+ * small. Pipes, terminals and stdin fall back to streaming read()s
+ * into a growable buffer.
+ *
+ * Follow mode reads a growing log like `tail -F`: it waits on
+ * inotify for appended data and reopens the file when it is rotated.
+ * ================================================================ */
+
+#ifndef LINEREADER_H
+#define LINEREADER_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+// Longest follow-mode wait before the file is checked without an event.
+#define FOLLOW_POLL_MS 1000
+
+/* ================================================================
+ * LineStatus enum:
+ * Result of lineReaderNext().
+ *
+ *  - LINE_PENDING: no complete line is available yet and reading on
+ *                  would block (pipes, terminals, follow mode); call
+ *                  lineReaderWait() and try again
+ * ================================================================ */
+typedef enum {
+    LINE_ERROR = -1,
+    LINE_END = 0,
+    LINE_READY = 1,
+    LINE_PENDING = 2
+} LineStatus;
+
+/* ================================================================
+ * LineReader struct:
+ * State for one input, in either mapped or streaming mode.
+ *
+ * Mapped mode:
+ *  - data / size: the whole file mapping
+ *  - adviseOffset: end of the last MADV_WILLNEED readahead window
+ *  - releasedOffset: everything before it was MADV_DONTNEED'ed
+ *
+ * Streaming mode:
+ *  - buffer / capacity: growable read buffer
+ *  - start / length: unread bytes are buffer[start, length)
+ *  - scanned: bytes before it are known to hold no newline
+ *  - eof: read() returned 0
+ *  - pollable: fd may block (pipe, terminal), so poll before read()
+ *
+ * Follow mode (always streaming):
+ *  - path: name of the followed file; reopened after rotation
+ *  - inotifyFd: watches the file (writes, truncation, rename,
+ *               delete) and its directory (a new file at `path`)
+ *  - dev / ino: identity of the open file, compared with `path`
+ *  - position: bytes read from the open file (detects truncation)
+ *  - draining: rotation was seen; read the old file out first
+ * ================================================================ */
+typedef struct {
+    int fd;                 // Input descriptor (not owned)
+    int mapped;             // 1 = mmap, 0 = streaming reads
+
+    // Mapped mode
+    const char *data;       // File mapping
+    size_t size;            // File size
+    size_t offset;          // Next unread byte
+    size_t adviseOffset;    // End of the readahead window
+    size_t releasedOffset;  // Pages before this were released
+
+    // Streaming mode
+    char *buffer;           // Read buffer
+    size_t capacity;        // Buffer size
+    size_t start;           // First unread byte in buffer
+    size_t length;          // Bytes valid in buffer
+    size_t scanned;         // Newline search resumes here
+    int eof;                // read() reported end of input
+    int pollable;           // Input can block (pipe, terminal)
+
+    // Follow mode
+    int follow;             // 1 = wait for appended data at EOF
+    const char *path;       // Followed file name
+    int inotifyFd;          // inotify instance (-1 = none)
+    int fileWatch;          // Watch on the open file
+    int dirWatch;           // Watch on the file's directory
+    dev_t dev;              // Device of the open file
+    ino_t ino;              // Inode of the open file
+    off_t position;         // Bytes read from the open file
+    int draining;           // Rotation seen, old file not yet drained
+} LineReader;
+
+/* ================================================================
+ * lineReaderOpen():
+ * Prepare to read lines from `fd`. Regular, non-empty files are
+ * mapped; anything else is read as a stream.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error (perror)
+ * ================================================================ */
+int lineReaderOpen(LineReader *reader, int fd);
+
+/* ================================================================
+ * lineReaderOpenFollow():
+ * Prepare to follow the file at `path`: its current contents are
+ * read, then lines appended later. If `path` is renamed or deleted
+ * and a new file appears under that name, the old file is read to
+ * its end and the new one is read from the start. A truncated file
+ * is read again from the start. The file does not have to exist yet.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error (perror)
+ * ================================================================ */
+int lineReaderOpenFollow(LineReader *reader, const char *path);
+
+/* ================================================================
+ * lineReaderNext():
+ * Returns the next line as a view in *line / *length, including its
+ * trailing '\n' if it has one. The view stays valid until the next
+ * call. In follow mode a line is only returned once its newline has
+ * been written, and end of input is never reached.
+ *
+ * Returns:
+ *  - LINE_READY when a line was returned
+ *  - LINE_PENDING when the next read would block
+ *  - LINE_END at end of input
+ *  - LINE_ERROR on read error (perror)
+ * ================================================================ */
+LineStatus lineReaderNext(LineReader *reader, const char **line, size_t *length);
+
+/* ================================================================
+ * lineReaderWait():
+ * Blocks after LINE_PENDING until more input may be available.
+ * Follow mode waits on inotify with a timeout of FOLLOW_POLL_MS, so
+ * changes inotify cannot report (e.g. network filesystems) are still
+ * noticed. A signal ends the wait early.
+ *
+ * Returns:
+ *  - 0 when the caller should call lineReaderNext() again
+ *  - -1 on error (perror)
+ * ================================================================ */
+int lineReaderWait(LineReader *reader);
+
+/* ================================================================
+ * lineReaderClose():
+ * Unmaps the file or frees the stream buffer. Does not close an fd
+ * passed to lineReaderOpen(); closes the followed file and inotify.
+ * ================================================================ */
+void lineReaderClose(LineReader *reader);
+
+#endif /* LINEREADER_H */
@@ -0,0 +1,547 @@
+/* ================================================================
+ * mcast.c — Multicast Subscriptions
+ *
+ * Opens one socket per port (more if a port carries more groups
+ * than one socket may join), joins the subscribed groups (source-
+ * specific when a source filter is set), and multiplexes the
+ * sockets with epoll.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <ifaddrs.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include "mcast.h"
+#include "utils.h"
+
+/* ================================================================
+ * resolveInterface() — Interface index from a name or IPv4 address
+ * ================================================================ */
+static int resolveInterface(const char *text, Subscription *sub) {
+    struct in_addr address;
+
+    if (inet_pton(AF_INET, text, &address) == 1) {
+        struct ifaddrs *list;
+        if (getifaddrs(&list) == -1) {
+            perror("getifaddrs");
+            return -1;
+        }
+
+        const char *name = NULL;
+        for (struct ifaddrs *ifa = list; ifa != NULL; ifa = ifa->ifa_next) {
+            if (ifa->ifa_addr != NULL && ifa->ifa_addr->sa_family == AF_INET &&
+                ((struct sockaddr_in *)ifa->ifa_addr)->sin_addr.s_addr == address.s_addr) {
+                name = ifa->ifa_name;
+                break;
+            }
+        }
+        if (name != NULL) {
+            snprintf(sub->ifname, sizeof(sub->ifname), "%s", name);
+        }
+        freeifaddrs(list);
+
+        if (name == NULL) {
+            printf("Error: No interface has address %s\n", text);
+            return -1;
+        }
+    }
+    else {
+        if (strlen(text) >= sizeof(sub->ifname)) {
+            printf("Error: Interface name too long: %s\n", text);
+            return -1;
+        }
+        snprintf(sub->ifname, sizeof(sub->ifname), "%s", text);
+    }
+
+    sub->ifindex = (int)if_nametoindex(sub->ifname);
+    if (sub->ifindex == 0) {
+        printf("Error: Unknown interface: %s\n", sub->ifname);
+        return -1;
+    }
+    return 0;
+}
+
+/* ================================================================
+ * mcastParse() — Parse "group:port[@interface]"
+ *
+ * The group must be in the multicast range and the port numeric,
+ * as validateArguments() requires for the two-argument form.
+ * ================================================================ */
+int mcastParse(const char *spec, Subscription *sub) {
+    char text[128];
+    memset(sub, 0, sizeof(*sub));
+
+    if (strlen(spec) >= sizeof(text)) {
+        printf("Error: Subscription too long: %s\n", spec);
+        return -1;
+    }
+    snprintf(text, sizeof(text), "%s", spec);
+
+    char *at = strchr(text, '@');
+    if (at != NULL) {
+        *at = '\0';
+    }
+    char *colon = strchr(text, ':');
+    if (colon == NULL) {
+        printf("Error: Subscription must be <group>:<port>[@interface]: %s\n", spec);
+        return -1;
+    }
+    *colon = '\0';
+
+    if (inet_pton(AF_INET, text, &sub->group) != 1) {
+        printf("Error: Invalid IP address format: %s\n", text);
+        return -1;
+    }
+    unsigned char firstOctet = ((unsigned char *)&sub->group.s_addr)[0];
+    if (firstOctet < 224 || firstOctet > 239) {
+        printf("Error: Not a multicast address: %s\n", text);
+        return -1;
+    }
+
+    const char *portText = colon + 1;
+    char *end;
+    long port = strtol(portText, &end, 10);
+    if (*portText == '\0' || !isdigit((unsigned char)*portText) || *end != '\0' ||
+        port < 1 || port > 65535) {
+        printf("Error: Invalid port number in %s (1-65535)\n", spec);
+        return -1;
+    }
+    sub->port = (int)port;
+
+    if (at != NULL && resolveInterface(at + 1, sub) == -1) {
+        return -1;
+    }
+    return 0;
+}
+
+/* ================================================================
+ * mcastLoadFile() — Read subscriptions, one per line
+ * ================================================================ */
+int mcastLoadFile(const char *path, Subscription *subs, int *count) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+
+        // Strip comments and surrounding whitespace
+        char *hash = strchr(line, '#');
+        if (hash != NULL) {
+            *hash = '\0';
+        }
+        char *start = line;
+        while (isspace((unsigned char)*start)) {
+            start++;
+        }
+        char *stop = start + strlen(start);
+        while (stop > start && isspace((unsigned char)stop[-1])) {
+            *--stop = '\0';
+        }
+        if (*start == '\0') {
+            continue;
+        }
+
+        if (*count >= MAX_SUBSCRIPTIONS) {
+            printf("Error: More than %d subscriptions\n", MAX_SUBSCRIPTIONS);
+            fclose(file);
+            return -1;
+        }
+        if (mcastParse(start, &subs[*count]) == -1) {
+            printf("  (%s line %d)\n", path, lineNumber);
+            fclose(file);
+            return -1;
+        }
+        (*count)++;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+/* ================================================================
+ * mcastAddSources() — Append a comma-separated sender list
+ * ================================================================ */
+int mcastAddSources(SourceFilter *filter, SourceMode mode, const char *list) {
+    char text[1024];
+
+    if (filter->mode != SOURCE_ANY && filter->mode != mode) {
+        printf("Error: Include and exclude source lists cannot be combined\n");
+        return -1;
+    }
+    filter->mode = mode;
+
+    if (strlen(list) >= sizeof(text)) {
+        printf("Error: Source list too long\n");
+        return -1;
+    }
+    snprintf(text, sizeof(text), "%s", list);
+
+    char *save = NULL;
+    for (char *item = strtok_r(text, ",", &save); item != NULL;
+         item = strtok_r(NULL, ",", &save)) {
+        if (filter->count >= MAX_SOURCES) {
+            printf("Error: More than %d sources\n", MAX_SOURCES);
+            return -1;
+        }
+        if (inet_pton(AF_INET, item, &filter->sources[filter->count]) != 1) {
+            printf("Error: Invalid source address: %s\n", item);
+            return -1;
+        }
+        filter->count++;
+    }
+    return 0;
+}
+
+/* ================================================================
+ * compareSubscriptions() — Order by port, then group, then interface
+ * ================================================================ */
+static int compareSubscriptions(const void *a, const void *b) {
+    const Subscription *x = a;
+    const Subscription *y = b;
+
+    if (x->port != y->port) {
+        return x->port < y->port ? -1 : 1;
+    }
+    uint32_t gx = ntohl(x->group.s_addr);
+    uint32_t gy = ntohl(y->group.s_addr);
+    if (gx != gy) {
+        return gx < gy ? -1 : 1;
+    }
+    return x->ifindex - y->ifindex;
+}
+
+/* ================================================================
+ * fillAddress() — sockaddr_storage for MCAST_* requests
+ * ================================================================ */
+static void fillAddress(struct sockaddr_storage *storage, struct in_addr address) {
+    struct sockaddr_in *sin = (struct sockaddr_in *)storage;
+
+    memset(storage, 0, sizeof(*storage));
+    sin->sin_family = AF_INET;
+    sin->sin_addr = address;
+}
+
+/* ================================================================
+ * joinGroup() — Join one subscription under the source filter
+ *
+ * The protocol-independent MCAST_* requests take an interface
+ * index, like ip_mreqn, and cover all three modes:
+ *  - any source: MCAST_JOIN_GROUP
+ *  - include: MCAST_JOIN_SOURCE_GROUP once per sender (IGMPv3
+ *    INCLUDE mode; other senders are never delivered)
+ *  - exclude: MCAST_JOIN_GROUP, then MCAST_BLOCK_SOURCE per sender
+ * ================================================================ */
+static int joinGroup(int sd, const Subscription *sub, const SourceFilter *filter) {
+    int mode = filter->kernel ? filter->mode : SOURCE_ANY;
+
+    if (mode == SOURCE_INCLUDE) {
+        for (int i = 0; i < filter->count; i++) {
+            struct group_source_req req;
+            memset(&req, 0, sizeof(req));
+            req.gsr_interface = sub->ifindex;
+            fillAddress(&req.gsr_group, sub->group);
+            fillAddress(&req.gsr_source, filter->sources[i]);
+            if (setsockopt(sd, IPPROTO_IP, MCAST_JOIN_SOURCE_GROUP,
+                           &req, sizeof(req)) == -1) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    struct group_req req;
+    memset(&req, 0, sizeof(req));
+    req.gr_interface = sub->ifindex;
+    fillAddress(&req.gr_group, sub->group);
+    if (setsockopt(sd, IPPROTO_IP, MCAST_JOIN_GROUP, &req, sizeof(req)) == -1) {
+        return -1;
+    }
+
+    if (mode == SOURCE_EXCLUDE) {
+        for (int i = 0; i < filter->count; i++) {
+            struct group_source_req block;
+            memset(&block, 0, sizeof(block));
+            block.gsr_interface = sub->ifindex;
+            fillAddress(&block.gsr_group, sub->group);
+            fillAddress(&block.gsr_source, filter->sources[i]);
+            if (setsockopt(sd, IPPROTO_IP, MCAST_BLOCK_SOURCE,
+                           &block, sizeof(block)) == -1) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* ================================================================
+ * openSocket() — Bind a socket to `port` and join its subscriptions
+ *
+ * IP_MULTICAST_ALL is turned off: by default Linux delivers a group
+ * to every socket bound to the port once any socket on the host has
+ * joined it, which would duplicate datagrams across our sockets.
+ * ================================================================ */
+static int openSocket(McastSet *set, int index, int first, int count, int rcvbuf) {
+    McastSocket *sock = &set->sockets[index];
+    struct sockaddr_in address;
+    int off = 0;
+    int on = 1;
+
+    memset(&address, 0, sizeof(address));
+    setupSocket(&sock->sd, set->subs[first].port, &address, MODE_SERVER, rcvbuf);
+    sock->port = set->subs[first].port;
+    sock->first = first;
+    sock->count = count;
+    sock->rcvbuf = getReceiveBuffer(sock->sd);
+
+    if (setsockopt(sock->sd, IPPROTO_IP, IP_MULTICAST_ALL, &off, sizeof(off)) == -1) {
+        perror("setsockopt IP_MULTICAST_ALL");
+        return -1;
+    }
+    if (setsockopt(sock->sd, IPPROTO_IP, IP_PKTINFO, &on, sizeof(on)) == -1) {
+        perror("setsockopt IP_PKTINFO");
+        return -1;
+    }
+
+    for (int i = first; i < first + count; i++) {
+        Subscription *sub = &set->subs[i];
+        char name[64];
+
+        sub->socketIndex = index;
+        if (joinGroup(sock->sd, sub, &set->filter) == -1) {
+            mcastFormat(sub, name, sizeof(name));
+            printf("Error: Failed to join %s: %s\n", name, strerror(errno));
+            if (errno == ENOBUFS) {
+                printf("Too many sources per group (see net.ipv4.igmp_max_msf)\n");
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* ================================================================
+ * mcastOpen() — Open sockets, join groups, set up epoll
+ * ================================================================ */
+int mcastOpen(McastSet *set, Subscription *subs, int count,
+              const SourceFilter *filter, int rcvbuf) {
+    memset(set, 0, sizeof(*set));
+    set->subs = subs;
+    set->subCount = count;
+    set->epfd = -1;
+    if (filter != NULL) {
+        set->filter = *filter;
+    }
+
+    qsort(subs, count, sizeof(Subscription), compareSubscriptions);
+    for (int i = 1; i < count; i++) {
+        if (compareSubscriptions(&subs[i - 1], &subs[i]) == 0) {
+            char name[64];
+            mcastFormat(&subs[i], name, sizeof(name));
+            printf("Error: Duplicate subscription %s\n", name);
+            return -1;
+        }
+    }
+
+    // Worst case: every subscription on its own socket
+    set->sockets = calloc(count, sizeof(McastSocket));
+    if (set->sockets == NULL) {
+        printf("Error: Could not allocate sockets\n");
+        return -1;
+    }
+
+    // One socket per port, split every MCAST_GROUPS_PER_SOCKET groups
+    int first = 0;
+    while (first < count) {
+        int last = first + 1;
+        while (last < count && subs[last].port == subs[first].port &&
+               last - first < MCAST_GROUPS_PER_SOCKET) {
+            last++;
+        }
+        if (openSocket(set, set->socketCount, first, last - first, rcvbuf) == -1) {
+            return -1;
+        }
+        set->socketCount++;
+        first = last;
+    }
+
+    if (set->socketCount == 1) {
+        return 0;
+    }
+
+    set->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (set->epfd == -1) {
+        perror("epoll_create1");
+        return -1;
+    }
+    for (int i = 0; i < set->socketCount; i++) {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u32 = (uint32_t)i;
+        if (epoll_ctl(set->epfd, EPOLL_CTL_ADD, set->sockets[i].sd, &event) == -1) {
+            perror("epoll_ctl");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* ================================================================
+ * mcastNextReady() — Next socket with data
+ *
+ * Sockets are level-triggered and handed out one per call in the
+ * order epoll_wait() reported them, so every ready socket is served
+ * once before any socket is served twice.
+ * ================================================================ */
+int mcastNextReady(McastSet *set, int wait) {
+    if (set->socketCount == 1) {
+        return 0;
+    }
+
+    if (set->next < set->ready) {
+        return (int)set->events[set->next++].data.u32;
+    }
+
+    int ready = epoll_wait(set->epfd, set->events, MCAST_EVENTS, wait ? -1 : 0);
+    if (ready == -1) {
+        return -1;
+    }
+    if (ready == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    set->waits++;
+    set->ready = ready;
+    set->next = 1;
+    return (int)set->events[0].data.u32;
+}
+
+/* ================================================================
+ * mcastAllowed() — Check a sender against the source filter
+ * ================================================================ */
+int mcastAllowed(const McastSet *set, struct in_addr source) {
+    const SourceFilter *filter = &set->filter;
+
+    if (filter->mode == SOURCE_ANY) {
+        return 1;
+    }
+
+    int listed = 0;
+    for (int i = 0; i < filter->count; i++) {
+        if (filter->sources[i].s_addr == source.s_addr) {
+            listed = 1;
+            break;
+        }
+    }
+    return filter->mode == SOURCE_INCLUDE ? listed : !listed;
+}
+
+/* ================================================================
+ * mcastLookup() — Subscription a datagram belongs to
+ *
+ * An interface-specific subscription wins over one on any
+ * interface for the same group.
+ * ================================================================ */
+Subscription *mcastLookup(McastSet *set, int socketIndex, struct in_addr group,
+                          int ifindex) {
+    const McastSocket *sock = &set->sockets[socketIndex];
+    Subscription *any = NULL;
+
+    for (int i = sock->first; i < sock->first + sock->count; i++) {
+        Subscription *sub = &set->subs[i];
+        if (sub->group.s_addr != group.s_addr) {
+            continue;
+        }
+        if (sub->ifindex == ifindex) {
+            return sub;
+        }
+        if (sub->ifindex == 0) {
+            any = sub;
+        }
+    }
+    return any;
+}
+
+/* ================================================================
+ * mcastFormat() — "group:port[@interface]"
+ * ================================================================ */
+void mcastFormat(const Subscription *sub, char *buffer, size_t size) {
+    char group[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &sub->group, group, sizeof(group));
+
+    if (sub->ifname[0] != '\0') {
+        snprintf(buffer, size, "%s:%d@%s", group, sub->port, sub->ifname);
+    }
+    else {
+        snprintf(buffer, size, "%s:%d", group, sub->port);
+    }
+}
+
+/* ================================================================
+ * mcastReport() — Print the filter and per-subscription counters
+ *
+ * With the filter in the kernel, rejected senders never reach the
+ * socket, so the filtered count only shows what slipped through;
+ * with --user-filter it counts every rejected datagram.
+ * ================================================================ */
+void mcastReport(const McastSet *set) {
+    const SourceFilter *filter = &set->filter;
+
+    printf("Subscriptions: %d on %d sockets, %ld epoll_wait() calls\n",
+           set->subCount, set->socketCount, set->waits);
+
+    if (filter->mode != SOURCE_ANY) {
+        long filtered = 0;
+        long filteredBytes = 0;
+        for (int i = 0; i < set->subCount; i++) {
+            filtered += set->subs[i].filtered;
+            filteredBytes += set->subs[i].filteredBytes;
+        }
+        printf("Source filter: %s %d sender(s) %s, %ld datagrams (%ld bytes) filtered in user space\n",
+               filter->mode == SOURCE_INCLUDE ? "include" : "exclude", filter->count,
+               filter->kernel ? "in the kernel" : "in user space only",
+               filtered, filteredBytes);
+    }
+
+    if (set->subCount == 1) {
+        return;
+    }
+    for (int i = 0; i < set->subCount; i++) {
+        char name[64];
+        mcastFormat(&set->subs[i], name, sizeof(name));
+        printf("  %-28s %10ld datagrams %12ld bytes", name,
+               set->subs[i].datagrams, set->subs[i].bytes);
+        if (filter->mode != SOURCE_ANY) {
+            printf(" %10ld filtered", set->subs[i].filtered);
+        }
+        printf("\n");
+    }
+}
+
+/* ================================================================
+ * mcastClose() — Close sockets and epoll, free the set
+ * ================================================================ */
+void mcastClose(McastSet *set) {
+    for (int i = 0; i < set->socketCount; i++) {
+        close(set->sockets[i].sd);
+    }
+    if (set->epfd != -1) {
+        close(set->epfd);
+    }
+    free(set->sockets);
+    free(set->subs);
+    memset(set, 0, sizeof(*set));
+    set->epfd = -1;
+}
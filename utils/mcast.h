@@ -0,0 +1,223 @@
+/* ================================================================
+ * mcast.h — Multicast Subscriptions
+ *
+ * Lets one server receive many multicast feeds. Each subscription
+ * is a group, a port and optionally an interface. Subscriptions on
+ * the same port share a bound socket (up to MCAST_GROUPS_PER_SOCKET
+ * memberships each), and all sockets are multiplexed with epoll.
+ * IP_PKTINFO tells which group a datagram was sent to.
+ *
+ * An optional source filter limits every group to a list of senders
+ * (INCLUDE) or blocks a list of senders (EXCLUDE). It is installed
+ * in the kernel as source-specific joins, so unwanted senders are
+ * dropped before they reach user space; the receive loop checks it
+ * again and counts whatever still gets through.
+ * ================================================================ */
+
+#ifndef MCAST_H
+#define MCAST_H
+
+#include <stdint.h>
+#include <net/if.h>      // IF_NAMESIZE
+#include <netinet/in.h>  // struct in_addr
+#include <sys/epoll.h>   // struct epoll_event
+
+// Upper bound for the number of subscriptions in one server.
+#define MAX_SUBSCRIPTIONS 1024
+
+// Memberships per socket (Linux igmp_max_memberships defaults to 20).
+#define MCAST_GROUPS_PER_SOCKET 20
+
+// Ready sockets taken from one epoll_wait() call.
+#define MCAST_EVENTS 64
+
+// Upper bound for the source filter list.
+#define MAX_SOURCES 64
+
+/* ================================================================
+ * SourceMode enum:
+ * How the source filter list is applied.
+ * ================================================================ */
+typedef enum {
+    SOURCE_ANY,                 // No filter: any-source joins
+    SOURCE_INCLUDE,             // Only the listed senders
+    SOURCE_EXCLUDE              // Every sender except the listed ones
+} SourceMode;
+
+/* ================================================================
+ * SourceFilter struct:
+ * Sender list applied to every subscription.
+ *
+ *  - kernel: 1 = install with MCAST_JOIN_SOURCE_GROUP /
+ *    MCAST_BLOCK_SOURCE; 0 = join any-source and filter only in the
+ *    receive loop (every filtered datagram is then counted)
+ * ================================================================ */
+typedef struct {
+    SourceMode mode;                    // Include, exclude or none
+    struct in_addr sources[MAX_SOURCES];  // Listed senders
+    int count;                          // Senders in the list
+    int kernel;                         // Filter in the kernel too
+} SourceFilter;
+
+/* ================================================================
+ * Subscription struct:
+ * One group:port[@interface] feed and its counters.
+ *
+ *  - ifindex: interface to join on (0 = chosen by the routing table)
+ *  - socketIndex: which McastSocket carries it
+ * ================================================================ */
+typedef struct {
+    struct in_addr group;       // Multicast group
+    int port;                   // UDP port
+    int ifindex;                // Interface index (0 = any)
+    char ifname[IF_NAMESIZE];   // Interface name ("" = any)
+    int socketIndex;            // Socket carrying this subscription
+    long datagrams;             // Datagrams received
+    long bytes;                 // Payload bytes received
+    long filtered;              // Datagrams rejected by the source filter
+    long filteredBytes;         // Payload bytes rejected by the filter
+} Subscription;
+
+/* ================================================================
+ * McastSocket struct:
+ * One bound socket and the range of subscriptions joined on it.
+ *
+ *  - rcvbuf: what the kernel reports for SO_RCVBUF (about twice
+ *    the size asked for)
+ *  - dropsSeen: the SO_RXQ_OVFL counter of the latest datagram;
+ *    drops only moves forward by the difference
+ * ================================================================ */
+typedef struct {
+    int sd;                     // UDP socket bound to INADDR_ANY:port
+    int port;                   // Bound port
+    int first;                  // First subscription on this socket
+    int count;                  // Subscriptions on this socket
+    int rcvbuf;                 // Effective receive buffer bytes
+    uint32_t dropsSeen;         // Last cumulative kernel drop counter
+    long drops;                 // Datagrams the kernel dropped (buffer full)
+    int grows;                  // Times the buffer was grown
+    uint64_t grownNs;           // CLOCK_MONOTONIC time of the last growth
+} McastSocket;
+
+/* ================================================================
+ * McastSet struct:
+ * All subscriptions, their sockets, and the epoll instance.
+ *
+ *  - subs: sorted by port, so each socket's subscriptions are
+ *    contiguous
+ *  - events / ready / next: sockets reported by the last
+ *    epoll_wait() that have not been handed out yet
+ * ================================================================ */
+typedef struct {
+    Subscription *subs;         // Subscriptions
+    int subCount;               // Number of subscriptions
+    McastSocket *sockets;       // Sockets
+    int socketCount;            // Number of sockets
+    int epfd;                   // epoll instance (-1 with one socket)
+    struct epoll_event events[MCAST_EVENTS];  // Last epoll_wait() result
+    int ready;                  // Events in the last result
+    int next;                   // Next event to hand out
+    long waits;                 // epoll_wait() calls that returned events
+    SourceFilter filter;        // Sender filter for every subscription
+} McastSet;
+
+/* ================================================================
+ * mcastParse():
+ * Parses "group:port" or "group:port@interface" into *sub. The
+ * interface is a name (eth0) or one of its IPv4 addresses.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error (message printed)
+ * ================================================================ */
+int mcastParse(const char *spec, Subscription *sub);
+
+/* ================================================================
+ * mcastLoadFile():
+ * Appends the subscriptions listed in `path` (one spec per line,
+ * blank lines and '#' comments ignored) to subs[*count], up to
+ * MAX_SUBSCRIPTIONS.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error (message printed)
+ * ================================================================ */
+int mcastLoadFile(const char *path, Subscription *subs, int *count);
+
+/* ================================================================
+ * mcastAddSources():
+ * Adds the comma-separated IPv4 addresses in `list` to the filter
+ * in `mode`. Include and exclude lists cannot be mixed.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error (message printed)
+ * ================================================================ */
+int mcastAddSources(SourceFilter *filter, SourceMode mode, const char *list);
+
+/* ================================================================
+ * mcastOpen():
+ * Opens and binds the sockets with a `rcvbuf`-byte receive buffer
+ * (0 = system default), joins every subscription under `filter`
+ * (NULL = any source), and registers the sockets with epoll.
+ * Takes over `subs` (malloc'ed, freed by mcastClose()), which is
+ * reordered by port.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error (message printed)
+ * ================================================================ */
+int mcastOpen(McastSet *set, Subscription *subs, int count,
+              const SourceFilter *filter, int rcvbuf);
+
+/* ================================================================
+ * mcastAllowed():
+ * Returns nonzero if the source filter lets `source` through.
+ * ================================================================ */
+int mcastAllowed(const McastSet *set, struct in_addr source);
+
+/* ================================================================
+ * mcastNextReady():
+ * Returns the index of a socket with data to read. With `wait`, it
+ * blocks in epoll_wait() until one is ready; without, it returns at
+ * once. With a single socket there is nothing to multiplex: socket 0
+ * is returned right away and the caller's receive call does the
+ * waiting.
+ *
+ * Returns:
+ *  - socket index
+ *  - -1 on error (errno set; EINTR, and EAGAIN when nothing is
+ *    ready without `wait`)
+ * ================================================================ */
+int mcastNextReady(McastSet *set, int wait);
+
+/* ================================================================
+ * mcastLookup():
+ * Finds the subscription on socket `socketIndex` that a datagram
+ * sent to `group` and received on `ifindex` belongs to.
+ *
+ * Returns: the subscription, or NULL if none matches
+ * ================================================================ */
+Subscription *mcastLookup(McastSet *set, int socketIndex, struct in_addr group,
+                          int ifindex);
+
+/* ================================================================
+ * mcastFormat():
+ * Writes "group:port" or "group:port@interface" into buffer.
+ * ================================================================ */
+void mcastFormat(const Subscription *sub, char *buffer, size_t size);
+
+/* ================================================================
+ * mcastReport():
+ * Prints the source filter and per-subscription datagram, byte and
+ * filtered counts.
+ * ================================================================ */
+void mcastReport(const McastSet *set);
+
+/* ================================================================
+ * mcastClose():
+ * Closes the sockets and epoll instance and frees the set.
+ * ================================================================ */
+void mcastClose(McastSet *set);
+
+#endif /* MCAST_H */
@@ -0,0 +1,409 @@
+/* ================================================================
+ * outsink.c — Asynchronous Buffered Output
+ *
+ * Threads format into their own buffer; a writer thread writes the
+ * filled buffers to the output with writev(), many at a time.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "outsink.h"
+
+// Buffers gathered into one writev() call (well below IOV_MAX).
+#define OUT_WRITE_BATCH 64
+
+// The calling thread's buffer (one sink per program).
+static __thread OutBuffer *currentBuffer = NULL;
+
+/* ================================================================
+ * takeBlock() — An empty buffer from the pool, or NULL
+ *
+ * With `wait` set, waits (and counts a stall) until the writer
+ * returns one; otherwise gives up at once.
+ * ================================================================ */
+static OutBlock *takeBlock(OutSink *sink, int wait) {
+    OutBlock *block = mpmcPop(&sink->freeRing);
+    if (block != NULL || !wait) {
+        return block;
+    }
+
+    atomic_fetch_add_explicit(&sink->stalls, 1, memory_order_relaxed);
+    unsigned attempt = 0;
+    while ((block = mpmcPop(&sink->freeRing)) == NULL) {
+        ringBackoff(&attempt);
+    }
+    return block;
+}
+
+/* ================================================================
+ * submitBlock() — Queue the thread's buffer for the writer
+ * ================================================================ */
+static void submitBlock(OutBuffer *out) {
+    if (out->block == NULL) {
+        return;
+    }
+    if (out->block->length == 0) {
+        return;
+    }
+
+    // The queue can hold every buffer, so this cannot fail
+    atomic_fetch_add_explicit(&out->sink->queued, 1, memory_order_relaxed);
+    mpmcPush(&out->sink->queue, out->block);
+    out->block = NULL;
+    out->mark = 0;
+}
+
+/* ================================================================
+ * writeAll() — writev() a set of buffers, resuming after short writes
+ * ================================================================ */
+static void writeAll(OutSink *sink, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(sink->fd, iov, count);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // The output is gone (closed pipe, full disk): discard
+            perror("writev");
+            return;
+        }
+
+        sink->writeCalls++;
+        sink->bytesWritten += written;
+
+        // Skip fully written iovecs, trim the partially written one
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+}
+
+/* ================================================================
+ * writerMain() — Writer thread: write queued buffers until stopped
+ *
+ * After `stopping` is set the queue is checked once more, so every
+ * buffer queued before the stop is still written.
+ * ================================================================ */
+static void *writerMain(void *arg) {
+    OutSink *sink = arg;
+    OutBlock *blocks[OUT_WRITE_BATCH];
+    struct iovec iov[OUT_WRITE_BATCH];
+    unsigned attempt = 0;
+
+    while (1) {
+        int count = 0;
+        while (count < OUT_WRITE_BATCH &&
+               (blocks[count] = mpmcPop(&sink->queue)) != NULL) {
+            iov[count].iov_base = blocks[count]->data;
+            iov[count].iov_len = blocks[count]->length;
+            count++;
+        }
+
+        if (count == 0) {
+            if (!atomic_load_explicit(&sink->stopping, memory_order_acquire)) {
+                ringBackoff(&attempt);
+                continue;
+            }
+            if ((blocks[0] = mpmcPop(&sink->queue)) == NULL) {
+                break;
+            }
+            iov[0].iov_base = blocks[0]->data;
+            iov[0].iov_len = blocks[0]->length;
+            count = 1;
+        }
+        attempt = 0;
+
+        writeAll(sink, iov, count);
+        sink->blocksWritten += count;
+
+        for (int i = 0; i < count; i++) {
+            blocks[i]->length = 0;
+            mpmcPush(&sink->freeRing, blocks[i]);
+        }
+        atomic_fetch_sub_explicit(&sink->queued, count, memory_order_relaxed);
+    }
+
+    return NULL;
+}
+
+/* ================================================================
+ * outSinkInit() — Allocate the buffer pool, start the writer
+ * ================================================================ */
+int outSinkInit(OutSink *sink, int fd, int blocks, size_t blockSize,
+                OutPolicy policy, int sampleEvery) {
+    memset(sink, 0, sizeof(*sink));
+    sink->fd = fd;
+    sink->policy = policy;
+    sink->sampleEvery = sampleEvery > 0 ? sampleEvery : 1;
+    sink->blockCount = blocks;
+    sink->blockSize = blockSize;
+    atomic_init(&sink->queued, 0);
+    atomic_init(&sink->stopping, 0);
+    atomic_init(&sink->stalls, 0);
+    atomic_init(&sink->dropped, 0);
+    atomic_init(&sink->sampledOut, 0);
+    pthread_mutex_init(&sink->lock, NULL);
+
+    sink->blocks = calloc(blocks, sizeof(OutBlock));
+    if (sink->blocks == NULL ||
+        mpmcInit(&sink->freeRing, blocks) == -1 ||
+        mpmcInit(&sink->queue, blocks) == -1) {
+        printf("Error: Could not allocate output buffers\n");
+        return -1;
+    }
+
+    for (int i = 0; i < blocks; i++) {
+        sink->blocks[i].data = malloc(blockSize);
+        if (sink->blocks[i].data == NULL) {
+            printf("Error: Could not allocate output buffers\n");
+            return -1;
+        }
+        sink->blocks[i].size = blockSize;
+        mpmcPush(&sink->freeRing, &sink->blocks[i]);
+    }
+
+    int err = pthread_create(&sink->writer, NULL, writerMain, sink);
+    if (err != 0) {
+        printf("Error: Could not start output thread: %s\n", strerror(err));
+        return -1;
+    }
+    sink->started = 1;
+    return 0;
+}
+
+/* ================================================================
+ * outCurrent() — The calling thread's buffer, created on first use
+ * ================================================================ */
+OutBuffer *outCurrent(OutSink *sink) {
+    if (currentBuffer != NULL && currentBuffer->sink == sink) {
+        return currentBuffer;
+    }
+
+    OutBuffer *out = calloc(1, sizeof(OutBuffer));
+    if (out == NULL) {
+        perror("calloc");
+        exit(1);
+    }
+    out->sink = sink;
+
+    // Registered so outSinkStop() can flush it after the thread ends
+    pthread_mutex_lock(&sink->lock);
+    out->next = sink->buffers;
+    sink->buffers = out;
+    pthread_mutex_unlock(&sink->lock);
+
+    currentBuffer = out;
+    return out;
+}
+
+/* ================================================================
+ * outBegin() — Start a message, applying the policy
+ *
+ * Sampling is by message count on each thread, so a steady stream
+ * keeps exactly one message in sampleEvery while the queue is more
+ * than half full.
+ * ================================================================ */
+int outBegin(OutBuffer *out) {
+    OutSink *sink = out->sink;
+
+    out->messages++;
+    out->skipping = 0;
+
+    if (sink->policy == OUT_SAMPLE &&
+        atomic_load_explicit(&sink->queued, memory_order_relaxed) > sink->blockCount / 2 &&
+        out->messages % sink->sampleEvery != 0) {
+        atomic_fetch_add_explicit(&sink->sampledOut, 1, memory_order_relaxed);
+        out->skipping = 1;
+        return 0;
+    }
+
+    if (out->block == NULL) {
+        out->block = takeBlock(sink, sink->policy == OUT_BLOCK);
+        if (out->block == NULL) {
+            atomic_fetch_add_explicit(&sink->dropped, 1, memory_order_relaxed);
+            out->skipping = 1;
+            return 0;
+        }
+    }
+
+    out->mark = out->block->length;
+    return 1;
+}
+
+/* ================================================================
+ * outBeginWait() — Start a message that bypasses the policy
+ * ================================================================ */
+void outBeginWait(OutBuffer *out) {
+    out->skipping = 0;
+
+    if (out->block == NULL) {
+        out->block = takeBlock(out->sink, 1);
+    }
+    out->mark = out->block->length;
+}
+
+/* ================================================================
+ * outVprintf() — Format into the current message
+ *
+ * When the message does not fit, the part formatted so far moves to
+ * a fresh buffer (if one is free right away) and the earlier
+ * messages are queued; otherwise the buffer grows. Either way the
+ * message stays in one piece.
+ * ================================================================ */
+void outVprintf(OutBuffer *out, const char *format, va_list args) {
+    if (out->skipping || out->block == NULL) {
+        return;
+    }
+
+    OutBlock *block = out->block;
+    va_list copy;
+    va_copy(copy, args);
+    int needed = vsnprintf(block->data + block->length,
+                           block->size - block->length, format, copy);
+    va_end(copy);
+    if (needed < 0) {
+        return;
+    }
+    if ((size_t)needed < block->size - block->length) {
+        block->length += needed;
+        return;
+    }
+
+    size_t partial = block->length - out->mark;
+    OutBlock *fresh = out->mark > 0 ? mpmcPop(&out->sink->freeRing) : NULL;
+    if (fresh != NULL && partial + needed < fresh->size) {
+        memcpy(fresh->data, block->data + out->mark, partial);
+        fresh->length = partial;
+        block->length = out->mark;
+        submitBlock(out);
+        out->block = block = fresh;
+    }
+    else {
+        if (fresh != NULL) {
+            mpmcPush(&out->sink->freeRing, fresh);
+        }
+        size_t size = block->size;
+        while (size - block->length <= (size_t)needed) {
+            size *= 2;
+        }
+        char *data = realloc(block->data, size);
+        if (data == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+        block->data = data;
+        block->size = size;
+    }
+
+    vsnprintf(block->data + block->length, block->size - block->length, format, args);
+    block->length += needed;
+}
+
+/* ================================================================
+ * outPrintf() — printf() into the current message
+ * ================================================================ */
+void outPrintf(OutBuffer *out, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    outVprintf(out, format, args);
+    va_end(args);
+}
+
+/* ================================================================
+ * outEnd() — End a message, queue the buffer once mostly full
+ * ================================================================ */
+void outEnd(OutBuffer *out) {
+    if (out->skipping || out->block == NULL) {
+        out->skipping = 0;
+        return;
+    }
+
+    out->mark = out->block->length;
+    if (out->block->length >= out->sink->blockSize / 4 * 3) {
+        submitBlock(out);
+    }
+}
+
+/* ================================================================
+ * outPending() — Check for output not yet queued
+ * ================================================================ */
+int outPending(const OutBuffer *out) {
+    return out->block != NULL && out->block->length > 0;
+}
+
+/* ================================================================
+ * outFlush() — Queue whatever the buffer holds
+ * ================================================================ */
+void outFlush(OutBuffer *out) {
+    submitBlock(out);
+}
+
+/* ================================================================
+ * outSinkStop() — Flush every thread's buffer, drain, join the writer
+ * ================================================================ */
+void outSinkStop(OutSink *sink) {
+    if (!sink->started) {
+        return;
+    }
+
+    pthread_mutex_lock(&sink->lock);
+    for (OutBuffer *out = sink->buffers; out != NULL; out = out->next) {
+        submitBlock(out);
+    }
+    pthread_mutex_unlock(&sink->lock);
+
+    atomic_store_explicit(&sink->stopping, 1, memory_order_release);
+    pthread_join(sink->writer, NULL);
+    sink->started = 0;
+}
+
+/* ================================================================
+ * outSinkReport() — Print writer and policy counters
+ * ================================================================ */
+void outSinkReport(const OutSink *sink) {
+    static const char *policyNames[] = { "block", "drop", "sample" };
+
+    printf("Output: %ld bytes in %ld writev() calls (%.1f buffers/call), policy %s\n",
+           sink->bytesWritten, sink->writeCalls,
+           sink->writeCalls > 0 ? (double)sink->blocksWritten / sink->writeCalls : 0.0,
+           policyNames[sink->policy]);
+    printf("Output backpressure: %ld stalls, %ld messages dropped, %ld sampled out\n",
+           atomic_load(&sink->stalls), atomic_load(&sink->dropped),
+           atomic_load(&sink->sampledOut));
+}
+
+/* ================================================================
+ * outSinkFree() — Release buffers, registry and rings
+ * ================================================================ */
+void outSinkFree(OutSink *sink) {
+    OutBuffer *out = sink->buffers;
+    while (out != NULL) {
+        OutBuffer *next = out->next;
+        if (out == currentBuffer) {
+            currentBuffer = NULL;
+        }
+        free(out);
+        out = next;
+    }
+
+    if (sink->blocks != NULL) {
+        for (int i = 0; i < sink->blockCount; i++) {
+            free(sink->blocks[i].data);
+        }
+    }
+    free(sink->blocks);
+    mpmcFree(&sink->freeRing);
+    mpmcFree(&sink->queue);
+    pthread_mutex_destroy(&sink->lock);
+    memset(sink, 0, sizeof(*sink));
+}
@@ -0,0 +1,192 @@
+/* ================================================================
+ * outsink.h — Asynchronous Buffered Output
+ *
+ * Threads format their output into their own buffer instead of
+ * calling printf(). Full buffers are queued for a background writer
+ * thread, which writes many of them with one writev() call, so a
+ * slow terminal or pipe never blocks the threads producing output.
+ *
+ * Output is grouped into messages (one datagram's output). A message
+ * always stays in one buffer, so messages from different threads
+ * never interleave. When the writer falls behind, the policy decides
+ * whether producers wait, drop messages, or keep only a sample.
+ * ================================================================ */
+
+#ifndef OUTSINK_H
+#define OUTSINK_H
+
+#include <stddef.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "ring.h"
+
+// Default buffer size and count.
+#define OUT_BLOCK_SIZE (256 * 1024)
+#define OUT_BLOCKS 64
+
+// Default sampling rate for OUT_SAMPLE: keep one message in this many.
+#define OUT_SAMPLE_EVERY 10
+
+/* ================================================================
+ * OutPolicy enum:
+ * What a producer does when the writer falls behind.
+ *
+ *  - OUT_BLOCK: wait for a free buffer (nothing is lost)
+ *  - OUT_DROP: drop messages while no buffer is free
+ *  - OUT_SAMPLE: once more than half the buffers are queued, keep
+ *                only one message in sampleEvery; drop when full
+ * ================================================================ */
+typedef enum {
+    OUT_BLOCK,
+    OUT_DROP,
+    OUT_SAMPLE
+} OutPolicy;
+
+/* ================================================================
+ * OutBlock struct:
+ * One formatting buffer. It grows when a single message needs more
+ * than blockSize bytes.
+ * ================================================================ */
+typedef struct {
+    char *data;             // Formatted bytes
+    size_t length;          // Bytes used
+    size_t size;            // Bytes allocated
+} OutBlock;
+
+struct OutSink;
+
+/* ================================================================
+ * OutBuffer struct:
+ * A thread's formatting state, created on first use by outCurrent().
+ *
+ *  - block: buffer being filled (NULL if none could be taken)
+ *  - mark: where the current message started in block
+ *  - skipping: the current message is being dropped
+ * ================================================================ */
+typedef struct OutBuffer {
+    struct OutSink *sink;       // Owning sink
+    OutBlock *block;            // Current buffer
+    size_t mark;                // Start of the current message
+    int skipping;               // Current message is discarded
+    long messages;              // Messages begun (for sampling)
+    struct OutBuffer *next;     // Registry of all thread buffers
+} OutBuffer;
+
+/* ================================================================
+ * OutSink struct:
+ * Buffer pool, queue, writer thread and counters.
+ * ================================================================ */
+typedef struct OutSink {
+    int fd;                     // Destination (usually stdout)
+    OutPolicy policy;           // Behaviour when behind
+    int sampleEvery;            // OUT_SAMPLE rate
+    int blockCount;             // Buffers in the pool
+    size_t blockSize;           // Initial size of each buffer
+    OutBlock *blocks;           // Buffer pool
+    MpmcRing freeRing;          // Empty buffers
+    MpmcRing queue;             // Filled buffers, in submission order
+    atomic_long queued;         // Buffers currently queued
+    pthread_t writer;           // Writer thread
+    int started;                // Writer thread is running
+    atomic_int stopping;        // Writer drains the queue and exits
+    pthread_mutex_t lock;       // Protects the buffer registry
+    OutBuffer *buffers;         // Every thread's OutBuffer
+
+    // Writer counters (writer thread only until it exits)
+    long bytesWritten;          // Bytes written
+    long writeCalls;            // writev() calls
+    long blocksWritten;         // Buffers written
+
+    // Producer counters
+    atomic_long stalls;         // Waits for a free buffer
+    atomic_long dropped;        // Messages dropped
+    atomic_long sampledOut;     // Messages skipped by sampling
+} OutSink;
+
+/* ================================================================
+ * outSinkInit():
+ * Allocate `blocks` buffers of `blockSize` bytes and start the
+ * writer thread for `fd`. Anything still buffered in stdio for the
+ * same descriptor must be flushed by the caller first.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error
+ * ================================================================ */
+int outSinkInit(OutSink *sink, int fd, int blocks, size_t blockSize,
+                OutPolicy policy, int sampleEvery);
+
+/* ================================================================
+ * outCurrent():
+ * Returns the calling thread's buffer for `sink`, creating it on
+ * first use.
+ * ================================================================ */
+OutBuffer *outCurrent(OutSink *sink);
+
+/* ================================================================
+ * outBegin():
+ * Starts a message. Applies the sink's policy.
+ *
+ * Returns:
+ *  - 1 if the message should be formatted
+ *  - 0 if it is dropped or sampled out (outPrintf() would discard
+ *    it anyway; skipping the formatting saves the work)
+ * ================================================================ */
+int outBegin(OutBuffer *out);
+
+/* ================================================================
+ * outBeginWait():
+ * Starts a message that is never dropped or sampled out, whatever
+ * the policy: waits for a free buffer if necessary. For statistics
+ * that must survive the overload they describe.
+ * ================================================================ */
+void outBeginWait(OutBuffer *out);
+
+/* ================================================================
+ * outPrintf() / outVprintf():
+ * Formats into the current message, like printf().
+ * ================================================================ */
+void outPrintf(OutBuffer *out, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+void outVprintf(OutBuffer *out, const char *format, va_list args);
+
+/* ================================================================
+ * outEnd():
+ * Ends a message. Queues the buffer once it is mostly full.
+ * ================================================================ */
+void outEnd(OutBuffer *out);
+
+/* ================================================================
+ * outPending():
+ * Returns nonzero if the buffer holds output not yet queued.
+ * ================================================================ */
+int outPending(const OutBuffer *out);
+
+/* ================================================================
+ * outFlush():
+ * Queues whatever the buffer holds. Call before the thread goes
+ * idle so output is not held back.
+ * ================================================================ */
+void outFlush(OutBuffer *out);
+
+/* ================================================================
+ * outSinkStop():
+ * Queues every thread's remaining output, lets the writer drain the
+ * queue, and joins it. Producer threads must be finished.
+ * ================================================================ */
+void outSinkStop(OutSink *sink);
+
+/* ================================================================
+ * outSinkReport():
+ * Prints bytes written, writev() calls, stalls, drops and samples.
+ * ================================================================ */
+void outSinkReport(const OutSink *sink);
+
+/* ================================================================
+ * outSinkFree():
+ * Releases buffers, registry and rings (after outSinkStop()).
+ * ================================================================ */
+void outSinkFree(OutSink *sink);
+
+#endif /* OUTSINK_H */
@@ -0,0 +1,206 @@
+/* ================================================================
+ * pacer.c — Token Bucket Rate Pacer
+ *
+ * Limits the client's send rate to a target number of records or
+ * bytes per second. Time comes from CLOCK_MONOTONIC; waits use an
+ * absolute timerfd deadline, or a busy-spin loop for microsecond
+ * pacing.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "pacer.h"
+
+#define NSEC_PER_SEC 1000000000ULL
+
+/* ================================================================
+ * refill() — Add the tokens earned since the last refill
+ *
+ * The bucket holds at most one item's worth of tokens (`cost`), so a
+ * pause never turns into a burst: items stay evenly spaced.
+ * ================================================================ */
+static void refill(Pacer *pacer, uint64_t now, double cost) {
+    // First item: start with a full bucket so it goes out immediately
+    if (pacer->lastRefillNs == 0) {
+        pacer->lastRefillNs = now;
+        pacer->tokens = cost;
+        return;
+    }
+
+    double elapsed = (double)(now - pacer->lastRefillNs) / NSEC_PER_SEC;
+    pacer->tokens += elapsed * pacer->rate;
+    if (pacer->tokens > cost) {
+        pacer->tokens = cost;
+    }
+    pacer->lastRefillNs = now;
+}
+
+/* ================================================================
+ * sleepUntil() — Wait for an absolute CLOCK_MONOTONIC deadline
+ *
+ * Spin mode polls clock_gettime() (vDSO, no syscall) until the
+ * deadline passes. Otherwise the timerfd is armed with
+ * TFD_TIMER_ABSTIME and read() blocks until it expires.
+ * ================================================================ */
+static void sleepUntil(Pacer *pacer, uint64_t deadline) {
+    if (pacer->spin) {
+        while (pacerNowNs() < deadline) {
+            // Busy-wait
+        }
+        return;
+    }
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = deadline / NSEC_PER_SEC;
+    spec.it_value.tv_nsec = deadline % NSEC_PER_SEC;
+
+    if (timerfd_settime(pacer->timerFd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+        perror("timerfd_settime");
+        return;
+    }
+
+    uint64_t expirations;
+    while (read(pacer->timerFd, &expirations, sizeof(expirations)) == -1) {
+        if (errno != EINTR) {
+            perror("read timerfd");
+            return;
+        }
+    }
+}
+
+/* ================================================================
+ * pacerNowNs() — Current CLOCK_MONOTONIC time in nanoseconds
+ * ================================================================ */
+uint64_t pacerNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/* ================================================================
+ * pacerInit() — Initialize the token bucket and timerfd
+ * ================================================================ */
+int pacerInit(Pacer *pacer, double rate, PaceUnit unit, int spin) {
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->rate = rate;
+    pacer->unit = unit;
+    pacer->spin = spin;
+    pacer->timerFd = -1;
+
+    // Unlimited or spinning pacers never sleep on the timer
+    if (rate > 0 && !spin) {
+        pacer->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (pacer->timerFd == -1) {
+            perror("timerfd_create");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* ================================================================
+ * pacerDelayNs() — Time until `cost` tokens are available
+ * ================================================================ */
+uint64_t pacerDelayNs(Pacer *pacer, double cost) {
+    if (pacer->rate <= 0) {
+        return 0;
+    }
+
+    refill(pacer, pacerNowNs(), cost);
+    if (pacer->tokens >= cost) {
+        return 0;
+    }
+
+    return (uint64_t)ceil((cost - pacer->tokens) / pacer->rate * NSEC_PER_SEC);
+}
+
+/* ================================================================
+ * pacerWait() — Block until `cost` tokens are available, take them
+ * ================================================================ */
+void pacerWait(Pacer *pacer, double cost) {
+    uint64_t now = pacerNowNs();
+
+    if (pacer->items == 0) {
+        pacer->startNs = now;
+    }
+
+    if (pacer->rate > 0) {
+        refill(pacer, now, cost);
+
+        if (pacer->tokens < cost) {
+            uint64_t deadline = now + (uint64_t)ceil((cost - pacer->tokens) /
+                                                     pacer->rate * NSEC_PER_SEC);
+            sleepUntil(pacer, deadline);
+            now = pacerNowNs();
+
+            // Record how late the wake-up was
+            uint64_t late = now > deadline ? now - deadline : 0;
+            pacer->waits++;
+            pacer->jitterSumNs += (double)late;
+            pacer->jitterSqSumNs += (double)late * (double)late;
+            if (late > pacer->jitterMaxNs) {
+                pacer->jitterMaxNs = late;
+            }
+
+            refill(pacer, now, cost);
+        }
+
+        pacer->tokens -= cost;
+    }
+
+    pacer->items++;
+    pacer->units += cost;
+    pacer->lastNs = now;
+}
+
+/* ================================================================
+ * pacerReport() — Print target/achieved rate and jitter
+ *
+ * The achieved rate is measured from the first item to the last,
+ * so n items span n - 1 intervals.
+ * ================================================================ */
+void pacerReport(const Pacer *pacer) {
+    const char *unitName = (pacer->unit == PACE_BYTES) ? "bytes/s" : "records/s";
+
+    if (pacer->rate > 0) {
+        printf("Pacing: target %.1f %s (%s)\n", pacer->rate, unitName,
+               pacer->spin ? "busy-spin" : "timerfd");
+    }
+    else {
+        printf("Pacing: unlimited\n");
+    }
+
+    if (pacer->items < 2 || pacer->lastNs <= pacer->startNs) {
+        return;
+    }
+
+    double elapsed = (double)(pacer->lastNs - pacer->startNs) / NSEC_PER_SEC;
+    double perItem = pacer->units / pacer->items;
+    printf("Achieved: %.1f %s over %.3f s\n",
+           (pacer->units - perItem) / elapsed, unitName, elapsed);
+
+    if (pacer->waits > 0) {
+        double mean = pacer->jitterSumNs / pacer->waits;
+        double variance = pacer->jitterSqSumNs / pacer->waits - mean * mean;
+        printf("Jitter: mean %.1f us, stddev %.1f us, max %.1f us over %ld waits\n",
+               mean / 1000.0, sqrt(variance > 0 ? variance : 0) / 1000.0,
+               pacer->jitterMaxNs / 1000.0, pacer->waits);
+    }
+}
+
+/* ================================================================
+ * pacerFree() — Close the timerfd
+ * ================================================================ */
+void pacerFree(Pacer *pacer) {
+    if (pacer->timerFd != -1) {
+        close(pacer->timerFd);
+        pacer->timerFd = -1;
+    }
+}
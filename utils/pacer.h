@@ -0,0 +1,98 @@
+/* ================================================================
+ * pacer.h — Token Bucket Rate Pacer
+ *
+ * Limits the client's send rate to a target number of records or
+ * bytes per second. Time comes from CLOCK_MONOTONIC; waits use an
+ * absolute timerfd deadline, or a busy-spin loop for microsecond
+ * pacing.
+ * ================================================================ */
+
+#ifndef PACER_H
+#define PACER_H
+
+#include <stdint.h>
+
+/* ================================================================
+ * PaceUnit enum:
+ * What one token in the bucket stands for.
+ * ================================================================ */
+typedef enum {
+    PACE_RECORDS,
+    PACE_BYTES
+} PaceUnit;
+
+/* ================================================================
+ * Pacer struct:
+ * Token bucket state plus run statistics.
+ *
+ *  - rate: tokens added per second (0 = unlimited, never waits)
+ *  - tokens: tokens currently in the bucket
+ *  - lastRefillNs: CLOCK_MONOTONIC time of the last refill
+ *
+ * Jitter is the lateness of each wake-up: the time the wait actually
+ * returned minus the deadline it was asked to wake at.
+ * ================================================================ */
+typedef struct {
+    double rate;            // Target tokens per second
+    PaceUnit unit;          // Records or bytes
+    int spin;               // 1 = busy-spin, 0 = sleep on timerfd
+    int timerFd;            // CLOCK_MONOTONIC timerfd (-1 when spinning)
+    double tokens;          // Tokens currently available
+    uint64_t lastRefillNs;  // Time of the last refill
+
+    // Statistics
+    uint64_t startNs;       // Time of the first pacerWait()
+    uint64_t lastNs;        // Time the last pacerWait() returned
+    long items;             // Items passed through the pacer
+    double units;           // Tokens consumed (records or bytes)
+    long waits;             // Waits that actually slept or spun
+    double jitterSumNs;     // Sum of wake-up lateness
+    double jitterSqSumNs;   // Sum of squared wake-up lateness
+    uint64_t jitterMaxNs;   // Worst wake-up lateness
+} Pacer;
+
+/* ================================================================
+ * pacerNowNs():
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ * ================================================================ */
+uint64_t pacerNowNs(void);
+
+/* ================================================================
+ * pacerInit():
+ * Initialize a pacer for `rate` units per second. A rate of 0 means
+ * "send as fast as possible". `spin` selects busy-spin waiting.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error (perror)
+ * ================================================================ */
+int pacerInit(Pacer *pacer, double rate, PaceUnit unit, int spin);
+
+/* ================================================================
+ * pacerDelayNs():
+ * Returns how many nanoseconds the caller would have to wait before
+ * an item costing `cost` units may go out (0 = right now).
+ * Does not consume tokens.
+ * ================================================================ */
+uint64_t pacerDelayNs(Pacer *pacer, double cost);
+
+/* ================================================================
+ * pacerWait():
+ * Blocks until an item costing `cost` units may go out, then
+ * consumes the tokens and updates the statistics.
+ * ================================================================ */
+void pacerWait(Pacer *pacer, double cost);
+
+/* ================================================================
+ * pacerReport():
+ * Prints the target rate, achieved rate, and wake-up jitter.
+ * ================================================================ */
+void pacerReport(const Pacer *pacer);
+
+/* ================================================================
+ * pacerFree():
+ * Closes the timerfd.
+ * ================================================================ */
+void pacerFree(Pacer *pacer);
+
+#endif /* PACER_H */
@@ -0,0 +1,329 @@
+/* ================================================================
+ * pipeline.c — Parallel Parse/Serialize Pipeline for the Client
+ *
+ * The reader thread cuts the input into chunks of whole lines and
+ * deals them round-robin to a pool of worker threads; the sender
+ * collects them in the same order, so records leave in input order.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pipeline.h"
+#include "lineparser.h"
+#include "scan.h"
+#include "sendbatch.h"
+
+/* ================================================================
+ * WorkerArgs struct:
+ * What each worker thread needs to find its rings.
+ * ================================================================ */
+typedef struct {
+    Pipeline *pipeline;
+    int index;
+} WorkerArgs;
+
+/* ================================================================
+ * pushWait() — Push, backing off while the ring is full
+ *
+ * Every ring holds more slots than there are chunks, so this only
+ * waits if something is badly wrong; it is a safety net.
+ * ================================================================ */
+static void pushWait(SpscRing *ring, void *item) {
+    unsigned attempt = 0;
+    while (spscPush(ring, item) == -1) {
+        ringBackoff(&attempt);
+    }
+}
+
+/* ================================================================
+ * growBuffer() — Make room for `needed` bytes in a heap buffer
+ * ================================================================ */
+static int growBuffer(char **buffer, size_t *size, size_t needed) {
+    if (needed <= *size) {
+        return 0;
+    }
+
+    size_t newSize = *size ? *size : CHUNK_BYTES;
+    while (newSize < needed) {
+        newSize *= 2;
+    }
+    char *grown = realloc(*buffer, newSize);
+    if (grown == NULL) {
+        perror("realloc");
+        return -1;
+    }
+    *buffer = grown;
+    *size = newSize;
+    return 0;
+}
+
+/* ================================================================
+ * serializeChunk() — Worker: serialize every line of a chunk
+ *
+ * Records are written back to back into chunk->json. Before each
+ * line the buffer is grown so a full MAX_DATAGRAM record fits, which
+ * keeps the writer's overflow behaviour identical to the serial path.
+ * ================================================================ */
+static void serializeChunk(Chunk *chunk) {
+    const char *pos = chunk->data;
+    const char *end = chunk->data + chunk->length;
+
+    chunk->jsonLength = 0;
+    chunk->records = 0;
+
+    while (pos < end) {
+        const char *newline = memchr(pos, '\n', (size_t)(end - pos));
+        size_t lineLength = newline ? (size_t)(newline + 1 - pos) : (size_t)(end - pos);
+
+        if (growBuffer(&chunk->json, &chunk->jsonSize, chunk->jsonLength + MAX_DATAGRAM) == -1) {
+            break;
+        }
+        if (chunk->records == chunk->recordsSize) {
+            int newSize = chunk->recordsSize ? chunk->recordsSize * 2 : 1024;
+            size_t *grown = realloc(chunk->recordLengths, (size_t)newSize * sizeof(size_t));
+            if (grown == NULL) {
+                perror("realloc");
+                break;
+            }
+            chunk->recordLengths = grown;
+            chunk->recordsSize = newSize;
+        }
+
+        JsonWriter writer;
+        jsonWriterInit(&writer, chunk->json + chunk->jsonLength, MAX_DATAGRAM);
+        int jsonLen = serializeLine(pos, lineLength, &writer, NULL);
+        if (jsonLen > 0) {
+            chunk->recordLengths[chunk->records++] = (size_t)jsonLen;
+            chunk->jsonLength += (size_t)jsonLen;
+        }
+
+        pos += lineLength;
+    }
+}
+
+/* ================================================================
+ * workerMain() — Worker thread: serialize chunks until the marker
+ * ================================================================ */
+static void *workerMain(void *arg) {
+    WorkerArgs *args = arg;
+    SpscRing *work = &args->pipeline->work[args->index];
+    SpscRing *done = &args->pipeline->done[args->index];
+    unsigned attempt = 0;
+
+    while (1) {
+        Chunk *chunk = spscPop(work);
+        if (chunk == NULL) {
+            ringBackoff(&attempt);
+            continue;
+        }
+        attempt = 0;
+
+        if (!chunk->last) {
+            serializeChunk(chunk);
+        }
+        pushWait(done, chunk);
+
+        if (chunk->last) {
+            return NULL;
+        }
+    }
+}
+
+/* ================================================================
+ * pipelineInit() — Allocate chunks and rings, start the workers
+ * ================================================================ */
+int pipelineInit(Pipeline *pipeline, int workers) {
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->workerCount = workers;
+    pipeline->chunkCount = workers * CHUNKS_PER_WORKER;
+    pipeline->endMarker.last = 1;
+    atomic_init(&pipeline->released, 0);
+
+    // Resolve the scanner dispatch before several threads use it
+    scanImplName();
+
+    pipeline->chunks = calloc(pipeline->chunkCount, sizeof(Chunk));
+    pipeline->work = calloc(workers, sizeof(SpscRing));
+    pipeline->done = calloc(workers, sizeof(SpscRing));
+    pipeline->threads = calloc(workers, sizeof(pthread_t));
+    pipeline->workerArgs = calloc(workers, sizeof(WorkerArgs));
+    if (pipeline->chunks == NULL || pipeline->work == NULL || pipeline->done == NULL ||
+        pipeline->threads == NULL || pipeline->workerArgs == NULL) {
+        printf("Error: Could not allocate the pipeline\n");
+        return -1;
+    }
+
+    // Room for every chunk plus the end marker, so pushes never fail
+    size_t ringSize = (size_t)pipeline->chunkCount + 1;
+    if (spscInit(&pipeline->freeRing, ringSize) == -1) {
+        printf("Error: Could not allocate the pipeline\n");
+        return -1;
+    }
+    for (int i = 0; i < workers; i++) {
+        if (spscInit(&pipeline->work[i], ringSize) == -1 ||
+            spscInit(&pipeline->done[i], ringSize) == -1) {
+            printf("Error: Could not allocate the pipeline\n");
+            return -1;
+        }
+    }
+    for (int i = 0; i < pipeline->chunkCount; i++) {
+        spscPush(&pipeline->freeRing, &pipeline->chunks[i]);
+    }
+
+    WorkerArgs *args = pipeline->workerArgs;
+    for (int i = 0; i < workers; i++) {
+        args[i].pipeline = pipeline;
+        args[i].index = i;
+        int err = pthread_create(&pipeline->threads[i], NULL, workerMain, &args[i]);
+        if (err != 0) {
+            printf("Error: Could not start worker thread: %s\n", strerror(err));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* ================================================================
+ * pipelineAcquire() — Take an empty chunk from the pool
+ * ================================================================ */
+Chunk *pipelineAcquire(Pipeline *pipeline) {
+    unsigned attempt = 0;
+    Chunk *chunk = pipeline->spare;
+
+    pipeline->spare = NULL;
+    while (chunk == NULL && (chunk = spscPop(&pipeline->freeRing)) == NULL) {
+        ringBackoff(&attempt);
+    }
+
+    chunk->data = NULL;
+    chunk->length = 0;
+    return chunk;
+}
+
+/* ================================================================
+ * pipelineAppend() — Reference or copy one line into a chunk
+ * ================================================================ */
+int pipelineAppend(Chunk *chunk, const char *line, size_t length, int stable) {
+    // Mapped input: lines are contiguous, so the chunk is one view
+    if (stable && (chunk->length == 0 || chunk->data + chunk->length == line)) {
+        if (chunk->length == 0) {
+            chunk->data = line;
+        }
+        chunk->length += length;
+        return 0;
+    }
+
+    // Streamed input: the line is only valid until the next read
+    if (chunk->length > 0 && chunk->data != chunk->storage) {
+        // Switching from a view to a copy (not expected, but safe)
+        if (growBuffer(&chunk->storage, &chunk->storageSize, chunk->length) == -1) {
+            return -1;
+        }
+        memcpy(chunk->storage, chunk->data, chunk->length);
+    }
+    if (growBuffer(&chunk->storage, &chunk->storageSize, chunk->length + length) == -1) {
+        return -1;
+    }
+    memcpy(chunk->storage + chunk->length, line, length);
+    chunk->data = chunk->storage;
+    chunk->length += length;
+    return 0;
+}
+
+/* ================================================================
+ * pipelineDispatch() — Hand a chunk to the next worker
+ * ================================================================ */
+void pipelineDispatch(Pipeline *pipeline, Chunk *chunk) {
+    // Only the sender pushes to the free ring, so keep it here
+    if (chunk->length == 0) {
+        pipeline->spare = chunk;
+        return;
+    }
+
+    int worker = (int)(pipeline->dispatched % pipeline->workerCount);
+    pushWait(&pipeline->work[worker], chunk);
+    pipeline->dispatched++;
+}
+
+/* ================================================================
+ * pipelineDrain() — Wait until the sender has released every chunk
+ * ================================================================ */
+void pipelineDrain(Pipeline *pipeline) {
+    unsigned attempt = 0;
+
+    while (atomic_load_explicit(&pipeline->released, memory_order_acquire) <
+           pipeline->dispatched) {
+        ringBackoff(&attempt);
+    }
+}
+
+/* ================================================================
+ * pipelineFinish() — Send the end marker through every worker
+ *
+ * The markers continue the round-robin sequence, so the sender meets
+ * the first one right after the last real chunk.
+ * ================================================================ */
+void pipelineFinish(Pipeline *pipeline) {
+    for (int i = 0; i < pipeline->workerCount; i++) {
+        int worker = (int)((pipeline->dispatched + i) % pipeline->workerCount);
+        pushWait(&pipeline->work[worker], &pipeline->endMarker);
+    }
+}
+
+/* ================================================================
+ * pipelineTryNext() — Next chunk in input order, if it is done
+ * ================================================================ */
+Chunk *pipelineTryNext(Pipeline *pipeline) {
+    int worker = (int)(pipeline->collected % pipeline->workerCount);
+    Chunk *chunk = spscPop(&pipeline->done[worker]);
+
+    if (chunk != NULL && !chunk->last) {
+        pipeline->collected++;
+    }
+    return chunk;
+}
+
+/* ================================================================
+ * pipelineRelease() — Return a chunk to the pool
+ * ================================================================ */
+void pipelineRelease(Pipeline *pipeline, Chunk *chunk) {
+    pushWait(&pipeline->freeRing, chunk);
+    atomic_fetch_add_explicit(&pipeline->released, 1, memory_order_release);
+}
+
+/* ================================================================
+ * pipelineFree() — Join the workers and free everything
+ * ================================================================ */
+void pipelineFree(Pipeline *pipeline) {
+    if (pipeline->threads != NULL) {
+        for (int i = 0; i < pipeline->workerCount; i++) {
+            if (pipeline->threads[i] != 0) {
+                pthread_join(pipeline->threads[i], NULL);
+            }
+        }
+    }
+
+    if (pipeline->chunks != NULL) {
+        for (int i = 0; i < pipeline->chunkCount; i++) {
+            free(pipeline->chunks[i].storage);
+            free(pipeline->chunks[i].json);
+            free(pipeline->chunks[i].recordLengths);
+        }
+    }
+    if (pipeline->work != NULL && pipeline->done != NULL) {
+        for (int i = 0; i < pipeline->workerCount; i++) {
+            spscFree(&pipeline->work[i]);
+            spscFree(&pipeline->done[i]);
+        }
+    }
+    spscFree(&pipeline->freeRing);
+
+    free(pipeline->chunks);
+    free(pipeline->work);
+    free(pipeline->done);
+    free(pipeline->threads);
+    free(pipeline->workerArgs);
+    memset(pipeline, 0, sizeof(*pipeline));
+}
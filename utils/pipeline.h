@@ -0,0 +1,155 @@
+/* ================================================================
+ * pipeline.h — Parallel Parse/Serialize Pipeline for the Client
+ *
+ * The reader thread cuts the input into chunks of whole lines and
+ * deals them round-robin to a pool of worker threads, which run the
+ * tokenizer and serializer. The sender collects the serialized
+ * chunks in the same round-robin order, so records leave in input
+ * order. Every hand-off is a lock-free SPSC ring:
+ *
+ *   reader --> work[i] --> worker i --> done[i] --> sender
+ *     ^                                               |
+ *     +------------------- free <---------------------+
+ * ================================================================ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "ring.h"
+
+// Input bytes collected into one chunk before it is dispatched.
+#define CHUNK_BYTES (64 * 1024)
+
+// Chunks in flight per worker (bounds memory and read-ahead).
+#define CHUNKS_PER_WORKER 4
+
+// Upper bound for the worker count accepted on the command line.
+#define MAX_WORKERS 64
+
+/* ================================================================
+ * Chunk struct:
+ * A run of whole input lines and, once a worker is done with it,
+ * the serialized records.
+ *
+ *  - data / length: the input lines; either a view into a mapped
+ *    file or a copy in `storage`
+ *  - json / jsonLength: serialized records back to back
+ *  - recordLengths / records: size of each serialized record
+ *  - last: end-of-input marker, carries no data
+ * ================================================================ */
+typedef struct {
+    const char *data;       // Input lines
+    size_t length;          // Input bytes
+    char *storage;          // Owned copy of streamed lines
+    size_t storageSize;     // Allocated storage bytes
+
+    char *json;             // Serialized records
+    size_t jsonLength;      // Bytes used in json
+    size_t jsonSize;        // Allocated json bytes
+    size_t *recordLengths;  // Length of each record in json
+    int records;            // Records in this chunk
+    int recordsSize;        // Allocated recordLengths entries
+
+    int last;               // End-of-input marker
+} Chunk;
+
+/* ================================================================
+ * Pipeline struct:
+ * Chunk pool, rings and worker threads.
+ *
+ *  - dispatched: chunks handed to workers (picks the next worker)
+ *  - collected: chunks taken by the sender (picks the next done ring)
+ *  - released: chunks the sender is finished with; the reader
+ *    compares it with dispatched in pipelineDrain()
+ *  - spare: an empty chunk the reader kept instead of dispatching
+ * ================================================================ */
+typedef struct {
+    int workerCount;        // Worker threads
+    int chunkCount;         // Chunks in the pool
+    Chunk *chunks;          // Chunk pool
+    SpscRing freeRing;      // Sender -> reader: chunks to refill
+    SpscRing *work;         // Reader -> worker i
+    SpscRing *done;         // Worker i -> sender
+    pthread_t *threads;     // Worker threads
+    void *workerArgs;       // Per-worker thread arguments
+    Chunk endMarker;        // Shared end-of-input marker
+    long dispatched;        // Chunks handed out by the reader
+    long collected;         // Chunks taken by the sender
+    atomic_long released;   // Chunks returned by the sender
+    Chunk *spare;           // Reader's unused empty chunk
+} Pipeline;
+
+/* ================================================================
+ * pipelineInit():
+ * Allocate the chunk pool and rings and start `workers` threads.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error
+ * ================================================================ */
+int pipelineInit(Pipeline *pipeline, int workers);
+
+/* ================================================================
+ * pipelineAcquire():
+ * Reader side. Returns an empty chunk, waiting while all chunks are
+ * in flight (this is the pipeline's backpressure).
+ * ================================================================ */
+Chunk *pipelineAcquire(Pipeline *pipeline);
+
+/* ================================================================
+ * pipelineAppend():
+ * Reader side. Adds one line to `chunk`. When `stable` is set the
+ * line stays valid until the pipeline is freed (a mapped file), so
+ * consecutive lines are referenced in place instead of copied.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on allocation failure
+ * ================================================================ */
+int pipelineAppend(Chunk *chunk, const char *line, size_t length, int stable);
+
+/* ================================================================
+ * pipelineDispatch():
+ * Reader side. Hands `chunk` to the next worker in round-robin
+ * order. An empty chunk is kept for the next pipelineAcquire().
+ * ================================================================ */
+void pipelineDispatch(Pipeline *pipeline, Chunk *chunk);
+
+/* ================================================================
+ * pipelineDrain():
+ * Reader side. Waits until every dispatched chunk has been sent and
+ * released, so the input the chunks point into may be unmapped.
+ * ================================================================ */
+void pipelineDrain(Pipeline *pipeline);
+
+/* ================================================================
+ * pipelineFinish():
+ * Reader side. Sends the end-of-input marker through every worker,
+ * which then exits.
+ * ================================================================ */
+void pipelineFinish(Pipeline *pipeline);
+
+/* ================================================================
+ * pipelineTryNext():
+ * Sender side. Returns the next chunk in input order once its
+ * worker is done with it, or NULL if it is not ready yet. A chunk
+ * with `last` set marks the end of input.
+ * ================================================================ */
+Chunk *pipelineTryNext(Pipeline *pipeline);
+
+/* ================================================================
+ * pipelineRelease():
+ * Sender side. Returns a sent chunk to the pool.
+ * ================================================================ */
+void pipelineRelease(Pipeline *pipeline, Chunk *chunk);
+
+/* ================================================================
+ * pipelineFree():
+ * Joins the workers (after pipelineFinish()) and frees everything.
+ * ================================================================ */
+void pipelineFree(Pipeline *pipeline);
+
+#endif /* PIPELINE_H */
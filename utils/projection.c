@@ -0,0 +1,545 @@
+/* ================================================================
+ * projection.c — Lazy Field Projection for JSON Records
+ *
+ * Walks a JSON object's top-level members once. A member's key is
+ * compared against the projection; wanted values are recorded as
+ * (pointer, length) views into the record, everything else is
+ * skipped without being decoded. Strings are the bulk of the text,
+ * so they are crossed with scanQuoted(), 16 or 32 bytes per step.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "projection.h"
+#include "scan.h"
+
+// Longest number text converted (cJSON has no limit; real ones are short).
+#define NUMBER_MAX 64
+
+/* ================================================================
+ * skipWhitespace() — Skip what cJSON treats as whitespace (<= ' ')
+ * ================================================================ */
+static inline const char *skipWhitespace(const char *pos, const char *end) {
+    while (pos < end && (unsigned char)*pos <= ' ' && *pos != '\0') {
+        pos++;
+    }
+    return pos;
+}
+
+/* ================================================================
+ * skipString() — Find the closing quote of a string
+ *
+ * `pos` is just past the opening quote. Sets *escaped if a
+ * backslash was seen. A raw newline is allowed, as in cJSON.
+ *
+ * Returns: position of the closing quote, or NULL if unterminated
+ * ================================================================ */
+static const char *skipString(const char *pos, const char *end, int *escaped) {
+    for (;;) {
+        pos = scanQuoted(pos, end);
+        if (pos >= end || *pos == '\0') {
+            return NULL;
+        }
+        if (*pos == '"') {
+            return pos;
+        }
+        if (*pos == '\\') {
+            *escaped = 1;
+            pos += 2;
+        }
+        else {
+            pos++; // '\n'
+        }
+    }
+}
+
+/* ================================================================
+ * skipNested() — Find the end of an object or array
+ *
+ * `pos` is at the opening bracket. Counts bracket depth, stepping
+ * over strings so brackets inside them do not count.
+ *
+ * Returns: position just past the closing bracket, or NULL
+ * ================================================================ */
+static const char *skipNested(const char *pos, const char *end) {
+    int depth = 0;
+    int escaped;
+
+    while (pos < end) {
+        switch (*pos) {
+            case '{':
+            case '[':
+                if (++depth > PROJECT_MAX_DEPTH) {
+                    return NULL;
+                }
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0) {
+                    return pos + 1;
+                }
+                break;
+            case '"':
+                pos = skipString(pos + 1, end, &escaped);
+                if (pos == NULL) {
+                    return NULL;
+                }
+                break;
+            case '\0':
+                return NULL;
+        }
+        pos++;
+    }
+    return NULL;
+}
+
+/* ================================================================
+ * skipNumber() — Find the end of a number: cJSON's [0-9+-.eE] run
+ * ================================================================ */
+static const char *skipNumber(const char *pos, const char *end) {
+    while (pos < end && ((*pos >= '0' && *pos <= '9') || *pos == '+' ||
+                         *pos == '-' || *pos == '.' || *pos == 'e' || *pos == 'E')) {
+        pos++;
+    }
+    return pos;
+}
+
+/* ================================================================
+ * checkNumber() — Whether cJSON would accept the whole number run
+ *
+ * cJSON converts the run with strtod() and fails unless all of it
+ * is consumed. Numbers in strict JSON syntax always are, so only
+ * anything else (leading zeros, "1.", hex-looking runs) pays for a
+ * strtod() call here.
+ * ================================================================ */
+static int checkNumber(const char *pos, size_t length) {
+    const char *end = pos + length;
+    const char *p = pos;
+
+    if (p < end && *p == '-') {
+        p++;
+    }
+    if (p < end && *p == '0') {
+        p++;
+    }
+    else if (p < end && *p >= '1' && *p <= '9') {
+        while (p < end && *p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    else {
+        p = NULL;
+    }
+    if (p != NULL && p < end && *p == '.') {
+        const char *digits = ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            p++;
+        }
+        p = (p > digits) ? p : NULL;
+    }
+    if (p != NULL && p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        const char *digits = p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            p++;
+        }
+        p = (p > digits) ? p : NULL;
+    }
+    if (p == end) {
+        return 1;
+    }
+
+    char number[NUMBER_MAX];
+    char *numberEnd;
+    if (length >= sizeof(number)) {
+        return 0;
+    }
+    memcpy(number, pos, length);
+    number[length] = '\0';
+    strtod(number, &numberEnd);
+    return (size_t)(numberEnd - number) == length;
+}
+
+/* ================================================================
+ * skipLiteral() — Match `literal` (true, false, null) at pos
+ * ================================================================ */
+static const char *skipLiteral(const char *pos, const char *end, const char *literal,
+                               size_t length) {
+    if ((size_t)(end - pos) < length || memcmp(pos, literal, length) != 0) {
+        return NULL;
+    }
+    return pos + length;
+}
+
+/* ================================================================
+ * scanValue() — Classify and skip the value starting at pos
+ *
+ * Fills in field's type, value, length and escaped.
+ *
+ * Returns: position just past the value, or NULL if malformed
+ * ================================================================ */
+static const char *scanValue(const char *pos, const char *end, Field *field) {
+    const char *next = NULL;
+
+    field->value = pos;
+    field->escaped = 0;
+
+    switch (*pos) {
+        case '"':
+            field->type = FIELD_STRING;
+            field->value = pos + 1;
+            next = skipString(pos + 1, end, &field->escaped);
+            if (next == NULL) {
+                return NULL;
+            }
+            field->length = (size_t)(next - field->value);
+            return next + 1;
+        case '{':
+        case '[':
+            field->type = (*pos == '{') ? FIELD_OBJECT : FIELD_ARRAY;
+            next = skipNested(pos, end);
+            break;
+        case 't':
+            field->type = FIELD_TRUE;
+            next = skipLiteral(pos, end, "true", 4);
+            break;
+        case 'f':
+            field->type = FIELD_FALSE;
+            next = skipLiteral(pos, end, "false", 5);
+            break;
+        case 'n':
+            field->type = FIELD_NULL;
+            next = skipLiteral(pos, end, "null", 4);
+            break;
+        default:
+            if (*pos == '-' || (*pos >= '0' && *pos <= '9')) {
+                field->type = FIELD_NUMBER;
+                next = skipNumber(pos, end);
+            }
+            break;
+    }
+
+    if (next != NULL) {
+        field->length = (size_t)(next - pos);
+    }
+    return next;
+}
+
+/* ================================================================
+ * parseHex4() — Four hex digits to a code unit, or -1
+ * ================================================================ */
+static long parseHex4(const char *pos) {
+    long value = 0;
+
+    for (int i = 0; i < 4; i++) {
+        char c = pos[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= c - '0';
+        }
+        else if (c >= 'a' && c <= 'f') {
+            value |= c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F') {
+            value |= c - 'A' + 10;
+        }
+        else {
+            return -1;
+        }
+    }
+    return value;
+}
+
+/* ================================================================
+ * unescape() — Decode `length` bytes of string text into `out`
+ *
+ * Mirrors cJSON's parse_string(): the two-character escapes, and
+ * \uXXXX to UTF-8 with a high surrogate needing a low one after it.
+ * The output is never longer than the input.
+ *
+ * Returns: decoded length, or -1 for a bad escape
+ * ================================================================ */
+static int unescape(const char *pos, size_t length, char *out) {
+    const char *end = pos + length;
+    char *start = out;
+
+    while (pos < end) {
+        if (*pos != '\\') {
+            *out++ = *pos++;
+            continue;
+        }
+        if (end - pos < 2) {
+            return -1;
+        }
+
+        switch (pos[1]) {
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case '"':
+            case '\\':
+            case '/':
+                *out++ = pos[1];
+                break;
+            case 'u': {
+                long code = (end - pos >= 6) ? parseHex4(pos + 2) : -1;
+                if (code == -1 || (code >= 0xDC00 && code <= 0xDFFF)) {
+                    return -1;
+                }
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    // High surrogate: the low half must follow
+                    long low = (end - pos >= 12 && pos[6] == '\\' && pos[7] == 'u')
+                               ? parseHex4(pos + 8) : -1;
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return -1;
+                    }
+                    code = 0x10000 + (((code & 0x3FF) << 10) | (low & 0x3FF));
+                    pos += 6;
+                }
+
+                if (code < 0x80) {
+                    *out++ = (char)code;
+                }
+                else if (code < 0x800) {
+                    *out++ = (char)(0xC0 | (code >> 6));
+                    *out++ = (char)(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000) {
+                    *out++ = (char)(0xE0 | (code >> 12));
+                    *out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (code & 0x3F));
+                }
+                else {
+                    *out++ = (char)(0xF0 | (code >> 18));
+                    *out++ = (char)(0x80 | ((code >> 12) & 0x3F));
+                    *out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (code & 0x3F));
+                }
+                pos += 4;
+                break;
+            }
+            default:
+                return -1;
+        }
+        pos += 2;
+    }
+
+    return (int)(out - start);
+}
+
+/* ================================================================
+ * matchKey() — Index of the projection key equal to a record key
+ *
+ * `key` is the raw text between the quotes. Escaped keys are
+ * decoded first; that is rare, and the common case is one length
+ * compare per projection key plus a memcmp() on equal lengths.
+ *
+ * Returns: key index, or -1 if the key is not projected
+ * ================================================================ */
+static int matchKey(const Projection *projection, const char *key, size_t length,
+                    int escaped) {
+    // Every escape takes at least as many bytes as it decodes to, up to 6:1
+    char decoded[PROJECT_MAX_KEY_LENGTH * 6 + 1];
+
+    if (escaped) {
+        if (length >= sizeof(decoded)) {
+            return -1;
+        }
+        int decodedLength = unescape(key, length, decoded);
+        if (decodedLength == -1) {
+            return -1;
+        }
+        key = decoded;
+        length = (size_t)decodedLength;
+    }
+
+    for (int i = 0; i < projection->count; i++) {
+        if (projection->lengths[i] == length &&
+            memcmp(projection->names[i], key, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* ================================================================
+ * projectionInit() — Split the key list
+ * ================================================================ */
+int projectionInit(Projection *projection, const char *list) {
+    memset(projection, 0, sizeof(*projection));
+
+    const char *pos = list;
+    for (;;) {
+        const char *comma = strchr(pos, ',');
+        size_t length = comma ? (size_t)(comma - pos) : strlen(pos);
+
+        if (length > 0 && matchKey(projection, pos, length, 0) != -1) {
+            printf("Error: Field '%.*s' is listed twice\n", (int)length, pos);
+            projectionFree(projection);
+            return -1;
+        }
+        if (projectionAdd(projection, pos, length) == -1) {
+            projectionFree(projection);
+            return -1;
+        }
+
+        if (comma == NULL) {
+            return 0;
+        }
+        pos = comma + 1;
+    }
+}
+
+/* ================================================================
+ * projectionAdd() — Look up or append one key
+ * ================================================================ */
+int projectionAdd(Projection *projection, const char *name, size_t length) {
+    if (length == 0 || length > PROJECT_MAX_KEY_LENGTH) {
+        printf("Error: Field names must be 1 to %d characters long\n",
+               PROJECT_MAX_KEY_LENGTH);
+        return -1;
+    }
+
+    int index = matchKey(projection, name, length, 0);
+    if (index != -1) {
+        return index;
+    }
+    if (projection->count == PROJECT_MAX_KEYS) {
+        printf("Error: At most %d fields can be projected\n", PROJECT_MAX_KEYS);
+        return -1;
+    }
+
+    char *copy = strndup(name, length);
+    if (copy == NULL) {
+        perror("strndup");
+        return -1;
+    }
+    projection->names[projection->count] = copy;
+    projection->lengths[projection->count] = length;
+    return projection->count++;
+}
+
+/* ================================================================
+ * projectionFree() — Release the key copies
+ * ================================================================ */
+void projectionFree(Projection *projection) {
+    for (int i = 0; i < projection->count; i++) {
+        free(projection->names[i]);
+    }
+    projection->count = 0;
+}
+
+/* ================================================================
+ * projectRecord() — Scan one object, keeping projected members
+ *
+ * The object grammar is followed exactly: '{', then "key": value
+ * pairs separated by ',', then '}'. Only the values are skipped
+ * lazily.
+ * ================================================================ */
+int projectRecord(const Projection *projection, const char *pos, const char *end,
+                  Field *fields, int capacity, const char **recordEnd) {
+    int stored = 0;
+
+    pos = skipWhitespace(pos, end);
+    if (pos >= end || *pos != '{') {
+        return -1;
+    }
+    pos = skipWhitespace(pos + 1, end);
+    if (pos < end && *pos == '}') {
+        *recordEnd = pos + 1;
+        return 0;
+    }
+
+    for (;;) {
+        // "key"
+        if (pos >= end || *pos != '"') {
+            return -1;
+        }
+        int keyEscaped = 0;
+        const char *key = pos + 1;
+        const char *keyEnd = skipString(key, end, &keyEscaped);
+        if (keyEnd == NULL) {
+            return -1;
+        }
+
+        // :
+        pos = skipWhitespace(keyEnd + 1, end);
+        if (pos >= end || *pos != ':') {
+            return -1;
+        }
+        pos = skipWhitespace(pos + 1, end);
+        if (pos >= end) {
+            return -1;
+        }
+
+        // value
+        Field field;
+        pos = scanValue(pos, end, &field);
+        if (pos == NULL) {
+            return -1;
+        }
+
+        field.key = matchKey(projection, key, (size_t)(keyEnd - key), keyEscaped);
+        if (field.key != -1) {
+            // Numbers are the one skipped type cJSON checks more closely
+            if (field.type == FIELD_NUMBER && !checkNumber(field.value, field.length)) {
+                return -1;
+            }
+            if (stored < capacity) {
+                fields[stored++] = field;
+            }
+        }
+
+        // , or }
+        pos = skipWhitespace(pos, end);
+        if (pos >= end) {
+            return -1;
+        }
+        if (*pos == '}') {
+            *recordEnd = pos + 1;
+            return stored;
+        }
+        if (*pos != ',') {
+            return -1;
+        }
+        pos = skipWhitespace(pos + 1, end);
+    }
+}
+
+/* ================================================================
+ * fieldString() — Unescape a string value
+ * ================================================================ */
+int fieldString(const Field *field, char *out) {
+    int length;
+
+    if (!field->escaped) {
+        memcpy(out, field->value, field->length);
+        length = (int)field->length;
+    }
+    else {
+        length = unescape(field->value, field->length, out);
+        if (length == -1) {
+            return -1;
+        }
+    }
+    out[length] = '\0';
+    return length;
+}
+
+/* ================================================================
+ * fieldNumber() — Convert a number value
+ * ================================================================ */
+double fieldNumber(const Field *field) {
+    char number[NUMBER_MAX];
+    size_t length = field->length < sizeof(number) ? field->length : sizeof(number) - 1;
+
+    memcpy(number, field->value, length);
+    number[length] = '\0';
+    return strtod(number, NULL);
+}
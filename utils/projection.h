@@ -0,0 +1,136 @@
+/* ================================================================
+ * projection.h — Lazy Field Projection for JSON Records
+ *
+ * Extracts a chosen set of top-level members from a JSON object by
+ * scanning its text once, without building a cJSON tree. Members
+ * whose key is not wanted are skipped structurally: strings are
+ * stepped over with the vectorized scanQuoted(), nested objects and
+ * arrays by bracket depth, and nothing is allocated.
+ * ================================================================ */
+
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include <stddef.h>
+
+// Most keys a projection may list, and the longest key.
+#define PROJECT_MAX_KEYS 64
+#define PROJECT_MAX_KEY_LENGTH 256
+
+// Deepest object/array nesting skipped inside a record (cJSON's limit).
+#define PROJECT_MAX_DEPTH 1000
+
+/* ================================================================
+ * Projection struct:
+ * The keys of interest, parsed from a comma-separated list.
+ *
+ *  - names / lengths: each key as given (matched against the
+ *    record's keys after unescaping) and its length
+ *  - count: number of keys
+ * ================================================================ */
+typedef struct {
+    char *names[PROJECT_MAX_KEYS];
+    size_t lengths[PROJECT_MAX_KEYS];
+    int count;
+} Projection;
+
+/* ================================================================
+ * FieldType enum:
+ * JSON type of a projected value.
+ * ================================================================ */
+typedef enum {
+    FIELD_STRING,
+    FIELD_NUMBER,
+    FIELD_TRUE,
+    FIELD_FALSE,
+    FIELD_NULL,
+    FIELD_OBJECT,
+    FIELD_ARRAY
+} FieldType;
+
+/* ================================================================
+ * Field struct:
+ * One projected member, pointing into the record text.
+ *
+ *  - key: index of the matching key in the projection
+ *  - value / length: the raw value; for strings, the text between
+ *    the quotes (still escaped if `escaped` is set), otherwise the
+ *    whole value as written (numbers, literals, nested JSON)
+ * ================================================================ */
+typedef struct {
+    int key;
+    FieldType type;
+    const char *value;
+    size_t length;
+    int escaped;
+} Field;
+
+/* ================================================================
+ * projectionInit():
+ * Parses `list`, a comma-separated list of keys, into *projection.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the list is empty, has an empty, repeated or longer
+ *    than PROJECT_MAX_KEY_LENGTH key, has more than
+ *    PROJECT_MAX_KEYS keys, or allocation fails (message printed)
+ * ================================================================ */
+int projectionInit(Projection *projection, const char *list);
+
+/* ================================================================
+ * projectionAdd():
+ * Adds the `length`-byte key `name` unless it is already listed.
+ *
+ * Returns:
+ *  - the key's index
+ *  - -1 if it is too long, the projection is full, or allocation
+ *    fails (message printed)
+ * ================================================================ */
+int projectionAdd(Projection *projection, const char *name, size_t length);
+
+/* ================================================================
+ * projectionFree():
+ * Releases the key copies.
+ * ================================================================ */
+void projectionFree(Projection *projection);
+
+/* ================================================================
+ * projectRecord():
+ * Scans the JSON object starting at `pos` (leading whitespace is
+ * skipped; need not be null-terminated) and stores up to `capacity`
+ * members whose key is in the projection, in record order, in
+ * `fields`. Further matches are scanned but not stored.
+ *
+ * Only what the scan needs is checked: the object's own syntax,
+ * string boundaries, literals and bracket balance of nested values.
+ * Text cJSON would reject inside a skipped value (a bad number deep
+ * in an array, say) may pass.
+ *
+ * On success *recordEnd points just past the closing '}'.
+ *
+ * Returns:
+ *  - number of fields stored
+ *  - -1 if the text is not a well-formed object
+ * ================================================================ */
+int projectRecord(const Projection *projection, const char *pos, const char *end,
+                  Field *fields, int capacity, const char **recordEnd);
+
+/* ================================================================
+ * fieldString():
+ * Writes a FIELD_STRING value to `out`, unescaping it the way cJSON
+ * does (including \uXXXX and surrogate pairs to UTF-8), and null-
+ * terminates it. `out` needs field->length + 1 bytes.
+ *
+ * Returns:
+ *  - length of the unescaped string
+ *  - -1 for an invalid escape sequence
+ * ================================================================ */
+int fieldString(const Field *field, char *out);
+
+/* ================================================================
+ * fieldNumber():
+ * Converts a FIELD_NUMBER value with strtod(), as cJSON does.
+ * ================================================================ */
+double fieldNumber(const Field *field);
+
+#endif /* PROJECTION_H */
@@ -0,0 +1,216 @@
+/* ================================================================
+ * recvbatch.c — Batched Datagram Receiver
+ *
+ * Receives up to a whole batch of datagrams with one recvmmsg()
+ * call into preallocated slots, and counts how full each batch was.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "recvbatch.h"
+
+/* ================================================================
+ * recvBatchInit() — Allocate slots and prewire the message headers
+ *
+ * One byte of every slot is kept back for the null terminator.
+ * ================================================================ */
+int recvBatchInit(RecvBatch *batch, int sd, int capacity, size_t slotSize) {
+    memset(batch, 0, sizeof(*batch));
+
+    batch->sd = sd;
+    batch->capacity = capacity;
+    batch->slotSize = slotSize;
+
+    if (slotSize > 0) {
+        batch->slab = malloc((size_t)capacity * slotSize);
+    }
+    batch->iov = calloc(capacity, sizeof(struct iovec));
+    batch->msgs = calloc(capacity, sizeof(struct mmsghdr));
+    batch->addrs = calloc(capacity, sizeof(struct sockaddr_in));
+    batch->control = calloc(capacity, RECV_CONTROL_SIZE);
+    if ((slotSize > 0 && batch->slab == NULL) || batch->iov == NULL ||
+        batch->msgs == NULL || batch->addrs == NULL || batch->control == NULL) {
+        recvBatchFree(batch);
+        return -1;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        if (slotSize > 0) {
+            recvBatchAttach(batch, i, batch->slab + (size_t)i * slotSize, slotSize);
+        }
+        batch->msgs[i].msg_hdr.msg_iov = &batch->iov[i];
+        batch->msgs[i].msg_hdr.msg_iovlen = 1;
+        batch->msgs[i].msg_hdr.msg_name = &batch->addrs[i];
+        batch->msgs[i].msg_hdr.msg_control = batch->control + (size_t)i * RECV_CONTROL_SIZE;
+    }
+
+    return 0;
+}
+
+/* ================================================================
+ * recvBatchAttach() — Point a slot at a caller-owned buffer
+ * ================================================================ */
+void recvBatchAttach(RecvBatch *batch, int i, char *buffer, size_t size) {
+    batch->iov[i].iov_base = buffer;
+    batch->iov[i].iov_len = size - 1;
+}
+
+/* ================================================================
+ * recvBatchReceive() — One recvmmsg() call
+ *
+ * msg_namelen and msg_controllen are in/out fields, so they are
+ * reset for every slot before each call (like addr_len before
+ * recvfrom()).
+ * ================================================================ */
+int recvBatchReceive(RecvBatch *batch, int flags) {
+    for (int i = 0; i < batch->capacity; i++) {
+        batch->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        batch->msgs[i].msg_hdr.msg_controllen = RECV_CONTROL_SIZE;
+    }
+
+    int received = recvmmsg(batch->sd, batch->msgs, batch->capacity,
+                            MSG_WAITFORONE | flags, NULL);
+    if (received == -1) {
+        batch->count = 0;
+        return -1;
+    }
+
+    for (int i = 0; i < received; i++) {
+        unsigned int length = batch->msgs[i].msg_len;
+        ((char *)batch->iov[i].iov_base)[length] = '\0';
+        batch->bytesReceived += length;
+        if (batch->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            batch->truncated++;
+        }
+    }
+
+    // Fill level bucket: floor(log2(received))
+    int bucket = 31 - __builtin_clz((unsigned)received);
+    if (bucket >= FILL_BUCKETS) {
+        bucket = FILL_BUCKETS - 1;
+    }
+    batch->fillBuckets[bucket]++;
+    if (received == batch->capacity) {
+        batch->fullBatches++;
+    }
+
+    batch->recvCalls++;
+    batch->datagramsReceived += received;
+    batch->count = received;
+    return received;
+}
+
+/* ================================================================
+ * recvBatchData() — Payload, length and source of one datagram
+ * ================================================================ */
+const char *recvBatchData(const RecvBatch *batch, int i, int *length,
+                          const struct sockaddr_in **source) {
+    *length = (int)batch->msgs[i].msg_len;
+    *source = &batch->addrs[i];
+    return batch->iov[i].iov_base;
+}
+
+/* ================================================================
+ * recvBatchDestination() — Destination and interface from IP_PKTINFO
+ * ================================================================ */
+int recvBatchDestination(const RecvBatch *batch, int i, struct in_addr *group,
+                         int *ifindex) {
+    struct msghdr *hdr = (struct msghdr *)&batch->msgs[i].msg_hdr;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO) {
+            struct in_pktinfo info;
+            memcpy(&info, CMSG_DATA(cmsg), sizeof(info));
+            *group = info.ipi_addr;
+            *ifindex = info.ipi_ifindex;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* ================================================================
+ * recvBatchTimestamp() — Kernel receive time from SO_TIMESTAMPNS
+ * ================================================================ */
+int recvBatchTimestamp(const RecvBatch *batch, int i, uint64_t *ns) {
+    struct msghdr *hdr = (struct msghdr *)&batch->msgs[i].msg_hdr;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            *ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* ================================================================
+ * recvBatchDrops() — Kernel drop counter from SO_RXQ_OVFL
+ * ================================================================ */
+int recvBatchDrops(const RecvBatch *batch, int i, uint32_t *drops) {
+    struct msghdr *hdr = (struct msghdr *)&batch->msgs[i].msg_hdr;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+            memcpy(drops, CMSG_DATA(cmsg), sizeof(*drops));
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* ================================================================
+ * recvBatchReport() — Print the fill level statistics
+ * ================================================================ */
+void recvBatchReport(const RecvBatch *batch) {
+    printf("Received %ld datagrams (%ld bytes) in %ld recvmmsg() calls\n",
+           batch->datagramsReceived, batch->bytesReceived, batch->recvCalls);
+    if (batch->truncated > 0) {
+        printf("Truncated datagrams: %ld\n", batch->truncated);
+    }
+    if (batch->recvCalls == 0) {
+        return;
+    }
+
+    printf("Batch fill: mean %.2f of %d, full %.1f%% of calls\n",
+           (double)batch->datagramsReceived / batch->recvCalls, batch->capacity,
+           100.0 * batch->fullBatches / batch->recvCalls);
+
+    for (int k = 0; k < FILL_BUCKETS; k++) {
+        if (batch->fillBuckets[k] == 0) {
+            continue;
+        }
+        int low = 1 << k;
+        int high = (k == FILL_BUCKETS - 1) ? batch->capacity : (2 << k) - 1;
+        if (high > batch->capacity) {
+            high = batch->capacity;
+        }
+        printf("  %4d-%-4d %10ld calls (%5.1f%%)\n", low, high, batch->fillBuckets[k],
+               100.0 * batch->fillBuckets[k] / batch->recvCalls);
+    }
+}
+
+/* ================================================================
+ * recvBatchFree() — Release all batch storage
+ * ================================================================ */
+void recvBatchFree(RecvBatch *batch) {
+    free(batch->slab);
+    free(batch->iov);
+    free(batch->msgs);
+    free(batch->addrs);
+    free(batch->control);
+    batch->slab = NULL;
+    batch->iov = NULL;
+    batch->msgs = NULL;
+    batch->addrs = NULL;
+    batch->control = NULL;
+    batch->count = 0;
+}
@@ -0,0 +1,150 @@
+/* ================================================================
+ * recvbatch.h — Batched Datagram Receiver
+ *
+ * Receives up to a whole batch of datagrams with one recvmmsg()
+ * call into preallocated slots, and counts how full each batch was
+ * so the batch size can be tuned.
+ * ================================================================ */
+
+#ifndef RECVBATCH_H
+#define RECVBATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>  // struct mmsghdr
+#include <sys/uio.h>     // struct iovec
+#include <netinet/in.h>  // struct sockaddr_in
+
+// Upper bound for the batch size accepted on the command line.
+#define MAX_RECV_BATCH 1024
+
+// Fill levels are counted in power-of-two buckets: 1, 2-3, 4-7, ...
+#define FILL_BUCKETS 11
+
+// Ancillary data space per slot (IP_PKTINFO and friends).
+#define RECV_CONTROL_SIZE 256
+
+/* ================================================================
+ * RecvBatch struct:
+ * A fixed set of receive slots backed by one contiguous slab.
+ *
+ *  - slab: capacity * slotSize bytes; slot i starts at i * slotSize
+ *  - iov / msgs / addrs / control: one iovec, mmsghdr, source
+ *    address and ancillary data buffer per slot, prewired to the slab
+ *  - count: datagrams filled by the last recvBatchReceive()
+ *  - fillBuckets[k]: calls that returned 2^k to 2^(k+1)-1 datagrams
+ *
+ * Counters are cumulative over the lifetime of the batch.
+ * ================================================================ */
+typedef struct {
+    int sd;                         // Bound UDP socket (may be switched between calls)
+    int capacity;                   // Maximum datagrams per recvmmsg() call
+    int count;                      // Datagrams in the last batch
+    size_t slotSize;                // Bytes available in each slot
+    char *slab;                     // Backing storage for all slots
+    struct iovec *iov;              // Per-slot iovec
+    struct mmsghdr *msgs;           // Per-slot message header
+    struct sockaddr_in *addrs;      // Per-slot source address
+    char *control;                  // Per-slot ancillary data (RECV_CONTROL_SIZE each)
+    long recvCalls;                 // recvmmsg() calls that returned data
+    long datagramsReceived;         // Datagrams received
+    long bytesReceived;             // Payload bytes received
+    long truncated;                 // Datagrams larger than a slot
+    long fullBatches;               // Calls that filled every slot
+    long fillBuckets[FILL_BUCKETS]; // Calls per fill level bucket
+} RecvBatch;
+
+/* ================================================================
+ * recvBatchInit():
+ * Allocate a batch of `capacity` slots of `slotSize` bytes each for
+ * the socket `sd`. With a slotSize of 0 no slab is allocated and
+ * every slot must be given a buffer with recvBatchAttach().
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on allocation failure
+ * ================================================================ */
+int recvBatchInit(RecvBatch *batch, int sd, int capacity, size_t slotSize);
+
+/* ================================================================
+ * recvBatchAttach():
+ * Makes slot i receive into `buffer` of `size` bytes (one byte is
+ * kept for the null terminator) instead of the slab, so datagrams
+ * can be handed to other threads without copying.
+ * ================================================================ */
+void recvBatchAttach(RecvBatch *batch, int i, char *buffer, size_t size);
+
+/* ================================================================
+ * recvBatchReceive():
+ * Blocks until at least one datagram arrives, then takes as many as
+ * are already queued, up to capacity (MSG_WAITFORONE). Each payload
+ * is null-terminated in its slot. `flags` is OR-ed into the
+ * recvmmsg() flags; MSG_DONTWAIT returns at once if nothing is queued.
+ *
+ * Returns:
+ *  - number of datagrams received (also stored in count)
+ *  - -1 on error (errno set; EINTR and EAGAIN are returned to the
+ *    caller)
+ * ================================================================ */
+int recvBatchReceive(RecvBatch *batch, int flags);
+
+/* ================================================================
+ * recvBatchData():
+ * Returns the payload of datagram i of the last batch and stores
+ * its length in *length and its source in *source.
+ * ================================================================ */
+const char *recvBatchData(const RecvBatch *batch, int i, int *length,
+                          const struct sockaddr_in **source);
+
+/* ================================================================
+ * recvBatchDestination():
+ * Reads the IP_PKTINFO ancillary data of datagram i: the group (or
+ * unicast address) it was sent to and the interface it arrived on.
+ * The socket must have IP_PKTINFO enabled.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the datagram carries no IP_PKTINFO
+ * ================================================================ */
+int recvBatchDestination(const RecvBatch *batch, int i, struct in_addr *group,
+                         int *ifindex);
+
+/* ================================================================
+ * recvBatchTimestamp():
+ * Reads the SO_TIMESTAMPNS ancillary data of datagram i: when the
+ * kernel received it, in CLOCK_REALTIME nanoseconds. The socket
+ * must have SO_TIMESTAMPNS enabled.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the datagram carries no timestamp
+ * ================================================================ */
+int recvBatchTimestamp(const RecvBatch *batch, int i, uint64_t *ns);
+
+/* ================================================================
+ * recvBatchDrops():
+ * Reads the SO_RXQ_OVFL ancillary data of datagram i: how many
+ * datagrams the socket had dropped for lack of buffer space when
+ * this one was queued (cumulative, wraps at 2^32). The socket must
+ * have SO_RXQ_OVFL enabled; the kernel only attaches the counter
+ * once it is nonzero.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the datagram carries no counter
+ * ================================================================ */
+int recvBatchDrops(const RecvBatch *batch, int i, uint32_t *drops);
+
+/* ================================================================
+ * recvBatchReport():
+ * Prints datagram/call counts, mean fill and the fill histogram.
+ * ================================================================ */
+void recvBatchReport(const RecvBatch *batch);
+
+/* ================================================================
+ * recvBatchFree():
+ * Releases the slab and message arrays.
+ * ================================================================ */
+void recvBatchFree(RecvBatch *batch);
+
+#endif /* RECVBATCH_H */
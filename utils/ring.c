@@ -0,0 +1,229 @@
+/* ================================================================
+ * ring.c — Lock-Free Ring Buffers
+ *
+ * Bounded single-producer/single-consumer and multi-producer/
+ * multi-consumer queues of pointers used to hand work between
+ * threads without locks.
+ * ================================================================ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include "ring.h"
+
+// Backoff phases: pause hints, then yields, then sleeps.
+#define SPIN_ATTEMPTS  64
+#define YIELD_ATTEMPTS 128
+#define MIN_SLEEP_NS   10000
+
+/* ================================================================
+ * cpuRelax() — Tell the CPU this is a spin-wait loop
+ * ================================================================ */
+static inline void cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/* ================================================================
+ * spscInit() — Allocate a power-of-two slot array
+ * ================================================================ */
+int spscInit(SpscRing *ring, size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+
+    ring->slots = calloc(size, sizeof(void *));
+    if (ring->slots == NULL) {
+        return -1;
+    }
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->cachedHead = 0;
+    ring->cachedTail = 0;
+    return 0;
+}
+
+/* ================================================================
+ * spscPush() — Producer: store the item, then publish the tail
+ * ================================================================ */
+int spscPush(SpscRing *ring, void *item) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    // Only re-read the consumer's index when the ring looks full
+    if (tail - ring->cachedHead > ring->mask) {
+        ring->cachedHead = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->cachedHead > ring->mask) {
+            return -1;
+        }
+    }
+
+    ring->slots[tail & ring->mask] = item;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+/* ================================================================
+ * spscPop() — Consumer: read the item, then release the slot
+ * ================================================================ */
+void *spscPop(SpscRing *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    // Only re-read the producer's index when the ring looks empty
+    if (head == ring->cachedTail) {
+        ring->cachedTail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == ring->cachedTail) {
+            return NULL;
+        }
+    }
+
+    void *item = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return item;
+}
+
+/* ================================================================
+ * spscFree() — Release the slot array
+ * ================================================================ */
+void spscFree(SpscRing *ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+/* ================================================================
+ * mpmcInit() — Allocate cells, each free for its own position
+ * ================================================================ */
+int mpmcInit(MpmcRing *ring, size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+
+    ring->cells = calloc(size, sizeof(MpmcCell));
+    if (ring->cells == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&ring->cells[i].sequence, i);
+    }
+    ring->mask = size - 1;
+    atomic_init(&ring->enqueuePos, 0);
+    atomic_init(&ring->dequeuePos, 0);
+    return 0;
+}
+
+/* ================================================================
+ * mpmcPush() — Claim a free cell, store, publish
+ *
+ * diff < 0: the cell still holds an item from one lap ago (full).
+ * diff > 0: another producer claimed this position; reload.
+ * ================================================================ */
+int mpmcPush(MpmcRing *ring, void *item) {
+    size_t pos = atomic_load_explicit(&ring->enqueuePos, memory_order_relaxed);
+    MpmcCell *cell;
+
+    while (1) {
+        cell = &ring->cells[pos & ring->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            return -1;
+        }
+        else {
+            pos = atomic_load_explicit(&ring->enqueuePos, memory_order_relaxed);
+        }
+    }
+
+    cell->item = item;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return 0;
+}
+
+/* ================================================================
+ * mpmcPop() — Claim a filled cell, load, hand it to the next lap
+ *
+ * diff < 0: no producer has filled this cell yet (empty).
+ * diff > 0: another consumer claimed this position; reload.
+ * ================================================================ */
+void *mpmcPop(MpmcRing *ring) {
+    size_t pos = atomic_load_explicit(&ring->dequeuePos, memory_order_relaxed);
+    MpmcCell *cell;
+
+    while (1) {
+        cell = &ring->cells[pos & ring->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->dequeuePos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            return NULL;
+        }
+        else {
+            pos = atomic_load_explicit(&ring->dequeuePos, memory_order_relaxed);
+        }
+    }
+
+    void *item = cell->item;
+    atomic_store_explicit(&cell->sequence, pos + ring->mask + 1, memory_order_release);
+    return item;
+}
+
+/* ================================================================
+ * mpmcFree() — Release the cell array
+ * ================================================================ */
+void mpmcFree(MpmcRing *ring) {
+    free(ring->cells);
+    ring->cells = NULL;
+}
+
+/* ================================================================
+ * ringBackoff() — Escalating wait for an idle ring
+ * ================================================================ */
+int ringBackoff(unsigned *attempt) {
+    unsigned n = *attempt;
+    if (n < SPIN_ATTEMPTS + YIELD_ATTEMPTS + 8) {
+        (*attempt)++;
+    }
+
+    if (n < SPIN_ATTEMPTS) {
+        cpuRelax();
+        return 0;
+    }
+
+    if (n < SPIN_ATTEMPTS + YIELD_ATTEMPTS) {
+        sched_yield();
+        return 1;
+    }
+
+    // 10 us, 20 us, ... capped at RING_MAX_SLEEP_NS
+    unsigned doublings = n - SPIN_ATTEMPTS - YIELD_ATTEMPTS;
+    long sleepNs = RING_MAX_SLEEP_NS;
+    if (doublings < 7) {
+        sleepNs = (long)MIN_SLEEP_NS << doublings;
+        if (sleepNs > RING_MAX_SLEEP_NS) {
+            sleepNs = RING_MAX_SLEEP_NS;
+        }
+    }
+    struct timespec pause = { 0, sleepNs };
+    nanosleep(&pause, NULL);
+    return 1;
+}
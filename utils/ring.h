@@ -0,0 +1,152 @@
+/* ================================================================
+ * ring.h — Lock-Free Ring Buffers
+ *
+ * Bounded queues of pointers used to hand work between threads
+ * without locks:
+ *  - SpscRing: one producer, one consumer. Each index lives on its
+ *    own cache line, and each side caches the other side's index so
+ *    most operations touch no shared cache line.
+ *  - MpmcRing: any number of producers and consumers, with a
+ *    sequence number per cell (Vyukov's bounded MPMC queue).
+ * ================================================================ */
+
+#ifndef RING_H
+#define RING_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Cache line size used to keep producer and consumer state apart.
+#define RING_CACHE_LINE 64
+
+/* ================================================================
+ * SpscRing struct:
+ * A power-of-two array of slots indexed by free-running counters.
+ *
+ *  - head: next slot to pop, written only by the consumer
+ *  - tail: next slot to push, written only by the producer
+ *  - cachedHead / cachedTail: each side's last view of the other
+ *    index, refreshed only when the ring looks full / empty
+ *
+ * The producer publishes a slot with a release store of tail; the
+ * consumer's acquire load of tail makes the slot contents visible.
+ * ================================================================ */
+typedef struct {
+    _Alignas(RING_CACHE_LINE) atomic_size_t head;  // Consumer index
+    size_t cachedTail;                              // Consumer's view of tail
+
+    _Alignas(RING_CACHE_LINE) atomic_size_t tail;  // Producer index
+    size_t cachedHead;                              // Producer's view of head
+
+    _Alignas(RING_CACHE_LINE) size_t mask;         // capacity - 1
+    void **slots;                                   // Item storage
+} SpscRing;
+
+/* ================================================================
+ * spscInit():
+ * Allocate a ring holding at least `capacity` items (rounded up to
+ * a power of two).
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on allocation failure
+ * ================================================================ */
+int spscInit(SpscRing *ring, size_t capacity);
+
+/* ================================================================
+ * spscPush():
+ * Producer side. Appends `item` (must not be NULL).
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the ring is full
+ * ================================================================ */
+int spscPush(SpscRing *ring, void *item);
+
+/* ================================================================
+ * spscPop():
+ * Consumer side. Returns the oldest item, or NULL if the ring is
+ * empty.
+ * ================================================================ */
+void *spscPop(SpscRing *ring);
+
+/* ================================================================
+ * spscFree():
+ * Releases the slot array. Items still queued are not freed.
+ * ================================================================ */
+void spscFree(SpscRing *ring);
+
+/* ================================================================
+ * MpmcCell / MpmcRing structs:
+ * A power-of-two array of cells, each with a sequence number that
+ * says whose turn the cell is:
+ *
+ *  - sequence == pos: free for the producer claiming position pos
+ *  - sequence == pos + 1: holds the item for the consumer at pos
+ *
+ * Producers and consumers claim positions with a compare-and-swap
+ * on enqueuePos / dequeuePos, then publish the cell by advancing its
+ * sequence with a release store.
+ * ================================================================ */
+typedef struct {
+    atomic_size_t sequence;     // Turn marker (see above)
+    void *item;                 // Stored item
+} MpmcCell;
+
+typedef struct {
+    _Alignas(RING_CACHE_LINE) atomic_size_t enqueuePos;  // Next producer position
+    _Alignas(RING_CACHE_LINE) atomic_size_t dequeuePos;  // Next consumer position
+    _Alignas(RING_CACHE_LINE) size_t mask;               // capacity - 1
+    MpmcCell *cells;                                      // Cell storage
+} MpmcRing;
+
+/* ================================================================
+ * mpmcInit():
+ * Allocate a ring holding at least `capacity` items (rounded up to
+ * a power of two).
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on allocation failure
+ * ================================================================ */
+int mpmcInit(MpmcRing *ring, size_t capacity);
+
+/* ================================================================
+ * mpmcPush():
+ * Appends `item` (must not be NULL). Safe from any thread.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the ring is full
+ * ================================================================ */
+int mpmcPush(MpmcRing *ring, void *item);
+
+/* ================================================================
+ * mpmcPop():
+ * Returns the oldest item, or NULL if the ring is empty. Safe from
+ * any thread.
+ * ================================================================ */
+void *mpmcPop(MpmcRing *ring);
+
+/* ================================================================
+ * mpmcFree():
+ * Releases the cell array. Items still queued are not freed.
+ * ================================================================ */
+void mpmcFree(MpmcRing *ring);
+
+/* ================================================================
+ * ringBackoff():
+ * Waits a little longer on every call while a ring stays empty or
+ * full: CPU pause hints first, then sched_yield(), then sleeps that
+ * double up to RING_MAX_SLEEP_NS. Reset *attempt to 0 after
+ * progress.
+ *
+ * Returns: 1 once the caller is about to give up the CPU (a good
+ * moment to flush buffered output), 0 while still spinning
+ * ================================================================ */
+int ringBackoff(unsigned *attempt);
+
+// Longest sleep between polls of an idle ring.
+#define RING_MAX_SLEEP_NS 1000000
+
+#endif /* RING_H */
@@ -0,0 +1,282 @@
+/* ================================================================
+ * rxpool.c — Receive Thread to Decoder Pool Hand-Off
+ *
+ * The receive thread fills pool slots straight from recvmmsg() and
+ * queues them; decoder threads parse them and give them back.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rxpool.h"
+#include "arena.h"
+
+#define NSEC_PER_SEC 1000000000ULL
+
+// The backlog high-water mark is sampled every this many datagrams.
+#define BACKLOG_SAMPLE 64
+
+/* ================================================================
+ * DecoderArgs struct:
+ * What each decoder thread needs to find its queue and counters.
+ * ================================================================ */
+typedef struct {
+    RxPool *pool;
+    int index;
+} DecoderArgs;
+
+/* ================================================================
+ * nowNs() — Current CLOCK_MONOTONIC time in nanoseconds
+ * ================================================================ */
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/* ================================================================
+ * takeWork() — Next filled slot for decoder `index`, or NULL
+ * ================================================================ */
+static DatagramSlot *takeWork(RxPool *pool, int index) {
+    if (pool->ordered) {
+        return spscPop(&pool->lanes[index]);
+    }
+    return mpmcPop(&pool->work);
+}
+
+/* ================================================================
+ * decoderMain() — Decoder thread: decode slots until stopped
+ *
+ * Each decoder parses into its own arena. Once it has spun without
+ * work for a while, the idle hook runs before each sleep. After the
+ * receiver sets `stopping`, the queue is checked once more, so
+ * datagrams queued before the stop are still decoded; then the exit
+ * hook runs.
+ * ================================================================ */
+static void *decoderMain(void *arg) {
+    DecoderArgs *args = arg;
+    RxPool *pool = args->pool;
+    DecoderStats *stats = &pool->stats[args->index];
+    unsigned attempt = 0;
+
+    Arena arena;
+    if (arenaInit(&arena, ARENA_DEFAULT_SIZE) == 0) {
+        arenaSetCurrent(&arena);
+    }
+
+    while (1) {
+        DatagramSlot *slot = takeWork(pool, args->index);
+        if (slot == NULL) {
+            if (atomic_load_explicit(&pool->stopping, memory_order_acquire) &&
+                (slot = takeWork(pool, args->index)) == NULL) {
+                break;
+            }
+            if (slot == NULL) {
+                if (ringBackoff(&attempt) && pool->idle != NULL) {
+                    pool->idle();
+                }
+                continue;
+            }
+        }
+        attempt = 0;
+
+        uint64_t start = nowNs();
+        int records = pool->decode(slot);
+        uint64_t busy = nowNs() - start;
+
+        atomic_fetch_add_explicit(&stats->datagrams, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats->records, records, memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats->busyNs, (long)busy, memory_order_relaxed);
+
+        // The free ring holds every slot, so this cannot fail
+        mpmcPush(&pool->freeRing, slot);
+    }
+
+    if (pool->done != NULL) {
+        pool->done();
+    }
+    arenaSetCurrent(NULL);
+    arenaFree(&arena);
+    return NULL;
+}
+
+/* ================================================================
+ * rxPoolInit() — Allocate slots and rings, start the decoders
+ * ================================================================ */
+int rxPoolInit(RxPool *pool, int decoders, int slots, size_t slotSize,
+               int ordered, DecodeFunc decode, IdleFunc idle, ExitFunc done) {
+    memset(pool, 0, sizeof(*pool));
+    pool->decoderCount = decoders;
+    pool->ordered = ordered;
+    pool->slotCount = slots;
+    pool->slotSize = slotSize;
+    pool->decode = decode;
+    pool->idle = idle;
+    pool->done = done;
+    atomic_init(&pool->stopping, 0);
+
+    pool->slots = calloc(slots, sizeof(DatagramSlot));
+    pool->slab = malloc((size_t)slots * slotSize);
+    pool->threads = calloc(decoders, sizeof(pthread_t));
+    pool->decoderArgs = calloc(decoders, sizeof(DecoderArgs));
+    pool->stats = aligned_alloc(RING_CACHE_LINE,
+                                (size_t)decoders * sizeof(DecoderStats));
+    if (pool->slots == NULL || pool->slab == NULL || pool->threads == NULL ||
+        pool->decoderArgs == NULL || pool->stats == NULL) {
+        printf("Error: Could not allocate the decoder pool\n");
+        return -1;
+    }
+    memset(pool->stats, 0, (size_t)decoders * sizeof(DecoderStats));
+
+    // Every ring can hold every slot, so pushes never fail
+    if (mpmcInit(&pool->freeRing, slots) == -1 ||
+        (!ordered && mpmcInit(&pool->work, slots) == -1)) {
+        printf("Error: Could not allocate the decoder pool\n");
+        return -1;
+    }
+    if (ordered) {
+        pool->lanes = calloc(decoders, sizeof(SpscRing));
+        if (pool->lanes == NULL) {
+            printf("Error: Could not allocate the decoder pool\n");
+            return -1;
+        }
+        for (int i = 0; i < decoders; i++) {
+            if (spscInit(&pool->lanes[i], slots) == -1) {
+                printf("Error: Could not allocate the decoder pool\n");
+                return -1;
+            }
+        }
+    }
+
+    for (int i = 0; i < slots; i++) {
+        pool->slots[i].data = pool->slab + (size_t)i * slotSize;
+        mpmcPush(&pool->freeRing, &pool->slots[i]);
+    }
+
+    pool->startNs = nowNs();
+
+    DecoderArgs *args = pool->decoderArgs;
+    for (int i = 0; i < decoders; i++) {
+        args[i].pool = pool;
+        args[i].index = i;
+        int err = pthread_create(&pool->threads[i], NULL, decoderMain, &args[i]);
+        if (err != 0) {
+            printf("Error: Could not start decoder thread: %s\n", strerror(err));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* ================================================================
+ * rxPoolAcquire() — Take an empty slot
+ * ================================================================ */
+DatagramSlot *rxPoolAcquire(RxPool *pool) {
+    DatagramSlot *slot = mpmcPop(&pool->freeRing);
+    if (slot != NULL) {
+        return slot;
+    }
+
+    // Decoders are behind: every slot is queued or being decoded
+    pool->stalls++;
+    unsigned attempt = 0;
+    while ((slot = mpmcPop(&pool->freeRing)) == NULL) {
+        ringBackoff(&attempt);
+    }
+    return slot;
+}
+
+/* ================================================================
+ * rxPoolSubmit() — Queue a filled slot
+ *
+ * Ordered mode hashes the sender's address and port to a decoder
+ * lane (Fibonacci hashing), so a sender always lands on the same
+ * decoder.
+ * ================================================================ */
+void rxPoolSubmit(RxPool *pool, DatagramSlot *slot) {
+    if (pool->ordered) {
+        uint64_t key = ((uint64_t)slot->source.sin_addr.s_addr << 16) | slot->source.sin_port;
+        int lane = (int)(((key * 0x9E3779B97F4A7C15ULL) >> 32) % (uint64_t)pool->decoderCount);
+        spscPush(&pool->lanes[lane], slot);
+    }
+    else {
+        mpmcPush(&pool->work, slot);
+    }
+
+    pool->received++;
+    pool->bytes += slot->length;
+
+    if (pool->received % BACKLOG_SAMPLE == 0) {
+        long decoded = 0;
+        for (int i = 0; i < pool->decoderCount; i++) {
+            decoded += atomic_load_explicit(&pool->stats[i].datagrams, memory_order_relaxed);
+        }
+        if (pool->received - decoded > pool->queuedHighWater) {
+            pool->queuedHighWater = pool->received - decoded;
+        }
+    }
+}
+
+/* ================================================================
+ * rxPoolStop() — Drain the queues and join the decoders
+ * ================================================================ */
+void rxPoolStop(RxPool *pool) {
+    atomic_store_explicit(&pool->stopping, 1, memory_order_release);
+
+    for (int i = 0; i < pool->decoderCount; i++) {
+        if (pool->threads[i] != 0) {
+            pthread_join(pool->threads[i], NULL);
+        }
+    }
+}
+
+/* ================================================================
+ * rxPoolReport() — Print per-stage throughput
+ *
+ * Rates are over the pool's whole lifetime. A decoder's busy share
+ * is the fraction of that time it spent decoding; decoders near
+ * 100% are the bottleneck.
+ * ================================================================ */
+void rxPoolReport(const RxPool *pool) {
+    double elapsed = (double)(nowNs() - pool->startNs) / NSEC_PER_SEC;
+    if (elapsed <= 0) {
+        elapsed = 1e-9;
+    }
+
+    printf("Receive: %ld datagrams (%.0f/s, %.2f MB/s), %ld stalls waiting for a free slot\n",
+           pool->received, pool->received / elapsed, pool->bytes / elapsed / 1e6,
+           pool->stalls);
+    printf("Queue: %d slots, backlog high-water %ld, %s\n", pool->slotCount,
+           pool->queuedHighWater, pool->ordered ? "ordered per sender" : "unordered");
+
+    for (int i = 0; i < pool->decoderCount; i++) {
+        long datagrams = atomic_load(&pool->stats[i].datagrams);
+        long records = atomic_load(&pool->stats[i].records);
+        long busyNs = atomic_load(&pool->stats[i].busyNs);
+        printf("Decoder %d: %ld datagrams, %ld records (%.0f records/s), busy %.1f%%\n",
+               i, datagrams, records, records / elapsed,
+               100.0 * busyNs / (elapsed * NSEC_PER_SEC));
+    }
+}
+
+/* ================================================================
+ * rxPoolFree() — Release slots and rings
+ * ================================================================ */
+void rxPoolFree(RxPool *pool) {
+    if (pool->lanes != NULL) {
+        for (int i = 0; i < pool->decoderCount; i++) {
+            spscFree(&pool->lanes[i]);
+        }
+    }
+    free(pool->lanes);
+    mpmcFree(&pool->work);
+    mpmcFree(&pool->freeRing);
+    free(pool->slots);
+    free(pool->slab);
+    free(pool->threads);
+    free(pool->decoderArgs);
+    free(pool->stats);
+    memset(pool, 0, sizeof(*pool));
+}
@@ -0,0 +1,164 @@
+/* ================================================================
+ * rxpool.h — Receive Thread to Decoder Pool Hand-Off
+ *
+ * The receive thread only drains the socket: recvmmsg() writes each
+ * datagram straight into a slot from a preallocated pool, and the
+ * slot is queued for a pool of decoder threads. Decoders parse and
+ * print, then return the slot. Every queue is a lock-free ring:
+ *
+ *   receiver --work (MPMC)---------> decoders     (any order)
+ *   receiver --lane[i] (SPSC)------> decoder i    (--ordered)
+ *   receiver <--free (MPMC)--------- decoders
+ *
+ * In ordered mode each sender address is hashed to one decoder, so
+ * one sender's datagrams are decoded in the order they arrived.
+ * ================================================================ */
+
+#ifndef RXPOOL_H
+#define RXPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <netinet/in.h>
+#include "ring.h"
+#include "envelope.h"
+
+// Upper bound for the decoder count accepted on the command line.
+#define MAX_DECODERS 32
+
+/* ================================================================
+ * DatagramSlot struct:
+ * One received datagram, null-terminated at data[length].
+ *
+ *  - destination: group and port it was sent to (sin_family is 0
+ *    when the socket reported no IP_PKTINFO)
+ *  - offset: where the payload starts in data; ENVELOPE_SIZE when
+ *    the datagram carried a sequence envelope, else 0
+ *  - wireNs / userNs: kernel receive time and recvmmsg() return
+ *    time, CLOCK_REALTIME (0 when latency is not measured)
+ * ================================================================ */
+typedef struct {
+    char *data;                 // Receive buffer (slotSize bytes)
+    int offset;                 // Payload start in data
+    int length;                 // Payload bytes (after offset)
+    struct sockaddr_in source;  // Sender address
+    struct sockaddr_in destination;  // Group and port it arrived on
+    Envelope envelope;          // Decoded envelope (when offset > 0)
+    uint64_t wireNs;            // Kernel receive time
+    uint64_t userNs;            // Time the receive thread got it
+} DatagramSlot;
+
+/* ================================================================
+ * DecodeFunc:
+ * Called on a decoder thread for every datagram. Returns the number
+ * of records decoded.
+ * ================================================================ */
+typedef int (*DecodeFunc)(const DatagramSlot *datagram);
+
+/* ================================================================
+ * IdleFunc:
+ * Called on a decoder thread when it runs out of work and is about
+ * to sleep (e.g. to flush buffered output). May be NULL.
+ * ================================================================ */
+typedef void (*IdleFunc)(void);
+
+/* ================================================================
+ * ExitFunc:
+ * Called on a decoder thread just before it exits, to release
+ * per-thread state the DecodeFunc built up. May be NULL.
+ * ================================================================ */
+typedef void (*ExitFunc)(void);
+
+/* ================================================================
+ * DecoderStats struct:
+ * Per-decoder counters, written only by that decoder.
+ * ================================================================ */
+typedef struct {
+    _Alignas(RING_CACHE_LINE) atomic_long datagrams;  // Datagrams decoded
+    atomic_long records;        // Records decoded
+    atomic_long busyNs;         // Time spent inside DecodeFunc
+} DecoderStats;
+
+/* ================================================================
+ * RxPool struct:
+ * Slot pool, rings, decoder threads and per-stage counters.
+ *
+ *  - stalls: times the receiver found no free slot and had to wait
+ *  - queuedHighWater: most datagrams waiting for a decoder at once
+ * ================================================================ */
+typedef struct {
+    int decoderCount;           // Decoder threads
+    int ordered;                // 1 = per-sender ordering (lanes)
+    int slotCount;              // Slots in the pool
+    size_t slotSize;            // Bytes per slot
+    DatagramSlot *slots;        // Slot pool
+    char *slab;                 // Slot payload storage
+    MpmcRing freeRing;          // Empty slots
+    MpmcRing work;              // Filled slots, unordered mode
+    SpscRing *lanes;            // Filled slots per decoder, ordered mode
+    DecodeFunc decode;          // Datagram handler
+    IdleFunc idle;              // Out-of-work hook (may be NULL)
+    ExitFunc done;              // Decoder exit hook (may be NULL)
+    pthread_t *threads;         // Decoder threads
+    void *decoderArgs;          // Per-decoder thread arguments
+    atomic_int stopping;        // Set once the receiver is done
+    uint64_t startNs;           // When the pool started
+
+    // Receiver counters (receive thread only)
+    long received;              // Datagrams queued for decoding
+    long bytes;                 // Payload bytes queued
+    long stalls;                // Waits for a free slot
+    long queuedHighWater;       // Deepest backlog seen
+
+    DecoderStats *stats;        // Per-decoder counters
+} RxPool;
+
+/* ================================================================
+ * rxPoolInit():
+ * Allocate `slots` slots of `slotSize` bytes and start `decoders`
+ * threads running `decode`, `idle` (if not NULL) whenever a
+ * decoder runs out of work, and `done` (if not NULL) as each
+ * decoder exits.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on error
+ * ================================================================ */
+int rxPoolInit(RxPool *pool, int decoders, int slots, size_t slotSize,
+               int ordered, DecodeFunc decode, IdleFunc idle, ExitFunc done);
+
+/* ================================================================
+ * rxPoolAcquire():
+ * Receiver side. Returns an empty slot, waiting (and counting a
+ * stall) while every slot is queued or being decoded.
+ * ================================================================ */
+DatagramSlot *rxPoolAcquire(RxPool *pool);
+
+/* ================================================================
+ * rxPoolSubmit():
+ * Receiver side. Queues a filled slot for the decoders.
+ * ================================================================ */
+void rxPoolSubmit(RxPool *pool, DatagramSlot *slot);
+
+/* ================================================================
+ * rxPoolStop():
+ * Receiver side. Lets the decoders finish what is queued, then
+ * joins them.
+ * ================================================================ */
+void rxPoolStop(RxPool *pool);
+
+/* ================================================================
+ * rxPoolReport():
+ * Prints receive, queue and per-decoder throughput.
+ * ================================================================ */
+void rxPoolReport(const RxPool *pool);
+
+/* ================================================================
+ * rxPoolFree():
+ * Releases the slots and rings (after rxPoolStop()).
+ * ================================================================ */
+void rxPoolFree(RxPool *pool);
+
+#endif /* RXPOOL_H */
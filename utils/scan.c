@@ -0,0 +1,289 @@
+/* ================================================================
+ * scan.c — Delimiter Scanning for the Line Tokenizer
+ *
+ * Finds the next structural character in a key:value line 16 (SSE2)
+ * or 32 (AVX2) bytes at a time. The widest implementation the CPU
+ * supports is picked at runtime; a table-driven scalar loop is the
+ * fallback on other architectures.
+ * ================================================================ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include "scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Stop sets. '\0' always stops a scan, because the tokenizer treats
+ * it as the end of the line.
+ */
+#define STOP_SPACE     0x01 // ' ', '\t', '\n', '\v', '\f', '\r'
+#define STOP_COLON     0x02 // ':'
+#define STOP_QUOTE     0x04 // '"'
+#define STOP_BACKSLASH 0x08 // '\\'
+#define STOP_NEWLINE   0x10 // '\n' (already covered by STOP_SPACE)
+#define STOP_NUL       0x20 // '\0'
+
+#define KEY_STOPS      (STOP_SPACE | STOP_COLON | STOP_QUOTE | STOP_BACKSLASH | STOP_NUL)
+#define QUOTED_STOPS   (STOP_QUOTE | STOP_BACKSLASH | STOP_NEWLINE | STOP_NUL)
+#define UNQUOTED_STOPS (STOP_SPACE | STOP_BACKSLASH | STOP_NUL)
+
+/*
+ * Character class table for the scalar scanner: classTable[c] has
+ * every STOP_* bit that character c belongs to.
+ */
+static const uint8_t classTable[256] = {
+    ['\0'] = STOP_NUL,
+    ['\t'] = STOP_SPACE,
+    ['\n'] = STOP_SPACE | STOP_NEWLINE,
+    ['\v'] = STOP_SPACE,
+    ['\f'] = STOP_SPACE,
+    ['\r'] = STOP_SPACE,
+    [' ']  = STOP_SPACE,
+    [':']  = STOP_COLON,
+    ['"']  = STOP_QUOTE,
+    ['\\'] = STOP_BACKSLASH,
+};
+
+/* ================================================================
+ * scalarScan() — One byte at a time through the class table
+ * ================================================================ */
+static inline const char *scalarScan(const char *pos, const char *end, int stops) {
+    while (pos < end && !(classTable[(unsigned char)*pos] & stops)) {
+        pos++;
+    }
+    return pos;
+}
+
+static const char *scalarKey(const char *pos, const char *end) {
+    return scalarScan(pos, end, KEY_STOPS);
+}
+
+static const char *scalarQuoted(const char *pos, const char *end) {
+    return scalarScan(pos, end, QUOTED_STOPS);
+}
+
+static const char *scalarUnquoted(const char *pos, const char *end) {
+    return scalarScan(pos, end, UNQUOTED_STOPS);
+}
+
+#ifdef SCAN_X86
+
+/* ================================================================
+ * sse2Mask() — Bitmask of the bytes in v that belong to `stops`
+ *
+ * Whitespace is the range 0x09-0x0D plus 0x20. The range test
+ * subtracts 9 and checks min(x, 4) == x with unsigned bytes, so
+ * anything below 9 wraps around and fails.
+ * ================================================================ */
+static inline int sse2Mask(__m128i v, int stops) {
+    __m128i hit = _mm_cmpeq_epi8(v, _mm_setzero_si128());
+
+    if (stops & STOP_SPACE) {
+        __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(9));
+        __m128i inRange = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+        hit = _mm_or_si128(hit, inRange);
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+    }
+    else if (stops & STOP_NEWLINE) {
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    }
+    if (stops & STOP_COLON) {
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8(':')));
+    }
+    if (stops & STOP_QUOTE) {
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+    }
+    if (stops & STOP_BACKSLASH) {
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+    }
+
+    return _mm_movemask_epi8(hit);
+}
+
+/* ================================================================
+ * sse2Scan() — 16 bytes per step, scalar for the tail
+ *
+ * Only whole 16-byte blocks inside [pos, end) are loaded, so the
+ * scan never reads past the end of the line (which matters for
+ * memory-mapped input ending at a page boundary).
+ * ================================================================ */
+static inline const char *sse2Scan(const char *pos, const char *end, int stops) {
+    while (end - pos >= 16) {
+        int mask = sse2Mask(_mm_loadu_si128((const __m128i *)pos), stops);
+        if (mask != 0) {
+            return pos + __builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+    return scalarScan(pos, end, stops);
+}
+
+static const char *sse2Key(const char *pos, const char *end) {
+    return sse2Scan(pos, end, KEY_STOPS);
+}
+
+static const char *sse2Quoted(const char *pos, const char *end) {
+    return sse2Scan(pos, end, QUOTED_STOPS);
+}
+
+static const char *sse2Unquoted(const char *pos, const char *end) {
+    return sse2Scan(pos, end, UNQUOTED_STOPS);
+}
+
+/* ================================================================
+ * avx2Mask() / avx2Scan() — Same as the SSE2 versions, 32 bytes wide
+ *
+ * Compiled for AVX2 with a target attribute so the rest of the
+ * program keeps the baseline instruction set; only called after
+ * __builtin_cpu_supports("avx2") says it is safe.
+ * ================================================================ */
+__attribute__((target("avx2")))
+static inline uint32_t avx2Mask(__m256i v, int stops) {
+    __m256i hit = _mm256_cmpeq_epi8(v, _mm256_setzero_si256());
+
+    if (stops & STOP_SPACE) {
+        __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(9));
+        __m256i inRange = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+        hit = _mm256_or_si256(hit, inRange);
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+    }
+    else if (stops & STOP_NEWLINE) {
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+    }
+    if (stops & STOP_COLON) {
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')));
+    }
+    if (stops & STOP_QUOTE) {
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+    }
+    if (stops & STOP_BACKSLASH) {
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+    }
+
+    return (uint32_t)_mm256_movemask_epi8(hit);
+}
+
+__attribute__((target("avx2")))
+static inline const char *avx2Scan(const char *pos, const char *end, int stops) {
+    while (end - pos >= 32) {
+        uint32_t mask = avx2Mask(_mm256_loadu_si256((const __m256i *)pos), stops);
+        if (mask != 0) {
+            return pos + __builtin_ctz(mask);
+        }
+        pos += 32;
+    }
+    return sse2Scan(pos, end, stops);
+}
+
+__attribute__((target("avx2")))
+static const char *avx2Key(const char *pos, const char *end) {
+    return avx2Scan(pos, end, KEY_STOPS);
+}
+
+__attribute__((target("avx2")))
+static const char *avx2Quoted(const char *pos, const char *end) {
+    return avx2Scan(pos, end, QUOTED_STOPS);
+}
+
+__attribute__((target("avx2")))
+static const char *avx2Unquoted(const char *pos, const char *end) {
+    return avx2Scan(pos, end, UNQUOTED_STOPS);
+}
+
+#endif /* SCAN_X86 */
+
+/* ================================================================
+ * ScanOps struct:
+ * The active implementation. Filled in with the SCAN_AUTO choice,
+ * exactly once, on first use or by the first scanSelect() call; an
+ * explicit scanSelect() then overrides it.
+ * ================================================================ */
+typedef struct {
+    const char *(*key)(const char *, const char *);
+    const char *(*quoted)(const char *, const char *);
+    const char *(*unquoted)(const char *, const char *);
+    const char *name;
+} ScanOps;
+
+static ScanOps active;
+static pthread_once_t activeOnce = PTHREAD_ONCE_INIT;
+
+/* ================================================================
+ * selectImpl() — Install an implementation in `active`
+ * ================================================================ */
+static int selectImpl(ScanImpl impl) {
+#ifdef SCAN_X86
+    if (impl == SCAN_AUTO) {
+        impl = __builtin_cpu_supports("avx2") ? SCAN_AVX2 : SCAN_SSE2;
+    }
+
+    if (impl == SCAN_AVX2) {
+        if (!__builtin_cpu_supports("avx2")) {
+            return -1;
+        }
+        active = (ScanOps){ avx2Key, avx2Quoted, avx2Unquoted, "avx2" };
+        return 0;
+    }
+
+    if (impl == SCAN_SSE2) {
+        active = (ScanOps){ sse2Key, sse2Quoted, sse2Unquoted, "sse2" };
+        return 0;
+    }
+#else
+    if (impl == SCAN_AUTO) {
+        impl = SCAN_SCALAR;
+    }
+#endif
+
+    if (impl == SCAN_SCALAR) {
+        active = (ScanOps){ scalarKey, scalarQuoted, scalarUnquoted, "scalar" };
+        return 0;
+    }
+
+    return -1;
+}
+
+/* ================================================================
+ * selectAuto() — The SCAN_AUTO choice, made once by pthread_once()
+ * ================================================================ */
+static void selectAuto(void) {
+    selectImpl(SCAN_AUTO);
+}
+
+/* ================================================================
+ * scanSelect() — Choose the scanner implementation
+ * ================================================================ */
+int scanSelect(ScanImpl impl) {
+    pthread_once(&activeOnce, selectAuto);
+    return selectImpl(impl);
+}
+
+/* ================================================================
+ * scanImplName() — Name of the implementation in use
+ * ================================================================ */
+const char *scanImplName(void) {
+    pthread_once(&activeOnce, selectAuto);
+    return active.name;
+}
+
+/* ================================================================
+ * scanKey() / scanQuoted() / scanUnquoted() — Dispatch
+ * ================================================================ */
+const char *scanKey(const char *pos, const char *end) {
+    pthread_once(&activeOnce, selectAuto);
+    return active.key(pos, end);
+}
+
+const char *scanQuoted(const char *pos, const char *end) {
+    pthread_once(&activeOnce, selectAuto);
+    return active.quoted(pos, end);
+}
+
+const char *scanUnquoted(const char *pos, const char *end) {
+    pthread_once(&activeOnce, selectAuto);
+    return active.unquoted(pos, end);
+}
@@ -0,0 +1,70 @@
+/* ================================================================
+ * scan.h — Delimiter Scanning for the Line Tokenizer
+ *
+ * Finds the next structural character in a key:value line 16 (SSE2)
+ * or 32 (AVX2) bytes at a time. The widest implementation the CPU
+ * supports is picked at runtime; a table-driven scalar loop is the
+ * fallback on other architectures.
+ *
+ * "Whitespace" means isspace() in the C locale: ' ', '\t', '\n',
+ * '\v', '\f', '\r'.
+ * ================================================================ */
+
+#ifndef SCAN_H
+#define SCAN_H
+
+/* ================================================================
+ * ScanImpl enum:
+ * Scanner implementations, selectable for benchmarking.
+ * ================================================================ */
+typedef enum {
+    SCAN_AUTO,      // Best available (default)
+    SCAN_SCALAR,    // One byte at a time
+    SCAN_SSE2,      // 16 bytes at a time
+    SCAN_AVX2       // 32 bytes at a time
+} ScanImpl;
+
+/* ================================================================
+ * scanKey():
+ * Returns the first position in [pos, end) holding whitespace,
+ * ':', '"', '\\' or '\0' — every character that ends a key.
+ * Returns end if there is none.
+ * ================================================================ */
+const char *scanKey(const char *pos, const char *end);
+
+/* ================================================================
+ * scanQuoted():
+ * Returns the first position in [pos, end) holding '"', '\\', '\n'
+ * or '\0' — every character that interrupts a quoted value.
+ * Returns end if there is none.
+ * ================================================================ */
+const char *scanQuoted(const char *pos, const char *end);
+
+/* ================================================================
+ * scanUnquoted():
+ * Returns the first position in [pos, end) holding whitespace,
+ * '\\' or '\0' — every character that ends an unquoted value.
+ * Returns end if there is none.
+ * ================================================================ */
+const char *scanUnquoted(const char *pos, const char *end);
+
+/* ================================================================
+ * scanSelect():
+ * Chooses the scanner implementation. SCAN_AUTO picks AVX2 when the
+ * CPU supports it, else SSE2 on x86, else scalar. Without a call,
+ * the SCAN_AUTO choice is made once, thread-safely, on first use;
+ * an explicit choice must be made before other threads scan.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 if the requested implementation is unavailable
+ * ================================================================ */
+int scanSelect(ScanImpl impl);
+
+/* ================================================================
+ * scanImplName():
+ * Name of the implementation currently in use.
+ * ================================================================ */
+const char *scanImplName(void);
+
+#endif /* SCAN_H */
@@ -0,0 +1,144 @@
+/* ================================================================
+ * sendbatch.c — Batched Datagram Sender
+ *
+ * Collects serialized datagrams in preallocated slots and flushes
+ * them to a connected UDP socket with a single sendmmsg() call.
+ * Each slot can reserve a fixed-size header in front of its payload
+ * (the sequence envelope), filled in just before the flush.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "sendbatch.h"
+
+/* ================================================================
+ * sendBatchInit() — Allocate slots and prewire the message headers
+ *
+ * Every mmsghdr points at its own iovec, and every iovec points at
+ * its own slot in the slab, so queuing a datagram only has to set
+ * iov_len. msg_name stays NULL because the socket is connected.
+ * The iovec starts at the header, so header and payload go out as
+ * one contiguous datagram.
+ * ================================================================ */
+int sendBatchInit(SendBatch *batch, int sd, int capacity, size_t headerSize,
+                  size_t slotSize) {
+    memset(batch, 0, sizeof(*batch));
+
+    batch->sd = sd;
+    batch->capacity = capacity;
+    batch->headerSize = headerSize;
+    batch->slotSize = slotSize;
+
+    size_t stride = headerSize + slotSize;
+    batch->slab = malloc((size_t)capacity * stride);
+    batch->iov = calloc(capacity, sizeof(struct iovec));
+    batch->msgs = calloc(capacity, sizeof(struct mmsghdr));
+    batch->items = calloc(capacity, sizeof(int));
+    if (batch->slab == NULL || batch->iov == NULL || batch->msgs == NULL ||
+        batch->items == NULL) {
+        sendBatchFree(batch);
+        return -1;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        batch->iov[i].iov_base = batch->slab + (size_t)i * stride;
+        batch->msgs[i].msg_hdr.msg_iov = &batch->iov[i];
+        batch->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    return 0;
+}
+
+/* ================================================================
+ * sendBatchSlot() — Payload buffer of the next free slot
+ * ================================================================ */
+char *sendBatchSlot(SendBatch *batch) {
+    return (char *)batch->iov[batch->count].iov_base + batch->headerSize;
+}
+
+/* ================================================================
+ * sendBatchCommit() — Queue the next free slot
+ * ================================================================ */
+void sendBatchCommit(SendBatch *batch, size_t length, int items) {
+    batch->iov[batch->count].iov_len = batch->headerSize + length;
+    batch->msgs[batch->count].msg_len = 0;
+    batch->items[batch->count] = items;
+    batch->count++;
+}
+
+/* ================================================================
+ * sendBatchHeader() — Header of a queued slot
+ * ================================================================ */
+char *sendBatchHeader(SendBatch *batch, int i) {
+    return batch->iov[i].iov_base;
+}
+
+/* ================================================================
+ * sendBatchFull() — Check whether every slot is queued
+ * ================================================================ */
+int sendBatchFull(const SendBatch *batch) {
+    return batch->count >= batch->capacity;
+}
+
+/* ================================================================
+ * sendBatchFlush() — Send all queued slots
+ *
+ * sendmmsg() returns the number of messages it sent. A short count
+ * means either the call was interrupted or the message at that
+ * index failed; in the failure case the next call reports the error
+ * for that message, which is then skipped.
+ * ================================================================ */
+int sendBatchFlush(SendBatch *batch) {
+    int next = 0;   // Index of the first slot not yet handled
+    int sent = 0;   // Datagrams accepted by the kernel
+
+    while (next < batch->count) {
+        int result = sendmmsg(batch->sd, &batch->msgs[next],
+                              batch->count - next, 0);
+        batch->sendCalls++;
+
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // The message at `next` failed — report it and skip it
+            perror("sendmmsg");
+            batch->msgs[next].msg_len = 0;
+            batch->sendErrors++;
+            next++;
+            continue;
+        }
+
+        for (int i = next; i < next + result; i++) {
+            batch->bytesSent += batch->msgs[i].msg_len;
+            batch->itemsSent += batch->items[i];
+        }
+        sent += result;
+        next += result;
+    }
+
+    batch->datagramsSent += sent;
+    batch->flushed = batch->count;
+    batch->count = 0;
+    return sent;
+}
+
+/* ================================================================
+ * sendBatchFree() — Release all batch storage
+ * ================================================================ */
+void sendBatchFree(SendBatch *batch) {
+    free(batch->slab);
+    free(batch->iov);
+    free(batch->msgs);
+    free(batch->items);
+    batch->slab = NULL;
+    batch->iov = NULL;
+    batch->msgs = NULL;
+    batch->items = NULL;
+    batch->count = 0;
+}
@@ -0,0 +1,115 @@
+/* ================================================================
+ * sendbatch.h — Batched Datagram Sender
+ *
+ * Collects serialized datagrams in preallocated slots and flushes
+ * them to a connected UDP socket with a single sendmmsg() call.
+ * Each slot can reserve a fixed-size header in front of its payload
+ * (the sequence envelope), filled in just before the flush.
+ * ================================================================ */
+
+#ifndef SENDBATCH_H
+#define SENDBATCH_H
+
+#include <stddef.h>
+#include <sys/socket.h>  // struct mmsghdr
+#include <sys/uio.h>     // struct iovec
+
+// Largest payload that fits in a single IPv4 UDP datagram.
+#define MAX_DATAGRAM 65507
+
+// Upper bound for the batch size accepted on the command line.
+#define MAX_BATCH 1024
+
+/* ================================================================
+ * SendBatch struct:
+ * A fixed set of datagram slots backed by one contiguous slab.
+ *
+ *  - slab: capacity * (headerSize + slotSize) bytes; each slot is
+ *          headerSize header bytes followed by slotSize payload bytes
+ *  - iov / msgs: one iovec and mmsghdr per slot, prewired to the slab
+ *  - items: records packed into each slot (one datagram may carry
+ *           several newline-delimited records)
+ *  - count: number of slots currently queued for sending
+ *  - flushed: number of slots handled by the last flush
+ *
+ * Counters are cumulative over the lifetime of the batch.
+ * ================================================================ */
+typedef struct {
+    int sd;                 // Connected UDP socket
+    int capacity;           // Maximum datagrams per sendmmsg() call
+    int count;              // Datagrams currently queued
+    int flushed;            // Slots handled by the last flush
+    size_t headerSize;      // Header bytes reserved in front of each payload
+    size_t slotSize;        // Payload bytes available in each slot
+    char *slab;             // Backing storage for all slots
+    struct iovec *iov;      // Per-slot iovec
+    struct mmsghdr *msgs;   // Per-slot message header
+    int *items;             // Per-slot record count
+    long datagramsSent;     // Datagrams accepted by the kernel
+    long itemsSent;         // Records inside accepted datagrams
+    long bytesSent;         // Datagram bytes accepted by the kernel
+    long sendCalls;         // sendmmsg() system calls made
+    long sendErrors;        // Datagrams dropped because of send errors
+} SendBatch;
+
+/* ================================================================
+ * sendBatchInit():
+ * Allocate a batch of `capacity` slots of `slotSize` payload bytes
+ * each, behind `headerSize` header bytes (0 = no header), for the
+ * connected socket `sd`.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on allocation failure
+ * ================================================================ */
+int sendBatchInit(SendBatch *batch, int sd, int capacity, size_t headerSize,
+                  size_t slotSize);
+
+/* ================================================================
+ * sendBatchSlot():
+ * Returns the payload buffer of the next free slot. The caller writes
+ * up to slotSize bytes into it and then calls sendBatchCommit().
+ * The batch must not be full (see sendBatchFull()).
+ * ================================================================ */
+char *sendBatchSlot(SendBatch *batch);
+
+/* ================================================================
+ * sendBatchCommit():
+ * Queues the next free slot holding `length` bytes of payload that
+ * carry `items` records. The datagram is the header plus payload.
+ * ================================================================ */
+void sendBatchCommit(SendBatch *batch, size_t length, int items);
+
+/* ================================================================
+ * sendBatchHeader():
+ * Returns the headerSize-byte header of queued slot `i`, for the
+ * caller to fill in before sendBatchFlush().
+ * ================================================================ */
+char *sendBatchHeader(SendBatch *batch, int i);
+
+/* ================================================================
+ * sendBatchFull():
+ * Returns nonzero when every slot is queued and a flush is required.
+ * ================================================================ */
+int sendBatchFull(const SendBatch *batch);
+
+/* ================================================================
+ * sendBatchFlush():
+ * Sends every queued slot with as few sendmmsg() calls as possible.
+ *
+ * A datagram that the kernel rejects is reported with perror() and
+ * dropped; the remaining datagrams are still sent. On return, for
+ * each slot i below `flushed`, msgs[i].msg_len holds the bytes sent
+ * (0 if the datagram was dropped), and the batch is empty.
+ *
+ * Returns: number of datagrams accepted by the kernel
+ * ================================================================ */
+int sendBatchFlush(SendBatch *batch);
+
+/* ================================================================
+ * sendBatchFree():
+ * Releases the slab and message arrays.
+ * ================================================================ */
+void sendBatchFree(SendBatch *batch);
+
+#endif /* SENDBATCH_H */
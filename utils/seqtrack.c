@@ -0,0 +1,256 @@
+/* ================================================================
+ * seqtrack.c — Per-Sender Sequence Tracking
+ *
+ * Open-addressing sender table plus a sliding window of seen
+ * sequence numbers per sender.
+ * ================================================================ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include "seqtrack.h"
+
+// Grow the table once it is this full (percent).
+#define SEQ_MAX_LOAD 70
+
+/* ================================================================
+ * hashKey() — Slot for a sender ID and address (Fibonacci hashing)
+ * ================================================================ */
+static size_t hashKey(uint32_t senderId, struct in_addr source, size_t capacity) {
+    uint64_t key = ((uint64_t)source.s_addr << 32) | senderId;
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (capacity - 1);
+}
+
+/* ================================================================
+ * findSlot() — The sender's slot, or the empty slot it would take
+ * ================================================================ */
+static SeqStream *findSlot(SeqStream *streams, size_t capacity,
+                           uint32_t senderId, struct in_addr source) {
+    size_t i = hashKey(senderId, source, capacity);
+
+    while (streams[i].used &&
+           (streams[i].senderId != senderId ||
+            streams[i].source.s_addr != source.s_addr)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &streams[i];
+}
+
+/* ================================================================
+ * grow() — Double the table and reinsert every sender
+ * ================================================================ */
+static int grow(SeqTracker *tracker) {
+    size_t capacity = tracker->capacity * 2;
+    SeqStream *streams = calloc(capacity, sizeof(SeqStream));
+    if (streams == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < tracker->capacity; i++) {
+        if (tracker->streams[i].used) {
+            SeqStream *slot = findSlot(streams, capacity, tracker->streams[i].senderId,
+                                       tracker->streams[i].source);
+            *slot = tracker->streams[i];
+        }
+    }
+
+    free(tracker->streams);
+    tracker->streams = streams;
+    tracker->capacity = capacity;
+    return 0;
+}
+
+/* ================================================================
+ * Window helpers — one bit per sequence number, modulo SEQ_WINDOW
+ * ================================================================ */
+static int seen(const SeqStream *stream, uint64_t seq) {
+    uint64_t bit = seq & (SEQ_WINDOW - 1);
+    return (stream->window[bit / 64] >> (bit % 64)) & 1;
+}
+
+static void markSeen(SeqStream *stream, uint64_t seq) {
+    uint64_t bit = seq & (SEQ_WINDOW - 1);
+    stream->window[bit / 64] |= 1ULL << (bit % 64);
+}
+
+static void clearSeen(SeqStream *stream, uint64_t seq) {
+    uint64_t bit = seq & (SEQ_WINDOW - 1);
+    stream->window[bit / 64] &= ~(1ULL << (bit % 64));
+}
+
+/* ================================================================
+ * startStream() — (Re)start a sender at `seq`
+ * ================================================================ */
+static void startStream(SeqStream *stream, uint64_t seq) {
+    memset(stream->window, 0, sizeof(stream->window));
+    stream->first = seq;
+    stream->highest = seq;
+    markSeen(stream, seq);
+}
+
+/* ================================================================
+ * seqTrackerInit() — Allocate the sender table
+ * ================================================================ */
+int seqTrackerInit(SeqTracker *tracker, size_t capacity) {
+    memset(tracker, 0, sizeof(*tracker));
+
+    tracker->capacity = 16;
+    while (tracker->capacity < capacity) {
+        tracker->capacity *= 2;
+    }
+    tracker->streams = calloc(tracker->capacity, sizeof(SeqStream));
+    return tracker->streams == NULL ? -1 : 0;
+}
+
+/* ================================================================
+ * seqTrack() — Classify one datagram and update its sender
+ *
+ * Moving `highest` forward clears the window bits of the sequence
+ * numbers skipped over, so they read as "not seen" until they turn
+ * up. A datagram behind `highest` is a duplicate if its bit is set
+ * and a reordered arrival otherwise; beyond the window there is no
+ * record left, so it only counts as late.
+ * ================================================================ */
+SeqVerdict seqTrack(SeqTracker *tracker, const Envelope *env, struct in_addr source) {
+    if ((tracker->count + 1) * 100 > tracker->capacity * SEQ_MAX_LOAD &&
+        grow(tracker) == -1) {
+        return SEQ_LATE;
+    }
+
+    uint64_t seq = env->sequence;
+    SeqStream *stream = findSlot(tracker->streams, tracker->capacity,
+                                 env->senderId, source);
+
+    if (!stream->used) {
+        memset(stream, 0, sizeof(*stream));
+        stream->used = 1;
+        stream->senderId = env->senderId;
+        stream->source = source;
+        stream->received = 1;
+        stream->unique = 1;
+        startStream(stream, seq);
+        tracker->count++;
+        return SEQ_FIRST;
+    }
+
+    stream->received++;
+    stream->unique++;
+
+    if (seq > stream->highest) {
+        uint64_t ahead = seq - stream->highest;
+        if (ahead >= SEQ_WINDOW) {
+            memset(stream->window, 0, sizeof(stream->window));
+        }
+        else {
+            for (uint64_t s = stream->highest + 1; s < seq; s++) {
+                clearSeen(stream, s);
+            }
+        }
+        stream->highest = seq;
+        markSeen(stream, seq);
+
+        if (ahead == 1) {
+            return SEQ_IN_ORDER;
+        }
+        stream->gaps++;
+        return SEQ_GAP;
+    }
+
+    uint64_t behind = stream->highest - seq;
+
+    // The sender was restarted: keep its history, then start over
+    if (seq == 0 && behind >= SEQ_WINDOW) {
+        stream->restarts++;
+        stream->spanBefore += (long)(stream->highest - stream->first + 1);
+        startStream(stream, seq);
+        return SEQ_RESTART;
+    }
+
+    if (behind >= SEQ_WINDOW || seq < stream->first) {
+        stream->late++;
+        return SEQ_LATE;
+    }
+    if (seen(stream, seq)) {
+        stream->duplicates++;
+        stream->unique--;
+        return SEQ_DUPLICATE;
+    }
+
+    markSeen(stream, seq);
+    stream->reordered++;
+    if (behind > stream->maxDepth) {
+        stream->maxDepth = behind;
+    }
+    return SEQ_REORDERED;
+}
+
+/* ================================================================
+ * seqMissing() — Sequence numbers in [first, highest] not received
+ *
+ * Covers every run of the sender since its first datagram. Late
+ * datagrams count as unique, so a duplicate arriving late can make
+ * this undercount; it never goes below zero.
+ * ================================================================ */
+long seqMissing(const SeqStream *stream) {
+    long span = stream->spanBefore + (long)(stream->highest - stream->first + 1);
+    return span > stream->unique ? span - stream->unique : 0;
+}
+
+/* ================================================================
+ * seqTrackerReport() — Print totals and per-sender lines
+ * ================================================================ */
+void seqTrackerReport(const SeqTracker *tracker) {
+    long received = 0, missing = 0, duplicates = 0, reordered = 0, late = 0;
+    uint64_t maxDepth = 0;
+
+    for (size_t i = 0; i < tracker->capacity; i++) {
+        const SeqStream *stream = &tracker->streams[i];
+        if (!stream->used) {
+            continue;
+        }
+        received += stream->received;
+        missing += seqMissing(stream);
+        duplicates += stream->duplicates;
+        reordered += stream->reordered;
+        late += stream->late;
+        if (stream->maxDepth > maxDepth) {
+            maxDepth = stream->maxDepth;
+        }
+    }
+
+    printf("Sequence: %zu sender(s), %ld datagrams, %ld missing, %ld duplicates, "
+           "%ld reordered (max depth %llu), %ld too late to classify\n",
+           tracker->count, received, missing, duplicates, reordered,
+           (unsigned long long)maxDepth, late);
+    if (tracker->badEnvelopes > 0) {
+        printf("Bad envelopes: %ld\n", tracker->badEnvelopes);
+    }
+
+    for (size_t i = 0; i < tracker->capacity; i++) {
+        const SeqStream *stream = &tracker->streams[i];
+        char source[INET_ADDRSTRLEN];
+        if (!stream->used) {
+            continue;
+        }
+        inet_ntop(AF_INET, &stream->source, source, sizeof(source));
+        printf("  sender %08x from %s: seq %llu-%llu, %ld received, %ld missing in %ld gaps, "
+               "%ld duplicates, %ld reordered (max depth %llu)",
+               stream->senderId, source, (unsigned long long)stream->first,
+               (unsigned long long)stream->highest, stream->received, seqMissing(stream),
+               stream->gaps, stream->duplicates, stream->reordered,
+               (unsigned long long)stream->maxDepth);
+        if (stream->restarts > 0) {
+            printf(", %ld restarts", stream->restarts);
+        }
+        printf("\n");
+    }
+}
+
+/* ================================================================
+ * seqTrackerFree() — Release the table
+ * ================================================================ */
+void seqTrackerFree(SeqTracker *tracker) {
+    free(tracker->streams);
+    memset(tracker, 0, sizeof(*tracker));
+}
@@ -0,0 +1,116 @@
+/* ================================================================
+ * seqtrack.h — Per-Sender Sequence Tracking
+ *
+ * Follows the envelope sequence numbers of every sender and counts
+ * missing, duplicated and reordered datagrams. Senders are kept in
+ * an open-addressing hash table (linear probing) keyed by sender ID
+ * and source address. Each sender remembers which of the last
+ * SEQ_WINDOW sequence numbers it has seen, so a late datagram can
+ * be told apart from a duplicate.
+ *
+ * Not thread-safe: the receive thread owns the tracker.
+ * ================================================================ */
+
+#ifndef SEQTRACK_H
+#define SEQTRACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <netinet/in.h>
+#include "envelope.h"
+
+// Sequence numbers remembered per sender (power of two).
+#define SEQ_WINDOW 1024
+
+/* ================================================================
+ * SeqVerdict enum:
+ * How one datagram fits its sender's sequence.
+ * ================================================================ */
+typedef enum {
+    SEQ_FIRST,                  // First datagram of a new sender
+    SEQ_IN_ORDER,               // Exactly the next sequence number
+    SEQ_GAP,                    // Ahead of the next one: some are missing
+    SEQ_REORDERED,              // Fills an earlier gap
+    SEQ_DUPLICATE,              // Already seen
+    SEQ_LATE,                   // Older than the window: cannot tell
+    SEQ_RESTART                 // Sequence 0 long after the start: sender restarted
+} SeqVerdict;
+
+/* ================================================================
+ * SeqStream struct:
+ * State and counters for one sender.
+ *
+ *  - window: bit (seq % SEQ_WINDOW) is set if seq was seen, for
+ *    seq in (highest - SEQ_WINDOW, highest]
+ *  - maxDepth: largest distance behind `highest` a reordered
+ *    datagram arrived at
+ *  - spanBefore: sequence numbers covered before the last restart,
+ *    so missing counts survive a sender starting over
+ * ================================================================ */
+typedef struct {
+    int used;                   // Slot holds a sender
+    uint32_t senderId;          // Envelope sender ID
+    struct in_addr source;      // Sender address
+    uint64_t first;             // First sequence number seen
+    uint64_t highest;           // Highest sequence number seen
+    long received;              // Datagrams received
+    long unique;                // Datagrams that were not duplicates
+    long spanBefore;            // Sequence numbers covered before restarts
+    long duplicates;            // Datagrams seen twice
+    long reordered;             // Datagrams that filled a gap
+    long late;                  // Datagrams older than the window
+    long gaps;                  // Jumps over missing sequence numbers
+    long restarts;              // Times the sender started over at 0
+    uint64_t maxDepth;          // Deepest reordering seen
+    uint64_t window[SEQ_WINDOW / 64];  // Seen bitmap
+} SeqStream;
+
+/* ================================================================
+ * SeqTracker struct:
+ * The sender table.
+ * ================================================================ */
+typedef struct {
+    SeqStream *streams;         // Table (capacity slots)
+    size_t capacity;            // Slots, power of two
+    size_t count;               // Senders in the table
+    long badEnvelopes;          // Truncated or unknown-version envelopes
+} SeqTracker;
+
+/* ================================================================
+ * seqTrackerInit():
+ * Allocate a table for at least `capacity` senders; it grows as
+ * needed.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - -1 on allocation failure
+ * ================================================================ */
+int seqTrackerInit(SeqTracker *tracker, size_t capacity);
+
+/* ================================================================
+ * seqTrack():
+ * Records one enveloped datagram from `source`.
+ *
+ * Returns: how the datagram fits its sender's sequence
+ * ================================================================ */
+SeqVerdict seqTrack(SeqTracker *tracker, const Envelope *env, struct in_addr source);
+
+/* ================================================================
+ * seqMissing():
+ * Returns the sequence numbers of `stream` never received so far.
+ * ================================================================ */
+long seqMissing(const SeqStream *stream);
+
+/* ================================================================
+ * seqTrackerReport():
+ * Prints totals and one line per sender.
+ * ================================================================ */
+void seqTrackerReport(const SeqTracker *tracker);
+
+/* ================================================================
+ * seqTrackerFree():
+ * Releases the table.
+ * ================================================================ */
+void seqTrackerFree(SeqTracker *tracker);
+
+#endif /* SEQTRACK_H */
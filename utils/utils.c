@@ -5,6 +5,7 @@
  * ================================================================ */
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -31,7 +32,7 @@ void validateArguments(int argc, char *argv[], struct in_addr *addr, int *port)
 
     // Step 1: Argument count check
     if (argc < 3) {
-        printf("Error: Usage is %s <multicast_ip> <portnumber>\n", argv[0]);
+        printf("Error: Usage is %s [options] <multicast_ip> <portnumber>\n", argv[0]);
         printf("Example: %s 239.0.0.1 5000\n", argv[0]);
         exit(1);
     }
@@ -77,10 +78,31 @@ void validateArguments(int argc, char *argv[], struct in_addr *addr, int *port)
     }
 }
 
+/* ================================================================
+ * emitStdout() — EmitFunc that prints to stdout
+ * ================================================================ */
+static void emitStdout(void *ctx, const char *format, ...) {
+    va_list args;
+    (void)ctx;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
 /* ================================================================
  * printJSONObject(): 
  * Display all key-value pairs in a cJSON object.
  *
+ * Prints to stdout; see emitJSONObject() for the format.
+ * ================================================================ */
+void printJSONObject(cJSON *obj, ProgramMode mode, int DebugMode) {
+    emitJSONObject(obj, mode, DebugMode, emitStdout, NULL);
+}
+
+/* ================================================================
+ * emitJSONObject(): 
+ * Format all key-value pairs in a cJSON object through `emit`.
+ *
  * Handles three JSON value types:
  *  - Strings: printed as-is (quoted strings retain their quotes)
  *  - Booleans: printed as "true" or "false"
@@ -94,16 +116,17 @@ void validateArguments(int argc, char *argv[], struct in_addr *addr, int *port)
  *  0: Normal mode - prints JSON object in specified mode format
  *  1: Debug mode - prints JSON object in cJSON_Print format
  * ================================================================ */
-void printJSONObject(cJSON *obj, ProgramMode mode, int DebugMode) {
+void emitJSONObject(cJSON *obj, ProgramMode mode, int DebugMode,
+                    EmitFunc emit, void *ctx) {
     // Verify valid cJSON object.
     if (obj == NULL || !cJSON_IsObject(obj)) {
-        printf("Error: Invalid JSON object\n");
+        emit(ctx, "Error: Invalid JSON object\n");
         return;
     }
 
     if (DebugMode == 1) {
-        printf("DEBUG MODE:\n");
-        printf("%s\n", cJSON_Print(obj));
+        emit(ctx, "DEBUG MODE:\n");
+        emit(ctx, "%s\n", cJSON_Print(obj));
         return;
     }
 
@@ -115,11 +138,11 @@ void printJSONObject(cJSON *obj, ProgramMode mode, int DebugMode) {
          *  FORMAT_CLIENT: Left-aligned, no padding
          */
         if (mode == MODE_SERVER) {
-            printf("%20s: ", item->string);
+            emit(ctx, "%20s: ", item->string);
         }
         else if (mode == MODE_CLIENT) {
-            printf("Parsed JSON data:\n");
-            printf("%s: ", item->string);
+            emit(ctx, "Parsed JSON data:\n");
+            emit(ctx, "%s: ", item->string);
         }
 
         /*
@@ -130,27 +153,27 @@ void printJSONObject(cJSON *obj, ProgramMode mode, int DebugMode) {
          */
         if (cJSON_IsString(item)) {
             if (mode == MODE_SERVER) {
-                printf("%20s\n", item->valuestring);
+                emit(ctx, "%20s\n", item->valuestring);
             }
             else {
-                printf("%s\n", item->valuestring);
+                emit(ctx, "%s\n", item->valuestring);
             }
         }
         else if (cJSON_IsBool(item)) {
             const char *boolStr = cJSON_IsTrue(item) ? "true" : "false";
             if (mode == MODE_SERVER) {
-                printf("%20s\n", boolStr);
+                emit(ctx, "%20s\n", boolStr);
             }
             else {
-                printf("%s\n", boolStr);
+                emit(ctx, "%s\n", boolStr);
             }
         }
         else if (cJSON_IsNumber(item)) {
             if (mode == MODE_SERVER) {
-                printf("%20g\n", item->valuedouble);
+                emit(ctx, "%20g\n", item->valuedouble);
             }
             else {
-                printf("%g\n", item->valuedouble);
+                emit(ctx, "%g\n", item->valuedouble);
             }
         }
     }
@@ -163,13 +186,16 @@ void printJSONObject(cJSON *obj, ProgramMode mode, int DebugMode) {
  * Behavior depends on mode:
  *  MODE_CLIENT: Creates socket, sets sin_family and sin_port.
  *               Does NOT set sin_addr (caller sets via inet_pton).
- *               Does NOT bind (OS assigns ephemeral port on sendto).
+ *               Does NOT bind (OS assigns ephemeral port on connect).
+ *               Connects the socket to the address so datagrams can
+ *               be sent with send()/sendmmsg() without a destination.
  *
  *  MODE_SERVER: Creates socket, sets SO_REUSEADDR and SO_REUSEPORT,
  *               sets sin_family, sin_port, sin_addr to INADDR_ANY,
  *               then binds to the address.
  * ================================================================ */
-void setupSocket(int *sd, int port, struct sockaddr_in *address, ProgramMode mode) {
+void setupSocket(int *sd, int port, struct sockaddr_in *address, ProgramMode mode,
+                 int rcvbuf) {
     // Create UDP socket
     *sd = socket(AF_INET, SOCK_DGRAM, 0);
     if (*sd == -1) {
@@ -187,6 +213,20 @@ void setupSocket(int *sd, int port, struct sockaddr_in *address, ProgramMode mod
         setsockopt(*sd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
         setsockopt(*sd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
 
+        /*
+         * Size the buffer before bind(), so no datagram is queued
+         * against the default size. SO_RXQ_OVFL makes every datagram
+         * carry the socket's cumulative count of datagrams dropped
+         * because the buffer was full.
+         */
+        if (rcvbuf > 0 && setReceiveBuffer(*sd, rcvbuf) == -1) {
+            exit(1);
+        }
+        if (setsockopt(*sd, SOL_SOCKET, SO_RXQ_OVFL, &reuse, sizeof(reuse)) == -1) {
+            perror("setsockopt SO_RXQ_OVFL");
+            exit(1);
+        }
+
         address->sin_addr.s_addr = INADDR_ANY;
 
         if (bind(*sd, (struct sockaddr *)address, sizeof(*address)) == -1) {
@@ -194,5 +234,43 @@ void setupSocket(int *sd, int port, struct sockaddr_in *address, ProgramMode mod
             exit(1);
         }
     }
-    // Client mode: sin_addr already set by caller via inet_pton()
+    /*
+     * Client mode: sin_addr already set by caller via inet_pton().
+     *
+     * connect() on a UDP socket sends nothing; it fixes the default
+     * destination so the kernel skips the per-call address lookup and
+     * sendmmsg() batches need no msg_name.
+     */
+    else if (mode == MODE_CLIENT) {
+        if (connect(*sd, (struct sockaddr *)address, sizeof(*address)) == -1) {
+            perror("connect");
+            exit(1);
+        }
+    }
+}
+
+/* ================================================================
+ * setReceiveBuffer() — SO_RCVBUFFORCE, falling back to SO_RCVBUF
+ * ================================================================ */
+int setReceiveBuffer(int sd, int bytes) {
+    if (setsockopt(sd, SOL_SOCKET, SO_RCVBUFFORCE, &bytes, sizeof(bytes)) == -1 &&
+        setsockopt(sd, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof(bytes)) == -1) {
+        perror("setsockopt SO_RCVBUF");
+        return -1;
+    }
+    return getReceiveBuffer(sd);
+}
+
+/* ================================================================
+ * getReceiveBuffer() — Effective receive buffer size
+ * ================================================================ */
+int getReceiveBuffer(int sd) {
+    int bytes;
+    socklen_t length = sizeof(bytes);
+
+    if (getsockopt(sd, SOL_SOCKET, SO_RCVBUF, &bytes, &length) == -1) {
+        perror("getsockopt SO_RCVBUF");
+        return -1;
+    }
+    return bytes;
 }
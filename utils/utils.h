@@ -53,6 +53,20 @@ void validateArguments(int argc, char *argv[], struct in_addr *addr, int *port);
  * ================================================================ */
 void printJSONObject(cJSON *obj, ProgramMode mode, int DebugMode);
 
+/* ================================================================
+ * EmitFunc:
+ * printf()-like output callback; `ctx` is passed through unchanged.
+ * ================================================================ */
+typedef void (*EmitFunc)(void *ctx, const char *format, ...);
+
+/* ================================================================
+ * emitJSONObject(): 
+ * Same as printJSONObject(), but every piece of output goes through
+ * emit(ctx, ...) instead of printf(), e.g. into a buffer.
+ * ================================================================ */
+void emitJSONObject(cJSON *obj, ProgramMode mode, int DebugMode,
+                    EmitFunc emit, void *ctx);
+
 /* ================================================================
  * setupSocket(): 
  * Create and configure a UDP socket
@@ -60,12 +74,36 @@ void printJSONObject(cJSON *obj, ProgramMode mode, int DebugMode);
  * Behavior depends on mode:
  *  MODE_CLIENT: Creates socket, sets sin_family and sin_port.
  *               Does NOT set sin_addr (caller sets via inet_pton).
- *               Does NOT bind (OS assigns ephemeral port on sendto).
+ *               Does NOT bind (OS assigns ephemeral port on connect).
+ *               Connects the socket to the address so datagrams can
+ *               be sent with send()/sendmmsg() without a destination.
  *
  *  MODE_SERVER: Creates socket, sets SO_REUSEADDR and SO_REUSEPORT,
- *               sets sin_family, sin_port, sin_addr to INADDR_ANY,
- *               then binds to the address.
+ *               sizes the receive buffer to `rcvbuf` bytes (0 keeps
+ *               the system default), enables SO_RXQ_OVFL drop
+ *               counting, sets sin_family, sin_port, sin_addr to
+ *               INADDR_ANY, then binds to the address.
+ * ================================================================ */
+void setupSocket(int *sd, int port, struct sockaddr_in *address, ProgramMode mode,
+                 int rcvbuf);
+
+/* ================================================================
+ * setReceiveBuffer():
+ * Asks for a `bytes` receive buffer: SO_RCVBUFFORCE first, which
+ * ignores net.core.rmem_max but needs CAP_NET_ADMIN, then SO_RCVBUF,
+ * which the kernel silently caps at rmem_max.
+ *
+ * Returns:
+ *  - the effective size read back (the kernel doubles the request
+ *    to cover its bookkeeping overhead)
+ *  - -1 on error (perror)
+ * ================================================================ */
+int setReceiveBuffer(int sd, int bytes);
+
+/* ================================================================
+ * getReceiveBuffer():
+ * Returns the effective receive buffer size of `sd`, or -1.
  * ================================================================ */
-void setupSocket(int *sd, int port, struct sockaddr_in *address, ProgramMode mode);
+int getReceiveBuffer(int sd);
 
 #endif /* UTILS_H */